@@ -0,0 +1,487 @@
+/*
+  relacsbench.cc
+  Benchmarks the data path from acquisition to disk and screen.
+
+  RELACS - Relaxed ELectrophysiological data Acquisition, Control, and Stimulation
+  Copyright (C) 2002-2015 Jan Benda <jan.benda@uni-tuebingen.de>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+  
+  RELACS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+#include <getopt.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <QApplication>
+#include <QImage>
+#include <relacs/cyclicarray.h>
+#include <relacs/detector.h>
+#include <relacs/eventlist.h>
+#include <relacs/indata.h>
+#include <relacs/inlist.h>
+#include <relacs/plot.h>
+#include <relacs/random.h>
+#include <relacs/str.h>
+#include <relacs/tablekey.h>
+#include <relacs/ephys/thresholdsuspikedetector.h>
+#include <relacs/multielectrode/templatespikesorter.h>
+#ifdef HAVE_NIX
+#include <nix.hpp>
+#include <relacs/nixtracewriter.h>
+#endif
+using namespace std;
+using namespace relacs;
+
+
+  // Count all allocations of the benchmark:
+static atomic< long > Allocations( 0 );
+
+void *operator new( size_t n )
+{
+  Allocations++;
+  void *p = malloc( n > 0 ? n : 1 );
+  if ( p == 0 )
+    throw bad_alloc();
+  return p;
+}
+
+
+void operator delete( void *p ) noexcept
+{
+  free( p );
+}
+
+
+  // Timing and allocation statistics of a single stage of the data path.
+class Stage
+{
+
+public:
+
+  Stage( const string &name )
+    : Name( name ), Samples( 0 ), Allocs( 0 ), Allocs0( 0 ) {};
+
+  void start( void )
+  {
+    Allocs0 = Allocations;
+    T0 = chrono::steady_clock::now();
+  };
+
+  void stop( long samples )
+  {
+    double dt = chrono::duration< double >( chrono::steady_clock::now() - T0 ).count();
+    Allocs += Allocations - Allocs0;
+    Times.push_back( dt );
+    Samples += samples;
+  };
+
+  double total( void ) const
+  {
+    double t = 0.0;
+    for ( unsigned int k=0; k<Times.size(); k++ )
+      t += Times[k];
+    return t;
+  };
+
+  double quantile( double p ) const
+  {
+    if ( Times.empty() )
+      return 0.0;
+    vector< double > times( Times );
+    sort( times.begin(), times.end() );
+    unsigned int k = (unsigned int)::floor( p*( times.size() - 1 ) + 0.5 );
+    return times[k];
+  };
+
+  void save( ostream &str, const TableKey &key, double duration ) const
+  {
+    double t = total();
+    key.save( str, Name, 0 );
+    key.save( str, t > 0.0 ? 1.0e-6*Samples/t : 0.0 );
+    key.save( str, 100.0*t/duration );
+    key.save( str, 1.0e6*quantile( 0.5 ) );
+    key.save( str, 1.0e6*quantile( 0.99 ) );
+    key.save( str, 1.0e6*quantile( 1.0 ) );
+    key.save( str, Times.empty() ? 0.0 : double( Allocs )/Times.size() );
+    str << '\n';
+  };
+
+
+private:
+
+  string Name;
+  vector< double > Times;
+  long Samples;
+  long Allocs;
+  long Allocs0;
+  chrono::steady_clock::time_point T0;
+
+};
+
+
+  // Gives access to the drawing function of a Plot.
+class BenchPlot : public Plot
+{
+
+public:
+
+  BenchPlot( void ) : Plot( Plot::Pointer ) {};
+  void render( QImage &image ) { draw( &image, true ); };
+
+};
+
+
+void writeUsage( void )
+{
+  cerr << '\n';
+  cerr << "usage:\n";
+  cerr << '\n';
+  cerr << "relacsbench [-c ##] [-r ##] [-u ##] [-t ##] [-d dir] [outfile]\n";
+  cerr << '\n';
+  cerr << "Drives synthetic recordings through the data path of RELACS\n";
+  cerr << "(acquisition buffers, detectors, data files, and plots),\n";
+  cerr << "and writes throughput, load, latencies, and allocations of each stage\n";
+  cerr << "as a table to <outfile> or stdout.\n";
+  cerr << "The load is the computation time relative to the duration of the recording.\n";
+  cerr << "  -c: number of channels (default 16)\n";
+  cerr << "  -r: sampling rate in Hz (default 20000)\n";
+  cerr << "  -u: update interval in seconds (default 0.01)\n";
+  cerr << "  -t: duration of the recording in seconds (default 60)\n";
+  cerr << "  -d: directory for the data files (default relacsbench.tmp)\n";
+  cerr << '\n';
+  exit( 1 );
+}
+
+
+int main( int argc, char *argv[] )
+{
+  int channels = 16;
+  double rate = 20000.0;
+  double update = 0.01;
+  double duration = 60.0;
+  string path = "relacsbench.tmp";
+
+  int c;
+  optind = 0;
+  opterr = 0;
+  while ( (c = getopt( argc, argv, "c:r:u:t:d:" )) >= 0 )
+    switch ( c ) {
+    case 'c' :
+      sscanf( optarg, " %d", &channels );
+      break;
+    case 'r' :
+      sscanf( optarg, " %lf", &rate );
+      break;
+    case 'u' :
+      sscanf( optarg, " %lf", &update );
+      break;
+    case 't' :
+      sscanf( optarg, " %lf", &duration );
+      break;
+    case 'd' :
+      path = optarg;
+      break;
+    default :
+      writeUsage();
+    }
+  if ( channels < 1 || rate <= 0.0 || update <= 0.0 || duration < update )
+    writeUsage();
+  ofstream of;
+  if ( optind < argc && argv[optind][0] != '-' ) {
+    of.open( argv[optind] );
+    if ( ! of.good() ) {
+      cerr << "! can't open file " << argv[optind] << " for writing\n";
+      return 1;
+    }
+  }
+  ostream &os = of.is_open() ? of : cout;
+
+  // widgets of the detectors and the plots can be rendered offscreen:
+  if ( getenv( "DISPLAY" ) == 0 )
+    setenv( "QT_QPA_PLATFORM", "offscreen", 0 );
+  QApplication app( argc, argv );
+
+  ::mkdir( path.c_str(), 0755 );
+  Str dir = path;
+  dir.provideLast( Str::dirSep() );
+
+  // synthetic recordings: one second of noise with spikes at 20Hz,
+  // repeated with different offsets for each channel:
+  int nupdate = (int)::rint( update*rate );
+  int nupdates = (int)::floor( duration/update );
+  int nsource = (int)::rint( rate );
+  if ( nsource < 4*nupdate )
+    nsource = 4*nupdate;
+  vector< float > source( nsource );
+  for ( int k=0; k<nsource; k++ )
+    source[k] = 0.1*rnd.gaussian();
+  int spikewidth = (int)::ceil( 0.001*rate );
+  for ( int k=rnd( (unsigned long)(0.05*rate) ); k+spikewidth<nsource; k += 1 + rnd( (unsigned long)(0.1*rate) ) ) {
+    for ( int j=0; j<spikewidth; j++ )
+      source[k+j] += ::sin( 2.0*M_PI*j/spikewidth );
+  }
+
+  // input traces:
+  int capacity = (int)::ceil( 10.0*rate );
+  InList traces;
+  for ( int c=0; c<channels; c++ ) {
+    InData *id = new InData( capacity, 1.0/rate );
+    id->setIdent( "V-" + Str( c+1 ) );
+    id->setUnit( "mV" );
+    id->setChannel( c );
+    id->setDevice( 0 );
+    traces.add( id, true );
+  }
+  vector< CyclicArrayF > rings( channels, CyclicArrayF( capacity ) );
+
+  // detectors:
+  typedef Detector< InData::const_iterator, InDataTimeIterator > InDataDetector;
+  vector< InDataDetector > detectors( channels, InDataDetector( 2 ) );
+  AcceptEvent< InData::const_iterator, InDataTimeIterator > accept;
+  vector< EventList* > peaks( channels );
+  vector< double > thresholds( channels, 0.5 );
+  EventList spikes;
+  EventList other;
+  EventData stimuli( 100, true, true );
+  stimuli.setCyclic();
+  vector< ephys::ThresholdSUSpikeDetector* > spikedetectors( channels );
+  for ( int c=0; c<channels; c++ ) {
+    detectors[c].init( traces[c].begin(), traces[c].end(), traces[c].timeBegin() );
+    peaks[c] = new EventList( 2, 10000, true, true );
+    (*peaks[c])[0].setCyclic();
+    (*peaks[c])[1].setCyclic();
+    EventData *ed = new EventData( 10000, true, true );
+    ed->setCyclic();
+    ed->setIdent( "Spikes-" + Str( c+1 ) );
+    spikes.add( ed, true );
+    spikedetectors[c] = new ephys::ThresholdSUSpikeDetector( "Spikes-" + Str( c+1 ), 0 );
+    spikedetectors[c]->setNumber( "threshold", 0.5 );
+    spikedetectors[c]->init( traces[c], spikes[c], other, stimuli );
+  }
+
+  // spike sorter on all channels, learning its templates in the first quarter:
+  multielectrode::TemplateSpikeSorter sorter( "Units", 0 );
+  EventList units;
+  for ( int k=0; k<multielectrode::TemplateSpikeSorter::MaxUnits; k++ ) {
+    EventData *ed = new EventData( 10000, true, true );
+    ed->setCyclic();
+    ed->setIdent( "Unit-" + Str( k+1 ) );
+    units.add( ed, true );
+  }
+  sorter.setNumber( "learntime", 0.25*duration );
+  sorter.init( traces, units, other, stimuli );
+
+  // RELACS data files:
+  vector< ofstream* > tracefiles( channels );
+  vector< int > traceindices( channels, 0 );
+  vector< ofstream* > eventfiles( channels );
+  vector< int > eventindices( channels, 0 );
+  TableKey eventkey;
+  eventkey.addNumber( "t", "sec", "%0.5f" );
+  eventkey.addNumber( "size", "mV", "%5.1f" );
+  eventkey.addNumber( "width", "ms", "%4.2f" );
+  for ( int c=0; c<channels; c++ ) {
+    tracefiles[c] = new ofstream( ( dir + "trace-" + Str( c+1 ) + ".raw" ).c_str(),
+				  ios::out | ios::binary );
+    eventfiles[c] = new ofstream( ( dir + "spikes-" + Str( c+1 ) + "-events.dat" ).c_str() );
+    *eventfiles[c] << "# events: Spikes-" << c+1 << "\n\n";
+    eventkey.saveKey( *eventfiles[c] );
+  }
+
+#ifdef HAVE_NIX
+  // NIX file:
+  string nixpath = dir + "relacsbench.nix";
+  nix::File nixfile = nix::File::open( nixpath, nix::FileMode::Overwrite );
+  nix::Block nixblock = nixfile.createBlock( "relacsbench", "relacs.recording" );
+  NixTraceWriter nixwriter;
+  vector< int > nixindices( channels, 0 );
+  size_t chunksize = NixTraceWriter::chunkSize( rate );
+  for ( int c=0; c<channels; c++ ) {
+    nix::DataArray da = nixblock.createDataArray( traces[c].ident(),
+						  "relacs.data.sampled." + traces[c].ident(),
+						  nix::DataType::Float, { 0 } );
+    da.appendSampledDimension( 1.0/rate );
+    nixwriter.addTrace( da, chunksize );
+  }
+  nixwriter.start();
+#endif
+
+  // plot of the first trace:
+  BenchPlot plot;
+  plot.resize( 800, 300 );
+  plot.setXRange( -1.0, 0.0 );
+  plot.setYRange( -2.0, 2.0 );
+  plot.plot( traces[0], 1, 0.0, 1.0, Plot::Green, 2, Plot::Solid );
+  QImage image( 800, 300, QImage::Format_RGB32 );
+
+  vector< Stage > stages;
+  stages.push_back( Stage( "cyclicarray-push" ) );
+  stages.push_back( Stage( "inlist-updateraw" ) );
+  stages.push_back( Stage( "detector-peaktrough" ) );
+  stages.push_back( Stage( "ephys-spikedetector" ) );
+  stages.push_back( Stage( "multielectrode-sorter" ) );
+  stages.push_back( Stage( "relacs-traces" ) );
+  stages.push_back( Stage( "relacs-events" ) );
+#ifdef HAVE_NIX
+  stages.push_back( Stage( "nix-traces" ) );
+#endif
+  stages.push_back( Stage( "plot-drawline" ) );
+
+  for ( int u=0; u<nupdates; u++ ) {
+    long samples = long( channels )*nupdate;
+    int s = 0;
+
+    // element-wise push into cyclic buffers:
+    stages[s].start();
+    for ( int c=0; c<channels; c++ ) {
+      int offs = ( u*nupdate + c*nsource/channels ) % nsource;
+      for ( int k=0; k<nupdate; k++ )
+	rings[c].push( source[(offs+k)%nsource] );
+    }
+    stages[s++].stop( samples );
+
+    // transfer into input traces as done by the analog input devices:
+    stages[s].start();
+    for ( int c=0; c<channels; c++ ) {
+      int offs = ( u*nupdate + c*nsource/channels ) % nsource;
+      int n = nupdate;
+      while ( n > 0 ) {
+	int m = traces[c].maxPush();
+	if ( m > n )
+	  m = n;
+	if ( m > nsource - offs )
+	  m = nsource - offs;
+	memcpy( traces[c].pushBuffer(), &source[offs], m*sizeof( float ) );
+	traces[c].push( m );
+	offs = ( offs + m ) % nsource;
+	n -= m;
+      }
+    }
+    traces.updateRaw();
+    stages[s++].stop( samples );
+
+    // peak and trough detection:
+    stages[s].start();
+    for ( int c=0; c<channels; c++ )
+      detectors[c].peakTrough( traces[c].minBegin(), traces[c].end(), *peaks[c],
+			       thresholds[c], thresholds[c], thresholds[c], accept );
+    stages[s++].stop( samples );
+
+    // spike detection:
+    stages[s].start();
+    for ( int c=0; c<channels; c++ )
+      spikedetectors[c]->detect( traces[c], spikes[c], other, stimuli );
+    stages[s++].stop( samples );
+
+    // spike sorting, templates are learned on a separate thread:
+    stages[s].start();
+    sorter.detect( traces, units, other, stimuli );
+    stages[s++].stop( samples );
+
+    // RELACS raw traces:
+    stages[s].start();
+    for ( int c=0; c<channels; c++ ) {
+      int n = traces[c].saveBinary( *tracefiles[c], traceindices[c] );
+      if ( n > 0 )
+	traceindices[c] += n;
+    }
+    stages[s++].stop( samples );
+
+    // RELACS event files:
+    stages[s].start();
+    for ( int c=0; c<channels; c++ ) {
+      if ( eventindices[c] < spikes[c].minEvent() )
+	eventindices[c] = spikes[c].minEvent();
+      for ( ; eventindices[c] < spikes[c].size(); eventindices[c]++ ) {
+	eventkey.save( *eventfiles[c], spikes[c][eventindices[c]], 0 );
+	eventkey.save( *eventfiles[c], spikes[c].eventSize( eventindices[c] ) );
+	eventkey.save( *eventfiles[c], 1000.0*spikes[c].eventWidth( eventindices[c] ) );
+	*eventfiles[c] << '\n';
+      }
+    }
+    stages[s++].stop( samples );
+
+#ifdef HAVE_NIX
+    // NIX traces:
+    stages[s].start();
+    for ( int c=0; c<channels; c++ ) {
+      while ( nixindices[c] < traces[c].size() ) {
+	int n = 0;
+	const float *data = traces[c].readBuffer( nixindices[c], n );
+	if ( n <= 0 )
+	  break;
+	nixwriter.append( c, data, n );
+	nixindices[c] += n;
+      }
+    }
+    stages[s++].stop( samples );
+#endif
+
+    // draw the first trace:
+    stages[s].start();
+    plot.render( image );
+    stages[s++].stop( nupdate );
+  }
+
+#ifdef HAVE_NIX
+  nixwriter.stop();
+  nixfile.close();
+  ::remove( nixpath.c_str() );
+#endif
+  for ( int c=0; c<channels; c++ ) {
+    tracefiles[c]->close();
+    delete tracefiles[c];
+    ::remove( ( dir + "trace-" + Str( c+1 ) + ".raw" ).c_str() );
+    eventfiles[c]->close();
+    delete eventfiles[c];
+    ::remove( ( dir + "spikes-" + Str( c+1 ) + "-events.dat" ).c_str() );
+    delete spikedetectors[c];
+    delete peaks[c];
+  }
+  ::rmdir( path.c_str() );
+
+  // results:
+  os << "# benchmark: relacsbench\n";
+  os << "# version  : " << VERSION << '\n';
+  os << "# channels : " << channels << '\n';
+  os << "# rate     : " << Str( 0.001*rate, "%g" ) << "kHz\n";
+  os << "# update   : " << Str( 1000.0*update, "%g" ) << "ms\n";
+  os << "# duration : " << Str( nupdates*update, "%g" ) << "s\n";
+  os << "# units    : " << sorter.integer( "units" ) << '\n';
+  os << '\n';
+  TableKey key;
+  key.addText( "stage", -20 );
+  key.addNumber( "throughput", "MS/s", "%10.3f" );
+  key.addNumber( "load", "%", "%6.2f" );
+  key.addNumber( "p50", "us", "%9.1f" );
+  key.addNumber( "p99", "us", "%9.1f" );
+  key.addNumber( "max", "us", "%9.1f" );
+  key.addNumber( "allocs", "1/update", "%8.2f" );
+  key.saveKey( os );
+  for ( unsigned int k=0; k<stages.size(); k++ )
+    stages[k].save( os, key, nupdates*update );
+
+  return 0;
+}
@@ -0,0 +1,138 @@
+/*
+  aoconversion.cc
+  Benchmark for converting analog output data into raw integer data
+
+  RELACS - Relaxed ELectrophysiological data Acquisition, Control, and Stimulation
+  Copyright (C) 2002-2015 Jan Benda <jan.benda@uni-tuebingen.de>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+  
+  RELACS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cmath>
+#include <ctime>
+#include <iostream>
+#include <relacs/outlist.h>
+#include <relacs/aoconversion.h>
+using namespace std;
+using namespace relacs;
+
+
+  /* The conversion as it was done by the comedi driver for each single value. */
+unsigned int fromPhysical( float v, double minval, double maxval, double scale,
+			   const double *coeff, int order, double origin,
+			   unsigned int maxdata )
+{
+  if ( v > maxval )
+    v = maxval;
+  else if ( v < minval )
+    v = minval;
+  v *= scale;
+  double value = 0.0;
+  double term = 1.0;
+  for ( int i=0; i<=order; i++ ) {
+    value += coeff[i] * term;
+    term *= v - origin;
+  }
+  if ( value < 0.0 )
+    return 0;
+  unsigned int d = (unsigned int)::nearbyint( value );
+  return d > maxdata ? maxdata : d;
+}
+
+
+int main( int argc, char **argv )
+{
+  const int nchannels = 2;
+  const int nbuffer = 8192;
+  const double duration = 100.0;
+  const double stepsize = 0.00005;
+  const unsigned int maxdata = 0xffff;
+  const double coeff[4] = { 32767.5, 3276.75, 0.5, 0.01 };
+  const double origin = 0.0;
+
+  OutList sigs;
+  for ( int k=0; k<nchannels; k++ ) {
+    OutData *sig = new OutData;
+    unsigned long seed = 42 + k;
+    sig->noiseWave( duration, stepsize, 1000.0, 3.0, &seed );
+    sigs.add( sig, true );
+  }
+  cout << "converting " << nchannels << " channels with "
+       << sigs[0].size() << " samples each\n";
+
+  unsigned short *buffer1 = new unsigned short[ nbuffer ];
+  unsigned short *buffer2 = new unsigned short[ nbuffer ];
+  int maxrows = nbuffer / nchannels;
+
+  // scalar conversion:
+  unsigned short *result = new unsigned short[ nchannels*sigs[0].size() ];
+  for ( int k=0; k<nchannels; k++ )
+    sigs[k].deviceReset( 100 );
+  clock_t t0 = clock();
+  unsigned short *rp = result;
+  while ( sigs[0].deviceWriting() ) {
+    unsigned short *bp = buffer1;
+    for ( int i=0; i<maxrows && sigs[0].deviceWriting(); i++ ) {
+      for ( int k=0; k<nchannels; k++ ) {
+	if ( sigs[k].deviceCount() < 0 ) {
+	  *bp = 0;
+	  sigs[k].incrDeviceIndex();
+	  if ( sigs[k].deviceIndex() >= sigs[k].deviceDelay() )
+	    sigs[k].incrDeviceCount();
+	}
+	else {
+	  *bp = fromPhysical( sigs[k].deviceValue(), -10.0, 10.0, 1.0,
+			      coeff, 3, origin, maxdata );
+	  if ( sigs[k].deviceIndex() >= sigs[k].deviceSize() )
+	    sigs[k].incrDeviceCount();
+	  *rp++ = *bp;
+	}
+	++bp;
+      }
+    }
+  }
+  double t1 = double( clock() - t0 ) / CLOCKS_PER_SEC;
+  cout << "scalar conversion: " << t1 << "s\n";
+
+  // block conversion:
+  AOConversion conv[ nchannels ];
+  unsigned short zeros[ nchannels ];
+  for ( int k=0; k<nchannels; k++ ) {
+    conv[k].setRange( -10.0, 10.0 );
+    conv[k].setPolynomial( coeff, 3, origin );
+    conv[k].setDataRange( 0.0, maxdata );
+    zeros[k] = 0;
+    sigs[k].deviceReset( 100 );
+  }
+  t0 = clock();
+  rp = result;
+  int diffs = 0;
+  int delay = 100*nchannels;
+  while ( sigs[0].deviceWriting() ) {
+    int n = nchannels * convertAO( sigs, conv, zeros, buffer2, maxrows );
+    for ( int i=delay; i<n; i++ ) {
+      if ( buffer2[i] != *rp++ )
+	diffs++;
+    }
+    delay = delay > n ? delay - n : 0;
+  }
+  double t2 = double( clock() - t0 ) / CLOCKS_PER_SEC;
+  cout << "block conversion:  " << t2 << "s (speedup " << t1/t2 << ")\n";
+  cout << "differences: " << diffs << '\n';
+
+  delete [] buffer1;
+  delete [] buffer2;
+  delete [] result;
+  return 0;
+}
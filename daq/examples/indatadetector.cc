@@ -0,0 +1,178 @@
+/*
+  indatadetector.cc
+  Benchmarks the Detector on the cyclic buffer of an InData.
+
+  RELACS - Relaxed ELectrophysiological data Acquisition, Control, and Stimulation
+  Copyright (C) 2002-2015 Jan Benda <jan.benda@uni-tuebingen.de>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+
+  RELACS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cmath>
+#include <chrono>
+#include <iostream>
+#include <vector>
+#include <relacs/random.h>
+#include <relacs/eventlist.h>
+#include <relacs/detector.h>
+#include <relacs/indata.h>
+using namespace std;
+using namespace relacs;
+
+
+  // Iterator over an InData that hides the cyclic buffer
+  // from the Detector, so that the data are traversed element by element:
+class ElementIterator
+{
+
+public:
+
+  ElementIterator( void ) : P() {};
+  ElementIterator( const InDataIterator &p ) : P( p ) {};
+  bool operator==( const ElementIterator &p ) const { return P == p.P; };
+  bool operator!=( const ElementIterator &p ) const { return P != p.P; };
+  bool operator<( const ElementIterator &p ) const { return P < p.P; };
+  bool operator>( const ElementIterator &p ) const { return P > p.P; };
+  bool operator<=( const ElementIterator &p ) const { return P <= p.P; };
+  bool operator>=( const ElementIterator &p ) const { return P >= p.P; };
+  const ElementIterator &operator++( void ) { ++P; return *this; };
+  const ElementIterator &operator+=( int n ) { P += n; return *this; };
+  ElementIterator operator+( int n ) const { return ElementIterator( P+n ); };
+  int operator-( const ElementIterator &p ) const { return P - p.P; };
+  double operator*( void ) const { return *P; };
+
+private:
+
+  InDataIterator P;
+
+};
+
+
+template < typename DataIter, typename TimeIter >
+class AcceptPeakTrough
+{
+
+public:
+
+  int checkPeak( DataIter first, DataIter last,
+		 DataIter event, TimeIter eventtime,
+		 DataIter index, TimeIter indextime,
+		 DataIter prevevent, TimeIter prevtime,
+		 EventList &outevents,
+		 double &threshold,
+		 double &minthresh, double &maxthresh,
+		 double &time, double &size, double &width )
+  {
+    time = *eventtime;
+    size = *event;
+    width = 0.0;
+    return 1;
+  }
+
+  int checkTrough( DataIter first, DataIter last,
+		   DataIter event, TimeIter eventtime,
+		   DataIter index, TimeIter indextime,
+		   DataIter prevevent, TimeIter prevtime,
+		   EventList &outevents,
+		   double &threshold,
+		   double &minthresh, double &maxthresh,
+		   double &time, double &size, double &width )
+  {
+    time = *eventtime;
+    size = *event;
+    width = 0.0;
+    return 1;
+  }
+
+};
+
+
+/*
+  Sparse spikes in noise sampled with 20kHz are pushed in chunks of
+  10ms into an InData holding one second, such that its cyclic buffer
+  wraps around many times. After each chunk peakTrough() is called
+  on the data, once with InData::const_iterator, which uses the
+  DetectorBuffer specialization for InDataIterator,
+  and once element by element. The detected events have to be identical.
+*/
+
+int main( int argc, char **argv )
+{
+  double stepsize = 0.00005;
+  double duration = 200.0;
+  double threshold = 1.0;
+  int n = (int)::rint( duration/stepsize );
+  int chunk = (int)::rint( 0.01/stepsize );
+
+  vector< float > spikes( n );
+  for ( int k=0; k<n; k++ )
+    spikes[k] = 0.1*rnd.gaussian();
+  for ( double t=0.01; t<duration; t += 0.05 + 0.05*rnd() ) {
+    int inx = (int)::rint( t/stepsize );
+    for ( int k=0; k<20 && inx+k < n; k++ )
+      spikes[inx+k] += 2.0*::sin( M_PI*k/10.0 );
+  }
+
+  InData data( (int)::rint( 1.0/stepsize ), stepsize );
+
+  typedef InData::const_range_iterator TimeIter;
+  Detector< InData::const_iterator, TimeIter > fastd;
+  AcceptPeakTrough< InData::const_iterator, TimeIter > fastcheck;
+  fastd.init( data.begin(), data.end(), data.timeBegin() );
+  EventList fastevents( 2, n/100 );
+
+  Detector< ElementIterator, TimeIter > slowd;
+  AcceptPeakTrough< ElementIterator, TimeIter > slowcheck;
+  slowd.init( ElementIterator( data.begin() ), ElementIterator( data.end() ),
+	      data.timeBegin() );
+  EventList slowevents( 2, n/100 );
+
+  double tfast = 0.0;
+  double tslow = 0.0;
+  for ( int k=0; k<n; k+=chunk ) {
+    for ( int j=k; j<k+chunk && j<n; j++ )
+      data.push( spikes[j] );
+
+    auto t0 = chrono::steady_clock::now();
+    fastd.peakTrough( data.minBegin(), data.end(), fastevents,
+		      threshold, threshold, threshold, fastcheck );
+    auto t1 = chrono::steady_clock::now();
+    slowd.peakTrough( ElementIterator( data.minBegin() ), ElementIterator( data.end() ),
+		      slowevents, threshold, threshold, threshold, slowcheck );
+    auto t2 = chrono::steady_clock::now();
+    tfast += chrono::duration< double >( t1 - t0 ).count();
+    tslow += chrono::duration< double >( t2 - t1 ).count();
+  }
+
+  bool identical = ( slowevents[0].size() == fastevents[0].size() &&
+		     slowevents[1].size() == fastevents[1].size() );
+  for ( int j=0; j<2 && identical; j++ ) {
+    for ( int k=0; k<slowevents[j].size(); k++ ) {
+      if ( slowevents[j][k] != fastevents[j][k] ||
+	   slowevents[j].eventSize( k ) != fastevents[j].eventSize( k ) ) {
+	identical = false;
+	break;
+      }
+    }
+  }
+  cout << "peakTrough() on " << n << " data elements of an InData holding "
+       << data.capacity() << ": "
+       << fastevents[0].size() << " peaks, "
+       << fastevents[1].size() << " troughs\n";
+  cout << "  element by element: " << 1000.0*tslow << "ms\n";
+  cout << "  contiguous buffer:  " << 1000.0*tfast << "ms\n";
+  cout << "  identical events:   " << ( identical ? "yes" : "no" ) << '\n';
+
+  return identical ? 0 : 1;
+}
@@ -0,0 +1,107 @@
+/*
+  outdatastream.cc
+  Checks OutDataSource streaming against the in-memory stimuli
+
+  RELACS - Relaxed ELectrophysiological data Acquisition, Control, and Stimulation
+  Copyright (C) 2002-2015 Jan Benda <jan.benda@uni-tuebingen.de>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+
+  RELACS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cmath>
+#include <iostream>
+#include <relacs/outdata.h>
+#include <relacs/outdatasource.h>
+#include <relacs/stats.h>
+using namespace std;
+using namespace relacs;
+
+
+  /* Maximum absolute difference between the samples of \a stream
+     read via streamValue() and the samples of \a data. */
+double maxDiff( OutData &stream, const SampleDataF &data )
+{
+  double max = 0.0;
+  for ( int k=0; k<data.size() && k<stream.deviceSize(); k++ ) {
+    double d = ::fabs( stream.streamValue( k ) - data[k] );
+    if ( d > max )
+      max = d;
+  }
+  return max;
+}
+
+
+int main( int argc, char **argv )
+{
+  const double duration = 2.0;
+  const double stepsize = 0.0001;
+  int errors = 0;
+
+  // many small blocks:
+  OutData::setStreamBlockSize( 1000 );
+
+  // streamed sine wave versus sineWave():
+  OutData sine;
+  sine.setSource( SineSource( 50.0, 2.0, 0.5 ), duration, stepsize );
+  OutData sinewave;
+  sinewave.sineWave( duration, stepsize, 50.0, 0.5, 2.0 );
+  double d = maxDiff( sine, sinewave );
+  cout << "sine: " << sine.deviceSize() << " streamed samples, "
+       << sinewave.size() << " samples of sineWave(), "
+       << "maximum difference " << d << '\n';
+  if ( sine.deviceSize() != sinewave.size() || d > 1.0e-5 )
+    errors++;
+
+  // the same noise for the same seed:
+  unsigned long seed = 42;
+  NoiseSource noise( 10.0, 500.0, 1.5, &seed );
+  OutData noise1;
+  noise1.setSource( noise, duration, stepsize );
+  OutData noise2;
+  noise2.setSource( NoiseSource( 10.0, 500.0, 1.5, &seed ), duration, stepsize );
+  SampleDataF noisedata( noise2.deviceSize(), 0.0, stepsize );
+  for ( int k=0; k<noise2.deviceSize(); k++ )
+    noisedata[k] = noise2.streamValue( k );
+  d = maxDiff( noise1, noisedata );
+  cout << "noise with seed " << seed << ": maximum difference " << d
+       << ", standard deviation " << stdev( noisedata ) << '\n';
+  if ( d > 0.0 || ::fabs( stdev( noisedata ) - 1.5 ) > 0.15 )
+    errors++;
+
+  // a different seed gives a different noise:
+  unsigned long seed3 = seed + 1;
+  OutData noise3;
+  noise3.setSource( NoiseSource( 10.0, 500.0, 1.5, &seed3 ), duration, stepsize );
+  d = maxDiff( noise3, noisedata );
+  cout << "noise with seed " << seed3 << ": maximum difference " << d << '\n';
+  if ( d == 0.0 )
+    errors++;
+
+  // stepping back into the previous block and to the start:
+  d = 0.0;
+  for ( int k=1500; k<noisedata.size(); k+=700 ) {
+    for ( int j=k; j>k-1200; j-=150 ) {
+      double dd = ::fabs( noise1.streamValue( j ) - noisedata[j] );
+      if ( dd > d )
+	d = dd;
+    }
+  }
+  d += ::fabs( noise1.streamValue( 0 ) - noisedata[0] );
+  cout << "noise stepping back: maximum difference " << d << '\n';
+  if ( d > 0.0 )
+    errors++;
+
+  cout << ( errors > 0 ? "FAILED" : "passed" ) << '\n';
+  return errors > 0 ? 1 : 0;
+}
@@ -29,6 +29,7 @@
 #include <QReadWriteLock>
 #include <QSemaphore>
 #include <QWaitCondition>
+#include <relacs/datawaitqueue.h>
 #include <relacs/tracespec.h>
 #include <relacs/inlist.h>
 #include <relacs/outlist.h>
@@ -693,6 +694,8 @@ protected:
   mutable QReadWriteLock ReadMutex;
     /*! Waits on new data in input traces. */
   QWaitCondition ReadWait;
+    /*! Threads in getRawData() waiting for data or signals. */
+  DataWaitQueue RawDataWait;
     /*! The input data from the last read(). */
   InList InTraces;
     /*! The size of InTraces at the last updateRawData(). */
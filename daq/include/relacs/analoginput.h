@@ -238,6 +238,17 @@ public:
 	\return -1: Failed to match a trace. */
   virtual int matchTraces( InList &traces ) const;
 
+    /*! Devices replaying recorded data return in \a signaltimes and
+        \a signaldurations the times and durations of the recorded
+        stimuli and in \a restarttimes the times of the recorded
+        restarts of the acquisition that have been replayed since the
+        previous call, all in seconds of the input traces.
+        This function is called by Acquire::waitForData().
+        The default implementation returns nothing. */
+  virtual void replayedEvents( vector< double > &signaltimes,
+			       vector< double > &signaldurations,
+			       vector< double > &restarttimes );
+
     /*! The id of the analog input implementation.
         \sa setAnalogInputType(), deviceType(), deviceName(), ident() */
   int analogInputType( void ) const;
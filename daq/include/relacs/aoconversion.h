@@ -0,0 +1,127 @@
+/*
+  aoconversion.h
+  Converts voltages of analog output signals into raw integer data
+
+  RELACS - Relaxed ELectrophysiological data Acquisition, Control, and Stimulation
+  Copyright (C) 2002-2015 Jan Benda <jan.benda@uni-tuebingen.de>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+  
+  RELACS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _RELACS_AOCONVERSION_H_
+#define _RELACS_AOCONVERSION_H_ 1
+
+#include <relacs/outlist.h>
+
+namespace relacs {
+
+
+/*!
+\class AOConversion
+\author Jan Benda
+\brief Converts voltages of analog output signals into raw integer data.
+
+The conversion of a single voltage \a v proceeds in the following steps:
+1. \a v is clipped to the range set by setRange().
+2. \a v is multiplied by the factor set by setScale(),
+   resulting in \f$ x = \mathrm{scale} \cdot v \f$.
+3. The calibration polynomial set by setPolynomial()
+   \f[ y = \sum_{i=0}^{\mathrm{order}} c_i (x - x_0)^i \f]
+   or the linear function \f$ y = \mathrm{offset} + \mathrm{gain} \cdot x \f$
+   set by setLinear() is evaluated.
+4. \a y is clipped to the range of the raw data set by setDataRange().
+5. \a y is rounded to the nearest integer (ties to even, like \c nearbyint() )
+   or truncated towards zero, depending on setRounding().
+
+convert() does this for a single value. The convertAO() functions
+apply this to whole blocks of data of several channels at once,
+using SIMD instructions if available, and interleave the results
+into the buffer of an analog output device. They are used by the
+hardware drivers for filling up their buffers.
+*/
+
+class AOConversion
+{
+
+public:
+
+    /*! Construct an identity conversion that rounds to the nearest integer.
+        Values are neither clipped nor scaled. */
+  AOConversion( void );
+
+    /*! Clip voltages to the range \a minval to \a maxval before scaling. */
+  void setRange( double minval, double maxval );
+    /*! Multiply the clipped voltages by \a scale. */
+  void setScale( double scale );
+    /*! Use the calibration polynomial with the \a order + 1 \a coefficients
+        expanded around \a origin. \a order must not exceed 3. */
+  void setPolynomial( const double *coefficients, int order, double origin=0.0 );
+    /*! Use the linear function \a offset + \a gain times the scaled voltage. */
+  void setLinear( double offset, double gain );
+    /*! Clip the raw data to the range \a mindata to \a maxdata.
+        This range must fit into a signed 32-bit integer. */
+  void setDataRange( double mindata, double maxdata );
+    /*! Round the raw data to the nearest integer if \a round
+        is \c true (default), truncate them towards zero otherwise. */
+  void setRounding( bool round );
+
+    /*! Convert the voltage \a v into raw data of type \a T. */
+  template < typename T >
+  T convert( float v ) const;
+
+  template < typename T >
+  friend void convertAO( const AOConversion *conv, const float * const *src,
+			 int nchannels, int n, T *dest );
+
+
+private:
+
+  double MinVal;
+  double MaxVal;
+  double Scale;
+  int Order;
+  double Coefficients[4];
+  double Origin;
+  double MinData;
+  double MaxData;
+  bool Round;
+
+};
+
+
+  /*! Convert the \a n voltages of each of the \a nchannels arrays \a src
+      by the corresponding conversions \a conv and write them interleaved
+      into \a dest, i.e. the \a i-th value of channel \a k goes to
+      <tt>dest[i*nchannels+k]</tt>.
+      \a T can be \c unsigned short, \c unsigned \c int, or \c signed \c short. */
+template < typename T >
+void convertAO( const AOConversion *conv, const float * const *src,
+		int nchannels, int n, T *dest );
+
+  /*! Fill the buffer \a dest of an analog output device with
+      at most \a maxrows rows of converted data of the signals \a sigs.
+      Each row holds one value of each channel.
+      The device indices of the signals are advanced accordingly.
+      During the delay of the signals the raw values \a zeros are written.
+      The conversion for the \a k-th signal is given by \a conv[k].
+      Streamed signals are converted block by block.
+      \return the number of rows written to \a dest. */
+template < typename T >
+int convertAO( OutList &sigs, const AOConversion *conv, const T *zeros,
+	       T *dest, int maxrows );
+
+
+}; /* namespace relacs */
+
+#endif /* ! _RELACS_AOCONVERSION_H_ */
@@ -0,0 +1,132 @@
+/*
+  datawaitqueue.h
+  Threads waiting for data up to a given trace or signal time.
+
+  RELACS - Relaxed ELectrophysiological data Acquisition, Control, and Stimulation
+  Copyright (C) 2002-2015 Jan Benda <jan.benda@uni-tuebingen.de>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+  
+  RELACS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _RELACS_DATAWAITQUEUE_H_
+#define _RELACS_DATAWAITQUEUE_H_ 1
+
+#include <map>
+#include <climits>
+#include <values.h>
+#include <QMutex>
+#include <QReadWriteLock>
+#include <QWaitCondition>
+using namespace std;
+
+namespace relacs {
+
+
+/*! 
+\class DataWaitQueue
+\author Jan Benda
+\brief Threads waiting for data up to a given trace or signal time.
+
+Unlike a plain QWaitCondition, where each update of the data wakes up
+all waiting threads, a thread waiting in wait() specifies the time
+of the input traces it needs and/or the time of the last signal it
+has seen. The producer of the data calls wakeUp() with the current
+trace time and signal time, and only the threads whose requested
+times have been reached are woken up.
+For each waiting thread this costs O(log n) for registering
+and waking it up.
+
+The data are protected by a lock that is read-locked by the waiting
+threads and write-locked by the producer while modifying the data.
+wakeUp() has to be called after the data have been modified.
+Call wakeAll() whenever the state changes in a way the waiting
+threads need to check, like stopping the acquisition.
+*/
+
+class DataWaitQueue
+{
+
+public:
+
+    /*! Constructs an empty wait queue. */
+  DataWaitQueue( void );
+    /*! Destructor. Wakes up all waiting threads. */
+  ~DataWaitQueue( void );
+
+    /*! Block the calling thread until the trace time passed to wakeUp()
+        is at least \a tracetime, or the signal time passed to wakeUp()
+        is larger than \a signaltime, or wakeAll() was called, or
+        \a time milliseconds elapsed.
+	\a lock has to be locked for reading by the calling thread.
+	It is released while waiting and again locked for reading
+	before returning.
+	\return \c false if \a time elapsed without being woken up. */
+  bool wait( QReadWriteLock *lock, double tracetime,
+	     double signaltime=MAXDOUBLE, unsigned long time=ULONG_MAX );
+    /*! Block the calling thread as the function above,
+        but for data guarded by the locked \a mutex. */
+  bool wait( QMutex *mutex, double tracetime,
+	     double signaltime=MAXDOUBLE, unsigned long time=ULONG_MAX );
+
+    /*! Wake up all threads that wait for a trace time smaller than
+        or equal to \a tracetime, or for a signal time smaller
+        than \a signaltime.
+	\return the number of threads woken up. */
+  int wakeUp( double tracetime, double signaltime );
+    /*! Wake up all waiting threads. */
+  void wakeAll( void );
+
+    /*! The number of currently waiting threads. */
+  int size( void ) const;
+    /*! The smallest trace time a thread is waiting for,
+        or MAXDOUBLE if no thread waits for data. */
+  double nextTraceTime( void ) const;
+
+
+private:
+
+  struct Waiter;
+  typedef multimap< double, Waiter* > WaiterMap;
+
+    /*! A waiting thread. */
+  struct Waiter
+  {
+    QWaitCondition Condition;
+    bool Woken;
+    WaiterMap::iterator TraceIter;
+    WaiterMap::iterator SignalIter;
+  };
+
+    /*! Register a waiter, block on Mutex until woken up or timed out.
+        Mutex must be locked. */
+  bool wait( double tracetime, double signaltime, unsigned long time );
+    /*! Remove \a w from the maps and wake it up. Mutex must be locked. */
+  void wake( Waiter *w );
+    /*! Remove \a w from the maps. Mutex must be locked. */
+  void remove( Waiter *w );
+
+    /*! All waiting threads sorted by the requested trace time. */
+  WaiterMap TraceWaiters;
+    /*! The threads waiting for a signal sorted by the requested signal time. */
+  WaiterMap SignalWaiters;
+    /*! The number of waiting threads. */
+  int Waiting;
+  mutable QMutex Mutex;
+
+};
+
+
+}; /* namespace relacs */
+
+#endif /* ! _RELACS_DATAWAITQUEUE_H_ */
@@ -26,6 +26,7 @@
 #include <string>
 #include <vector>
 #include <relacs/cyclicsampledata.h>
+#include <relacs/detector.h>
 #include <relacs/daqerror.h>
 using namespace std;
 
@@ -660,6 +661,13 @@ public:
     /*! Returns the value of the data element where the iterator + \a n points to. */
   inline double operator[]( int n ) const
     { assert( ID != 0 && Index+n >= ID->minIndex() && Index+n < ID->size() ); return (*ID)[Index+n]; };
+    /*! Returns a pointer to the data element where the iterator points to
+        in the cyclic buffer of the InData.
+        In \a maxn the maximum number of consecutive data elements
+        that can be read from this buffer is returned.
+	\sa CyclicArray::readBuffer() */
+  inline const float *readBuffer( int &maxn ) const
+    { assert( ID != 0 ); return ID->readBuffer( Index, maxn ); };
     
     
 protected:
@@ -669,6 +677,29 @@ protected:
     
 };
 
+
+/*! Contiguous memory of an InData for the Detector. The cyclic
+    buffer is split into at most two contiguous spans. */
+template <>
+class DetectorBuffer< InDataIterator >
+{
+
+public:
+
+  typedef float value_type;
+  static const bool Contiguous = true;
+
+  static const value_type *buffer( const InDataIterator &iter,
+				   const InDataIterator &last, int &n )
+  {
+    const float *buf = iter.readBuffer( n );
+    if ( n > last - iter )
+      n = last - iter;
+    return buf;
+  };
+
+};
+
 /*! 
   \class InDataDiffIterator
   \author Jan Benda
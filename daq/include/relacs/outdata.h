@@ -28,6 +28,7 @@
 #include <relacs/sampledata.h>
 #include <relacs/daqerror.h>
 #include <relacs/options.h>
+#include <relacs/outdatasource.h>
 
 using namespace std;
 
@@ -70,6 +71,16 @@ are mapped to the full output range of the daq board.
 scale() might be used internally by AnalogOutput for proper scaling.
 The resulting voltage is then attenuated by additional hardware
 according to the requested intensity() or level().
+
+Very long stimuli do not need to be kept in memory. With setSource()
+the OutData holds only a single block of streamBlockSize() samples that is
+filled by an OutDataSource whenever the hardware driver requests the next
+samples via deviceValue(). In this streaming() mode size() is the size
+of the current block. Use deviceSize() and duration() for the size
+and the duration of the whole stimulus.
+Multiplying or adding a scalar to a streaming OutData is
+applied to all blocks of the stimulus.
+Other operations like append() or repeat() only act on the current block.
 */
 
 class OutData : public SampleData< float >, public DaqError
@@ -533,7 +544,7 @@ class OutData : public SampleData< float >, public DaqError
     /*! Returns \c true if no level is set. \sa level(), noIntensity() */
   bool noLevel( void ) const;
 
-    /*! The duration of the output signal. Equals length(). */
+    /*! The duration of the output signal. Equals length() if not streaming(). */
   double duration( void ) const;
     /*! Total duration of the output signal in seconds 
         ( delay() + duration() ). */
@@ -817,6 +828,49 @@ class OutData : public SampleData< float >, public DaqError
 		  double tau, double ampl=1.0, double delay=0.0,
 		  const string &name="" );
 
+    /*! Stream the stimulus from a copy of \a source
+        for \a duration seconds sampled with \a stepsize seconds.
+        If \a duration is negative, the duration() of \a source is used.
+        If \a stepsize is negative, the sampleInterval() of \a source is used.
+	If \a stepsize is still negative or if fixedSampleRate(),
+	the sampling rate is set using minSampleInterval().
+	Only the first block of data is generated right away.
+	The description of \a source becomes the description of the stimulus,
+	request() is set to the range of \a source.
+        \param[in] \a name the optional name can be used to functionally describe the signal.
+	\sa streaming(), clearSource() */
+  void setSource( const OutDataSource &source, double duration=-1.0,
+		  double stepsize=-1.0, const string &name="" );
+    /*! True if the data are generated block by block by an OutDataSource.
+        \sa setSource() */
+  bool streaming( void ) const { return Source != 0; };
+    /*! The generator of the data or null if not streaming(). */
+  const OutDataSource *source( void ) const { return Source; };
+    /*! Stop streaming. The data of the current block are kept. */
+  void clearSource( void );
+    /*! The number of samples of a block used in streaming() mode. */
+  static int streamBlockSize( void ) { return StreamBlockSize; };
+    /*! Set the number of samples of a block used in streaming() mode
+        to \a size. */
+  static void setStreamBlockSize( int size );
+    /*! Append \a n copies of the last value to a streaming() stimulus.
+        Used by some hardware drivers to work around bugs. */
+  void setStreamPadding( int n );
+    /*! The value of the \a index-th element of the whole stimulus.
+        In streaming() mode the block containing \a index is generated
+        if necessary. Accessing the elements in increasing order is
+        efficient. Going back into the previous block is cheap as well,
+        going back further requires generating the data from the start.
+	\a index must be a valid index smaller than deviceSize(). */
+  float streamValue( int index );
+    /*! The value of the last element of the whole stimulus.
+        In streaming() mode this is the lastValue() of source()
+        scaled and shifted like the streamed samples, otherwise back(). */
+  float streamLastValue( void ) const;
+
+    /*! The number of elements of the whole stimulus to be written
+        to the data buffer. Equals size() if not streaming(). */
+  int deviceSize( void ) const { return Source != 0 ? StreamSize + StreamPadding : size(); };
     /*! The index of the next element to be written to the data buffer.
         \sa incrDeviceIndex(), devieValue(), incrDeviceCount(), deviceReset() */
   int deviceIndex( void ) const { return DeviceIndex; };
@@ -824,7 +878,24 @@ class OutData : public SampleData< float >, public DaqError
   void incrDeviceIndex( void ) { DeviceIndex++; };
     /*! Return the value of the next element to be written to the data buffer
         and increment deviceIndex(). \sa deviceIndex() */
-  float deviceValue( void ) { return (*this)[ DeviceIndex++ ]; };
+  float deviceValue( void )
+  { if ( DeviceIndex < StreamOffset || DeviceIndex >= StreamOffset + size() ) loadBlock( DeviceIndex );
+    return (*this)[ DeviceIndex++ - StreamOffset ]; };
+    /*! The number of elements starting at deviceIndex() that are
+        contiguously available in memory via deviceData().
+        In streaming() mode the block containing deviceIndex()
+        is generated if necessary.
+        Returns zero if deviceIndex() reached deviceSize(). */
+  int deviceAvailable( void );
+    /*! Pointer to the element at deviceIndex().
+        Call deviceAvailable() before to make sure
+        that the element is in memory. */
+  const float *deviceData( void ) const { return data() + DeviceIndex - StreamOffset; };
+    /*! Increment deviceIndex() by \a n.
+        \sa deviceAvailable(), deviceData() */
+  void incrDeviceIndex( int n ) { DeviceIndex += n; };
+    /*! The last value that was written to the data buffer via deviceValue(). */
+  float deviceLastValue( void ) const;
     /*! The number of delay elements. \sa setDeviceDelay() */
   int deviceDelay( void ) const { return DeviceDelay; };
     /*! Set the number of delay elements to \a delay. \sa deviceDelay() */
@@ -835,7 +906,7 @@ class OutData : public SampleData< float >, public DaqError
     /*! Set the device counter to \a count. \sa deviceCount() */
   void setDeviceCount( int count ) { DeviceCount = count; };
     /*! Increment the device counter and reset deviceIndex(). \sa deviceCount() */
-  void incrDeviceCount( void ) { DeviceCount++; DeviceIndex = 0; };
+  void incrDeviceCount( void );
     /*! Returns \c true as long data need to be transferred to the device. */
   bool deviceWriting( void ) const { return ( DeviceCount <= 0 ); };
     /*! Reset the device index, counter, and delay. */
@@ -848,6 +919,8 @@ class OutData : public SampleData< float >, public DaqError
  private:
 
   void construct( void );
+    /*! Generate the block of streamed data that contains \a index. */
+  void loadBlock( int index );
     /*! We do not want an offset! */
   void setRange( const double &offset, const double &stepsize ) {};
 
@@ -906,6 +979,29 @@ class OutData : public SampleData< float >, public DaqError
     /*! Counts repetitions of outputs. -1: delay emulation, 0: first time. */
   int DeviceCount;
 
+    /*! The generator of streamed data. */
+  OutDataSource *Source;
+    /*! Number of samples of the streamed stimulus. */
+  int StreamSize;
+    /*! Number of additional samples with the last value. */
+  int StreamPadding;
+    /*! Index of the first element of the current block. */
+  int StreamOffset;
+    /*! Index of the next element the source generates, -1: source needs a reset. */
+  int StreamNext;
+    /*! Factor applied to the generated data. */
+  double StreamScale;
+    /*! Offset added to the generated data. */
+  double StreamShift;
+    /*! Value of the last element of the previous run. */
+  float StreamLast;
+    /*! Copy of the block preceding the current one. */
+  ArrayF StreamPrevious;
+    /*! Index of the first element of StreamPrevious. */
+  int StreamPreviousOffset;
+    /*! Number of samples of a block. */
+  static int StreamBlockSize;
+
     /*! Default minimum possible sampling interval in seconds. */
   static double DefaultMinSampleInterval;
 
@@ -0,0 +1,371 @@
+/*
+  outdatasource.h
+  Generators that stream samples of an OutData block by block.
+
+  RELACS - Relaxed ELectrophysiological data Acquisition, Control, and Stimulation
+  Copyright (C) 2002-2015 Jan Benda <jan.benda@uni-tuebingen.de>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+  
+  RELACS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _RELACS_OUTDATASOURCE_H_
+#define _RELACS_OUTDATASOURCE_H_ 1
+
+#include <string>
+#include <fstream>
+#include <relacs/options.h>
+#include <relacs/random.h>
+#ifdef HAVE_LIBSNDFILE
+#include <sndfile.h>
+#endif
+
+using namespace std;
+
+namespace relacs {
+
+
+/*!
+\class OutDataSource
+\author Jan Benda
+\brief Base class for generators that stream samples of an OutData block by block.
+
+An OutData set up with OutData::setSource() holds only a single block
+of samples in memory. Whenever the hardware driver or a simulation
+needs the next block, OutData calls generate() of its copy of the source.
+This way stimuli of very long durations can be put out without
+synthesizing them in advance.
+
+Implementations need to provide copy(), generate(), minValue(),
+and maxValue(). A generator has to produce the very same samples
+after each reset(). Random generators therefore reseed their
+random number generator in reset().
+
+The description() of the source becomes the description of the
+OutData and is what SaveFiles records about the stimulus.
+*/
+
+class OutDataSource
+{
+
+public:
+
+  OutDataSource( void );
+  virtual ~OutDataSource( void );
+
+    /*! Return a pointer to a new generator with the same parameters.
+        reset() is called before it generates any samples. */
+  virtual OutDataSource *copy( void ) const = 0;
+
+    /*! Restart the generator for a stimulus of \a size samples
+        sampled with \a stepsize seconds.
+        The next call of generate() will request index zero.
+        Implementations should call this function. */
+  virtual void reset( double stepsize, int size );
+    /*! Write \a n samples starting at sample \a index into \a buffer.
+        Succeeding calls request consecutive samples,
+        i.e. \a index is the sum of \a index and \a n
+        of the previous call. */
+  virtual void generate( float *buffer, int index, int n ) = 0;
+
+    /*! The duration in seconds defined by the source itself,
+        e.g. the length of a file. A negative value, the default,
+        means that the duration has to be specified in OutData::setSource(). */
+  virtual double duration( void ) const;
+    /*! The sampling interval in seconds the source was made for,
+        e.g. the one of a file. A negative value, the default,
+        means that the source can be sampled with any interval. */
+  virtual double sampleInterval( void ) const;
+    /*! The minimum value the source is going to generate.
+        Used for selecting the gain of the analog output
+	and for checking the signal range.
+	Is called after reset(), so it may depend on size(). */
+  virtual double minValue( void ) const = 0;
+    /*! The maximum value the source is going to generate.
+        Used for selecting the gain of the analog output.
+	Is called after reset(), so it may depend on size(). */
+  virtual double maxValue( void ) const = 0;
+    /*! The last value of the stimulus. Zero by default. */
+  virtual double lastValue( void ) const;
+    /*! The carrier frequency of the generated signal in Hertz
+        that is relevant for attenuators. Zero by default. */
+  virtual double carrierFreq( void ) const;
+
+    /*! The description of the stimulus. */
+  const Options &description( void ) const;
+    /*! The description of the stimulus. */
+  Options &description( void );
+
+    /*! The sampling interval set by reset(). */
+  double stepsize( void ) const { return StepSize; };
+    /*! The number of samples set by reset(). */
+  int size( void ) const { return Size; };
+
+
+protected:
+
+    /*! Multiply the \a n samples in \a buffer starting at sample \a index
+        with a linear ramp of \a ramp seconds at the beginning and the end
+        of the stimulus. The very last sample is set to zero. */
+  void ramp( float *buffer, int index, int n, double ramp ) const;
+
+  Options Description;
+  double StepSize;
+  int Size;
+
+};
+
+
+/*!
+\class NoiseSource
+\author Jan Benda
+\brief Streams Gaussian white noise, optionally band-limited.
+
+Instead of the FFT of OutData::bandNoiseWave(), which needs the
+whole stimulus at once, the noise is low-pass filtered with a fourth-order Butterworth filter
+at the upper cutoff frequency and high-pass filtered with a
+second-order Butterworth filter at the lower cutoff frequency.
+The spectrum therefore does not have sharp edges.
+The filtered noise is scaled to the requested standard deviation.
+minValue() and maxValue() grow with the number of samples set by reset(),
+from five standard deviations for short stimuli to about 6.7 standard
+deviations for an hour of noise sampled at 20kHz,
+such that only about one in a hundred stimuli exceeds this range.
+Samples beyond this range are clipped by the analog output.
+*/
+
+class NoiseSource : public OutDataSource
+{
+
+public:
+
+    /*! Gaussian white noise with standard deviation \a stdev,
+        cut off below \a cutofffreqlow Hertz (zero: no high-pass filter)
+        and above \a cutofffreqhigh Hertz (zero: no low-pass filter)
+        and ramps of \a ramp seconds at the beginning and the end.
+        If \a seed is not null, the random number generator is seeded with
+        the value pointed to by \a seed, and the used seed is returned in \a seed. */
+  NoiseSource( double cutofffreqlow, double cutofffreqhigh, double stdev=1.0,
+	       unsigned long *seed=0, double ramp=0.0 );
+
+  virtual OutDataSource *copy( void ) const;
+  virtual void reset( double stepsize, int size );
+  virtual void generate( float *buffer, int index, int n );
+  virtual double minValue( void ) const;
+  virtual double maxValue( void ) const;
+  virtual double carrierFreq( void ) const;
+
+
+private:
+
+  struct Biquad
+  {
+    double B0, B1, B2, A1, A2;
+    double X1, X2, Y1, Y2;
+    void setLowPass( double freq, double q, double stepsize );
+    void setHighPass( double freq, double q, double stepsize );
+    void clear( void );
+    double operator()( double x );
+  };
+
+  double CutoffLow;
+  double CutoffHigh;
+  double StDev;
+  double Ramp;
+  unsigned long Seed;
+  RandomXoshiro Rand;
+  int NFilter;
+  Biquad Filter[3];
+  double Gain;
+
+};
+
+
+/*!
+\class SineSource
+\author Jan Benda
+\brief Streams a sine wave.
+*/
+
+class SineSource : public OutDataSource
+{
+
+public:
+
+    /*! A sine wave with frequency \a freq Hertz, phase \a phase (in rad),
+        amplitude \a ampl, and ramps of \a ramp seconds
+	at the beginning and the end. */
+  SineSource( double freq, double ampl=1.0, double phase=0.0, double ramp=0.0 );
+
+  virtual OutDataSource *copy( void ) const;
+  virtual void generate( float *buffer, int index, int n );
+  virtual double minValue( void ) const;
+  virtual double maxValue( void ) const;
+  virtual double carrierFreq( void ) const;
+
+
+private:
+
+  double Freq;
+  double Ampl;
+  double Phase;
+  double Ramp;
+
+};
+
+
+/*!
+\class AMSource
+\author Jan Benda
+\brief Streams a sinusoidally amplitude modulated sine wave.
+
+The generated signal is
+\f[ a \left( 1 + m \sin( 2 \pi f_{AM} t ) \right) \sin( 2 \pi f_c t ) / ( 1 + m ) \f]
+with amplitude \f$ a \f$, modulation depth \f$ m \f$,
+modulation frequency \f$ f_{AM} \f$, and carrier frequency \f$ f_c \f$.
+*/
+
+class AMSource : public OutDataSource
+{
+
+public:
+
+    /*! An amplitude modulated sine wave with carrier frequency \a carrierfreq,
+        modulation frequency \a amfreq, modulation depth \a depth (0 to 1),
+        peak amplitude \a ampl, and ramps of \a ramp seconds
+	at the beginning and the end. */
+  AMSource( double carrierfreq, double amfreq, double depth,
+	    double ampl=1.0, double ramp=0.0 );
+
+  virtual OutDataSource *copy( void ) const;
+  virtual void generate( float *buffer, int index, int n );
+  virtual double minValue( void ) const;
+  virtual double maxValue( void ) const;
+  virtual double carrierFreq( void ) const;
+
+
+private:
+
+  double CarrierFreq;
+  double AMFreq;
+  double Depth;
+  double Ampl;
+  double Ramp;
+
+};
+
+
+/*!
+\class SweepSource
+\author Jan Benda
+\brief Streams a linear frequency sweep.
+
+Like OutData::sweepWave() the frequency changes linearly
+from the start frequency to the end frequency over the
+whole duration of the stimulus.
+*/
+
+class SweepSource : public OutDataSource
+{
+
+public:
+
+    /*! A frequency sweep from \a startfreq to \a endfreq Hertz
+        with amplitude \a ampl and ramps of \a ramp seconds
+	at the beginning and the end. */
+  SweepSource( double startfreq, double endfreq, double ampl=1.0,
+	       double ramp=0.0 );
+
+  virtual OutDataSource *copy( void ) const;
+  virtual void generate( float *buffer, int index, int n );
+  virtual double minValue( void ) const;
+  virtual double maxValue( void ) const;
+
+
+private:
+
+  double StartFreq;
+  double EndFreq;
+  double Ampl;
+  double Ramp;
+
+};
+
+
+/*!
+\class FileSource
+\author Jan Benda
+\brief Plays back a stimulus from a file without loading it into memory.
+
+Supported are the ascii files read by OutData::load(),
+i.e. two columns with time and amplitude, and, if libsndfile is
+available, audio files with extension \c .wav.
+The file is scanned once on construction for its sampling interval,
+its length, and its range of values.
+The OutData needs to be sampled with the sampleInterval() of the file.
+*/
+
+class FileSource : public OutDataSource
+{
+
+public:
+
+    /*! Play back file \a file. If \a filename is not empty,
+        it is stored as the file name in the description,
+	otherwise \a file is stored.
+	Check success with good(). */
+  FileSource( const string &file, const string &filename="" );
+  FileSource( const FileSource &fs );
+  virtual ~FileSource( void );
+
+    /*! True if the file could be opened and contains data. */
+  bool good( void ) const { return Samples > 0; };
+
+  virtual OutDataSource *copy( void ) const;
+  virtual void reset( double stepsize, int size );
+  virtual void generate( float *buffer, int index, int n );
+  virtual double duration( void ) const;
+  virtual double sampleInterval( void ) const;
+  virtual double minValue( void ) const;
+  virtual double maxValue( void ) const;
+  virtual double lastValue( void ) const;
+
+
+private:
+
+  bool open( void );
+  void close( void );
+  void scan( void );
+  int read( float *buffer, int n );
+
+  string File;
+  bool Sound;
+  int Samples;
+  double Interval;
+  double Min;
+  double Max;
+  double Last;
+  int Channels;
+  ifstream Ascii;
+  streampos DataStart;
+#ifdef HAVE_LIBSNDFILE
+  SNDFILE *Snd;
+#endif
+
+};
+
+
+}; /* namespace relacs */
+
+#endif /* ! _RELACS_OUTDATASOURCE_H_ */
+
@@ -0,0 +1,134 @@
+/*
+  spiketriggeredaverage.h
+  Incrementally accumulated spike-triggered averages of many input traces
+
+  RELACS - Relaxed ELectrophysiological data Acquisition, Control, and Stimulation
+  Copyright (C) 2002-2015 Jan Benda <jan.benda@uni-tuebingen.de>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+  
+  RELACS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _RELACS_SPIKETRIGGEREDAVERAGE_H_
+#define _RELACS_SPIKETRIGGEREDAVERAGE_H_ 1
+
+#include <vector>
+#include <relacs/sampledata.h>
+#include <relacs/eventdata.h>
+#include <relacs/random.h>
+#include <relacs/inlist.h>
+using namespace std;
+
+namespace relacs {
+
+
+/*!
+\class SpikeTriggeredAverage
+\author Jan Benda
+\brief Incrementally accumulated spike-triggered averages of many input traces.
+
+The snippets of the input traces from tmin() to tmax() relative
+to each spike time are not stored. Instead, for each trace and each
+lag the running sums and sums of squares of the data values are
+updated whenever update() is called with new spikes.
+Memory and computation time per call therefore only depend on the number
+of new spikes, the number of traces, and the length of the snippets.
+Call average() and stdev() to retrieve the spike-triggered averages
+and their standard deviations at any time.
+
+Optionally, nsnippets() snippets per trace are kept
+by reservoir sampling, i.e. each spike averaged so far
+has the same chance to be represented by a snippet.
+The snippets of the different traces belong to the same spikes.
+
+The lags are given by the sampling interval of each trace.
+Spikes are only averaged as soon as the data of all traces
+are available up to tmax() after the spike.
+*/
+
+class SpikeTriggeredAverage
+{
+
+public:
+
+    /*! Constructs an empty SpikeTriggeredAverage. */
+  SpikeTriggeredAverage( void );
+    /*! Constructs a SpikeTriggeredAverage for the input traces \a traces
+        from \a tmin to \a tmax seconds relative to the spikes.
+        Keep \a nsnippets snippets for each trace. \sa init() */
+  SpikeTriggeredAverage( const InList &traces, double tmin, double tmax,
+			 int nsnippets=0 );
+
+    /*! Initialize the averages of the input traces \a traces
+        from \a tmin to \a tmax seconds relative to the spikes.
+        Keep \a nsnippets snippets for each trace.
+        Only spikes later than the current time of the traces are
+        averaged by subsequent calls of update(). */
+  void init( const InList &traces, double tmin, double tmax,
+	     int nsnippets=0 );
+    /*! Discard all accumulated data.
+        Only spikes later than the current time of the traces are
+        averaged by subsequent calls of update(). */
+  void reset( void );
+
+    /*! Add all spikes of \a spikes that have not been averaged yet
+        and for which the data of all traces are available.
+        \return the number of spikes added. */
+  int update( const EventData &spikes );
+
+    /*! The number of input traces. */
+  int traces( void ) const;
+    /*! The start time of the snippets relative to the spikes. */
+  double tmin( void ) const;
+    /*! The end time of the snippets relative to the spikes. */
+  double tmax( void ) const;
+    /*! The number of spikes averaged so far. */
+  int count( void ) const;
+
+    /*! Return in \a average the spike-triggered average of the \a trace-th
+        input trace. */
+  void average( int trace, SampleDataF &average ) const;
+    /*! Return in \a stdev the standard deviation of the snippets
+        of the \a trace-th input trace. */
+  void stdev( int trace, SampleDataF &stdev ) const;
+
+    /*! The maximum number of snippets kept for each trace. */
+  int nsnippets( void ) const;
+    /*! The snippets kept for the \a trace-th input trace. */
+  const vector< SampleDataF > &snippets( int trace ) const;
+
+
+private:
+
+  struct Sums {
+    SampleDataD Sum;
+    SampleDataD SumSq;
+    SampleDataD Shift;
+    vector< SampleDataF > Snippets;
+  };
+
+  InList Traces;
+  vector< Sums > Averages;
+  double TMin;
+  double TMax;
+  int NSnippets;
+  int Count;
+  double LastSpike;
+  RandomXoshiro Rand;
+
+};
+
+
+}; /* namespace relacs */
+
+#endif /* ! _RELACS_SPIKETRIGGEREDAVERAGE_H_ */
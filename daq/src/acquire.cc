@@ -926,6 +926,9 @@ int Acquire::stopRead( void )
   // wake up all jobs sleeping on AISemaphore:
   AISemaphore.release( 1000 );
 
+  // wake up all threads waiting on data:
+  RawDataWait.wakeAll();
+
   return success ? 0 : -1;
 }
 
@@ -1270,7 +1273,7 @@ int Acquire::getRawData( InList &data, EventList &events, double &signaltime,
       while ( InTraces.success() &&
 	      SignalTime <= prevsignal &&
 	      isReadRunning() ) { 
-	ReadWait.wait( &ReadMutex );
+	RawDataWait.wait( &ReadMutex, MAXDOUBLE, prevsignal );
 	if ( ! isWriteRunning() )
 	  break;
       }
@@ -1284,7 +1287,7 @@ int Acquire::getRawData( InList &data, EventList &events, double &signaltime,
     while ( InTraces.success() &&
 	    InTraces.currentTime() < mintracetime &&
 	    isReadRunning() ) {
-      ReadWait.wait( &ReadMutex );
+      RawDataWait.wait( &ReadMutex, mintracetime );
     }
     
     interrupted = ( InTraces.currentTime() < mintracetime || mintracetime == 0.0 );
@@ -1340,6 +1343,24 @@ int Acquire::waitForData( double &signaltime )
   else
     NumEmptyData = 0;
   signaltime = getSignal();
+  // events of replayed recordings:
+  for ( unsigned int i=0; i<AI.size(); i++ ) {
+    if ( AI[i].Traces.empty() )
+      continue;
+    vector< double > signaltimes;
+    vector< double > signaldurations;
+    vector< double > restarttimes;
+    AI[i].AI->replayedEvents( signaltimes, signaldurations, restarttimes );
+    for ( unsigned int k=0; k<signaltimes.size(); k++ ) {
+      if ( SignalEvents != 0 )
+	SignalEvents->push( signaltimes[k], 0.0, signaldurations[k] );
+      signaltime = signaltimes[k];
+    }
+    for ( unsigned int k=0; k<restarttimes.size(); k++ ) {
+      if ( RestartEvents != 0 )
+	RestartEvents->push( restarttimes[k] );
+    }
+  }
   // set signal time:
   if ( signaltime >= 0.0 ) {
     SignalTime = signaltime;
@@ -1350,9 +1371,18 @@ int Acquire::waitForData( double &signaltime )
       RestartEvents->setSignalTime( SignalTime );
   }
   PreviousTime = InTraces.currentTimeRaw();
+  double currenttime = InTraces.currentTime();
+  double currentsignal = SignalTime;
   // check data:
   bool failed = InTraces.failed();
   ReadMutex.unlock();
+  // wake up threads waiting in getRawData() whose data are available,
+  // or which wait for a signal that will not come anymore:
+  if ( failed || finished )
+    RawDataWait.wakeAll();
+  else
+    RawDataWait.wakeUp( currenttime,
+			isWriteRunning() ? currentsignal : MAXDOUBLE );
   return failed ? -1 : ( finished ? 0 : 1 );
 }
 
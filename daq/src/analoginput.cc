@@ -148,6 +148,13 @@ int AnalogInput::matchTraces( InList &traces ) const
 }
 
 
+void AnalogInput::replayedEvents( vector< double > &signaltimes,
+				  vector< double > &signaldurations,
+				  vector< double > &restarttimes )
+{
+}
+
+
 int AnalogInput::analogInputType( void ) const
 {
   return AnalogInputSubType;
@@ -307,7 +307,7 @@ int AnalogOutput::testWriteData( OutList &sigs )
       sigs[k].addError( DaqError::MultipleRestart ); 
       sigs[k].setRestart( sigs[0].restart() );
     }
-    if ( sigs[k].size() != sigs[0].size() ) {
+    if ( sigs[k].deviceSize() != sigs[0].deviceSize() ) {
       sigs[k].addError( DaqError::MultipleBuffersizes );
     }
   }
@@ -0,0 +1,254 @@
+/*
+  aoconversion.cc
+  Converts voltages of analog output signals into raw integer data
+
+  RELACS - Relaxed ELectrophysiological data Acquisition, Control, and Stimulation
+  Copyright (C) 2002-2015 Jan Benda <jan.benda@uni-tuebingen.de>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+  
+  RELACS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cmath>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include <relacs/aoconversion.h>
+
+namespace relacs {
+
+
+AOConversion::AOConversion( void )
+  : MinVal( -HUGE_VAL ),
+    MaxVal( HUGE_VAL ),
+    Scale( 1.0 ),
+    Order( 1 ),
+    Origin( 0.0 ),
+    MinData( -2147483648.0 ),
+    MaxData( 2147483647.0 ),
+    Round( true )
+{
+  Coefficients[0] = 0.0;
+  Coefficients[1] = 1.0;
+  Coefficients[2] = 0.0;
+  Coefficients[3] = 0.0;
+}
+
+
+void AOConversion::setRange( double minval, double maxval )
+{
+  MinVal = minval;
+  MaxVal = maxval;
+}
+
+
+void AOConversion::setScale( double scale )
+{
+  Scale = scale;
+}
+
+
+void AOConversion::setPolynomial( const double *coefficients, int order,
+				  double origin )
+{
+  if ( order > 3 )
+    order = 3;
+  if ( order < 0 )
+    order = 0;
+  Order = order;
+  for ( int k=0; k<4; k++ )
+    Coefficients[k] = k <= order ? coefficients[k] : 0.0;
+  Origin = origin;
+}
+
+
+void AOConversion::setLinear( double offset, double gain )
+{
+  Order = 1;
+  Coefficients[0] = offset;
+  Coefficients[1] = gain;
+  Coefficients[2] = 0.0;
+  Coefficients[3] = 0.0;
+  Origin = 0.0;
+}
+
+
+void AOConversion::setDataRange( double mindata, double maxdata )
+{
+  MinData = mindata;
+  MaxData = maxdata;
+}
+
+
+void AOConversion::setRounding( bool round )
+{
+  Round = round;
+}
+
+
+template < typename T >
+T AOConversion::convert( float v ) const
+{
+  double x = v;
+  if ( x > MaxVal )
+    x = MaxVal;
+  else if ( x < MinVal )
+    x = MinVal;
+  x = Scale * x - Origin;
+  double y = Coefficients[Order];
+  for ( int k=Order-1; k>=0; k-- )
+    y = y * x + Coefficients[k];
+  if ( y > MaxData )
+    y = MaxData;
+  else if ( y < MinData )
+    y = MinData;
+  return (T)( Round ? ::nearbyint( y ) : ::trunc( y ) );
+}
+
+
+template < typename T >
+void convertAO( const AOConversion *conv, const float * const *src,
+		int nchannels, int n, T *dest )
+{
+  for ( int k=0; k<nchannels; k++ ) {
+    const AOConversion &c = conv[k];
+    const float *sp = src[k];
+    T *dp = dest + k;
+    int i = 0;
+#ifdef __SSE2__
+    // four values per iteration, computed in two double precision lanes:
+    const __m128d minval = _mm_set1_pd( c.MinVal );
+    const __m128d maxval = _mm_set1_pd( c.MaxVal );
+    const __m128d scale = _mm_set1_pd( c.Scale );
+    const __m128d origin = _mm_set1_pd( c.Origin );
+    const __m128d mindata = _mm_set1_pd( c.MinData );
+    const __m128d maxdata = _mm_set1_pd( c.MaxData );
+    __m128d coeff[4];
+    for ( int j=0; j<4; j++ )
+      coeff[j] = _mm_set1_pd( c.Coefficients[j] );
+    const int order = c.Order;
+    const bool round = c.Round;
+    int raw[4];
+    for ( ; i+4<=n; i+=4 ) {
+      __m128 f = _mm_loadu_ps( sp + i );
+      __m128d x[2];
+      x[0] = _mm_cvtps_pd( f );
+      x[1] = _mm_cvtps_pd( _mm_movehl_ps( f, f ) );
+      __m128i r[2];
+      for ( int h=0; h<2; h++ ) {
+	__m128d xh = _mm_min_pd( _mm_max_pd( x[h], minval ), maxval );
+	xh = _mm_sub_pd( _mm_mul_pd( xh, scale ), origin );
+	__m128d y = coeff[order];
+	for ( int j=order-1; j>=0; j-- )
+	  y = _mm_add_pd( _mm_mul_pd( y, xh ), coeff[j] );
+	y = _mm_min_pd( _mm_max_pd( y, mindata ), maxdata );
+	// _mm_cvtpd_epi32() uses the current rounding mode (nearest even):
+	r[h] = round ? _mm_cvtpd_epi32( y ) : _mm_cvttpd_epi32( y );
+      }
+      _mm_storeu_si128( (__m128i *)raw, _mm_unpacklo_epi64( r[0], r[1] ) );
+      for ( int j=0; j<4; j++ ) {
+	*dp = (T)raw[j];
+	dp += nchannels;
+      }
+    }
+#endif
+    for ( ; i<n; i++ ) {
+      *dp = c.convert<T>( sp[i] );
+      dp += nchannels;
+    }
+  }
+}
+
+
+template < typename T >
+int convertAO( OutList &sigs, const AOConversion *conv, const T *zeros,
+	       T *dest, int maxrows )
+{
+  const int nchannels = sigs.size();
+  const float *src[ nchannels ];
+  int rows = 0;
+  while ( rows < maxrows && sigs[0].deviceWriting() ) {
+    // number of rows that can be converted in one go:
+    int m = maxrows - rows;
+    for ( int k=0; k<nchannels && m>0; k++ ) {
+      if ( sigs[k].deviceCount() < 0 )
+	m = 0;
+      else {
+	int a = sigs[k].deviceAvailable();
+	if ( m > a )
+	  m = a;
+	src[k] = sigs[k].deviceData();
+      }
+    }
+
+    if ( m > 0 ) {
+      convertAO( conv, src, nchannels, m, dest );
+      dest += m*nchannels;
+      rows += m;
+      for ( int k=0; k<nchannels; k++ ) {
+	sigs[k].incrDeviceIndex( m );
+	if ( sigs[k].deviceIndex() >= sigs[k].deviceSize() )
+	  sigs[k].incrDeviceCount();
+      }
+    }
+    else {
+      // single row during delay:
+      for ( int k=0; k<nchannels; k++ ) {
+	if ( sigs[k].deviceCount() < 0 ) {
+	  *dest = zeros[k];
+	  sigs[k].incrDeviceIndex();
+	  if ( sigs[k].deviceIndex() >= sigs[k].deviceDelay() )
+	    sigs[k].incrDeviceCount();
+	}
+	else if ( sigs[k].deviceAvailable() > 0 ) {
+	  *dest = conv[k].convert<T>( sigs[k].deviceValue() );
+	  if ( sigs[k].deviceIndex() >= sigs[k].deviceSize() )
+	    sigs[k].incrDeviceCount();
+	}
+	else {
+	  *dest = zeros[k];
+	  sigs[k].incrDeviceCount();
+	}
+	++dest;
+      }
+      ++rows;
+    }
+  }
+  return rows;
+}
+
+
+template unsigned short AOConversion::convert<unsigned short>( float v ) const;
+template unsigned int AOConversion::convert<unsigned int>( float v ) const;
+template signed short AOConversion::convert<signed short>( float v ) const;
+
+template void convertAO<unsigned short>( const AOConversion *conv, const float * const *src,
+					 int nchannels, int n, unsigned short *dest );
+template void convertAO<unsigned int>( const AOConversion *conv, const float * const *src,
+				       int nchannels, int n, unsigned int *dest );
+template void convertAO<signed short>( const AOConversion *conv, const float * const *src,
+				       int nchannels, int n, signed short *dest );
+
+template int convertAO<unsigned short>( OutList &sigs, const AOConversion *conv,
+					const unsigned short *zeros,
+					unsigned short *dest, int maxrows );
+template int convertAO<unsigned int>( OutList &sigs, const AOConversion *conv,
+				      const unsigned int *zeros,
+				      unsigned int *dest, int maxrows );
+template int convertAO<signed short>( OutList &sigs, const AOConversion *conv,
+				      const signed short *zeros,
+				      signed short *dest, int maxrows );
+
+
+}; /* namespace relacs */
+
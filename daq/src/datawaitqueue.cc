@@ -0,0 +1,160 @@
+/*
+  datawaitqueue.cc
+  Threads waiting for data up to a given trace or signal time.
+
+  RELACS - Relaxed ELectrophysiological data Acquisition, Control, and Stimulation
+  Copyright (C) 2002-2015 Jan Benda <jan.benda@uni-tuebingen.de>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+  
+  RELACS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QTime>
+#include <relacs/datawaitqueue.h>
+
+namespace relacs {
+
+
+DataWaitQueue::DataWaitQueue( void )
+  : Waiting( 0 )
+{
+}
+
+
+DataWaitQueue::~DataWaitQueue( void )
+{
+  wakeAll();
+}
+
+
+bool DataWaitQueue::wait( QReadWriteLock *lock, double tracetime,
+			  double signaltime, unsigned long time )
+{
+  // the producer cannot modify the data and call wakeUp()
+  // before we are registered:
+  Mutex.lock();
+  lock->unlock();
+  bool r = wait( tracetime, signaltime, time );
+  Mutex.unlock();
+  lock->lockForRead();
+  return r;
+}
+
+
+bool DataWaitQueue::wait( QMutex *mutex, double tracetime,
+			  double signaltime, unsigned long time )
+{
+  Mutex.lock();
+  mutex->unlock();
+  bool r = wait( tracetime, signaltime, time );
+  Mutex.unlock();
+  mutex->lock();
+  return r;
+}
+
+
+bool DataWaitQueue::wait( double tracetime, double signaltime,
+			  unsigned long time )
+{
+  Waiter w;
+  w.Woken = false;
+  // every waiter is in TraceWaiters, so that wakeAll() finds it:
+  w.TraceIter = TraceWaiters.insert( WaiterMap::value_type( tracetime, &w ) );
+  w.SignalIter = SignalWaiters.end();
+  if ( signaltime < MAXDOUBLE )
+    w.SignalIter = SignalWaiters.insert( WaiterMap::value_type( signaltime, &w ) );
+  Waiting++;
+
+  if ( time == ULONG_MAX ) {
+    while ( ! w.Woken )
+      w.Condition.wait( &Mutex );
+  }
+  else {
+    QTime timer;
+    timer.start();
+    unsigned long elapsed = 0;
+    while ( ! w.Woken && elapsed < time ) {
+      w.Condition.wait( &Mutex, time - elapsed );
+      elapsed = timer.elapsed();
+    }
+  }
+
+  if ( ! w.Woken )
+    remove( &w );
+  return w.Woken;
+}
+
+
+int DataWaitQueue::wakeUp( double tracetime, double signaltime )
+{
+  QMutexLocker locker( &Mutex );
+  int n = 0;
+  while ( ! TraceWaiters.empty() &&
+	  TraceWaiters.begin()->first <= tracetime ) {
+    wake( TraceWaiters.begin()->second );
+    n++;
+  }
+  while ( ! SignalWaiters.empty() &&
+	  SignalWaiters.begin()->first < signaltime ) {
+    wake( SignalWaiters.begin()->second );
+    n++;
+  }
+  return n;
+}
+
+
+void DataWaitQueue::wakeAll( void )
+{
+  QMutexLocker locker( &Mutex );
+  while ( ! TraceWaiters.empty() )
+    wake( TraceWaiters.begin()->second );
+}
+
+
+int DataWaitQueue::size( void ) const
+{
+  QMutexLocker locker( &Mutex );
+  return Waiting;
+}
+
+
+double DataWaitQueue::nextTraceTime( void ) const
+{
+  QMutexLocker locker( &Mutex );
+  return TraceWaiters.empty() ? MAXDOUBLE : TraceWaiters.begin()->first;
+}
+
+
+void DataWaitQueue::wake( Waiter *w )
+{
+  remove( w );
+  w->Woken = true;
+  w->Condition.wakeOne();
+}
+
+
+void DataWaitQueue::remove( Waiter *w )
+{
+  if ( w->TraceIter != TraceWaiters.end() ) {
+    TraceWaiters.erase( w->TraceIter );
+    w->TraceIter = TraceWaiters.end();
+  }
+  if ( w->SignalIter != SignalWaiters.end() ) {
+    SignalWaiters.erase( w->SignalIter );
+    w->SignalIter = SignalWaiters.end();
+  }
+  Waiting--;
+}
+
+
+}; /* namespace relacs */
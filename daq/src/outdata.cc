@@ -40,6 +40,7 @@ const double OutData::AutoRange = -2.0e300;
 const double OutData::ExtRef = -1.0e300;
 
 double OutData::DefaultMinSampleInterval = 0.0001;
+int OutData::StreamBlockSize = 65536;
 const Acquire *OutData::A = 0;
 
 
@@ -93,6 +94,16 @@ OutData::OutData( const OutData  &od )
   DeviceIndex = od.DeviceIndex;
   DeviceDelay = od.DeviceDelay;
   DeviceCount = od.DeviceCount;
+  Source = od.Source != 0 ? od.Source->copy() : 0;
+  StreamSize = od.StreamSize;
+  StreamPadding = od.StreamPadding;
+  StreamOffset = od.StreamOffset;
+  StreamNext = od.Source != 0 ? -1 : 0;
+  StreamScale = od.StreamScale;
+  StreamShift = od.StreamShift;
+  StreamLast = od.StreamLast;
+  StreamPrevious = od.StreamPrevious;
+  StreamPreviousOffset = od.StreamPreviousOffset;
   setError( od.error() );
 }
 
@@ -101,6 +112,8 @@ OutData::~OutData( void )
 {
   if ( GainData != 0 )
     delete [] GainData;
+  if ( Source != 0 )
+    delete Source;
 }
 
 
@@ -132,6 +145,15 @@ void OutData::construct( void )
   DeviceIndex = 0;
   DeviceDelay = 0;
   DeviceCount = 0;
+  Source = 0;
+  StreamSize = 0;
+  StreamPadding = 0;
+  StreamOffset = 0;
+  StreamNext = 0;
+  StreamScale = 1.0;
+  StreamShift = 0.0;
+  StreamLast = 0.0;
+  StreamPreviousOffset = 0;
   clearError();
 }
 
@@ -155,6 +177,9 @@ const OutData &OutData::operator=( const OutData &od )
       (*iter1) = static_cast< value_type >( x );			\
       ++iter1;								\
     };									\
+    StreamScale = 0.0;						\
+    StreamShift = x;						\
+    StreamPrevious.clear();						\
     return *this;							\
   }									\
 
@@ -192,6 +217,8 @@ OUTDATAASSIGNSCALARDEF
       (*iter1) += static_cast< value_type >( x );			\
       ++iter1;								\
     };									\
+    StreamShift += x;						\
+    StreamPrevious.clear();						\
     return *this;							\
   }									\
 
@@ -229,6 +256,8 @@ OUTDATAADDSCALARDEF
       (*iter1) -= static_cast< value_type >( x );			\
       ++iter1;								\
     };									\
+    StreamShift -= x;						\
+    StreamPrevious.clear();						\
     return *this;							\
   }									\
 
@@ -266,6 +295,9 @@ OUTDATASUBTRACTSCALARDEF
       (*iter1) *= static_cast< value_type >( x );			\
       ++iter1;								\
     };									\
+    StreamScale *= x;						\
+    StreamShift *= x;						\
+    StreamPrevious.clear();						\
     return *this;							\
   }									\
 
@@ -303,6 +335,9 @@ OUTDATAMULTIPLYSCALARDEF
       (*iter1) /= static_cast< value_type >( x );			\
       ++iter1;								\
     };									\
+    StreamScale /= x;						\
+    StreamShift /= x;						\
+    StreamPrevious.clear();						\
     return *this;							\
   }									\
 
@@ -378,6 +413,20 @@ OutData &OutData::assign( const OutData &od )
   DeviceIndex = od.DeviceIndex;
   DeviceDelay = od.DeviceDelay;
   DeviceCount = od.DeviceCount;
+  if ( &od != this ) {
+    if ( Source != 0 )
+      delete Source;
+    Source = od.Source != 0 ? od.Source->copy() : 0;
+    StreamNext = od.Source != 0 ? -1 : 0;
+  }
+  StreamSize = od.StreamSize;
+  StreamPadding = od.StreamPadding;
+  StreamOffset = od.StreamOffset;
+  StreamScale = od.StreamScale;
+  StreamShift = od.StreamShift;
+  StreamLast = od.StreamLast;
+  StreamPrevious = od.StreamPrevious;
+  StreamPreviousOffset = od.StreamPreviousOffset;
   setError( od.error() );
   return *this;
 }
@@ -412,6 +461,20 @@ const OutData &OutData::copy( OutData &od ) const
   od.DeviceIndex = DeviceIndex;
   od.DeviceDelay = DeviceDelay;
   od.DeviceCount = DeviceCount;
+  if ( &od != this ) {
+    if ( od.Source != 0 )
+      delete od.Source;
+    od.Source = Source != 0 ? Source->copy() : 0;
+    od.StreamNext = Source != 0 ? -1 : 0;
+  }
+  od.StreamSize = StreamSize;
+  od.StreamPadding = StreamPadding;
+  od.StreamOffset = StreamOffset;
+  od.StreamScale = StreamScale;
+  od.StreamShift = StreamShift;
+  od.StreamLast = StreamLast;
+  od.StreamPrevious = StreamPrevious;
+  od.StreamPreviousOffset = StreamPreviousOffset;
   od.setError( error() );
   return *this;
 }
@@ -511,6 +574,7 @@ void OutData::clear( void )
 {
   SampleDataF::clear();
   Description.clear();
+  clearSource();
 }
 
 
@@ -945,6 +1009,8 @@ double OutData::maxValue( void ) const
 
 double OutData::duration( void ) const
 {
+  if ( Source != 0 )
+    return deviceSize()*stepsize();
   return length();
 }
 
@@ -1105,6 +1171,7 @@ istream &OutData::load( istream &str, const string &filename )
   // metadata:
   sq.stripComments( "-#" );
   Description.clear();
+  clearSource();
   Description.load( sq );
   Description.insertText( "File", "", filename );
   if ( Description.type().empty() ) {
@@ -1127,6 +1194,7 @@ OutData &OutData::load( const string &file, const string &filename )
 #ifdef HAVE_LIBSNDFILE
     SampleDataF::loadSndFile( file );
     Description.clear();
+    clearSource();
     Description.insertText( "File", "", filename );
     Description.setType( "stimulus/file" );
     setIdent( filename );
@@ -1221,6 +1289,7 @@ double OutData::fill( const OutData &am, double carrierfreq, double lowfreq,
   back() = 0.0;
 
   Description.clear();
+  clearSource();
   Description.setType( "stimulus" );
   Description.newSection( am.Description );
   Description.insertText( "Function", "", "AM" );
@@ -1250,6 +1319,7 @@ void OutData::constWave( double value, const string &name )
   SampleDataF::resize( 1, 0.0, minSampleInterval() );
   *this = value;
   Description.clear();
+  clearSource();
   Description.setType( "stimulus/value" );
   Description.setName( name );
   Description.addNumber( "StartTime", 0.0, "s" );
@@ -1266,6 +1336,7 @@ void OutData::constWave( double duration, double stepsize, double value, const s
   SampleDataF::resize( 0.0, duration, stepsize );
   *this = value;
   Description.clear();
+  clearSource();
   Description.setType( "stimulus/value" );
   Description.setName( name );
   Description.addNumber( "StartTime", 0.0, "s" );
@@ -1283,6 +1354,7 @@ void OutData::pulseWave( double duration, double stepsize,
   SampleDataF::resize( 0.0, duration, stepsize );
   *this = value;
   Description.clear();
+  clearSource();
   Description.setType( "stimulus/pulse" );
   Description.setName( name );
   Description.addNumber( "StartTime", 0.0, "s" );
@@ -1308,6 +1380,7 @@ void OutData::rectangleWave( double duration, double stepsize,
   back() = 0.0;
 
   Description.clear();
+  clearSource();
   Description.setType( "stimulus/square_wave" );
   Description.setName( name );
   Description.addNumber( "StartTime", 0.0, "s" );
@@ -1338,6 +1411,7 @@ void OutData::sineWave( double duration, double stepsize,
   back() = 0.0;
 
   Description.clear();
+  clearSource();
   Description.setType( "stimulus/sine_wave" );
   Description.setName( name );
   Description.addNumber( "StartTime", 0.0, "s" );
@@ -1357,7 +1431,7 @@ void OutData::noiseWave( double duration, double stepsize,
 {
   if ( stepsize < minSampleInterval() || fixedSampleRate() )
     stepsize = minSampleInterval();
-  Random rand;
+  RandomXoshiro rand;
   if ( seed != 0 )
     *seed = rand.setSeed( *seed );
   whiteNoise( duration, stepsize, 0.0, cutofffreq, rand );
@@ -1368,6 +1442,7 @@ void OutData::noiseWave( double duration, double stepsize,
   back() = 0.0;
 
   Description.clear();
+  clearSource();
   Description.setType( "stimulus/white_noise" );
   Description.addNumber( "StartTime", 0.0, "s" );
   Description.setName( name );
@@ -1388,7 +1463,7 @@ void OutData::bandNoiseWave( double duration, double stepsize,
 {
   if ( stepsize < minSampleInterval() || fixedSampleRate() )
     stepsize = minSampleInterval();
-  Random rand;
+  RandomXoshiro rand;
   if ( seed != 0 )
     *seed = rand.setSeed( *seed );
   whiteNoise( duration, stepsize, 
@@ -1400,6 +1475,7 @@ void OutData::bandNoiseWave( double duration, double stepsize,
   back() = 0.0;
 
   Description.clear();
+  clearSource();
   Description.setType( "stimulus/white_noise" );
   Description.setName( name );
   Description.addNumber( "StartTime", 0.0, "s" );
@@ -1420,7 +1496,7 @@ void OutData::ouNoiseWave( double duration, double stepsize,
 {
   if ( stepsize < minSampleInterval() || fixedSampleRate() )
     stepsize = minSampleInterval();
-  Random rand;
+  RandomXoshiro rand;
   if ( seed != 0 )
     *seed = rand.setSeed( *seed );
   ouNoise( duration, stepsize, tau, rand );
@@ -1431,6 +1507,7 @@ void OutData::ouNoiseWave( double duration, double stepsize,
   back() = 0.0;
 
   Description.clear();
+  clearSource();
   Description.setType( "stimulus/colored_noise" );
   Description.setName( name );
   Description.addNumber( "StartTime", 0.0, "s" );
@@ -1459,6 +1536,7 @@ void OutData::sweepWave( double duration, double stepsize,
   back() = 0.0;
 
   Description.clear();
+  clearSource();
   Description.setType( "stimulus/sweep_wave" );
   Description.setName( name );
   Description.addNumber( "StartTime", 0.0, "s" );
@@ -1484,6 +1562,7 @@ void OutData::dampedOscillationWave( double duration, double stepsize, double ta
   back() = 0.0;
 
   Description.clear();
+  clearSource();
   Description.setType( "stimulus/damped_oscillation" );
   Description.setName( name );
   Description.addNumber( "StartTime", 0.0, "s" );
@@ -1507,6 +1586,7 @@ void OutData::rampWave( double duration, double stepsize,
   for ( int k=0; k<size(); k++ )
     (*this)[k] = first + (last-first)*(k+1)/size();
   Description.clear();
+  clearSource();
   Description.setType( "stimulus/ramp" );
   Description.setName( name );
   Description.addNumber( "StartTime", 0.0, "s" );
@@ -1528,6 +1608,7 @@ void OutData::sawUpWave( double duration, double stepsize,
   back() = 0.0;
 
   Description.clear();
+  clearSource();
   Description.setType( "stimulus/sawtooth" );
   Description.setName( name );
   Description.addNumber( "StartTime", 0.0, "s" );
@@ -1554,6 +1635,7 @@ void OutData::sawDownWave( double duration, double stepsize,
   back() = 0.0;
 
   Description.clear();
+  clearSource();
   Description.setType( "stimulus/sawtooth" );
   Description.setName( name );
   Description.addNumber( "StartTime", 0.0, "s" );
@@ -1579,6 +1661,7 @@ void OutData::triangleWave( double duration, double stepsize,
   back() = 0.0;
 
   Description.clear();
+  clearSource();
   Description.setType( "stimulus/sawtooth" );
   Description.setName( name );
   Description.addNumber( "StartTime", 0.0, "s" );
@@ -1614,6 +1697,7 @@ void OutData::alphaWave( double &duration, double stepsize,
   duration = length();
 
   Description.clear();
+  clearSource();
   Description.setType( "stimulus/alpha" );
   Description.setName( name );
   Description.addNumber( "StartTime", delay, "s" );
@@ -1627,6 +1711,171 @@ void OutData::alphaWave( double &duration, double stepsize,
 }
 
 
+void OutData::setSource( const OutDataSource &source, double duration,
+			 double stepsize, const string &name )
+{
+  bool sourceduration = ( duration < 0.0 );
+  if ( sourceduration )
+    duration = source.duration();
+  if ( stepsize <= 0.0 )
+    stepsize = source.sampleInterval();
+  if ( stepsize < minSampleInterval() || fixedSampleRate() )
+    stepsize = minSampleInterval();
+
+  SampleDataF::clear();
+  Description.clear();
+  clearSource();
+  int n = 0;
+  if ( duration > 0.0 ) {
+    // the number of samples of a file, or the same as for the other waves:
+    if ( sourceduration )
+      n = (int)::floor( duration/stepsize + 0.5 );
+    else
+      n = LinearRange( 0.0, duration, stepsize ).size();
+  }
+  if ( n <= 0 ) {
+    setStepsize( stepsize );
+    setError( DaqError::NoData );
+    return;
+  }
+
+  Source = source.copy();
+  StreamSize = n;
+  StreamNext = -1;
+  SampleDataF::resize( 0, 0.0, stepsize );
+  loadBlock( 0 );
+
+  Description = source.description();
+  Description.setName( name );
+  Description.addNumber( "Duration", duration, "s" );
+  // the range may depend on the size set by loadBlock():
+  request( Source->minValue(), Source->maxValue() );
+  if ( source.carrierFreq() > 0.0 )
+    setCarrierFreq( source.carrierFreq() );
+  clearError();
+}
+
+
+void OutData::clearSource( void )
+{
+  if ( Source != 0 )
+    delete Source;
+  Source = 0;
+  StreamSize = 0;
+  StreamPadding = 0;
+  StreamOffset = 0;
+  StreamNext = 0;
+  StreamScale = 1.0;
+  StreamShift = 0.0;
+  StreamLast = 0.0;
+  StreamPrevious.clear();
+  StreamPreviousOffset = 0;
+}
+
+
+void OutData::setStreamBlockSize( int size )
+{
+  if ( size > 0 )
+    StreamBlockSize = size;
+}
+
+
+void OutData::setStreamPadding( int n )
+{
+  if ( Source != 0 && n >= 0 )
+    StreamPadding = n;
+}
+
+
+float OutData::streamValue( int index )
+{
+  if ( index < StreamOffset || index >= StreamOffset + size() ) {
+    if ( index >= StreamPreviousOffset &&
+	 index < StreamPreviousOffset + StreamPrevious.size() )
+      return StreamPrevious[ index - StreamPreviousOffset ];
+    loadBlock( index );
+  }
+  return (*this)[ index - StreamOffset ];
+}
+
+
+float OutData::streamLastValue( void ) const
+{
+  if ( Source != 0 )
+    return StreamScale*Source->lastValue() + StreamShift;
+  return back();
+}
+
+
+int OutData::deviceAvailable( void )
+{
+  if ( DeviceIndex >= deviceSize() )
+    return 0;
+  if ( DeviceIndex < StreamOffset || DeviceIndex >= StreamOffset + size() )
+    loadBlock( DeviceIndex );
+  return StreamOffset + size() - DeviceIndex;
+}
+
+
+float OutData::deviceLastValue( void ) const
+{
+  if ( DeviceIndex > StreamOffset && DeviceIndex <= StreamOffset + size() )
+    return (*this)[ DeviceIndex - StreamOffset - 1 ];
+  return Source != 0 ? StreamLast : back();
+}
+
+
+void OutData::incrDeviceCount( void )
+{
+  if ( Source != 0 && DeviceCount >= 0 &&
+       DeviceIndex > StreamOffset && DeviceIndex <= StreamOffset + size() )
+    StreamLast = (*this)[ DeviceIndex - StreamOffset - 1 ];
+  DeviceCount++;
+  DeviceIndex = 0;
+}
+
+
+void OutData::loadBlock( int index )
+{
+  if ( Source == 0 || index < 0 || index >= deviceSize() )
+    return;
+
+  // going back requires to start all over:
+  if ( StreamNext < 0 || index < StreamOffset ) {
+    Source->reset( stepsize(), StreamSize );
+    StreamNext = 0;
+  }
+
+  do {
+    // keep the current block for stepping back:
+    if ( StreamNext > 0 && StreamNext == StreamOffset + size() ) {
+      StreamPrevious.assign( data(), size() );
+      StreamPreviousOffset = StreamOffset;
+    }
+    int n = deviceSize() - StreamNext;
+    if ( n > StreamBlockSize )
+      n = StreamBlockSize;
+    SampleDataF::resize( n );
+    float *buffer = data();
+    int m = StreamSize - StreamNext;
+    if ( m > n )
+      m = n;
+    if ( m > 0 )
+      Source->generate( buffer, StreamNext, m );
+    else
+      m = 0;
+    for ( int k=m; k<n; k++ )
+      buffer[k] = Source->lastValue();
+    if ( StreamScale != 1.0 || StreamShift != 0.0 ) {
+      for ( int k=0; k<n; k++ )
+	buffer[k] = StreamScale*buffer[k] + StreamShift;
+    }
+    StreamOffset = StreamNext;
+    StreamNext += n;
+  } while ( index >= StreamNext );
+}
+
+
 ostream &operator<<( ostream &str, const OutData &od )
 {
   //  str << SampleDataF( od );
@@ -68,7 +68,7 @@ OutDataInfo::OutDataInfo( const OutData &signal )
     TraceName( signal.traceName() ),
     Delay( signal.delay() ),
     SampleRate( signal.sampleRate() ),
-    Length( signal.length() ),
+    Length( signal.duration() ),
     Intensity( signal.intensity() ),
     Level( signal.level() ),
     CarrierFreq( signal.carrierFreq() ),
@@ -0,0 +1,696 @@
+/*
+  outdatasource.cc
+  Generators that stream samples of an OutData block by block.
+
+  RELACS - Relaxed ELectrophysiological data Acquisition, Control, and Stimulation
+  Copyright (C) 2002-2015 Jan Benda <jan.benda@uni-tuebingen.de>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+  
+  RELACS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cmath>
+#include <cstdlib>
+#include <relacs/linearrange.h>
+#include <relacs/str.h>
+#include <relacs/strqueue.h>
+#include <relacs/outdatasource.h>
+using namespace std;
+
+namespace relacs {
+
+
+OutDataSource::OutDataSource( void )
+  : StepSize( 0.0 ),
+    Size( 0 )
+{
+}
+
+
+OutDataSource::~OutDataSource( void )
+{
+}
+
+
+void OutDataSource::reset( double stepsize, int size )
+{
+  StepSize = stepsize;
+  Size = size;
+}
+
+
+double OutDataSource::duration( void ) const
+{
+  return -1.0;
+}
+
+
+double OutDataSource::sampleInterval( void ) const
+{
+  return -1.0;
+}
+
+
+double OutDataSource::lastValue( void ) const
+{
+  return 0.0;
+}
+
+
+double OutDataSource::carrierFreq( void ) const
+{
+  return 0.0;
+}
+
+
+const Options &OutDataSource::description( void ) const
+{
+  return Description;
+}
+
+
+Options &OutDataSource::description( void )
+{
+  return Description;
+}
+
+
+void OutDataSource::ramp( float *buffer, int index, int n, double ramp ) const
+{
+  if ( ramp > 0.0 && StepSize > 0.0 ) {
+    int maxi = LinearRange( Size, 0.0, StepSize ).indices( ramp );
+    if ( maxi > 0 ) {
+      for ( int k=index; k<index+n && k<maxi; k++ )
+	buffer[k-index] *= float( double(k)/double(maxi) );
+      int k = Size - maxi;
+      if ( k < index )
+	k = index;
+      for ( ; k<index+n; k++ ) {
+	int i = Size-1-k;
+	if ( i < maxi )
+	  buffer[k-index] *= float( double(i)/double(maxi) );
+      }
+    }
+  }
+  if ( index + n >= Size && Size > index )
+    buffer[Size-1-index] = 0.0;
+}
+
+
+void NoiseSource::Biquad::setLowPass( double freq, double q, double stepsize )
+{
+  double w = 2.0*M_PI*freq*stepsize;
+  double cw = ::cos( w );
+  double alpha = ::sin( w )/(2.0*q);
+  double a0 = 1.0 + alpha;
+  B0 = 0.5*(1.0-cw)/a0;
+  B1 = (1.0-cw)/a0;
+  B2 = B0;
+  A1 = -2.0*cw/a0;
+  A2 = (1.0-alpha)/a0;
+  clear();
+}
+
+
+void NoiseSource::Biquad::setHighPass( double freq, double q, double stepsize )
+{
+  double w = 2.0*M_PI*freq*stepsize;
+  double cw = ::cos( w );
+  double alpha = ::sin( w )/(2.0*q);
+  double a0 = 1.0 + alpha;
+  B0 = 0.5*(1.0+cw)/a0;
+  B1 = -(1.0+cw)/a0;
+  B2 = B0;
+  A1 = -2.0*cw/a0;
+  A2 = (1.0-alpha)/a0;
+  clear();
+}
+
+
+void NoiseSource::Biquad::clear( void )
+{
+  X1 = X2 = Y1 = Y2 = 0.0;
+}
+
+
+double NoiseSource::Biquad::operator()( double x )
+{
+  double y = B0*x + B1*X1 + B2*X2 - A1*Y1 - A2*Y2;
+  X2 = X1;
+  X1 = x;
+  Y2 = Y1;
+  Y1 = y;
+  return y;
+}
+
+
+NoiseSource::NoiseSource( double cutofffreqlow, double cutofffreqhigh,
+			  double stdev, unsigned long *seed, double ramp )
+  : CutoffLow( cutofffreqlow ),
+    CutoffHigh( cutofffreqhigh ),
+    StDev( stdev ),
+    Ramp( ramp ),
+    Seed( 0 ),
+    NFilter( 0 ),
+    Gain( stdev )
+{
+  Seed = Rand.setSeed( seed != 0 ? *seed : 0 );
+  if ( seed != 0 )
+    *seed = Seed;
+
+  Description.setType( "stimulus/white_noise" );
+  Description.addNumber( "StartTime", 0.0, "s" );
+  Description.addNumber( "Mean", 0.0 );
+  Description.addNumber( "StDev", StDev );
+  Description.addNumber( "UpperCutoffFrequency", CutoffHigh, "Hz" );
+  Description.addNumber( "LowerCutoffFrequency", CutoffLow, "Hz" );
+  Description.addInteger( "Seed", Seed );
+}
+
+
+OutDataSource *NoiseSource::copy( void ) const
+{
+  return new NoiseSource( *this );
+}
+
+
+void NoiseSource::reset( double stepsize, int size )
+{
+  OutDataSource::reset( stepsize, size );
+  Rand.setSeed( Seed );
+
+  // Butterworth filters:
+  NFilter = 0;
+  double minfreq = 0.5/stepsize;
+  if ( CutoffHigh > 0.0 && CutoffHigh < 0.45/stepsize ) {
+    Filter[NFilter++].setLowPass( CutoffHigh, 0.54119610, stepsize );
+    Filter[NFilter++].setLowPass( CutoffHigh, 1.30656296, stepsize );
+    minfreq = CutoffHigh;
+  }
+  if ( CutoffLow > 0.0 && CutoffLow < 0.45/stepsize ) {
+    Filter[NFilter++].setHighPass( CutoffLow, M_SQRT1_2, stepsize );
+    minfreq = CutoffLow;
+  }
+  if ( NFilter == 0 ) {
+    Gain = StDev;
+    return;
+  }
+
+  // normalize by the power of the impulse response:
+  int m = (int)::ceil( 20.0/minfreq/stepsize );
+  if ( m < 1000 )
+    m = 1000;
+  else if ( m > 1000000 )
+    m = 1000000;
+  double power = 0.0;
+  for ( int k=0; k<m; k++ ) {
+    double y = k == 0 ? 1.0 : 0.0;
+    for ( int f=0; f<NFilter; f++ )
+      y = Filter[f]( y );
+    power += y*y;
+  }
+  Gain = power > 0.0 ? StDev/::sqrt( power ) : StDev;
+
+  // bring the filters into their steady state:
+  for ( int f=0; f<NFilter; f++ )
+    Filter[f].clear();
+  for ( int k=0; k<m/4; k++ ) {
+    double y = Rand.gaussian();
+    for ( int f=0; f<NFilter; f++ )
+      y = Filter[f]( y );
+  }
+}
+
+
+void NoiseSource::generate( float *buffer, int index, int n )
+{
+  Rand.fillGaussian( buffer, n );
+  if ( NFilter > 0 ) {
+    for ( int k=0; k<n; k++ ) {
+      double y = buffer[k];
+      for ( int f=0; f<NFilter; f++ )
+	y = Filter[f]( y );
+      buffer[k] = Gain*y;
+    }
+  }
+  else if ( Gain != 1.0 ) {
+    for ( int k=0; k<n; k++ )
+      buffer[k] *= Gain;
+  }
+  ramp( buffer, index, n, Ramp );
+}
+
+
+double NoiseSource::minValue( void ) const
+{
+  return -maxValue();
+}
+
+
+double NoiseSource::maxValue( void ) const
+{
+  // the probability that any of the samples exceeds z standard deviations
+  // is smaller than size()*exp(-z^2/2) = 0.01:
+  double z = 5.0;
+  if ( Size > 0 ) {
+    double zn = ::sqrt( 2.0*::log( 100.0*Size ) );
+    if ( zn > z )
+      z = zn;
+  }
+  return z*StDev;
+}
+
+
+double NoiseSource::carrierFreq( void ) const
+{
+  return CutoffHigh;
+}
+
+
+SineSource::SineSource( double freq, double ampl, double phase, double ramp )
+  : Freq( freq ),
+    Ampl( ampl ),
+    Phase( phase ),
+    Ramp( ramp )
+{
+  Description.setType( "stimulus/sine_wave" );
+  Description.addNumber( "StartTime", 0.0, "s" );
+  Description.addNumber( "Amplitude", Ampl );
+  Description.addNumber( "Frequency", Freq, "Hz" );
+  Description.addNumber( "Phase", Phase );
+}
+
+
+OutDataSource *SineSource::copy( void ) const
+{
+  return new SineSource( *this );
+}
+
+
+void SineSource::generate( float *buffer, int index, int n )
+{
+  double w = 2.0*M_PI*Freq*StepSize;
+  for ( int k=0; k<n; k++ )
+    buffer[k] = Ampl * ::sin( w*(index+k) + Phase );
+  ramp( buffer, index, n, Ramp );
+}
+
+
+double SineSource::minValue( void ) const
+{
+  return -::fabs( Ampl );
+}
+
+
+double SineSource::maxValue( void ) const
+{
+  return ::fabs( Ampl );
+}
+
+
+double SineSource::carrierFreq( void ) const
+{
+  return Freq;
+}
+
+
+AMSource::AMSource( double carrierfreq, double amfreq, double depth,
+		    double ampl, double ramp )
+  : CarrierFreq( carrierfreq ),
+    AMFreq( amfreq ),
+    Depth( depth ),
+    Ampl( ampl ),
+    Ramp( ramp )
+{
+  Description.setType( "stimulus/am_wave" );
+  Description.addNumber( "StartTime", 0.0, "s" );
+  Description.addNumber( "Amplitude", Ampl );
+  Description.addNumber( "CarrierFrequency", CarrierFreq, "Hz" );
+  Description.addNumber( "Frequency", AMFreq, "Hz" );
+  Description.addNumber( "Depth", Depth );
+}
+
+
+OutDataSource *AMSource::copy( void ) const
+{
+  return new AMSource( *this );
+}
+
+
+void AMSource::generate( float *buffer, int index, int n )
+{
+  double wc = 2.0*M_PI*CarrierFreq*StepSize;
+  double wam = 2.0*M_PI*AMFreq*StepSize;
+  double a = Ampl/(1.0+::fabs( Depth ));
+  for ( int k=0; k<n; k++ ) {
+    double i = index + k;
+    buffer[k] = a * ( 1.0 + Depth*::sin( wam*i ) ) * ::sin( wc*i );
+  }
+  ramp( buffer, index, n, Ramp );
+}
+
+
+double AMSource::minValue( void ) const
+{
+  return -::fabs( Ampl );
+}
+
+
+double AMSource::maxValue( void ) const
+{
+  return ::fabs( Ampl );
+}
+
+
+double AMSource::carrierFreq( void ) const
+{
+  return CarrierFreq;
+}
+
+
+SweepSource::SweepSource( double startfreq, double endfreq, double ampl,
+			  double ramp )
+  : StartFreq( startfreq ),
+    EndFreq( endfreq ),
+    Ampl( ampl ),
+    Ramp( ramp )
+{
+  Description.setType( "stimulus/sweep_wave" );
+  Description.addNumber( "StartTime", 0.0, "s" );
+  Description.addNumber( "Amplitude", Ampl );
+  Description.addNumber( "StartFrequency", StartFreq, "Hz" );
+  Description.addNumber( "EndFrequency", EndFreq, "Hz" );
+  Description.addNumber( "Phase", 0.0 );
+}
+
+
+OutDataSource *SweepSource::copy( void ) const
+{
+  return new SweepSource( *this );
+}
+
+
+void SweepSource::generate( float *buffer, int index, int n )
+{
+  double l = Size*StepSize;
+  double fac = l > 0.0 ? 0.5*(EndFreq-StartFreq)/l : 0.0;
+  for ( int k=0; k<n; k++ ) {
+    double t = (index+k)*StepSize;
+    buffer[k] = Ampl * ::sin( 2.0*M_PI*( StartFreq + fac*t )*t );
+  }
+  ramp( buffer, index, n, Ramp );
+}
+
+
+double SweepSource::minValue( void ) const
+{
+  return -::fabs( Ampl );
+}
+
+
+double SweepSource::maxValue( void ) const
+{
+  return ::fabs( Ampl );
+}
+
+
+FileSource::FileSource( const string &file, const string &filename )
+  : File( file ),
+    Sound( false ),
+    Samples( 0 ),
+    Interval( -1.0 ),
+    Min( 0.0 ),
+    Max( 0.0 ),
+    Last( 0.0 ),
+    Channels( 1 )
+#ifdef HAVE_LIBSNDFILE
+    , Snd( 0 )
+#endif
+{
+  Sound = ( Str( file ).extension().lower() == ".wav" );
+  if ( ! open() )
+    return;
+  scan();
+  Description.insertText( "File", "", filename.empty() ? file : filename );
+  if ( Description.type().empty() )
+    Description.setType( "stimulus/file" );
+}
+
+
+FileSource::FileSource( const FileSource &fs )
+  : OutDataSource( fs ),
+    File( fs.File ),
+    Sound( fs.Sound ),
+    Samples( fs.Samples ),
+    Interval( fs.Interval ),
+    Min( fs.Min ),
+    Max( fs.Max ),
+    Last( fs.Last ),
+    Channels( fs.Channels ),
+    DataStart( fs.DataStart )
+#ifdef HAVE_LIBSNDFILE
+    , Snd( 0 )
+#endif
+{
+  if ( Samples > 0 )
+    open();
+}
+
+
+FileSource::~FileSource( void )
+{
+  close();
+}
+
+
+bool FileSource::open( void )
+{
+  if ( Sound ) {
+#ifdef HAVE_LIBSNDFILE
+    SF_INFO sfinfo;
+    sfinfo.format = 0;
+    Snd = sf_open( File.c_str(), SFM_READ, &sfinfo );
+    if ( Snd == 0 || sfinfo.samplerate <= 0 ) {
+      close();
+      return false;
+    }
+    Interval = 1.0/sfinfo.samplerate;
+    Channels = sfinfo.channels;
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  Ascii.open( File.c_str() );
+  return Ascii.good();
+}
+
+
+void FileSource::close( void )
+{
+#ifdef HAVE_LIBSNDFILE
+  if ( Snd != 0 )
+    sf_close( Snd );
+  Snd = 0;
+#endif
+  if ( Ascii.is_open() )
+    Ascii.close();
+}
+
+
+void FileSource::scan( void )
+{
+  Samples = 0;
+  Min = 0.0;
+  Max = 0.0;
+  Last = 0.0;
+  if ( Sound ) {
+#ifdef HAVE_LIBSNDFILE
+    const int blocksize = 4096;
+    float buffer[blocksize];
+    int n = 0;
+    while ( ( n = read( buffer, blocksize ) ) > 0 ) {
+      for ( int k=0; k<n; k++ ) {
+	if ( Samples == 0 || buffer[k] < Min )
+	  Min = buffer[k];
+	if ( Samples == 0 || buffer[k] > Max )
+	  Max = buffer[k];
+	Samples++;
+      }
+      Last = buffer[n-1];
+    }
+    sf_seek( Snd, 0, SEEK_SET );
+#endif
+    return;
+  }
+
+  // header with description and key, as in OutData::load():
+  StrQueue sq;
+  double tfac = 1.0;
+  string s;
+  DataStart = Ascii.tellg();
+  while ( getline( Ascii, s ) && ( s.empty() || s.find( '#' ) == 0 ) ) {
+    if ( s.find( "#Key" ) == 0 ) {
+      for ( int k=0; k<4; k++ ) {
+	DataStart = Ascii.tellg();
+	if ( ! getline( Ascii, s ) || ( ! s.empty() && s.find( '#' ) != 0 ) )
+	  break;
+	if ( s.find( "ms" ) != string::npos )
+	  tfac = 0.001;
+      }
+      break;
+    }
+    sq.add( s );
+    DataStart = Ascii.tellg();
+  }
+  sq.stripComments( "-#" );
+  Description.load( sq );
+
+  // data:
+  Ascii.clear();
+  Ascii.seekg( DataStart );
+  double t0 = 0.0;
+  while ( getline( Ascii, s ) ) {
+    if ( s.empty() || s[0] == '#' )
+      continue;
+    const char *cp = s.c_str();
+    char *ep;
+    double t = ::strtod( cp, &ep );
+    if ( ep == cp )
+      continue;
+    double v = ::strtod( ep, 0 );
+    if ( Samples == 0 ) {
+      t0 = t;
+      Min = v;
+      Max = v;
+    }
+    else if ( Samples == 1 )
+      Interval = tfac*( t - t0 );
+    if ( v < Min )
+      Min = v;
+    if ( v > Max )
+      Max = v;
+    Last = v;
+    Samples++;
+  }
+  Ascii.clear();
+  Ascii.seekg( DataStart );
+}
+
+
+int FileSource::read( float *buffer, int n )
+{
+  if ( Sound ) {
+#ifdef HAVE_LIBSNDFILE
+    if ( Snd == 0 )
+      return 0;
+    if ( Channels == 1 )
+      return sf_readf_float( Snd, buffer, n );
+    float frames[ 256*Channels ];
+    int r = 0;
+    while ( r < n ) {
+      int m = n - r < 256 ? n - r : 256;
+      int c = sf_readf_float( Snd, frames, m );
+      for ( int k=0; k<c; k++ )
+	buffer[r+k] = frames[k*Channels];
+      r += c;
+      if ( c < m )
+	break;
+    }
+    return r;
+#else
+    return 0;
+#endif
+  }
+
+  int r = 0;
+  string s;
+  while ( r < n && getline( Ascii, s ) ) {
+    if ( s.empty() || s[0] == '#' )
+      continue;
+    const char *cp = s.c_str();
+    char *ep;
+    ::strtod( cp, &ep );
+    if ( ep == cp )
+      continue;
+    buffer[r++] = ::strtod( ep, 0 );
+  }
+  return r;
+}
+
+
+OutDataSource *FileSource::copy( void ) const
+{
+  return new FileSource( *this );
+}
+
+
+void FileSource::reset( double stepsize, int size )
+{
+  OutDataSource::reset( stepsize, size );
+  if ( Sound ) {
+#ifdef HAVE_LIBSNDFILE
+    if ( Snd != 0 )
+      sf_seek( Snd, 0, SEEK_SET );
+#endif
+  }
+  else {
+    Ascii.clear();
+    Ascii.seekg( DataStart );
+  }
+}
+
+
+void FileSource::generate( float *buffer, int index, int n )
+{
+  int r = 0;
+  if ( index < Samples )
+    r = read( buffer, n );
+  for ( int k=r; k<n; k++ )
+    buffer[k] = Last;
+}
+
+
+double FileSource::duration( void ) const
+{
+  return Samples*Interval;
+}
+
+
+double FileSource::sampleInterval( void ) const
+{
+  return Interval;
+}
+
+
+double FileSource::minValue( void ) const
+{
+  return Min;
+}
+
+
+double FileSource::maxValue( void ) const
+{
+  return Max;
+}
+
+
+double FileSource::lastValue( void ) const
+{
+  return Last;
+}
+
+
+}; /* namespace relacs */
+
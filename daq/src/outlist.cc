@@ -331,7 +331,7 @@ int OutList::deviceBufferSize( void )
 {
   int n = 0;
   for ( int k=0; k<size(); k++ )
-    n += operator[]( k ).deviceDelay() + operator[]( k ).size();
+    n += operator[]( k ).deviceDelay() + operator[]( k ).deviceSize();
   return n;
 }
 
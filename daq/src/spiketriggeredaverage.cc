@@ -0,0 +1,220 @@
+/*
+  spiketriggeredaverage.cc
+  Incrementally accumulated spike-triggered averages of many input traces
+
+  RELACS - Relaxed ELectrophysiological data Acquisition, Control, and Stimulation
+  Copyright (C) 2002-2015 Jan Benda <jan.benda@uni-tuebingen.de>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+  
+  RELACS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cmath>
+#include <relacs/spiketriggeredaverage.h>
+
+namespace relacs {
+
+
+SpikeTriggeredAverage::SpikeTriggeredAverage( void )
+  : TMin( 0.0 ),
+    TMax( 0.0 ),
+    NSnippets( 0 ),
+    Count( 0 ),
+    LastSpike( -HUGE_VAL ),
+    Rand( 1 )
+{
+}
+
+
+SpikeTriggeredAverage::SpikeTriggeredAverage( const InList &traces,
+					      double tmin, double tmax,
+					      int nsnippets )
+  : Rand( 1 )
+{
+  init( traces, tmin, tmax, nsnippets );
+}
+
+
+void SpikeTriggeredAverage::init( const InList &traces, double tmin, double tmax,
+				  int nsnippets )
+{
+  Traces.clear();
+  Traces.add( traces );
+  TMin = tmin;
+  TMax = tmax;
+  NSnippets = nsnippets;
+  Averages.resize( Traces.size() );
+  for ( int k=0; k<Traces.size(); k++ ) {
+    Averages[k].Sum.resize( TMin, TMax, Traces[k].sampleInterval(), 0.0 );
+    Averages[k].SumSq.resize( TMin, TMax, Traces[k].sampleInterval(), 0.0 );
+    Averages[k].Shift.resize( TMin, TMax, Traces[k].sampleInterval(), 0.0 );
+  }
+  reset();
+}
+
+
+void SpikeTriggeredAverage::reset( void )
+{
+  for ( unsigned int k=0; k<Averages.size(); k++ ) {
+    Averages[k].Sum = 0.0;
+    Averages[k].SumSq = 0.0;
+    Averages[k].Shift = 0.0;
+    Averages[k].Snippets.clear();
+    Averages[k].Snippets.reserve( NSnippets );
+  }
+  Count = 0;
+  LastSpike = -HUGE_VAL;
+  for ( int k=0; k<Traces.size(); k++ ) {
+    if ( LastSpike < Traces[k].currentTime() )
+      LastSpike = Traces[k].currentTime();
+  }
+}
+
+
+int SpikeTriggeredAverage::update( const EventData &spikes )
+{
+  if ( Traces.empty() )
+    return 0;
+
+  int n = 0;
+  int first = spikes.next( LastSpike );
+  if ( first < spikes.minEvent() )
+    first = spikes.minEvent();
+  for ( int i=first; i<spikes.size(); i++ ) {
+    double t = spikes[i];
+    if ( t <= LastSpike )
+      continue;
+
+    // data available?
+    bool complete = true;
+    bool available = true;
+    for ( int k=0; k<Traces.size(); k++ ) {
+      int i0 = Traces[k].index( t + TMin );
+      if ( i0 + Averages[k].Sum.size() > Traces[k].size() ) {
+	complete = false;
+	break;
+      }
+      if ( i0 < Traces[k].minIndex() )
+	available = false;
+    }
+    if ( ! complete )
+      break;
+    LastSpike = t;
+    if ( ! available )
+      continue;
+
+    // reservoir sampling of snippets:
+    Count++;
+    int slot = -1;
+    if ( Count <= NSnippets )
+      slot = Count - 1;
+    else if ( NSnippets > 0 ) {
+      unsigned long r = Rand( (unsigned long)Count );
+      if ( r < (unsigned long)NSnippets )
+	slot = r;
+    }
+
+    // accumulate:
+    for ( int k=0; k<Traces.size(); k++ ) {
+      const InData &trace = Traces[k];
+      Sums &s = Averages[k];
+      int i0 = trace.index( t + TMin );
+      int m = s.Sum.size();
+      if ( Count == 1 ) {
+	// shift data for numerical stability of the variance:
+	for ( int j=0; j<m; j++ )
+	  s.Shift[j] = trace[i0+j];
+      }
+      for ( int j=0; j<m; j++ ) {
+	double v = trace[i0+j] - s.Shift[j];
+	s.Sum[j] += v;
+	s.SumSq[j] += v*v;
+      }
+      if ( slot >= 0 ) {
+	if ( slot >= (int)s.Snippets.size() )
+	  s.Snippets.push_back( SampleDataF( m, s.Sum.offset(), s.Sum.stepsize() ) );
+	SampleDataF &snippet = s.Snippets[slot];
+	for ( int j=0; j<m; j++ )
+	  snippet[j] = trace[i0+j];
+      }
+    }
+    n++;
+  }
+
+  return n;
+}
+
+
+int SpikeTriggeredAverage::traces( void ) const
+{
+  return Traces.size();
+}
+
+
+double SpikeTriggeredAverage::tmin( void ) const
+{
+  return TMin;
+}
+
+
+double SpikeTriggeredAverage::tmax( void ) const
+{
+  return TMax;
+}
+
+
+int SpikeTriggeredAverage::count( void ) const
+{
+  return Count;
+}
+
+
+void SpikeTriggeredAverage::average( int trace, SampleDataF &average ) const
+{
+  const Sums &s = Averages[trace];
+  average.resize( s.Sum.size(), s.Sum.offset(), s.Sum.stepsize(), 0.0 );
+  if ( Count <= 0 )
+    return;
+  for ( int j=0; j<average.size(); j++ )
+    average[j] = s.Shift[j] + s.Sum[j]/Count;
+}
+
+
+void SpikeTriggeredAverage::stdev( int trace, SampleDataF &stdev ) const
+{
+  const Sums &s = Averages[trace];
+  stdev.resize( s.Sum.size(), s.Sum.offset(), s.Sum.stepsize(), 0.0 );
+  if ( Count <= 1 )
+    return;
+  for ( int j=0; j<stdev.size(); j++ ) {
+    double m = s.Sum[j]/Count;
+    double var = ( s.SumSq[j] - Count*m*m )/( Count - 1 );
+    stdev[j] = var > 0.0 ? ::sqrt( var ) : 0.0;
+  }
+}
+
+
+int SpikeTriggeredAverage::nsnippets( void ) const
+{
+  return NSnippets;
+}
+
+
+const vector< SampleDataF > &SpikeTriggeredAverage::snippets( int trace ) const
+{
+  return Averages[trace].Snippets;
+}
+
+
+}; /* namespace relacs */
+
@@ -25,6 +25,7 @@
 
 #include <deque>
 #include <vector>
+#include <limits>
 #include <relacs/array.h>
 #include <relacs/options.h>
 using namespace std;
@@ -559,12 +560,57 @@ public:
   template < typename T >
   ostream &saveVector( ostream &str, const vector< T > &vec, int c=-1 ) const;
 
+    /*! The number format of a single column, parsed once
+        instead of for every value that is written. */
+  struct ColumnFormat
+  {
+    ColumnFormat( void );
+      /*! Interpret the printf-style \a format the same way
+	  as Str( double, format ) and Str( long, format ) do. */
+    void compile( const string &format );
+      /*! Append \a v formatted according to the format to \a line. */
+    void append( double v, string &line ) const;
+      /*! Append the integer \a v formatted according to the format to \a line. */
+    void append( long v, string &line ) const;
+
+      /*! The format used by sprintf() for floating point numbers. */
+    string Float;
+      /*! The format used by sprintf() for integer numbers. */
+    string Integer;
+      /*! True if the format is a plain %[-][width][.precision]f,
+	  that is formatted without sprintf(). */
+    bool Fixed;
+      /*! Left align the number within Width. */
+    bool Left;
+      /*! The minimum width of the formatted number. */
+    int Width;
+      /*! The number of digits after the decimal point. */
+    int Precision;
+  };
+
+    /*! Compile the formats of all columns into Formats. */
+  void compileFormats( void ) const;
+    /*! Append the separator or the data start for column \a c to Line. */
+  void appendStart( int c ) const;
+    /*! Append \a v formatted and padded for column \a c to Line. */
+  void appendNumber( double v, int c ) const;
+    /*! Append \a v formatted and padded for column \a c to Line. */
+  void appendNumber( long v, int c ) const;
+    /*! Append \a v formatted and padded for column \a c to Line
+        as an integer or a floating point number depending on \a T. */
+  template < typename T >
+  void appendValue( T v, int c ) const;
+    /*! Write the content of Line to \a str. */
+  ostream &writeLine( ostream &str ) const;
+
   Options Opt;
 
   deque< deque < Options::section_iterator > > Sections;
   deque < Options::iterator > Columns;
   vector < int > Width;
+  mutable vector < ColumnFormat > Formats;
   mutable int PrevCol;
+  mutable string Line;
 
   mutable Parameter Dummy;
   mutable Options DummySection;
@@ -587,23 +633,17 @@ ostream &TableKey::save( ostream &str, const T *v, int n, int c ) const
   if ( c < 0 )
     return str;
 
+  Line.clear();
   const T *vp = v;
   for ( int k=0; k < n; k++, ++vp ) {
     if ( c >= (int)Columns.size() )
-      return str;
-    if ( c > 0 )
-      str << Separator;
-    else
-      str << DataStart;
-    Str s( *vp, format( c ) );
-    if ( s.size() >= Width[c] )
-      str << s;
-    else
-      str << Str( s, Width[c] );
+      break;
+    appendStart( c );
+    appendValue( *vp, c );
     PrevCol = c;
     c++;
   }
-  return str;  
+  return writeLine( str );
 }
 
 
@@ -616,24 +656,18 @@ ostream &TableKey::saveVector( ostream &str, const vector< T > &vec, int c ) con
   if ( c < 0 )
     return str;
 
+  Line.clear();
   for ( typename vector< T >::const_iterator vp = vec.begin();
 	vp != vec.end();
 	++vp ) {
     if ( c >= (int)Columns.size() )
-      return str;
-    if ( c > 0 )
-      str << Separator;
-    else
-      str << DataStart;
-    Str s( *vp, format( c ) );
-    if ( s.size() >= Width[c] )
-      str << s;
-    else
-      str << Str( s, Width[c] );
+      break;
+    appendStart( c );
+    appendValue( *vp, c );
     PrevCol = c;
     c++;
   }
-  return str;  
+  return writeLine( str );
 }
 
 
@@ -646,24 +680,18 @@ ostream &TableKey::save( ostream &str, const Array< T > &vec, int c ) const
   if ( c < 0 )
     return str;
 
+  Line.clear();
   for ( typename Array< T >::const_iterator vp = vec.begin();
 	vp != vec.end();
 	++vp ) {
     if ( c >= (int)Columns.size() )
-      return str;
-    if ( c > 0 )
-      str << Separator;
-    else
-      str << DataStart;
-    Str s( *vp, format( c ) );
-    if ( s.size() >= Width[c] )
-      str << s;
-    else
-      str << Str( s, Width[c] );
+      break;
+    appendStart( c );
+    appendValue( *vp, c );
     PrevCol = c;
     c++;
   }
-  return str;  
+  return writeLine( str );
 }
 
 
@@ -677,22 +705,16 @@ ostream &TableKey::save( ostream &str, const vector< vector< T > > &v,
   if ( c < 0 )
     return str;
 
+  Line.clear();
   for ( unsigned int k=0; k<v.size(); k++ ) {
     if ( c >= (int)Columns.size() )
-      return str;
-    if ( c > 0 )
-      str << Separator;
-    else
-      str << DataStart;
-    Str s( r < (int)v[k].size() ? v[k][r] : 0.0, format( c ) );
-    if ( s.size() >= Width[c] )
-      str << s;
-    else
-      str << Str( s, Width[c] );
+      break;
+    appendStart( c );
+    appendValue( r < (int)v[k].size() ? v[k][r] : 0.0, c );
     PrevCol = c;
     c++;
   }
-  return str;  
+  return writeLine( str );
 }
 
 
@@ -706,22 +728,26 @@ ostream &TableKey::save( ostream &str, const vector< Array< T > > &v,
   if ( c < 0 )
     return str;
 
+  Line.clear();
   for ( unsigned int k=0; k<v.size(); k++ ) {
     if ( c >= (int)Columns.size() )
-      return str;
-    if ( c > 0 )
-      str << Separator;
-    else
-      str << DataStart;
-    Str s( r < (int)v[k].size() ? v[k][r] : 0.0, format( c ) );
-    if ( s.size() >= Width[c] )
-      str << s;
-    else
-      str << Str( s, Width[c] );
+      break;
+    appendStart( c );
+    appendValue( r < (int)v[k].size() ? v[k][r] : 0.0, c );
     PrevCol = c;
     c++;
   }
-  return str;  
+  return writeLine( str );
+}
+
+
+template < typename T >
+void TableKey::appendValue( T v, int c ) const
+{
+  if ( numeric_limits< T >::is_integer )
+    appendNumber( (long)v, c );
+  else
+    appendNumber( (double)v, c );
 }
 
 
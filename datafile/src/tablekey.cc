@@ -20,6 +20,9 @@
 */
 
 #include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
 #include <relacs/strqueue.h>
 #include <relacs/tabledata.h>
 #include <relacs/tablekey.h>
@@ -32,7 +35,9 @@ TableKey::TableKey( void )
     Sections(),
     Columns(),
     Width(),
+    Formats(),
     PrevCol( -1 ),
+    Line(),
     Comment( "#" ),
     KeyStart( "# " ),
     DataStart( "  " ),
@@ -47,7 +52,9 @@ TableKey::TableKey( const TableKey &key )
     Sections( key.Sections ),
     Columns( key.Columns ),
     Width( key.Width ),
+    Formats( key.Formats ),
     PrevCol( key.PrevCol ),
+    Line(),
     Comment( key.Comment ),
     KeyStart( key.KeyStart ),
     DataStart( key.DataStart ),
@@ -62,7 +69,9 @@ TableKey::TableKey( const Options &o )
     Sections(),
     Columns(),
     Width(),
+    Formats(),
     PrevCol( -1 ),
+    Line(),
     Comment( "#" ),
     KeyStart( "# " ),
     DataStart( "  " ),
@@ -426,8 +435,11 @@ int TableKey::formatWidth( const string &pattern ) const
 
 Parameter &TableKey::setFormat( int column, const string &format )
 {
-  if ( column >= 0 && column < (int)Columns.size() )
-    return Columns[column]->setFormat( format );
+  if ( column >= 0 && column < (int)Columns.size() ) {
+    Parameter &p = Columns[column]->setFormat( format );
+    Formats[column].compile( p.format() );
+    return p;
+  }
   else
     return Dummy;
 }
@@ -600,6 +612,7 @@ void TableKey::clear( void )
   Sections.clear();
   Columns.clear();
   Width.clear();
+  Formats.clear();
 }
 
 
@@ -609,6 +622,9 @@ ostream &TableKey::saveKey( ostream &str, bool key, bool num,
   if ( Columns.size() < 1 )
     return str;
 
+  // the formats might have been changed via the parameter references:
+  compileFormats();
+
   // key marker:
   if ( key )
     str << Str( KeyStart ).strip() << "Key" << '\n';
@@ -1097,16 +1113,10 @@ ostream &TableKey::save( ostream &str, double v, int c ) const
 
   PrevCol = c;
 
-  if ( c > 0 )
-    str << Separator;
-  else
-    str << DataStart;
-  Str s( v, format( c ) );
-  if ( s.size() >= Width[c] )
-    str << s;
-  else
-    str << Str( s, Width[c] );
-  return str;  
+  Line.clear();
+  appendStart( c );
+  appendNumber( v, c );
+  return writeLine( str );
 }
 
 
@@ -1119,22 +1129,16 @@ ostream &TableKey::save( ostream &str, const TableData &table,
   if ( c < 0 )
     return str;
 
+  Line.clear();
   for ( int k=0; k<table.columns(); k++ ) {
     if ( c >= (int)Columns.size() )
-      return str;
-    if ( c > 0 )
-      str << Separator;
-    else
-      str << DataStart;
-    Str s( r < (int)table.rows() ? table( k, r ) : 0.0, format( c ) );
-    if ( s.size() >= Width[c] )
-      str << s;
-    else
-      str << Str( s, Width[c] );
+      break;
+    appendStart( c );
+    appendNumber( r < (int)table.rows() ? table( k, r ) : 0.0, c );
     PrevCol = c;
     c++;
   }
-  return str;  
+  return writeLine( str );
 }
 
 
@@ -1152,40 +1156,29 @@ ostream &TableKey::save( ostream &str, const TableData &table,
   if ( cend >= table.columns() || cend < 0 )
     cend = table.columns();
 
+  Line.clear();
   for ( int k=cbegin; k<cend; k++ ) {
     if ( c >= (int)Columns.size() )
-      return str;
-    if ( c > 0 )
-      str << Separator;
-    else
-      str << DataStart;
-    Str s( r < (int)table.rows() ? table( k, r ) : 0.0, format( c ) );
-    if ( s.size() >= Width[c] )
-      str << s;
-    else
-      str << Str( s, Width[c] );
+      break;
+    appendStart( c );
+    appendNumber( r < (int)table.rows() ? table( k, r ) : 0.0, c );
     PrevCol = c;
     c++;
   }
-  return str;  
+  return writeLine( str );
 }
 
 
 ostream &TableKey::save( ostream &str, const TableData &table ) const
 {
   for ( int r=0; r<table.rows(); r++ ) {
+    Line.clear();
     for ( int c=0; c<table.columns() && c<columns(); c++ ) {
-      if ( c > 0 )
-	str << Separator;
-      else
-	str << DataStart;
-      Str s( table( c, r ), format( c ) );
-      if ( s.size() >= Width[c] )
-	str << s;
-      else
-	str << Str( s, Width[c] );
+      appendStart( c );
+      appendNumber( table( c, r ), c );
     }
-    str << '\n';
+    Line += '\n';
+    writeLine( str );
   }
   PrevCol = -1;
   return str;  
@@ -1275,6 +1268,210 @@ void TableKey::resetSaveColumn( void )
 }
 
 
+TableKey::ColumnFormat::ColumnFormat( void )
+  : Float( "%g" ),
+    Integer( "%ld" ),
+    Fixed( false ),
+    Left( false ),
+    Width( 0 ),
+    Precision( 6 )
+{
+}
+
+
+void TableKey::ColumnFormat::compile( const string &format )
+{
+  Fixed = false;
+  Left = false;
+  Width = 0;
+  Precision = 6;
+
+  // find format specifier in format (see Str::ReadFormat()):
+  const char *fs = format.c_str();
+  const char *fp = fs;
+  for ( fp = strchr( fp, '%' ); fp != 0; fp = strchr( fp, '%' ) ) {
+    if ( *(fp+1) == '%' )
+      fp += 2;
+    else
+      break;
+  }
+
+  // no format specifier found:
+  if ( fp == 0 ) {
+    Float = "%g";
+    Integer = "%ld";
+    return;
+  }
+
+  // analyse format specifier:
+  const char *sp = fp + 1;
+  char *ep;
+  Width = abs( strtol( sp, &ep, 10 ) );
+  const char *pp = ep;
+  if ( *pp == '.' ) {
+    Precision = strtol( pp+1, &ep, 10 );
+    if ( Precision < 0 )
+      Precision = 0;
+    pp = ep;
+  }
+  unsigned int findex = pp - fs;
+
+  // format for floating point numbers as in Str::Construct( double, format ):
+  Float = format;
+  if ( findex == format.size() )
+    Float += 'g';
+  else if ( strchr( "aAfFgGeE", format[findex] ) == 0 )
+    Float[findex] = 'g';
+
+  // format for integer numbers as in Str::Construct( long, format ):
+  Integer = format;
+  if ( findex == format.size() )
+    Integer += "ld";
+  else if ( format[findex] != 'l' || 
+	    strchr( "diouxX", format[findex+1] ) == 0 ) {
+    if ( format[findex] != 'l' )
+      Integer.insert( findex, 1, 'l' );
+    if ( strchr( "diouxX", Integer[findex+1] ) == 0 )
+      Integer[findex+1] = 'd';
+  }
+
+  // a plain %[-][width][.precision]f format without any text around:
+  if ( fp == fs && findex+1 == format.size() &&
+       ( format[findex] == 'f' || format[findex] == 'F' ) ) {
+    const char *cp = sp;
+    if ( *cp == '-' ) {
+      Left = true;
+      ++cp;
+    }
+    // no zero padding:
+    if ( *cp == '0' )
+      return;
+    while ( *cp >= '0' && *cp <= '9' )
+      ++cp;
+    if ( *cp == '.' ) {
+      ++cp;
+      while ( *cp >= '0' && *cp <= '9' )
+	++cp;
+    }
+    Fixed = ( cp == pp && Precision <= 9 );
+  }
+}
+
+
+void TableKey::ColumnFormat::append( double v, string &line ) const
+{
+  static const double pow10[10] = { 1.0, 1.0e1, 1.0e2, 1.0e3, 1.0e4,
+				     1.0e5, 1.0e6, 1.0e7, 1.0e8, 1.0e9 };
+
+  if ( Fixed ) {
+    // v scaled to an integer number of the last digit:
+    double s = ::fabs( v ) * pow10[Precision];
+    // this is false for nan and inf:
+    if ( s < 4.0e15 ) {
+      double r = ::floor( s );
+      double f = s - r;
+      // leave values close to half the last digit to sprintf(),
+      // since the rounding of s could change the result:
+      if ( ::fabs( f - 0.5 ) > 4.0e-16*s + 1.0e-12 ) {
+	unsigned long long n = (unsigned long long)r;
+	if ( f > 0.5 )
+	  n++;
+	char buf[32];
+	char *ep = buf + sizeof( buf );
+	char *bp = ep;
+	for ( int k=0; k<Precision; k++ ) {
+	  *--bp = '0' + n % 10;
+	  n /= 10;
+	}
+	if ( Precision > 0 )
+	  *--bp = '.';
+	do {
+	  *--bp = '0' + n % 10;
+	  n /= 10;
+	} while ( n > 0 );
+	if ( std::signbit( v ) )
+	  *--bp = '-';
+	int pad = Width - ( ep - bp );
+	if ( pad > 0 && ! Left )
+	  line.append( pad, ' ' );
+	line.append( bp, ep );
+	if ( pad > 0 && Left )
+	  line.append( pad, ' ' );
+	return;
+      }
+    }
+  }
+
+  char buf[128];
+  int n = snprintf( buf, sizeof( buf ), Float.c_str(), v );
+  if ( n < (int)sizeof( buf ) )
+    line.append( buf, n > 0 ? n : 0 );
+  else {
+    vector< char > lbuf( n+1 );
+    snprintf( &lbuf[0], lbuf.size(), Float.c_str(), v );
+    line.append( &lbuf[0], n );
+  }
+}
+
+
+void TableKey::ColumnFormat::append( long v, string &line ) const
+{
+  char buf[128];
+  int n = snprintf( buf, sizeof( buf ), Integer.c_str(), v );
+  if ( n < (int)sizeof( buf ) )
+    line.append( buf, n > 0 ? n : 0 );
+  else {
+    vector< char > lbuf( n+1 );
+    snprintf( &lbuf[0], lbuf.size(), Integer.c_str(), v );
+    line.append( &lbuf[0], n );
+  }
+}
+
+
+void TableKey::compileFormats( void ) const
+{
+  Formats.resize( Columns.size() );
+  for ( unsigned int c=0; c<Columns.size(); c++ )
+    Formats[c].compile( Columns[c]->format() );
+}
+
+
+void TableKey::appendStart( int c ) const
+{
+  if ( c > 0 )
+    Line += Separator;
+  else
+    Line += DataStart;
+}
+
+
+void TableKey::appendNumber( double v, int c ) const
+{
+  unsigned int n = Line.size();
+  Formats[c].append( v, Line );
+  int w = Line.size() - n;
+  if ( w < Width[c] )
+    Line.insert( n, Width[c] - w, ' ' );
+}
+
+
+void TableKey::appendNumber( long v, int c ) const
+{
+  unsigned int n = Line.size();
+  Formats[c].append( v, Line );
+  int w = Line.size() - n;
+  if ( w < Width[c] )
+    Line.insert( n, Width[c] - w, ' ' );
+}
+
+
+ostream &TableKey::writeLine( ostream &str ) const
+{
+  str.write( Line.data(), Line.size() );
+  return str;
+}
+
+
 void TableKey::addParams( Options *o, deque < Options::section_iterator > &sections, int &level )
 {
   level++;
@@ -1332,6 +1529,7 @@ void TableKey::init( void )
     Width[c] = uw > w ? uw : w;
   }
 
+  compileFormats();
 }
 
 
@@ -0,0 +1,129 @@
+/*
+  relacsshmclient.c
+  Example client reading traces and events exported by RELACS to shared memory
+
+  RELACS - Relaxed ELectrophysiological data Acquisition, Control, and Stimulation
+  Copyright (C) 2002-2015 Jan Benda <jan.benda@uni-tuebingen.de>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+  
+  RELACS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+  Run RELACS with "liveexport" enabled in the settings and start
+    relacsshmclient [segment [trace]]
+  It prints for every update of RELACS the number of new data elements,
+  their mean and standard deviation, and the number of new events
+  of each event trace.
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <relacs/relacsshm.h>
+
+
+int main( int argc, char *argv[] )
+{
+  const char *name = argc > 1 ? argv[1] : "/relacs";
+  relacs_shm *shm = relacs_shm_open( name );
+  if ( shm == NULL ) {
+    perror( "relacsshmclient: cannot open shared memory segment" );
+    return 1;
+  }
+
+  int trace = 0;
+  if ( argc > 2 ) {
+    trace = relacs_shm_find_trace( shm, argv[2] );
+    if ( trace < 0 ) {
+      fprintf( stderr, "relacsshmclient: trace %s not found\n", argv[2] );
+      relacs_shm_close( shm );
+      return 1;
+    }
+  }
+
+  for ( int k=0; k<relacs_shm_traces( shm ); k++ ) {
+    const relacs_shm_trace *tr = relacs_shm_trace_info( shm, k );
+    printf( "trace %-20s %8.3fkHz %-6s buffer %llu\n", tr->ident,
+	    0.001/tr->sampleinterval, tr->unit, (unsigned long long)tr->capacity );
+  }
+  int nevents = relacs_shm_events_size( shm );
+  for ( int k=0; k<nevents; k++ ) {
+    const relacs_shm_events *ev = relacs_shm_events_info( shm, k );
+    printf( "events %-19s %s buffer %llu\n", ev->ident,
+	    ev->sizeoffset > 0 ? "with sizes" : "          ",
+	    (unsigned long long)ev->capacity );
+  }
+  if ( relacs_shm_traces( shm ) == 0 ) {
+    relacs_shm_close( shm );
+    return 0;
+  }
+
+  uint64_t index = relacs_shm_trace_index( shm, trace );
+  uint64_t *eventindex = (uint64_t *)malloc( (nevents+1)*sizeof( uint64_t ) );
+  for ( int k=0; k<nevents; k++ )
+    eventindex[k] = relacs_shm_events_index( shm, k );
+  uint64_t updates = relacs_shm_updates( shm );
+  for ( ; ; ) {
+    int r = relacs_shm_wait( shm, updates, 5.0 );
+    if ( r < 0 ) {
+      printf( "RELACS stopped exporting data\n" );
+      break;
+    }
+    if ( r == 0 )
+      continue;
+    updates = relacs_shm_updates( shm );
+
+    /* process the new data directly in the shared memory: */
+    double sum = 0.0;
+    double sumsq = 0.0;
+    long n = 0;
+    uint64_t end = relacs_shm_trace_index( shm, trace );
+    while ( index < end ) {
+      long m = 0;
+      const float *data = relacs_shm_trace_buffer( shm, trace, index, &m );
+      if ( data == NULL )
+	break;
+      for ( long i=0; i<m; i++ ) {
+	sum += data[i];
+	sumsq += data[i]*data[i];
+      }
+      if ( ! relacs_shm_trace_valid( shm, trace, index ) )
+	break;
+      index += m;
+      n += m;
+    }
+    if ( index < end ) {
+      printf( "too slow, data have been overwritten\n" );
+      index = relacs_shm_trace_index( shm, trace );
+      continue;
+    }
+    double mean = n > 0 ? sum/n : 0.0;
+    double stdev = n > 1 ? sqrt( ( sumsq - n*mean*mean )/( n-1 ) ) : 0.0;
+    printf( "%10.3fs: %6ld data mean=%9.4g std=%9.4g",
+	    relacs_shm_info( shm )->time, n, mean, stdev );
+
+    /* count new events: */
+    for ( int k=0; k<nevents; k++ ) {
+      uint64_t eend = relacs_shm_events_index( shm, k );
+      printf( "  %s=%llu", relacs_shm_events_info( shm, k )->ident,
+	      (unsigned long long)( eend - eventindex[k] ) );
+      eventindex[k] = eend;
+    }
+    printf( "\n" );
+  }
+
+  free( eventindex );
+  relacs_shm_close( shm );
+  return 0;
+}
@@ -0,0 +1,124 @@
+/*
+  batchfit.cc
+  
+
+  RELACS - Relaxed ELectrophysiological data Acquisition, Control, and Stimulation
+  Copyright (C) 2002-2015 Jan Benda <jan.benda@uni-tuebingen.de>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+  
+  RELACS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <chrono>
+#include <iostream>
+#include <relacs/array.h>
+#include <relacs/fitalgorithm.h>
+#include <relacs/random.h>
+using namespace std;
+using namespace relacs;
+
+
+int main( int argc, char *argv[] )
+{
+  int nfits = 2000;
+  int n = 500;
+  if ( argc > 1 )
+    nfits = atoi( argv[1] );
+
+  // generate data sets of exponentials with different time constants:
+  double sig = 0.1;
+  vector< ArrayD > x( nfits, ArrayD( n ) );
+  vector< ArrayD > y( nfits, ArrayD( n ) );
+  vector< ArrayD > s( nfits, ArrayD( n, sig ) );
+  ArrayD c( 3 );
+  for ( int k=0; k<nfits; k++ ) {
+    c[0] = 2.0;
+    c[1] = -0.01*(1.0+rnd());
+    c[2] = -1.0;
+    for ( int i=0; i<n; i++ ) {
+      x[k][i] = 0.0001*i;
+      y[k][i] = expFunc( x[k][i], c ) + sig*rnd.gaussian();
+    }
+  }
+  ArrayD p0( 3 );
+  p0[0] = 1.0;
+  p0[1] = -0.02;
+  p0[2] = 0.0;
+  ArrayI pi( 3, 1 );
+
+  // one by one:
+  vector< ArrayD > ps( nfits, p0 );
+  ArrayD u( 3 );
+  double ch = 0.0;
+  auto t0 = chrono::steady_clock::now();
+  for ( int k=0; k<nfits; k++ )
+    marquardtFit( x[k], y[k], s[k], expFuncDerivs, ps[k], pi, u, ch );
+  auto t1 = chrono::steady_clock::now();
+  double tserial = chrono::duration< double >( t1 - t0 ).count();
+
+  // vectorized on a single thread:
+  vector< ArrayD > pv( nfits, p0 );
+  vector< ArrayD > uv;
+  vector< MarquardtStats > stats;
+  t0 = chrono::steady_clock::now();
+  marquardtFitBatch( x, y, s, expFuncJacobian, pv, pi, uv, stats, 1 );
+  t1 = chrono::steady_clock::now();
+  double tvector = chrono::duration< double >( t1 - t0 ).count();
+
+  // vectorized and on all threads:
+  vector< ArrayD > pb( nfits, p0 );
+  vector< ArrayD > ub;
+  t0 = chrono::steady_clock::now();
+  int failed = marquardtFitBatch( x, y, s, expFuncJacobian, pb, pi, ub, stats );
+  t1 = chrono::steady_clock::now();
+  double tbatch = chrono::duration< double >( t1 - t0 ).count();
+
+  // point-by-point fit function on all threads:
+  vector< ArrayD > pp( nfits, p0 );
+  vector< ArrayD > up;
+  vector< MarquardtStats > pstats;
+  PointwiseFitFunc< double( double, const ArrayD &, ArrayD & ) > pf( expFuncDerivs );
+  t0 = chrono::steady_clock::now();
+  marquardtFitBatch( x, y, s, pf, pp, pi, up, pstats );
+  t1 = chrono::steady_clock::now();
+  double tpoint = chrono::duration< double >( t1 - t0 ).count();
+
+  double maxdiff = 0.0;
+  ArrayD iters( nfits );
+  ArrayD rms( nfits );
+  for ( int k=0; k<nfits; k++ ) {
+    for ( int j=0; j<3; j++ ) {
+      double d = ::fabs( ps[k][j] - pb[k][j] );
+      if ( d > maxdiff )
+	maxdiff = d;
+      d = ::fabs( ps[k][j] - pp[k][j] );
+      if ( d > maxdiff )
+	maxdiff = d;
+    }
+    iters[k] = stats[k].Iterations;
+    rms[k] = stats[k].ResidualRMS;
+  }
+
+  cout << nfits << " fits of " << n << " data points each\n";
+  cout << "one by one:        " << tserial << "s\n";
+  cout << "vectorized:        " << tvector << "s\n";
+  cout << "vectorized batch:  " << tbatch << "s on "
+       << thread::hardware_concurrency() << " cores\n";
+  cout << "pointwise batch:   " << tpoint << "s\n";
+  cout << "failed fits:       " << failed << '\n';
+  cout << "iterations:        " << iters.mean() << " +/- " << iters.stdev() << '\n';
+  cout << "residual rms:      " << rms.mean() << " (sigma=" << sig << ")\n";
+  cout << "max param diff:    " << maxdiff << '\n';
+
+  return 0;
+}
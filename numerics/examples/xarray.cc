@@ -20,6 +20,7 @@
 */
 
 #include <cmath>
+#include <chrono>
 #include <iostream>
 #include <vector>
 #include <relacs/array.h>
@@ -27,8 +28,58 @@ using namespace std;
 using namespace relacs;
 
 
+  // Compare computing a = b*c + d and a = 2*(b - c)/d + 1
+  // by means of the container operators with a plain loop:
+void benchmark( int n, int repeats )
+{
+  ArrayD a( n, 0.0 );
+  ArrayD b( n ), c( n ), d( n );
+  for ( int k=0; k<n; k++ ) {
+    b[k] = 0.001*k;
+    c[k] = ::sin( 0.01*k );
+    d[k] = 2.0 + ::cos( 0.01*k );
+  }
+
+  auto t0 = chrono::steady_clock::now();
+  for ( int r=0; r<repeats; r++ )
+    a = b*c + d;
+  auto t1 = chrono::steady_clock::now();
+  for ( int r=0; r<repeats; r++ ) {
+    for ( int k=0; k<n; k++ )
+      a[k] = b[k]*c[k] + d[k];
+  }
+  auto t2 = chrono::steady_clock::now();
+  for ( int r=0; r<repeats; r++ )
+    a = 2.0*(b - c)/d + 1.0;
+  auto t3 = chrono::steady_clock::now();
+  ArrayD e( a );
+  for ( int r=0; r<repeats; r++ ) {
+    for ( int k=0; k<n; k++ )
+      a[k] = 2.0*(b[k] - c[k])/d[k] + 1.0;
+  }
+  auto t4 = chrono::steady_clock::now();
+  e -= a;
+
+  double f = 1.0e3/repeats;
+  cout << "n=" << n << '\n';
+  cout << "  a = b*c + d:          operators "
+       << f*chrono::duration< double >( t1 - t0 ).count() << "ms, loop "
+       << f*chrono::duration< double >( t2 - t1 ).count() << "ms\n";
+  cout << "  a = 2*(b - c)/d + 1:  operators "
+       << f*chrono::duration< double >( t3 - t2 ).count() << "ms, loop "
+       << f*chrono::duration< double >( t4 - t3 ).count() << "ms, max difference "
+       << max( e.max(), -e.min() ) << '\n';
+}
+
+
 int main( int argc, char **argv )
 {
+  if ( argc > 1 && string( argv[1] ) == "-b" ) {
+    benchmark( 1000, 10000 );
+    benchmark( 1000000, 20 );
+    return 0;
+  }
+
   ArrayD a( 4 );
   ArrayF b( 4 );
   vector< double > c( 4 );
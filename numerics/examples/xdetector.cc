@@ -20,8 +20,10 @@
 */
 
 #include <cmath>
+#include <chrono>
 #include <iostream>
 #include <relacs/array.h>
+#include <relacs/random.h>
 #include <relacs/sampledata.h>
 #include <relacs/eventdata.h>
 #include <relacs/detector.h>
@@ -98,6 +100,94 @@ public:
 };
 
 
+  // Iterator over a float array that hides the contiguous memory
+  // from the Detector, so that the data are traversed element by element:
+class ElementIterator
+{
+
+public:
+
+  ElementIterator( void ) : P( 0 ) {};
+  ElementIterator( const float *p ) : P( p ) {};
+  bool operator==( const ElementIterator &p ) const { return P == p.P; };
+  bool operator!=( const ElementIterator &p ) const { return P != p.P; };
+  bool operator<( const ElementIterator &p ) const { return P < p.P; };
+  bool operator>( const ElementIterator &p ) const { return P > p.P; };
+  bool operator<=( const ElementIterator &p ) const { return P <= p.P; };
+  bool operator>=( const ElementIterator &p ) const { return P >= p.P; };
+  const ElementIterator &operator++( void ) { ++P; return *this; };
+  const ElementIterator &operator+=( int n ) { P += n; return *this; };
+  ElementIterator operator+( int n ) const { return ElementIterator( P+n ); };
+  int operator-( const ElementIterator &p ) const { return P - p.P; };
+  double operator*( void ) const { return *P; };
+
+private:
+
+  const float *P;
+
+};
+
+
+template < typename DataIter, typename TimeIter >
+class AcceptPeakTrough
+{
+
+public:
+
+  int checkPeak( DataIter first, DataIter last,
+		 DataIter event, TimeIter eventtime,
+		 DataIter index, TimeIter indextime,
+		 DataIter prevevent, TimeIter prevtime,
+		 EventList &outevents,
+		 double &threshold,
+		 double &minthresh, double &maxthresh,
+		 double &time, double &size, double &width )
+  {
+    time = *eventtime;
+    size = *event;
+    width = 0.0;
+    return 1; 
+  }
+
+  int checkTrough( DataIter first, DataIter last,
+		   DataIter event, TimeIter eventtime,
+		   DataIter index, TimeIter indextime,
+		   DataIter prevevent, TimeIter prevtime,
+		   EventList &outevents,
+		   double &threshold,
+		   double &minthresh, double &maxthresh,
+		   double &time, double &size, double &width )
+  {
+    time = *eventtime;
+    size = *event;
+    width = 0.0;
+    return 1; 
+  }
+
+};
+
+
+  // Detect peaks and troughs in \a signal in chunks of \a chunk data elements
+  // and return the computation time in seconds:
+template < typename DataIter >
+double benchmarkPeakTrough( DataIter first, DataIter last,
+			    const SampleDataF &signal, int chunk,
+			    double threshold, EventList &events )
+{
+  typedef SampleDataF::const_range_iterator TimeIter;
+  Detector< DataIter, TimeIter > D;
+  AcceptPeakTrough< DataIter, TimeIter > check;
+  D.init( first, first, signal.range().begin() );
+  auto t0 = chrono::steady_clock::now();
+  for ( DataIter end = first; end < last; ) {
+    end = end + chunk < last ? end + chunk : last;
+    D.peakTrough( first, end, events, threshold, threshold, threshold, check );
+  }
+  auto t1 = chrono::steady_clock::now();
+  return chrono::duration< double >( t1 - t0 ).count();
+}
+
+
 int main( int argc, char **argv )
 {
   double threshold = 0.5;
@@ -145,4 +235,39 @@ int main( int argc, char **argv )
 	   threshold, threshold, threshold, checked );
   cout << "EventData: detected " << outevents.size() << " events.\n";
 
+  // Benchmark peakTrough() on sparse spikes in noise:
+  SampleDataF spikes( 0.0, 200.0, 0.00005 );
+  for ( int k=0; k<spikes.size(); k++ )
+    spikes[k] = 0.1*rnd.gaussian();
+  for ( double t=0.01; t<spikes.length(); t += 0.05 + 0.05*rnd() ) {
+    int inx = spikes.index( t );
+    for ( int k=0; k<20 && inx+k < spikes.size(); k++ )
+      spikes[inx+k] += 2.0*::sin( M_PI*k/10.0 );
+  }
+  int chunk = spikes.indices( 0.01 );
+  EventList slowevents( 2, spikes.size()/100 );
+  double tslow = benchmarkPeakTrough( ElementIterator( spikes.data() ),
+				      ElementIterator( spikes.data() + spikes.size() ),
+				      spikes, chunk, 1.0, slowevents );
+  EventList fastevents( 2, spikes.size()/100 );
+  double tfast = benchmarkPeakTrough( spikes.begin(), spikes.end(),
+				      spikes, chunk, 1.0, fastevents );
+  bool identical = ( slowevents[0].size() == fastevents[0].size() &&
+		     slowevents[1].size() == fastevents[1].size() );
+  for ( int j=0; j<2 && identical; j++ ) {
+    for ( int k=0; k<slowevents[j].size(); k++ ) {
+      if ( slowevents[j][k] != fastevents[j][k] ||
+	   slowevents[j].eventSize( k ) != fastevents[j].eventSize( k ) ) {
+	identical = false;
+	break;
+      }
+    }
+  }
+  cout << "peakTrough() on " << spikes.size() << " data elements: "
+       << fastevents[0].size() << " peaks, "
+       << fastevents[1].size() << " troughs\n";
+  cout << "  element by element: " << 1000.0*tslow << "ms\n";
+  cout << "  contiguous buffer:  " << 1000.0*tfast << "ms\n";
+  cout << "  identical events:   " << ( identical ? "yes" : "no" ) << '\n';
+
 }
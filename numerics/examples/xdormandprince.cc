@@ -0,0 +1,102 @@
+/*
+  xdormandprince.cc
+
+
+  RELACS - Relaxed ELectrophysiological data Acquisition, Control, and Stimulation
+  Copyright (C) 2002-2015 Jan Benda <jan.benda@uni-tuebingen.de>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+
+  RELACS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cmath>
+#include <iostream>
+#include <relacs/odealgorithm.h>
+#include <relacs/random.h>
+using namespace std;
+using namespace relacs;
+
+
+  // leaky integrator driven by white noise that is held constant
+  // within each sample interval, as in the neuron models:
+class NoisyLeak
+{
+public:
+  NoisyLeak( double tau, double noisefac )
+    : Tau( tau ), NoiseFac( noisefac ), Noise( 0.0 ) {};
+
+  void operator()( double x, double *y, double *dydx, int n ) const
+  {
+    dydx[0] = ( -y[0] + NoiseFac*Noise )/Tau;
+  };
+
+  double Tau;
+  double NoiseFac;
+  double Noise;
+};
+
+
+  // variance of the noise input reconstructed from the state
+  // integrated with Dormand-Prince, with or without refreshing
+  // the first stage after each new noise value:
+double dpInputVariance( NoisyLeak &nl, double deltat, int n, bool refresh )
+{
+  RandomXoshiro rand( 1 );
+  DormandPrince dp( 1.0e-4, 1.0e-4 );
+  double a = ::exp( -deltat/nl.Tau );
+  double y = 0.0;
+  dp.init( 0.0, &y, 1, deltat, nl );
+  double sumsq = 0.0;
+  for ( int k=0; k<n; k++ ) {
+    nl.Noise = rand.gaussian();
+    if ( refresh )
+      dp.refresh( nl );
+    double yp = y;
+    dp.integrate( (k+1)*deltat, &y, nl );
+    double s = ( y - a*yp )/( 1.0 - a );
+    sumsq += s*s;
+  }
+  return sumsq/n;
+}
+
+
+int main( void )
+{
+  double tau = 1.0;
+  double deltat = 0.05;
+  double noised = 1.0;
+  int n = 1000000;
+  NoisyLeak nl( tau, ::sqrt( 2.0*noised/deltat ) );
+
+  // noise input reconstructed from a fixed-step Euler integration:
+  RandomXoshiro rand( 1 );
+  double a = ::exp( -deltat/tau );
+  double y = 0.0;
+  double dydx = 0.0;
+  double sumsq = 0.0;
+  for ( int k=0; k<n; k++ ) {
+    nl.Noise = rand.gaussian();
+    double yp = y;
+    eulerStep( k*deltat, &y, &dydx, 1, deltat, nl );
+    double s = ( y - a*yp )/( 1.0 - a );
+    sumsq += s*s;
+  }
+
+  cout << "variance of the noise input:\n";
+  cout << "requested:                   " << nl.NoiseFac*nl.NoiseFac << '\n';
+  cout << "fixed-step Euler:            " << sumsq/n << '\n';
+  cout << "Dormand-Prince:              " << dpInputVariance( nl, deltat, n, true ) << '\n';
+  cout << "Dormand-Prince, stale stage: " << dpInputVariance( nl, deltat, n, false ) << '\n';
+
+  return 0;
+}
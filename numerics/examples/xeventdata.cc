@@ -20,12 +20,191 @@
 */
 
 #include <iostream>
+#include <ctime>
+#include <algorithm>
 #include <relacs/eventdata.h>
 using namespace std;
 using namespace relacs;
 
 
-int main( void )
+  // reference: plain bisection over all accessible events
+int bisectNext( const EventData &events, double time )
+{
+  int l = events.minEvent();
+  int r = events.size();
+  while ( r > l ) {
+    int h = (l+r)/2;
+    if ( events[h] < time )
+      l = h+1;
+    else
+      r = h;
+  }
+  return l;
+}
+
+
+void benchmarkSearch( int n )
+{
+  // cyclic buffer with n spikes of a 100Hz Poisson spike train,
+  // filled more than twice:
+  EventData spikes( n );
+  spikes.setCyclic( true );
+  double t = 0.0;
+  for ( int k=0; k<5*n/2; k++ ) {
+    t += 0.001 + rnd.exponential()*0.009;
+    spikes.push( t );
+  }
+  double tmin = spikes.minTime();
+  double tmax = spikes.back();
+  cout << "events " << spikes.minEvent() << " - " << spikes.size()
+       << " between " << tmin << "s and " << tmax << "s\n";
+
+  // random query times:
+  int m = 1000000;
+  ArrayD times( m );
+  for ( int k=0; k<m; k++ )
+    times[k] = tmin - 1.0 + ( tmax - tmin + 2.0 )*rnd();
+
+  // check next() and previous():
+  int errors = 0;
+  for ( int k=0; k<m; k++ ) {
+    int i = bisectNext( spikes, times[k] );
+    if ( spikes.next( times[k] ) != i )
+      errors++;
+    int p = i-1 < spikes.minEvent() ? -1 : i-1;
+    if ( i < spikes.size() && spikes[i] == times[k] )
+      p = i;
+    if ( spikes.previous( times[k] ) != p )
+      errors++;
+  }
+  cout << "errors in next() and previous(): " << errors << '\n';
+
+  // timing of single queries:
+  clock_t c0 = clock();
+  long sum = 0;
+  for ( int k=0; k<m; k++ )
+    sum += bisectNext( spikes, times[k] );
+  clock_t c1 = clock();
+  for ( int k=0; k<m; k++ )
+    sum -= spikes.next( times[k] );
+  clock_t c2 = clock();
+  cout << "bisection: " << 1.0e9*double( c1 - c0 )/CLOCKS_PER_SEC/m << "ns, "
+       << "next(): " << 1.0e9*double( c2 - c1 )/CLOCKS_PER_SEC/m << "ns per query"
+       << ( sum != 0 ? " FAILED" : "" ) << '\n';
+
+  // windows of 10000 successive trials of 1s duration each:
+  int trials = 10000;
+  ArrayD tbegin( trials );
+  ArrayD tend( trials );
+  for ( int k=0; k<trials; k++ ) {
+    tbegin[k] = tmin + k*( tmax - tmin - 1.0 )/trials;
+    tend[k] = tbegin[k] + 1.0;
+  }
+  int reps = 100;
+  ArrayI counts;
+  c0 = clock();
+  for ( int r=0; r<reps; r++ ) {
+    counts.resize( trials );
+    for ( int k=0; k<trials; k++ )
+      counts[k] = spikes.count( tbegin[k], tend[k] );
+  }
+  c1 = clock();
+  ArrayI bcounts;
+  for ( int r=0; r<reps; r++ )
+    spikes.count( tbegin, tend, bcounts );
+  c2 = clock();
+  errors = 0;
+  for ( int k=0; k<trials; k++ ) {
+    if ( counts[k] != bcounts[k] )
+      errors++;
+  }
+  cout << "count() for " << trials << " trials: "
+       << 1.0e3*double( c1 - c0 )/CLOCKS_PER_SEC/reps << "ms single, "
+       << 1.0e3*double( c2 - c1 )/CLOCKS_PER_SEC/reps << "ms batched, "
+       << errors << " errors\n";
+}
+
+
+  // compare batched next(), previous() and count() with the single calls:
+int compareBatched( const EventData &events, int m )
+{
+  double tmin = events.minTime() - 1.0;
+  double tmax = events.size() > 0 ? events.back() + 1.0 : 1.0;
+  ArrayD times( m );
+  for ( int k=0; k<m; k++ )
+    times[k] = tmin + ( tmax - tmin )*rnd();
+  sort( times.begin(), times.end() );
+  // include the event times themselves:
+  for ( int k=events.minEvent(); k<events.size() && k-events.minEvent()<m; k++ )
+    times[k-events.minEvent()] = events[k];
+  sort( times.begin(), times.end() );
+  ArrayD tend( times );
+  tend += 0.5*( tmax - tmin )/events.capacity();
+  ArrayI nexts;
+  events.next( times, nexts );
+  ArrayI prevs;
+  events.previous( times, prevs );
+  ArrayI counts;
+  events.count( times, tend, counts );
+  int errors = 0;
+  for ( int k=0; k<m; k++ ) {
+    if ( nexts[k] != events.next( times[k] ) )
+      errors++;
+    if ( prevs[k] != events.previous( times[k] ) )
+      errors++;
+    if ( counts[k] != events.count( times[k], tend[k] ) )
+      errors++;
+  }
+  return errors;
+}
+
+
+void testBatched( void )
+{
+  // full non-cyclic buffer:
+  EventData full( 4 );
+  full.setCyclic( false );
+  for ( int k=1; k<=4; k++ )
+    full.push( k );
+  // the first query is a single call, the second one is batched:
+  ArrayD times( 2, 0.5 );
+  times[1] = 5.0;
+  ArrayI indices;
+  full.next( times, indices );
+  cout << "full buffer: next(5)=" << indices[1] << " (" << full.next( 5.0 ) << ")";
+  full.previous( times, indices );
+  cout << ", previous(5)=" << indices[1] << " (" << full.previous( 5.0 ) << ")";
+  ArrayD tbegin( 2, 0.5 );
+  tbegin[1] = 3.5;
+  ArrayD tend( 2, 1.0 );
+  tend[1] = 10.0;
+  full.count( tbegin, tend, indices );
+  cout << ", count(3.5,10)=" << indices[1] << " (" << full.count( 3.5, 10.0 ) << ")\n";
+
+  // random buffers at and around the wrap-around of the cyclic buffer:
+  int errors = 0;
+  for ( int n=1; n<=50; n++ ) {
+    EventData events( n );
+    events.setCyclic( false );
+    EventData cyclic( n );
+    cyclic.setCyclic( true );
+    double t = 0.0;
+    for ( int k=0; k<3*n+2; k++ ) {
+      t += 0.001 + rnd.exponential()*0.009;
+      if ( k < n ) {
+        events.push( t );
+        errors += compareBatched( events, 100 );
+      }
+      cyclic.push( t );
+      errors += compareBatched( cyclic, 100 );
+    }
+  }
+  cout << "errors of batched versus single next(), previous(), and count(): "
+       << errors << '\n';
+}
+
+
+void testCapacity( void )
 {
   EventData spikes;
   cout << "size=" << spikes.size() << '\n';
@@ -48,6 +227,16 @@ int main( void )
       break;
     }
   }
+}
+
 
+int main( void )
+{
+  testCapacity();
+  testBatched();
+  // buffer fitting into the cache:
+  benchmarkSearch( 20000 );
+  // large buffer:
+  benchmarkSearch( 1000000 );
   return 0;
 }
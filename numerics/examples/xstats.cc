@@ -1,6 +1,7 @@
 /*
   xstats.cc
-  check whether the functions provided in stats.h compie with various types.
+  check whether the functions provided in stats.h compile with various types
+  and benchmark the specializations for doubles and floats.
 
   RELACS - Relaxed ELectrophysiological data Acquisition, Control, and Stimulation
   Copyright (C) 2002-2015 Jan Benda <jan.benda@uni-tuebingen.de>
@@ -19,7 +20,9 @@
   along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <chrono>
 #include <cstdio>
+#include <cmath>
 #include <vector>
 #include <relacs/stats.h>
 #include <relacs/array.h>
@@ -87,6 +90,91 @@ void testfunc( T &x, T &y )
   v = ::relacs::rank( x );
 }
 
+  /* Runs func repeatedly for about 0.2s and returns the time
+     in nanoseconds per element of a range of size n. */
+template < typename Func >
+double timeit( Func func, int n )
+{
+  chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+  double dt = 0.0;
+  int r = 0;
+  do {
+    func();
+    r++;
+    dt = chrono::duration< double >( chrono::steady_clock::now() - t0 ).count();
+  } while ( dt < 0.2 );
+  return 1.0e9 * dt / r / n;
+}
+
+
+  /* Compares the generic algorithms running on std::vector iterators
+     with the specializations for contiguous ranges. */
+template < typename T >
+void benchmark( const char *type, int n )
+{
+  Array< T > x( n ), y( n );
+  for ( int k=0; k<n; k++ ) {
+    x[k] = 1000.0 + ::sin( 0.01*k ) + 0.1*rnd();
+    y[k] = 0.5*x[k] + 0.1*rnd();
+  }
+  const vector< T > vx( x.begin(), x.end() );
+  const vector< T > vy( y.begin(), y.end() );
+  const Array< T > &cx = x;
+  const Array< T > &cy = y;
+  volatile double sink = 0.0;
+  double g, s;
+  T a, b, c, d;
+
+  printf( "%-6s n=%-8d %12s %12s %8s %12s\n", type, n,
+	  "generic/ns", "simd/ns", "speedup", "rel. diff" );
+
+  g = timeit( [&]{ sink = mean( vx ); }, n );
+  s = timeit( [&]{ sink = mean( cx ); }, n );
+  printf( "  %-23s %12.3f %12.3f %8.2f %12.2g\n", "mean", g, s, g/s,
+	  ::fabs( mean( vx ) - mean( cx ) )/::fabs( mean( cx ) ) );
+
+  g = timeit( [&]{ sink = variance( vx ); }, n );
+  s = timeit( [&]{ sink = variance( cx ); }, n );
+  printf( "  %-23s %12.3f %12.3f %8.2f %12.2g\n", "variance", g, s, g/s,
+	  ::fabs( variance( vx ) - variance( cx ) )/variance( cx ) );
+
+  g = timeit( [&]{ sink = stdev( vx ); }, n );
+  s = timeit( [&]{ sink = stdev( cx ); }, n );
+  printf( "  %-23s %12.3f %12.3f %8.2f %12.2g\n", "stdev", g, s, g/s,
+	  ::fabs( stdev( vx ) - stdev( cx ) )/stdev( cx ) );
+
+  g = timeit( [&]{ sink = meanStdev( a, vx ); }, n );
+  s = timeit( [&]{ sink = meanStdev( b, cx ); }, n );
+  printf( "  %-23s %12.3f %12.3f %8.2f %12.2g\n", "meanStdev", g, s, g/s,
+	  ::fabs( a - b )/b );
+
+  g = timeit( [&]{ minMax( a, b, vx ); sink = a + b; }, n );
+  s = timeit( [&]{ minMax( c, d, cx ); sink = c + d; }, n );
+  printf( "  %-23s %12.3f %12.3f %8.2f %12.2g\n", "minMax", g, s, g/s,
+	  ::fabs( a - c ) + ::fabs( b - d ) );
+
+  g = timeit( [&]{ sink = max( vx ); }, n );
+  s = timeit( [&]{ sink = max( cx ); }, n );
+  printf( "  %-23s %12.3f %12.3f %8.2f %12.2g\n", "max", g, s, g/s,
+	  ::fabs( max( vx ) - max( cx ) ) );
+
+  g = timeit( [&]{ sink = rms( vx ); }, n );
+  s = timeit( [&]{ sink = rms( cx ); }, n );
+  printf( "  %-23s %12.3f %12.3f %8.2f %12.2g\n", "rms", g, s, g/s,
+	  ::fabs( rms( vx ) - rms( cx ) )/rms( cx ) );
+
+  g = timeit( [&]{ sink = cov( vx, vy ); }, n );
+  s = timeit( [&]{ sink = cov( cx, cy ); }, n );
+  printf( "  %-23s %12.3f %12.3f %8.2f %12.2g\n", "cov", g, s, g/s,
+	  ::fabs( cov( vx, vy ) - cov( cx, cy ) )/::fabs( cov( cx, cy ) ) );
+
+  g = timeit( [&]{ sink = corrCoef( vx, vy ); }, n );
+  s = timeit( [&]{ sink = corrCoef( cx, cy ); }, n );
+  printf( "  %-23s %12.3f %12.3f %8.2f %12.2g\n", "corrCoef", g, s, g/s,
+	  ::fabs( corrCoef( vx, vy ) - corrCoef( cx, cy ) ) );
+}
+
+
 int main( int argc, char **argv )
 {
   ArrayD a, b;
@@ -115,5 +203,10 @@ int main( int argc, char **argv )
   }
   testfunc( g, h );
 
+  benchmark< double >( "double", 1000 );
+  benchmark< double >( "double", 1000000 );
+  benchmark< float >( "float", 1000 );
+  benchmark< float >( "float", 1000000 );
+
   return 0;
 }
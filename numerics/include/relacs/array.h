@@ -39,6 +39,7 @@
 #include <relacs/stats.h>
 #include <relacs/linearrange.h>
 #include <relacs/random.h>
+#include <relacs/overlapsave.h>
 
 using namespace std;
 
@@ -47,6 +48,8 @@ namespace relacs {
   template < typename T > class Array;
   template < typename T, typename S >
     Array<T> convolve( const Array<T> &x, const S &y, int offs=0 );
+  template < typename T, typename S >
+    Array<T> fftConvolve( const Array<T> &x, const S &y, int offs=0 );
 
 /*! 
 \class Array
@@ -118,6 +121,9 @@ class Array
         Creates an array with the same size and content
         as the array \a a. */
   Array( const Array< T > &a );
+    /*! Move constructor.
+        Takes over the data buffer of \a a and leaves \a a empty. */
+  Array( Array< T > &&a );
     /*! Creates an array from \a range. */
   Array( const LinearRange &range );
     /*! The destructor. */
@@ -130,6 +136,8 @@ class Array
   const Array<T> &operator=( const LinearRange &range );
     /*! Set the size(), capacity(), and content of the array to \a a. */
   const Array<T> &operator=( const Array<T> &a );
+    /*! Take over the data buffer of \a a and leave \a a empty. */
+  const Array<T> &operator=( Array<T> &&a );
 
     /*! Set the size() and capacity() of the array to \a n
         and its content to \a a. */
@@ -686,9 +694,16 @@ class Array
 
      /*! Return the convolution of \a x with the container \a y.
          \a y can be shifted by \a offs indices.
-         If possible, y.size() should be smaller than x.size(). */
+         If possible, y.size() should be smaller than x.size().
+         For long \a y the convolution is computed by fftConvolve(),
+         otherwise directly. */
   template < typename TT, typename SS >
   friend Array<TT> convolve( const Array<TT> &x, const SS &y, int offs );
+     /*! Return the convolution of \a x with the container \a y,
+         computed block-wise by FFTs (overlap-save, see OverlapSave).
+         \a y can be shifted by \a offs indices. */
+  template < typename TT, typename SS >
+  friend Array<TT> fftConvolve( const Array<TT> &x, const SS &y, int offs );
 
     /*! Replace each element of the sorted array between
         indices \a first (inclusively) and \a last (exclusively)
@@ -905,6 +920,20 @@ Array<T>::Array( const Array< T > &a )
 }
 
 
+template < typename T >
+Array<T>::Array( Array< T > &&a )
+  : Buffer( a.Buffer ),
+    NBuffer( a.NBuffer ),
+    NSize( a.NSize ),
+    MaxBuffer( a.MaxBuffer ),
+    Dummy( 0 )
+{
+  a.Buffer = 0;
+  a.NBuffer = 0;
+  a.NSize = 0;
+}
+
+
 template < typename T > 
 Array<T>::Array( const LinearRange &range )
   : Buffer( 0 ),
@@ -939,6 +968,24 @@ const Array<T> &Array<T>::operator=( const Array<T> &a )
 }
 
 
+template < typename T >
+const Array<T> &Array<T>::operator=( Array<T> &&a )
+{
+  if ( &a == this )
+    return *this;
+
+  if ( Buffer != 0 )
+    delete [] Buffer;
+  Buffer = a.Buffer;
+  NBuffer = a.NBuffer;
+  NSize = a.NSize;
+  a.Buffer = 0;
+  a.NBuffer = 0;
+  a.NSize = 0;
+  return *this;
+}
+
+
 template < typename T >
 const Array<T> &Array<T>::operator=( const LinearRange &range )
 {
@@ -1137,8 +1184,7 @@ template < typename T > template < typename R >
 Array<T> &Array<T>::rand( int n, R &r )
 {
   resize( n );
-  for ( iterator p = begin(); p != end(); ++p )
-    *p = r.uniform();
+  r.fill( data(), size() );
   return *this;
 }
 
@@ -1147,8 +1193,7 @@ template < typename T > template < typename R >
 Array<T> &Array<T>::randNorm( int n, R &r )
 {
   resize( n );
-  for ( iterator p = begin(); p != end(); ++p )
-    *p = r.gaussian();
+  r.fillGaussian( data(), size() );
   return *this;
 }
 
@@ -2290,34 +2335,62 @@ typename numerical_traits< T >::variance_type
 template < typename T, typename S >
 Array<T> convolve( const Array<T> &x, const S &y, int offs )
 {
-  Array<T> z(x);
-  typename Array<T>::iterator iter3 = z.begin();
-  typename Array<T>::iterator begin3 = z.begin();
-  typename Array<T>::iterator end3 = z.end();
-  while ( iter3 != end3 ) {
-    (*iter3) = 0.0;
-    typename S::const_iterator iter2 = y.begin();
-    typename S::const_iterator end2 = y.end();
-    typename Array<T>::iterator iter1 = x.begin() + (iter2-begin3) + offs;
-    typename Array<T>::iterator begin1 = x.begin();
-    typename Array<T>::iterator end1 = x.end();
-    int n = iter1 - end1 + 1;
-    if ( n > 0 ) {
-      iter2 += n;
-      iter1 -= n;
-    }
-    while ( iter2 != end2 && iter1 >= begin1 ) {
-      (*iter3) += (*iter1) * (*iter2);
-      --iter1;
-      ++iter2;
+  int nx = x.size();
+  int ny = y.size();
+
+  // the FFT is faster for long filters:
+  if ( ny >= 64 && (double)nx * ny >= 2.0e5 )
+    return fftConvolve( x, y, offs );
+
+  Array<T> z( nx );
+  typename S::const_iterator firsty = y.begin();
+  for ( int j=0; j<nx; j++ ) {
+    // range of y that overlaps with x:
+    int m0 = j + offs - nx + 1;
+    if ( m0 < 0 )
+      m0 = 0;
+    int m1 = j + offs + 1;
+    if ( m1 > ny )
+      m1 = ny;
+    T sum = 0;
+    if ( m0 < m1 ) {
+      typename Array<T>::const_iterator iterx = x.begin() + j + offs - m0;
+      typename S::const_iterator itery = firsty + m0;
+      for ( int m=m0; m<m1; m++ ) {
+	sum += (*iterx) * (*itery);
+	--iterx;
+	++itery;
+      }
     }
-    ++iter3;
-  };
+    z[j] = sum;
+  }
   
   return z;
 }
 
 
+template < typename T, typename S >
+Array<T> fftConvolve( const Array<T> &x, const S &y, int offs )
+{
+  int nx = x.size();
+  Array<T> z( nx, 0 );
+  if ( y.size() <= 0 )
+    return z;
+
+  vector< double > h( y.begin(), y.end() );
+  OverlapSave os( &h[0], h.size(), offs );
+  int j = 0;
+  for ( int k=0; j<nx; k++ ) {
+    int n = os.push( k < nx ? x[k] : 0.0 );
+    for ( int i=0; i<n && j<nx; i++ )
+      z[j++] = os[i];
+  }
+
+  return z;
+}
+
+
+
 template < typename T > 
 double Array<T>::rank( int first, int last )
 {
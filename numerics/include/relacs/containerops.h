@@ -22,6 +22,8 @@
 #ifndef _RELACS_CONTAINEROPS_H_
 #define _RELACS_CONTAINEROPS_H_ 1
 
+#include <utility>
+
 namespace relacs {
 
 
@@ -121,40 +123,49 @@ namespace relacs {
 //////////// binary class friend operators ///////////////////////////////////
 
 
+/* Used by macro CONTAINEROPS2SCALARDEC to generate declarations
+   for binary class friend operators that take the class and a scalar
+   as argument.
+   A temporary container is reused for the result.
+   \a CONTAINERTEMPL is a template definition (like template< class T > ),
+   \a CONTAINERTYPE is the return type and one of the arguments (like Array<T>),
+   \a COP is the operator name (like operator+ ), and
+   \a SCALAR is the type of the scalar argument. */
+#define CONTAINEROPS2SINGLESCALARDEC( CONTAINERTEMPL, CONTAINERTYPE, COP, SCALAR ) \
+  CONTAINERTEMPL friend CONTAINERTYPE COP( SCALAR x, const CONTAINERTYPE &y ); \
+  CONTAINERTEMPL friend CONTAINERTYPE COP( SCALAR x, CONTAINERTYPE &&y ); \
+  CONTAINERTEMPL friend CONTAINERTYPE COP( const CONTAINERTYPE &x, SCALAR y ); \
+  CONTAINERTEMPL friend CONTAINERTYPE COP( CONTAINERTYPE &&x, SCALAR y ); \
+
+
 /* Generates declarations for binary class friend operators
    that take the class and a scalar as argument.
    \a CONTAINERTEMPL is a template definition (like template< class T > ),
    \a CONTAINERTYPE is the return type and one of the arguments (like Array<T>),
    and \a COP is the operator name (like operator+ ). */
 #define CONTAINEROPS2SCALARDEC( CONTAINERTEMPL, CONTAINERTYPE, COP )	\
-  CONTAINERTEMPL friend CONTAINERTYPE COP( float x, const CONTAINERTYPE &y ); \
-  CONTAINERTEMPL friend CONTAINERTYPE COP( const CONTAINERTYPE &x, float y ); \
-  CONTAINERTEMPL friend CONTAINERTYPE COP( double x, const CONTAINERTYPE &y ); \
-  CONTAINERTEMPL friend CONTAINERTYPE COP( const CONTAINERTYPE &x, double y ); \
-  CONTAINERTEMPL friend CONTAINERTYPE COP( long double x, const CONTAINERTYPE &y ); \
-  CONTAINERTEMPL friend CONTAINERTYPE COP( const CONTAINERTYPE &x, long double y ); \
-  CONTAINERTEMPL friend CONTAINERTYPE COP( signed char x, const CONTAINERTYPE &y ); \
-  CONTAINERTEMPL friend CONTAINERTYPE COP( const CONTAINERTYPE &x, signed char y ); \
-  CONTAINERTEMPL friend CONTAINERTYPE COP( unsigned char x, const CONTAINERTYPE &y ); \
-  CONTAINERTEMPL friend CONTAINERTYPE COP( const CONTAINERTYPE &x, unsigned char y ); \
-  CONTAINERTEMPL friend CONTAINERTYPE COP( signed int x, const CONTAINERTYPE &y ); \
-  CONTAINERTEMPL friend CONTAINERTYPE COP( const CONTAINERTYPE &x, signed int y ); \
-  CONTAINERTEMPL friend CONTAINERTYPE COP( unsigned int x, const CONTAINERTYPE &y ); \
-  CONTAINERTEMPL friend CONTAINERTYPE COP( const CONTAINERTYPE &x, unsigned int y ); \
-  CONTAINERTEMPL friend CONTAINERTYPE COP( signed long x, const CONTAINERTYPE &y ); \
-  CONTAINERTEMPL friend CONTAINERTYPE COP( const CONTAINERTYPE &x, signed long y ); \
-  CONTAINERTEMPL friend CONTAINERTYPE COP( unsigned long x, const CONTAINERTYPE &y ); \
-  CONTAINERTEMPL friend CONTAINERTYPE COP( const CONTAINERTYPE &x, unsigned long y ); \
+  CONTAINEROPS2SINGLESCALARDEC( CONTAINERTEMPL, CONTAINERTYPE, COP, float ) \
+    CONTAINEROPS2SINGLESCALARDEC( CONTAINERTEMPL, CONTAINERTYPE, COP, double ) \
+    CONTAINEROPS2SINGLESCALARDEC( CONTAINERTEMPL, CONTAINERTYPE, COP, long double ) \
+    CONTAINEROPS2SINGLESCALARDEC( CONTAINERTEMPL, CONTAINERTYPE, COP, signed char ) \
+    CONTAINEROPS2SINGLESCALARDEC( CONTAINERTEMPL, CONTAINERTYPE, COP, unsigned char ) \
+    CONTAINEROPS2SINGLESCALARDEC( CONTAINERTEMPL, CONTAINERTYPE, COP, signed int ) \
+    CONTAINEROPS2SINGLESCALARDEC( CONTAINERTEMPL, CONTAINERTYPE, COP, unsigned int ) \
+    CONTAINEROPS2SINGLESCALARDEC( CONTAINERTEMPL, CONTAINERTYPE, COP, signed long ) \
+    CONTAINEROPS2SINGLESCALARDEC( CONTAINERTEMPL, CONTAINERTYPE, COP, unsigned long ) \
 
 
 /* Generates declarations for binary class friend operators
    that take other containers as the second argument or a scalar as either argument.
+   If the first argument is a temporary, it is reused for the result.
    \a CONTAINERTEMPL is a template type definition needed for CONTAINERTYPE (like class TT ),
    \a CONTAINERTYPE is the type of first argument and the return type (like Array<TT>) and
    \a COP is the operator name (like operator+ ). */
 #define CONTAINEROPS2DEC( CONTAINERTEMPL, CONTAINERTYPE, COP )		    \
   template < CONTAINERTEMPL, typename COT >				    \
     friend CONTAINERTYPE COP( const CONTAINERTYPE &x,  const COT &y );	    \
+  template < CONTAINERTEMPL, typename COT >				    \
+    friend CONTAINERTYPE COP( CONTAINERTYPE &&x,  const COT &y );	    \
 									    \
   CONTAINEROPS2SCALARDEC( template < CONTAINERTEMPL >, CONTAINERTYPE, COP ) \
 
@@ -162,6 +173,8 @@ namespace relacs {
 /* Used by macro CONTAINEROPS2SCALARDEF to generate
    definitions for binary class friend operators 
    that take the class and a scalar as argument. 
+   A temporary container argument is modified in place
+   and moved into the result.
    \a CONTAINERTEMPL is a template definition (like template< class T > ),
    \a CONTAINERTYPE is the return type (the class),
    \a COPNAME is the operator name (like operator+ ),
@@ -193,6 +206,30 @@ namespace relacs {
     };									\
     return z;								\
   }									\
+									\
+  CONTAINERTEMPL							\
+  CONTAINERTYPE COPNAME( SCALAR x, CONTAINERTYPE &&y )			\
+  {									\
+    typename CONTAINERTYPE::iterator iter1 = y.begin();			\
+    typename CONTAINERTYPE::iterator end1 = y.end();			\
+    while ( iter1 != end1 ) {						\
+      (*iter1) = static_cast< typename CONTAINERTYPE::value_type >( x COP (*iter1) ); \
+      ++iter1;								\
+    };									\
+    return std::move( y );						\
+  }									\
+									\
+  CONTAINERTEMPL							\
+  CONTAINERTYPE COPNAME( CONTAINERTYPE &&x, SCALAR y )			\
+  {									\
+    typename CONTAINERTYPE::iterator iter1 = x.begin();			\
+    typename CONTAINERTYPE::iterator end1 = x.end();			\
+    while ( iter1 != end1 ) {						\
+      (*iter1) = static_cast< typename CONTAINERTYPE::value_type >( (*iter1) COP y ); \
+      ++iter1;								\
+    };									\
+    return std::move( x );						\
+  }									\
 
 
 /* Generates definitions for binary class member operators. 
@@ -215,6 +252,9 @@ namespace relacs {
 
 /* Generates definitions for binary class friend operators
    that take other containers as the second argument or a scalar as either argument.
+   If the first argument is a temporary, the result is computed in place
+   and moved into the return value, so that chained expressions like
+   a*b + c allocate only a single container.
    \a CONTAINERTEMPL is a template type definition needed for CONTAINERTYPE (like class TT ),
    \a CONTAINERTYPE is the type of first argument and the return type (like Array<TT>) and
    \a COPNAME is the operator name (like operator+ ), and
@@ -236,6 +276,21 @@ namespace relacs {
     return z;								\
   }									\
 									\
+  template < CONTAINERTEMPL, typename COT >				\
+    CONTAINERTYPE COPNAME( CONTAINERTYPE &&x, const COT &y )		\
+  {									\
+    typename CONTAINERTYPE::iterator iter1 = x.begin();			\
+    typename CONTAINERTYPE::iterator end1 = x.end();			\
+    typename COT::const_iterator iter2 = y.begin();			\
+    typename COT::const_iterator end2 = y.end();			\
+    while ( iter1 != end1 && iter2 != end2 ) {				\
+      (*iter1) = (*iter1) COP (*iter2);					\
+      ++iter1;								\
+      ++iter2;								\
+    };									\
+    return std::move( x );						\
+  }									\
+									\
   CONTAINEROPS2SCALARDEF( template< CONTAINERTEMPL >, CONTAINERTYPE, COPNAME, COP ) \
 
 
@@ -22,12 +22,74 @@
 #ifndef _RELACS_DETECTOR_H_
 #define _RELACS_DETECTOR_H_ 1
 
+#include <cmath>
 #include <relacs/eventdata.h>
 #include <relacs/eventlist.h>
 
 namespace relacs {
 
 
+/*!
+\class DetectorBuffer
+\author Jan Benda
+\version 1.0
+\brief Access to contiguous memory of the data traversed by a Detector.
+
+Detector::peakTrough() and its variants skip data elements that
+cannot change the state of the detector in blocks of contiguously
+stored data elements instead of dereferencing \a DataIter element by
+element. This class tells the Detector whether and where such
+contiguous memory is available for a given type of \a DataIter.
+
+The default implementation does not provide any buffer,
+so the Detector traverses the data element by element.
+The specialization for plain pointers returns the whole range.
+Iterators of cyclic buffers (see InDataIterator) should return
+the part of the range up to the end of the cyclic buffer.
+*/
+
+template < typename DataIter >
+class DetectorBuffer
+{
+
+public:
+
+    /*! The type of the data elements in the buffer. */
+  typedef double value_type;
+    /*! \c true if buffer() can return contiguous memory. */
+  static const bool Contiguous = false;
+
+    /*! \return a pointer to the data element \a iter points to.
+        In \a n the number of data elements that can be read
+        consecutively from this pointer, but not beyond \a last,
+	is returned. */
+  static const value_type *buffer( const DataIter &iter, const DataIter &last, int &n )
+    { n = 0; return 0; };
+
+};
+
+
+template < typename T >
+class DetectorBuffer< const T* >
+{
+
+public:
+
+  typedef T value_type;
+  static const bool Contiguous = true;
+
+  static const value_type *buffer( const T *iter, const T *last, int &n )
+    { n = last - iter; return iter; };
+
+};
+
+
+template < typename T >
+class DetectorBuffer< T* > : public DetectorBuffer< const T* >
+{
+};
+
+
 /*!
 \class Detector
 \author Jan Benda
@@ -214,6 +276,23 @@ public:
   void checkThresh( double &threshold,
 		    double minthresh, double maxthresh );
 
+    /*! \return the number of data elements from the current Index
+        up to \a last, but at most \a maxn elements if \a maxn is
+	not negative, that neither exceed the current extremum
+        nor cross the \a threshold while rising or falling,
+	i.e. that do not change the state of peakTrough().
+	Only data for which DetectorBuffer provides contiguous
+	memory are scanned, otherwise zero is returned. */
+  int quietData( DataIter last, double threshold, int maxn=-1 ) const;
+    /*! \return the number of leading elements of \a data that neither
+        exceed \a maxvalue nor drop below \a maxvalue by \a threshold. */
+  template < typename T >
+  static int quietRising( const T *data, int n, double maxvalue, double threshold );
+    /*! \return the number of leading elements of \a data that neither
+        fall below \a minvalue nor rise above \a minvalue by \a threshold. */
+  template < typename T >
+  static int quietFalling( const T *data, int n, double minvalue, double threshold );
+
   int Dir;
   DataIter Index;
   TimeIter IndexTime;
@@ -381,6 +460,106 @@ void Detector< DataIter, TimeIter >::checkThresh( double &threshold,
 }
 
 
+template < typename DataIter, typename TimeIter >
+int Detector< DataIter, TimeIter >::quietData( DataIter last, double threshold,
+					      int maxn ) const
+{
+  if ( ! DetectorBuffer< DataIter >::Contiguous || Dir == 0 )
+    return 0;
+
+  // at most two contiguous spans for a cyclic buffer:
+  DataIter index = Index;
+  int quiet = 0;
+  while ( index < last && ( maxn < 0 || quiet < maxn ) ) {
+    int n = 0;
+    const typename DetectorBuffer< DataIter >::value_type *buffer
+      = DetectorBuffer< DataIter >::buffer( index, last, n );
+    if ( buffer == 0 || n <= 0 )
+      break;
+    if ( maxn >= 0 && n > maxn - quiet )
+      n = maxn - quiet;
+    int k = Dir > 0 ? quietRising( buffer, n, MaxValue, threshold )
+      : quietFalling( buffer, n, MinValue, threshold );
+    quiet += k;
+    if ( k < n )
+      break;
+    index += k;
+  }
+  return quiet;
+}
+
+
+template < typename DataIter, typename TimeIter >
+template < typename T >
+int Detector< DataIter, TimeIter >::quietRising( const T *data, int n,
+						 double maxvalue, double threshold )
+{
+  // peakTrough() changes its state if maxvalue < data
+  // or maxvalue >= data + threshold. Both conditions are translated
+  // into exact bounds in the precision of the data
+  // that can be compared without conversion to double:
+  T hi = maxvalue;
+  if ( hi != maxvalue )
+    return 0;
+  T lo = maxvalue - threshold;
+  for ( int k=0; k<4 && ! ( maxvalue >= lo + threshold ); k++ )
+    lo = nextafter( lo, T( -HUGE_VAL ) );
+  for ( int k=0; k<4 && maxvalue >= nextafter( lo, T( HUGE_VAL ) ) + threshold; k++ )
+    lo = nextafter( lo, T( HUGE_VAL ) );
+  if ( ! ( maxvalue >= lo + threshold ) ||
+       maxvalue >= nextafter( lo, T( HUGE_VAL ) ) + threshold )
+    return 0;
+
+  // count quiet data in blocks without branches for vectorization:
+  const int blocksize = 32;
+  int k = 0;
+  for ( ; k+blocksize <= n; k += blocksize ) {
+    int quiet = 0;
+    for ( int j=0; j<blocksize; j++ )
+      quiet += ( lo < data[k+j] ) & ( data[k+j] <= hi );
+    if ( quiet < blocksize )
+      break;
+  }
+  while ( k < n && ! ( hi < data[k] ) && ! ( data[k] <= lo ) )
+    k++;
+  return k;
+}
+
+
+template < typename DataIter, typename TimeIter >
+template < typename T >
+int Detector< DataIter, TimeIter >::quietFalling( const T *data, int n,
+						  double minvalue, double threshold )
+{
+  // peakTrough() changes its state if data < minvalue
+  // or data >= minvalue + threshold:
+  T lo = minvalue;
+  if ( lo != minvalue )
+    return 0;
+  double upper = minvalue + threshold;
+  T hi = upper;
+  for ( int k=0; k<4 && ! ( hi >= upper ); k++ )
+    hi = nextafter( hi, T( HUGE_VAL ) );
+  for ( int k=0; k<4 && nextafter( hi, T( -HUGE_VAL ) ) >= upper; k++ )
+    hi = nextafter( hi, T( -HUGE_VAL ) );
+  if ( ! ( hi >= upper ) || nextafter( hi, T( -HUGE_VAL ) ) >= upper )
+    return 0;
+
+  const int blocksize = 32;
+  int k = 0;
+  for ( ; k+blocksize <= n; k += blocksize ) {
+    int quiet = 0;
+    for ( int j=0; j<blocksize; j++ )
+      quiet += ( lo <= data[k+j] ) & ( data[k+j] < hi );
+    if ( quiet < blocksize )
+      break;
+  }
+  while ( k < n && ! ( data[k] < lo ) && ! ( data[k] >= hi ) )
+    k++;
+  return k;
+}
+
+
 template < typename DataIter, typename TimeIter >
 template < class Check >
 void Detector< DataIter, TimeIter >::peakTrough( DataIter first,
@@ -453,6 +632,14 @@ void Detector< DataIter, TimeIter >::peakTrough( DataIter first,
 
   // loop through the new read data:
   for ( ; Index < last; ++Index, ++IndexTime ) {
+    // skip data that do not change the state of the detector:
+    int quiet = quietData( last, threshold );
+    if ( quiet > 0 ) {
+      Index += quiet;
+      IndexTime += quiet;
+      if ( ! ( Index < last ) )
+	break;
+    }
     // rising?
     if ( Dir > 0 ) {
       if ( MaxValue < *Index ) {
@@ -648,6 +835,14 @@ void Detector< DataIter, TimeIter >::peakTroughHist( DataIter first,
 
   // loop through the new read data:
   for ( ; Index < last; ++Index, ++IndexTime ) {
+    // skip data that do not change the state of the detector:
+    int quiet = quietData( last, threshold );
+    if ( quiet > 0 ) {
+      Index += quiet;
+      IndexTime += quiet;
+      if ( ! ( Index < last ) )
+	break;
+    }
     // rising?
     if ( Dir > 0 ) {
       if ( MaxValue < *Index ) {
@@ -1431,6 +1626,30 @@ void Detector< DataIter, TimeIter >::dynamicPeakTrough( DataIter first,
 
   // loop through the new read data:
   for ( ; Index < last; ++Index, ++IndexTime ) {
+    // skip data that do not change the state of the detector
+    // as long as the threshold is not decaying:
+    if ( DetectorBuffer< DataIter >::Contiguous && Dir != 0 &&
+	 *IndexTime - PreviousEvent <= delay ) {
+      int maxn = last - Index;
+      if ( *(IndexTime + (maxn-1)) - PreviousEvent > delay ) {
+	int n0 = 1;
+	while ( n0 < maxn ) {
+	  int n = ( n0 + maxn + 1 ) / 2;
+	  if ( *(IndexTime + (n-1)) - PreviousEvent > delay )
+	    maxn = n-1;
+	  else
+	    n0 = n;
+	}
+      }
+      int quiet = quietData( last, threshold, maxn );
+      if ( quiet > 0 ) {
+	PreviousTime = *(IndexTime + (quiet-1));
+	Index += quiet;
+	IndexTime += quiet;
+	if ( ! ( Index < last ) )
+	  break;
+      }
+    }
 
     currenttime = *IndexTime;
     // no recent events?
@@ -1655,6 +1874,30 @@ void Detector< DataIter, TimeIter >::dynamicPeakTroughHist( DataIter first,
 
   // loop through the new read data:
   for ( ; Index < last; ++Index, ++IndexTime ) {
+    // skip data that do not change the state of the detector
+    // as long as the threshold is not decaying:
+    if ( DetectorBuffer< DataIter >::Contiguous && Dir != 0 &&
+	 *IndexTime - PreviousEvent <= delay ) {
+      int maxn = last - Index;
+      if ( *(IndexTime + (maxn-1)) - PreviousEvent > delay ) {
+	int n0 = 1;
+	while ( n0 < maxn ) {
+	  int n = ( n0 + maxn + 1 ) / 2;
+	  if ( *(IndexTime + (n-1)) - PreviousEvent > delay )
+	    maxn = n-1;
+	  else
+	    n0 = n;
+	}
+      }
+      int quiet = quietData( last, threshold, maxn );
+      if ( quiet > 0 ) {
+	PreviousTime = *(IndexTime + (quiet-1));
+	Index += quiet;
+	IndexTime += quiet;
+	if ( ! ( Index < last ) )
+	  break;
+      }
+    }
 
     currenttime = *IndexTime;
     // no recent events?
@@ -791,6 +791,25 @@ public:
     /*! Count all events since time \a time (seconds). */
   int count( double time ) const;
 
+    /*! Returns in \a indices for each of the \a times in seconds
+        the index of the event following or equal to that time, as next().
+        If \a times are sorted in ascending order, successive events
+        are found by a linear merge that starts searching at the
+        previous result. This is much faster than calling next()
+        for thousands of trials. Unsorted times are supported,
+        but are as slow as calling next() for each of them. */
+  void next( const ArrayD &times, ArrayI &indices ) const;
+    /*! Returns in \a indices for each of the \a times in seconds
+        the index of the event preceeding or equal to that time, as previous().
+        As for next( const ArrayD&, ArrayI& ), \a times should be sorted
+        in ascending order. */
+  void previous( const ArrayD &times, ArrayI &indices ) const;
+    /*! Returns in \a counts the number of events between each of the times
+        \a tbegin and the corresponding time \a tend in seconds, as count().
+        \a tbegin and \a tend should be sorted in ascending order,
+        like the windows of successive trials. */
+  void count( const ArrayD &tbegin, const ArrayD &tend, ArrayI &counts ) const;
+
     /*! Mean event rate (Hz) as the number of events between time \a tbegin
         and time \a tend seconds divided by the width of the time window
 	\a tend - \a tbegin. */
@@ -1252,6 +1271,13 @@ public:
 
 private:
 
+    /*! Returns the index of the first event larger than or equal to
+        (\a upper = \c false) or larger than (\a upper = \c true)
+        \a time, searching forward from event \a index with an
+        initial step of \a step events. Used by the batched versions
+        of next() and previous(). */
+  int nextFrom( int index, int step, double time, bool upper ) const;
+
     /*! \c true in case this owns the buffers. */
   bool Own;
     /*! Buffer for the times of events measured in seconds. */
@@ -24,6 +24,8 @@
 
 #include <cmath>
 #include <vector>
+#include <thread>
+#include <atomic>
 #include <relacs/array.h>
 using namespace std;
 
@@ -238,15 +240,165 @@ int marquardtFit( const ContainerX &x, const ContainerY &y, const ContainerS &s,
 		  int *iter=NULL, ostream *os=NULL,
 		  double chieps=0.0005, int maxiter=300 );
 
+
+  /*! Statistics of a single fit performed by
+      marquardtFit() with a MarquardtWorkspace
+      or by marquardtFitBatch(). */
+class MarquardtStats
+{
+
+public:
+
+  MarquardtStats( void );
+
+    /*! The error code as returned by marquardtFit(). */
+  int Error;
+    /*! The number of iterations needed. */
+  int Iterations;
+    /*! The number of data points used for the fit. */
+  int DataPoints;
+    /*! The final chi squared. */
+  double ChiSq;
+    /*! The mean of the residuals y - f(x) of the fitted function. */
+  double ResidualMean;
+    /*! The root-mean-square of the residuals y - f(x). */
+  double ResidualRMS;
+
+};
+
+
+  /*! Buffers used by marquardtFit() for vectorized fit functions.
+      Passing the same workspace to many successive fits
+      avoids any memory allocation after the first fit. */
+class MarquardtWorkspace
+{
+
+public:
+
+  MarquardtWorkspace( void );
+    /*! Make the buffers fit for \a nparams parameters
+        and \a ndata data points. */
+  void resize( int nparams, int ndata );
+
+  ArrayD X;
+  ArrayD Y;
+  ArrayD W;
+  ArrayD F;
+  vector< ArrayD > DFDP;
+  vector< ArrayD > Alpha;
+  vector< ArrayD > Covar;
+  ArrayD Beta;
+  ArrayD OneDA;
+  ArrayD DA;
+  ArrayD ATry;
+  ArrayD EmptyB;
+    /*! Set to true by marquardtFit() whenever the fit function is
+        evaluated for new parameters. This is the per-fit replacement
+        of the global FitFlag for fit functions that take it
+        as their last argument. */
+  bool FitFlag;
+
+};
+
+
+  /*! Wraps a fit function \a f with the signature
+      T f( S x, const ArrayD &params, ArrayD &dfdp )
+      as it is used by the point-by-point marquardtFit()
+      into a vectorized fit function as it is needed by
+      marquardtFit() with a MarquardtWorkspace and by marquardtFitBatch().
+      Instead of the global FitFlag, \a f can take the FitFlag of the
+      workspace as a fourth argument \c bool \c &fitflag.
+      It is true for the first data point of new parameters
+      and \a f may clear it after updating the values
+      that only depend on the parameters. */
+template < typename FitFunc >
+class PointwiseFitFunc
+{
+
+public:
+
+  PointwiseFitFunc( FitFunc &f ) : F( f ) {};
+  void operator()( const ArrayD &x, const ArrayD &params,
+		   ArrayD &y, vector< ArrayD > &dfdp ) const;
+  void operator()( const ArrayD &x, const ArrayD &params,
+		   ArrayD &y, vector< ArrayD > &dfdp, bool &fitflag ) const;
+
+private:
+
+  FitFunc &F;
+
+};
+
+
+  /*! Fit the vectorized function \a f with parameter \a params
+      to the data in array \a firsty through \a lasty at x-position
+      \a firstx through \a lastx with corresponding 
+      measurement errors \a firsts through \a lasts
+      using the Levenberg-Marquardt method.
+      \a f has the signature
+      void f( const ArrayD &x, const ArrayD &params, ArrayD &y, vector< ArrayD > &dfdp ).
+      It returns in \a y the values of the function at all positions \a x
+      for the parameter values \a params and in \a dfdp[k][i] the
+      derivative with respect to the k-th parameter at \a x[i],
+      i.e. the Jacobian of the function.
+      If \a f takes \c bool \c &fitflag as a fifth argument,
+      it gets \a w.FitFlag, which is set to true for each new
+      set of parameters.
+      All temporary buffers are taken from \a w.
+      Number of iterations, final chi squared and
+      statistics of the residuals are returned in \a stats.
+      \return the same error codes as the point-by-point marquardtFit(). 
+      \sa expFuncJacobian(), sineFuncJacobian(), PointwiseFitFunc */
+template < typename ForwardIterX, typename ForwardIterY,
+  typename ForwardIterS, typename FitFunc >
+int marquardtFit( ForwardIterX firstx, ForwardIterX lastx,
+		  ForwardIterY firsty, ForwardIterY lasty,
+		  ForwardIterS firsts, ForwardIterS lasts,
+		  FitFunc &f, ArrayD &params, const ArrayI &paramfit,
+		  ArrayD &uncert, MarquardtWorkspace &w, MarquardtStats &stats,
+		  double chieps=0.0005, int maxiter=300 );
+
+  /*! Fit the vectorized function \a f
+      to each of the data sets \a y[k] at x-positions \a x[k] with
+      measurement errors \a s[k] using the Levenberg-Marquardt method.
+      The fits are independent from each other and are distributed
+      on \a nthreads threads. If \a nthreads is less than one,
+      as many threads as there are cores are used.
+      Each thread reuses a single MarquardtWorkspace for all its fits,
+      so the FitFlag passed to \a f is private to the thread.
+      \a f has to be of the signature described in
+      the vectorized marquardtFit() and is shared between all threads,
+      i.e. its function call operator needs to be thread safe.
+      \param[in,out] params the initial values for the parameters
+      of each data set on input, the fitted values on return.
+      \param[in] paramfit which parameters should be fitted,
+      common for all data sets.
+      \param[out] uncert the uncertainties of the fitted parameters.
+      \param[out] stats error code, iterations and residuals
+      of each fit.
+      \return the number of fits that returned a non-zero error code. */
+template < typename FitFunc >
+int marquardtFitBatch( const vector< ArrayD > &x, const vector< ArrayD > &y,
+		       const vector< ArrayD > &s, FitFunc &f,
+		       vector< ArrayD > &params, const ArrayI &paramfit,
+		       vector< ArrayD > &uncert, vector< MarquardtStats > &stats,
+		       int nthreads=0, double chieps=0.0005, int maxiter=300 );
+
   /*! Returns \f[ p_0 \exp( x / p_1 ) + p_2 \f] */
 double expFunc( double x, const ArrayD &p );
 double expFuncDerivs( double x, const ArrayD &p, ArrayD &dfdp );
+  /*! Vectorized version of expFuncDerivs() for marquardtFitBatch(). */
+void expFuncJacobian( const ArrayD &x, const ArrayD &p,
+		      ArrayD &y, vector< ArrayD > &dfdp );
 void expGuess( ArrayD &p, double y0, double x1, double y1,
 	       double x2, double y2 );
 
   /*! Returns \f[ p_0 + p_1 \sin( 2 \pi p_2 x + p_3 ) \f] */
 double sineFunc( double x, const ArrayD &p );
 double sineFuncDerivs( double x, const ArrayD &p, ArrayD &dfdp );
+  /*! Vectorized version of sineFuncDerivs() for marquardtFitBatch(). */
+void sineFuncJacobian( const ArrayD &x, const ArrayD &p,
+		       ArrayD &y, vector< ArrayD > &dfdp );
 
   /*! Computes the Savitzky-Golay filter coefficients.
       These can be used for the SampleData::smooth() function.
@@ -1333,6 +1485,327 @@ int marquardtFit( const ContainerX &x, const ContainerY &y, const ContainerS &s,
 }
 
 
+  // Evaluate the point-by-point fit function f,
+  // passing the fit flag if f takes it:
+template < typename FitFunc >
+auto pointwiseEval( FitFunc &f, double x, const ArrayD &params,
+		    ArrayD &dfdp, bool &fitflag, int )
+  -> decltype( f( x, params, dfdp, fitflag ) )
+{
+  return f( x, params, dfdp, fitflag );
+}
+
+
+template < typename FitFunc >
+auto pointwiseEval( FitFunc &f, double x, const ArrayD &params,
+		    ArrayD &dfdp, bool &fitflag, long )
+  -> decltype( f( x, params, dfdp ) )
+{
+  return f( x, params, dfdp );
+}
+
+
+template < typename FitFunc >
+void PointwiseFitFunc< FitFunc >::operator()( const ArrayD &x, const ArrayD &params,
+					      ArrayD &y, vector< ArrayD > &dfdp ) const
+{
+  bool fitflag = true;   // new parameters
+  operator()( x, params, y, dfdp, fitflag );
+}
+
+
+template < typename FitFunc >
+void PointwiseFitFunc< FitFunc >::operator()( const ArrayD &x, const ArrayD &params,
+					      ArrayD &y, vector< ArrayD > &dfdp,
+					      bool &fitflag ) const
+{
+  ArrayD dyda( params.size() );
+  for ( int i=0; i<x.size(); i++ ) {
+    y[i] = pointwiseEval( F, x[i], params, dyda, fitflag, 0 );
+    for ( int l=0; l<params.size(); l++ )
+      dfdp[l][i] = dyda[l];
+  }
+}
+
+
+  // Evaluate the vectorized fit function f,
+  // passing the fit flag if f takes it:
+template < typename FitFunc >
+auto marquardtEval( FitFunc &f, const ArrayD &x, const ArrayD &params,
+		    ArrayD &y, vector< ArrayD > &dfdp, bool &fitflag, int )
+  -> decltype( f( x, params, y, dfdp, fitflag ), void() )
+{
+  f( x, params, y, dfdp, fitflag );
+}
+
+
+template < typename FitFunc >
+void marquardtEval( FitFunc &f, const ArrayD &x, const ArrayD &params,
+		    ArrayD &y, vector< ArrayD > &dfdp, bool &fitflag, long )
+{
+  f( x, params, y, dfdp );
+}
+
+
+template < typename FitFunc >
+void marquardtCof( FitFunc &f, const ArrayD &params, const ArrayI &paramfit,
+		   int mfit, double &chisq, MarquardtWorkspace &w,
+		   vector< ArrayD > &alpha, ArrayD &beta )
+{
+  int n = w.X.size();
+  w.FitFlag = true;   // new parameters
+  marquardtEval( f, w.X, params, w.F, w.DFDP, w.FitFlag, 0 );
+
+  // weighted residuals:
+  const double *yp = w.Y.data();
+  const double *wp = w.W.data();
+  double *fp = w.F.data();
+  chisq = 0.0;
+  for ( int i=0; i<n; i++ ) {
+    fp[i] = ( yp[i] - fp[i] ) * wp[i];
+    chisq += fp[i]*fp[i];
+  }
+
+  // weighted derivatives:
+  for ( int l=0; l<params.size(); l++ ) {
+    if ( paramfit[l] ) {
+      double *dp = w.DFDP[l].data();
+      for ( int i=0; i<n; i++ )
+	dp[i] *= wp[i];
+    }
+  }
+
+  // matrix elements:
+  for ( int j=0, l=0; l<params.size(); l++ ) {
+    if ( paramfit[l] ) {
+      const double *dl = w.DFDP[l].data();
+      for ( int k=0, m=0; m<=l; m++ ) {
+	if ( paramfit[m] ) {
+	  const double *dm = w.DFDP[m].data();
+	  double a = 0.0;
+	  for ( int i=0; i<n; i++ )
+	    a += dl[i]*dm[i];
+	  alpha[j][k++] = 0.5*a;
+	}
+      }
+      double b = 0.0;
+      for ( int i=0; i<n; i++ )
+	b += fp[i]*dl[i];
+      beta[j] = b;
+      j++;
+    }
+  }
+
+  // fill up alpha:
+  for ( int j=1; j<mfit; j++ ) {
+    for ( int k=0; k<j; k++ )
+      alpha[k][j] = alpha[j][k];
+  }
+}
+
+
+template < typename ForwardIterX, typename ForwardIterY,
+  typename ForwardIterS, typename FitFunc >
+int marquardtFit( ForwardIterX firstx, ForwardIterX lastx,
+		  ForwardIterY firsty, ForwardIterY lasty,
+		  ForwardIterS firsts, ForwardIterS lasts,
+		  FitFunc &f, ArrayD &params, const ArrayI &paramfit,
+		  ArrayD &uncert, MarquardtWorkspace &w, MarquardtStats &stats,
+		  double chieps, int maxiter )
+{
+  const double chigood = 1.0e-8;
+  const int maxsearch = 4;
+  const int miniter = 30;
+  const double lambdastart = 1.0;
+  const double lambdafac = 10.0;
+
+  // copy data:
+  int n = 0;
+  for ( ForwardIterX ix=firstx; ix != lastx; ++ix )
+    n++;
+  w.resize( params.size(), n );
+  n = 0;
+  while ( (firstx != lastx) && (firsty != lasty) && (firsts != lasts) ) {
+    w.X[n] = *firstx;
+    w.Y[n] = *firsty;
+    w.W[n] = 1.0/(*firsts);
+    ++firstx;
+    ++firsty;
+    ++firsts;
+    n++;
+  }
+  w.resize( params.size(), n );
+
+  // initialize:
+  for ( int k=0; k<params.size(); k++ )
+    uncert[k] = HUGE_VAL;
+  stats = MarquardtStats();
+  stats.DataPoints = n;
+  // numbers of parameters to be fitted:
+  int mfit = 0;
+  for ( int j=0; j<paramfit.size(); j++ ) {
+    if ( paramfit[j] )
+      mfit++;
+  }
+  if ( mfit==0 ) {
+    stats.Error = 1;
+    return 1;
+  }
+  if ( n <= mfit ) {
+    stats.Error = 2;
+    return 2;
+  }
+
+  double alambda = lambdastart;
+  double chisq = 0.0;
+  w.ATry = params;
+  marquardtCof( f, params, paramfit, mfit, chisq, w, w.Alpha, w.Beta );
+  double ochisq = chisq;
+
+  // iterate until maxsearch successfull iterations or
+  // miniter unsuccsessful successive iterations or
+  // more than maxiter iterations are done:
+  int notbetter = 0;
+  int iteration=0;
+  for ( int search=0;
+        (search<maxsearch) && iteration<=maxiter && notbetter < miniter;
+        iteration++ ) {
+    // calculate matrix elements:
+    for ( int j=0; j<mfit; j++ ) {
+      for ( int k=0; k<mfit; k++ )
+	w.Covar[j][k] = w.Alpha[j][k];
+      w.Covar[j][j] = w.Alpha[j][j]*(1.0+alambda);
+      w.OneDA[j] = w.Beta[j];
+    }
+    // solve marix:
+    int gjr = gaussJordan( w.Covar, mfit, w.OneDA );
+    if ( gjr ) {
+      stats.Iterations = iteration;
+      stats.Error = 16*gjr;
+      return stats.Error;
+    }
+
+    for ( int j=0; j<mfit; j++ )
+      w.DA[j] = w.OneDA[j];
+    for ( int j=0, l=0; l<params.size(); l++ ) {
+      if ( paramfit[l] )
+	w.ATry[l] = params[l] + w.DA[j++];
+    }
+    marquardtCof( f, w.ATry, paramfit, mfit, chisq, w, w.Covar, w.DA );
+
+    // success?
+    if ( chisq < ochisq + chigood ) {
+      if ( fabs(1.0-ochisq/chisq) < chieps )
+	search++;
+      alambda /= lambdafac;
+      ochisq=chisq;
+      for ( int j=0; j<mfit; j++ ) {
+	for ( int k=0; k<mfit; k++ )
+	  w.Alpha[j][k] = w.Covar[j][k];
+	w.Beta[j] = w.DA[j];
+      }
+      for ( int l=0; l<params.size(); l++ )
+	params[l] = w.ATry[l];
+      notbetter = 0;
+    }
+    else {
+      alambda *= lambdafac*lambdafac;
+      chisq = ochisq;
+      notbetter++;
+    }
+  }
+
+  stats.Iterations = iteration;
+
+  if ( notbetter >= miniter ) {
+    stats.Error = 8;
+    return 8;
+  }
+
+  // calculate uncertainties:
+  for ( int j=0; j<mfit; j++ ) {
+    for ( int k=0; k<mfit; k++ )
+      w.Covar[j][k] = w.Alpha[j][k];
+  }
+  int gjr = gaussJordan( w.Covar, mfit, w.EmptyB );
+  if ( gjr ) {
+    stats.Error = 64 * gjr;
+    return stats.Error;
+  }
+  covarSort( w.Covar, paramfit, mfit );
+  for ( int j=0; j<params.size(); j++ )
+    uncert[j] = ::sqrt( ::fabs( w.Covar[j][j] ) );
+
+  // residuals:
+  w.FitFlag = true;   // new parameters
+  marquardtEval( f, w.X, params, w.F, w.DFDP, w.FitFlag, 0 );
+  double rm = 0.0;
+  double rs = 0.0;
+  for ( int i=0; i<n; i++ ) {
+    double r = w.Y[i] - w.F[i];
+    rm += r;
+    rs += r*r;
+  }
+  stats.ResidualMean = rm/n;
+  stats.ResidualRMS = ::sqrt( rs/n );
+  stats.ChiSq = chisq;
+
+  stats.Error = iteration > maxiter ? 4 : 0;
+  return stats.Error;
+}
+
+
+template < typename FitFunc >
+int marquardtFitBatch( const vector< ArrayD > &x, const vector< ArrayD > &y,
+		       const vector< ArrayD > &s, FitFunc &f,
+		       vector< ArrayD > &params, const ArrayI &paramfit,
+		       vector< ArrayD > &uncert, vector< MarquardtStats > &stats,
+		       int nthreads, double chieps, int maxiter )
+{
+  int nfits = x.size();
+  if ( (int)y.size() < nfits )
+    nfits = y.size();
+  if ( (int)s.size() < nfits )
+    nfits = s.size();
+  if ( (int)params.size() < nfits )
+    nfits = params.size();
+  uncert.resize( nfits );
+  stats.resize( nfits );
+  for ( int k=0; k<nfits; k++ )
+    uncert[k].resize( params[k].size() );
+
+  if ( nthreads < 1 )
+    nthreads = thread::hardware_concurrency();
+  if ( nthreads > nfits )
+    nthreads = nfits;
+  if ( nthreads < 1 )
+    nthreads = 1;
+
+  // each worker takes the next data set that is not fitted yet:
+  atomic< int > next( 0 );
+  atomic< int > failed( 0 );
+  auto worker = [&]( void ) {
+    MarquardtWorkspace w;
+    for ( int k = next++; k < nfits; k = next++ ) {
+      if ( marquardtFit( x[k].begin(), x[k].end(), y[k].begin(), y[k].end(),
+			 s[k].begin(), s[k].end(), f, params[k], paramfit,
+			 uncert[k], w, stats[k], chieps, maxiter ) != 0 )
+	failed++;
+    }
+  };
+
+  vector< thread > threads;
+  threads.reserve( nthreads-1 );
+  for ( int t=1; t<nthreads; t++ )
+    threads.push_back( thread( worker ) );
+  worker();
+  for ( unsigned int t=0; t<threads.size(); t++ )
+    threads[t].join();
+
+  return failed;
+}
+
+
 }; /* namespace relacs */
 
 #endif /* ! _RELACS_FITALGORITHM_H_ */
@@ -22,6 +22,9 @@
 #ifndef _RELACS_KERNEL_H_
 #define _RELACS_KERNEL_H_ 1
 
+#include <vector>
+using namespace std;
+
 namespace relacs {
 
 
@@ -47,6 +50,14 @@ and the corresponding standard deviation by stdev().
 Note that the value returned by stdev() usually differs from scale().
 The mean of the kernel is mean().
 The maximum value of the kernel is max().
+
+values() computes the kernel at many equidistant positions at once
+without a virtual function call per position.
+sample() computes the kernel at the positions of data sampled with a
+given stepsize, as needed for convolving events with the kernel
+(see EventData::rate()). If the kernel was tabulated by tabulate()
+for this stepsize, sample() interpolates the kernel values linearly
+from the table instead of computing them.
 */
 
 class Kernel
@@ -55,9 +66,11 @@ class Kernel
 public:
 
     /*! Constructs a default kernel with its scale factor set to one. */
-  Kernel( void ) : Scale( 1.0 ) {};
+  Kernel( void ) : Scale( 1.0 ), TableStep( 0.0 ), TableScale( 0.0 ),
+    TableResolution( 0 ), TableOffset( 0 ), TableSize( 0 ) {};
     /*! Constructs a kernel with standard deviation \a stdev. */
-  Kernel( double stdev ) : Scale( 1.0 ) { setStdev( stdev ); };
+  Kernel( double stdev ) : Scale( 1.0 ), TableStep( 0.0 ), TableScale( 0.0 ),
+    TableResolution( 0 ), TableOffset( 0 ), TableSize( 0 ) { setStdev( stdev ); };
     /*! Destructor. */
   virtual ~Kernel( void ) {};
 
@@ -71,6 +84,35 @@ public:
         If you need a NON virtual function as an interface,
 	implement operator(). */
   virtual double value( double x ) const;
+    /*! Computes the values of the kernel at the \a n positions
+        \a x, \a x + \a dx, \a x + 2 \a dx, ... and stores them in \a y.
+        This default implementation calls value() for each position.
+        The kernels defined here implement this function by means of
+        their non-virtual operator(). */
+  virtual void values( double x, double dx, int n, double *y ) const;
+
+    /*! Computes the kernel sampled with \a stepsize and shifted by
+        \a dt, i.e. at the positions i*stepsize + dt for the indices i
+        from floor( left()/stepsize ) to floor( right()/stepsize )
+        (exclusively), and stores the values in \a y.
+        \a dt should be between zero and \a stepsize.
+        If the kernel is tabulated() for \a stepsize the values are
+        interpolated from the table.
+        \return the first index i. */
+  int sample( double dt, double stepsize, vector< double > &y ) const;
+    /*! Precompute the kernel sampled with \a stepsize
+        at \a resolution equidistant shifts between zero and \a stepsize
+        for sample(). Call this function again after changing the scale
+        of the kernel.
+        The larger \a resolution the more precise are the interpolated
+        kernel values. Note that the interpolation smears out
+        discontinuities like the edges of a RectKernel. */
+  void tabulate( double stepsize, int resolution=32 );
+    /*! \return \c true if the kernel is tabulated for \a stepsize
+        and its current scale. */
+  bool tabulated( double stepsize ) const;
+    /*! Free the table computed by tabulate(). */
+  void clearTable( void );
 
     /*! Return the scale factor of the kernel (the width). */
   double scale( void ) const { return Scale; };
@@ -110,6 +152,15 @@ private:
 
   double Scale;
 
+    /*! The kernel values of tabulate(), TableResolution+1 rows
+        of TableSize values each. */
+  vector< double > Table;
+  double TableStep;
+  double TableScale;
+  int TableResolution;
+  int TableOffset;
+  int TableSize;
+
 };
 
 
@@ -137,6 +188,7 @@ public:
 
   double operator()( double x ) const;
   virtual double value( double x ) const;
+  virtual void values( double x, double dx, int n, double *y ) const;
 
   virtual void setScale( double scale );
 
@@ -178,6 +230,7 @@ public:
 
   double operator()( double x ) const;
   virtual double value( double x ) const;
+  virtual void values( double x, double dx, int n, double *y ) const;
 
   virtual void setScale( double scale );
 
@@ -222,6 +275,7 @@ public:
 
   double operator()( double x ) const;
   virtual double value( double x ) const;
+  virtual void values( double x, double dx, int n, double *y ) const;
 
   virtual void setScale( double scale );
 
@@ -266,6 +320,7 @@ public:
 
   double operator()( double x ) const;
   virtual double value( double x ) const;
+  virtual void values( double x, double dx, int n, double *y ) const;
 
   virtual void setScale( double scale );
 
@@ -314,6 +369,7 @@ public:
 
   double operator()( double x ) const;
   virtual double value( double x ) const;
+  virtual void values( double x, double dx, int n, double *y ) const;
 
   virtual void setScale( double scale );
 
@@ -323,7 +379,7 @@ public:
   virtual double max( void ) const;
 
   int order( void ) const { return Order; };
-  void setOrder( int order ) { Order = order > 0 ? order : 1; };
+  void setOrder( int order ) { Order = order > 0 ? order : 1; clearTable(); };
 
   virtual double left( void ) const;
   virtual double right( void ) const;
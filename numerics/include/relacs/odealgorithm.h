@@ -23,6 +23,7 @@
 #define _RELACS_ODEALGORITHM_H_ 1
 
 #include <cmath>
+#include <vector>
 
 namespace relacs {
 
@@ -293,6 +294,323 @@ void rk4Step( double x, double *y, double *dydx, int n,
 }
 
 
+/*!
+\class DormandPrince
+\author Jan Benda
+\brief Embedded Runge-Kutta method of Dormand and Prince of order 5(4)
+with adaptive step size control and dense output.
+
+Integrates the set of ordinary differential equations dy/dx = f(y(x),x).
+The functor \a Derivs has a function f( x, y, dydx, n ) that computes
+the derivative \a dydx for the current state vector \a y of size \a n at \a x,
+as for rk4Step().
+
+Each step needs six evaluations of the derivative (the last
+evaluation of a step is the first one of the next step).
+The step size is adapted such that the estimated local error of each
+component y_i stays below absTol() + relTol()*|y_i|.
+
+First set the initial conditions with init(). Then either call step()
+for single steps with dense output via interpolate(),
+or integrate() for getting the state at a given \a x:
+\code
+DormandPrince dp( 1.0e-6, 1.0e-6 );
+dp.init( 0.0, y, n, 0.01, f );
+for ( int k=1; k<=100; k++ ) {
+  dp.integrate( k*0.1, y, f );
+  ...
+}
+\endcode
+ */
+
+class DormandPrince
+{
+
+public:
+
+    /*! Construct the integrator with absolute tolerance \a abstol
+        and relative tolerance \a reltol. */
+  DormandPrince( double abstol=1.0e-6, double reltol=1.0e-6 );
+
+    /*! The absolute tolerance. */
+  double absTol( void ) const { return ATol; };
+    /*! The relative tolerance. */
+  double relTol( void ) const { return RTol; };
+    /*! Set the absolute tolerance to \a abstol
+        and the relative tolerance to \a reltol. */
+  void setTolerance( double abstol, double reltol );
+    /*! The maximum step size. Zero means no limit. */
+  double maxStep( void ) const { return MaxStep; };
+    /*! Set the maximum step size to \a maxstep. Zero means no limit. */
+  void setMaxStep( double maxstep );
+
+    /*! Set the initial conditions \a y of size \a n at \a x.
+        \a h is the first step size that is tried. */
+  template < class Derivs >
+  void init( double x, const double *y, int n, double h, Derivs &f );
+    /*! Recompute the derivative at x() that is reused as the first
+        stage of the next step. Call this whenever \a f changed
+        since the last step, e.g. after drawing a new noise value. */
+  template < class Derivs >
+  void refresh( Derivs &f );
+
+    /*! Make a single step, but do not go beyond \a xmax.
+        After a successful step interpolate() can be used
+        for obtaining the state between xPrevious() and x().
+        \return the number of evaluations of the derivative,
+	or -1 if the step size became too small. */
+  template < class Derivs >
+  int step( double xmax, Derivs &f );
+    /*! Integrate up to \a x, without stepping beyond \a x,
+        and return the state in \a y.
+        \return the number of evaluations of the derivative,
+	or -1 if the step size became too small. */
+  template < class Derivs >
+  int integrate( double x, double *y, Derivs &f );
+    /*! Compute in \a y the state at \a x from the dense output
+        of the last step. \a x needs to be within xPrevious() and x(). */
+  void interpolate( double x, double *y ) const;
+
+    /*! The number of state variables. */
+  int size( void ) const { return N; };
+    /*! The current value of \a x. */
+  double x( void ) const { return X; };
+    /*! The state vector at x(). */
+  const double *y( void ) const { return &Y[0]; };
+    /*! The value of \a x before the last step. */
+  double xPrevious( void ) const { return XOld; };
+    /*! The step size that is tried next. */
+  double stepSize( void ) const { return H; };
+    /*! The total number of evaluations of the derivative since init(). */
+  int evaluations( void ) const { return Evaluations; };
+
+
+private:
+
+  int N;
+  double X;
+  double XOld;
+  double H;
+  double HOld;
+  double ATol;
+  double RTol;
+  double MaxStep;
+  int Evaluations;
+  std::vector< double > Y;
+  std::vector< double > YNew;
+  std::vector< double > YT;
+  std::vector< double > K[7];
+  std::vector< double > Dense[5];
+
+};
+
+
+inline DormandPrince::DormandPrince( double abstol, double reltol )
+  : N( 0 ),
+    X( 0.0 ),
+    XOld( 0.0 ),
+    H( 0.0 ),
+    HOld( 0.0 ),
+    ATol( abstol ),
+    RTol( reltol ),
+    MaxStep( 0.0 ),
+    Evaluations( 0 )
+{
+}
+
+
+inline void DormandPrince::setTolerance( double abstol, double reltol )
+{
+  ATol = abstol;
+  RTol = reltol;
+}
+
+
+inline void DormandPrince::setMaxStep( double maxstep )
+{
+  MaxStep = maxstep;
+}
+
+
+template < class Derivs >
+void DormandPrince::init( double x, const double *y, int n, double h, Derivs &f )
+{
+  N = n;
+  X = x;
+  XOld = x;
+  H = h;
+  HOld = 0.0;
+  Y.assign( y, y+n );
+  YNew.resize( n );
+  YT.resize( n );
+  for ( int i=0; i<7; i++ )
+    K[i].resize( n );
+  for ( int i=0; i<5; i++ )
+    Dense[i].assign( n, 0.0 );
+  // the first derivative is reused from the last step:
+  f( X, &Y[0], &K[0][0], N );
+  Evaluations = 1;
+}
+
+
+template < class Derivs >
+void DormandPrince::refresh( Derivs &f )
+{
+  if ( N <= 0 )
+    return;
+  f( X, &Y[0], &K[0][0], N );
+  Evaluations++;
+}
+
+
+template < class Derivs >
+int DormandPrince::step( double xmax, Derivs &f )
+{
+  static const double c2 = 1.0/5.0, c3 = 3.0/10.0, c4 = 4.0/5.0, c5 = 8.0/9.0;
+  static const double a21 = 1.0/5.0;
+  static const double a31 = 3.0/40.0, a32 = 9.0/40.0;
+  static const double a41 = 44.0/45.0, a42 = -56.0/15.0, a43 = 32.0/9.0;
+  static const double a51 = 19372.0/6561.0, a52 = -25360.0/2187.0,
+    a53 = 64448.0/6561.0, a54 = -212.0/729.0;
+  static const double a61 = 9017.0/3168.0, a62 = -355.0/33.0,
+    a63 = 46732.0/5247.0, a64 = 49.0/176.0, a65 = -5103.0/18656.0;
+  static const double a71 = 35.0/384.0, a73 = 500.0/1113.0,
+    a74 = 125.0/192.0, a75 = -2187.0/6784.0, a76 = 11.0/84.0;
+  static const double e1 = 71.0/57600.0, e3 = -71.0/16695.0,
+    e4 = 71.0/1920.0, e5 = -17253.0/339200.0, e6 = 22.0/525.0, e7 = -1.0/40.0;
+  static const double d1 = -12715105075.0/11282082432.0,
+    d3 = 87487479700.0/32700410799.0, d4 = -10690763975.0/1880347072.0,
+    d5 = 701980252875.0/199316789632.0, d6 = -1453857185.0/822651844.0,
+    d7 = 69997945.0/29380423.0;
+
+  if ( N <= 0 || xmax <= X )
+    return 0;
+
+  double *k1 = &K[0][0];
+  double *k2 = &K[1][0];
+  double *k3 = &K[2][0];
+  double *k4 = &K[3][0];
+  double *k5 = &K[4][0];
+  double *k6 = &K[5][0];
+  double *k7 = &K[6][0];
+  double *y = &Y[0];
+  double *yt = &YT[0];
+  double *yn = &YNew[0];
+  int evals = 0;
+  bool rejected = false;
+
+  for ( ;; ) {
+    if ( MaxStep > 0.0 && H > MaxStep )
+      H = MaxStep;
+    double h = H;
+    bool last = false;
+    if ( X + h >= xmax ) {
+      h = xmax - X;
+      last = true;
+    }
+    if ( h <= 1.0e-12 * ( ::fabs( X ) + ::fabs( h ) ) || X + h == X )
+      return -1;
+
+    for ( int i=0; i<N; i++ )
+      yt[i] = y[i] + h*a21*k1[i];
+    f( X + c2*h, yt, k2, N );
+    for ( int i=0; i<N; i++ )
+      yt[i] = y[i] + h*( a31*k1[i] + a32*k2[i] );
+    f( X + c3*h, yt, k3, N );
+    for ( int i=0; i<N; i++ )
+      yt[i] = y[i] + h*( a41*k1[i] + a42*k2[i] + a43*k3[i] );
+    f( X + c4*h, yt, k4, N );
+    for ( int i=0; i<N; i++ )
+      yt[i] = y[i] + h*( a51*k1[i] + a52*k2[i] + a53*k3[i] + a54*k4[i] );
+    f( X + c5*h, yt, k5, N );
+    for ( int i=0; i<N; i++ )
+      yt[i] = y[i] + h*( a61*k1[i] + a62*k2[i] + a63*k3[i] + a64*k4[i] + a65*k5[i] );
+    double xn = last ? xmax : X + h;
+    f( xn, yt, k6, N );
+    for ( int i=0; i<N; i++ )
+      yn[i] = y[i] + h*( a71*k1[i] + a73*k3[i] + a74*k4[i] + a75*k5[i] + a76*k6[i] );
+    f( xn, yn, k7, N );
+    evals += 6;
+
+    // error estimate:
+    double err = 0.0;
+    for ( int i=0; i<N; i++ ) {
+      double sc = ATol + RTol * ( ::fabs( y[i] ) > ::fabs( yn[i] ) ? ::fabs( y[i] ) : ::fabs( yn[i] ) );
+      double e = h*( e1*k1[i] + e3*k3[i] + e4*k4[i] + e5*k5[i] + e6*k6[i] + e7*k7[i] ) / sc;
+      err += e*e;
+    }
+    err = ::sqrt( err/N );
+
+    // new step size:
+    double fac = err > 0.0 ? 0.9 * ::pow( err, -0.2 ) : 10.0;
+    if ( fac > 10.0 )
+      fac = 10.0;
+    else if ( fac < 0.2 )
+      fac = 0.2;
+
+    if ( err <= 1.0 ) {
+      // accept step, dense output:
+      for ( int i=0; i<N; i++ ) {
+	double ydiff = yn[i] - y[i];
+	double bspl = h*k1[i] - ydiff;
+	Dense[0][i] = y[i];
+	Dense[1][i] = ydiff;
+	Dense[2][i] = bspl;
+	Dense[3][i] = ydiff - h*k7[i] - bspl;
+	Dense[4][i] = h*( d1*k1[i] + d3*k3[i] + d4*k4[i] + d5*k5[i] + d6*k6[i] + d7*k7[i] );
+      }
+      XOld = X;
+      HOld = h;
+      X = xn;
+      Y.swap( YNew );
+      K[0].swap( K[6] );
+      // do not increase the step size right after a rejection
+      // and do not let a shortened last step shrink it:
+      if ( rejected && fac > 1.0 )
+	fac = 1.0;
+      if ( ! last || h*fac > H )
+	H = h*fac;
+      Evaluations += evals;
+      return evals;
+    }
+
+    // reject step:
+    H = h*fac;
+    rejected = true;
+  }
+}
+
+
+template < class Derivs >
+int DormandPrince::integrate( double x, double *y, Derivs &f )
+{
+  int evals = 0;
+  while ( X < x ) {
+    int r = step( x, f );
+    if ( r < 0 )
+      return -1;
+    evals += r;
+  }
+  for ( int i=0; i<N; i++ )
+    y[i] = Y[i];
+  return evals;
+}
+
+
+inline void DormandPrince::interpolate( double x, double *y ) const
+{
+  if ( HOld <= 0.0 ) {
+    for ( int i=0; i<N; i++ )
+      y[i] = Y[i];
+    return;
+  }
+  double theta = ( x - XOld ) / HOld;
+  double theta1 = 1.0 - theta;
+  for ( int i=0; i<N; i++ )
+    y[i] = Dense[0][i] + theta*( Dense[1][i] + theta1*( Dense[2][i] + theta*( Dense[3][i] + theta1*Dense[4][i] ) ) );
+}
+
+
 #ifdef NOTHING
 
 
@@ -0,0 +1,114 @@
+/*
+  overlapsave.h
+  Convolution of a stream of data with a filter by FFT overlap-save.
+
+  RELACS - Relaxed ELectrophysiological data Acquisition, Control, and Stimulation
+  Copyright (C) 2002-2015 Jan Benda <jan.benda@uni-tuebingen.de>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+  
+  RELACS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _RELACS_OVERLAPSAVE_H_
+#define _RELACS_OVERLAPSAVE_H_ 1
+
+#include <vector>
+using namespace std;
+
+namespace relacs {
+
+
+/*! 
+\class OverlapSave
+\author Jan Benda
+\brief Convolution of a stream of data with a filter by FFT overlap-save.
+
+The filter is given by its impulse response \a h (setFilter()).
+Data are added sample by sample with push().
+The filtered data
+\f[ y_j = \sum_{m} h_m x_{j+\mathrm{offs}-m} \f]
+are computed in blocks of blockSize() samples by multiplying
+the Fourier transforms of \a blockSize() + filterSize() - 1 data
+elements and of the filter. push() returns the number of filtered
+samples that have become available; they are then accessible via
+operator[] until the next block is completed.
+Data before the first pushed sample are taken as zero.
+
+\a offs is the index of the element of \a h that corresponds to zero lag.
+For \a offs > 0 the filter is non-causal and the first filtered
+sample becomes available only after \a offs further data
+elements have been pushed.
+*/
+
+class OverlapSave
+{
+
+public:
+
+    /*! Constructs an empty filter. */
+  OverlapSave( void );
+    /*! Constructs the filter with the \a n elements of impulse response \a h,
+        where \a h[ \a offs ] corresponds to zero lag. */
+  OverlapSave( const double *h, int n, int offs=0 );
+
+    /*! Set the impulse response of the filter to the \a n elements of \a h.
+        \a h[ \a offs ] corresponds to zero lag.
+        The size of the FFTs is set to the power of two equal or greater than
+        four times \a n, but at least \a minfft.
+        Clears the data by calling reset(). */
+  void setFilter( const double *h, int n, int offs=0, int minfft=256 );
+    /*! Clear the data that have been pushed so far. */
+  void reset( void );
+
+    /*! The number of elements of the impulse response. */
+  int filterSize( void ) const;
+    /*! The number of filtered samples computed at once. */
+  int blockSize( void ) const;
+    /*! The size of the FFTs. */
+  int fftSize( void ) const;
+
+    /*! Add the data element \a x. 
+        \return the number of filtered samples that became available
+	and can be retrieved by operator[]. */
+  int push( double x );
+    /*! The \a i-th filtered sample of the last completed block. */
+  double operator[]( int i ) const { return Output[OutputOffset+i]; };
+
+
+private:
+
+    /*! Compute the filtered samples from the buffered data. */
+  void process( void );
+
+  int Size;
+  int Offset;
+  int NFFT;
+  int Block;
+    /*! Number of filtered samples still to be discarded
+        (or to be prepended as zeros, if negative). */
+  int Skip;
+    /*! Half-complex Fourier transform of the impulse response. */
+  vector< double > H;
+    /*! Data, the first Size-1 elements from the previous block. */
+  vector< double > Buffer;
+  int BufferIndex;
+  vector< double > Output;
+  int OutputOffset;
+
+};
+
+
+}; /* namespace relacs */
+
+#endif /* ! _RELACS_OVERLAPSAVE_H_ */
+
@@ -26,6 +26,7 @@
 #include <cmath>
 #include <string>
 #include <ctime>
+#include <stdint.h>
 
 #ifdef HAVE_LIBRAND55
 #include <limits.h>
@@ -100,12 +101,51 @@ public:
         p(x) dx = x^(a-1) exp(-x)/Gamma(a) dx. */
   virtual double gamma( int a );
 
+    /*! Fill the \a n elements of \a x with uniformly distributed
+        random numbers between zero (inclusively) and one (exclusively).
+        The default implementation calls uniform() for each element. */
+  virtual void fill( double *x, int n );
+    /*! Fill the \a n elements of \a x with uniformly distributed
+        random numbers between zero (inclusively) and one (exclusively). */
+  virtual void fill( float *x, int n );
+    /*! Fill the \a n elements of \a x with uniformly distributed
+        random numbers between zero (inclusively) and one (exclusively). */
+  template < typename T >
+  void fill( T *x, int n );
+    /*! Fill the \a n elements of \a x with unit gaussian distributed
+        random numbers.
+        The default implementation calls gaussian() for each element. */
+  virtual void fillGaussian( double *x, int n );
+    /*! Fill the \a n elements of \a x with unit gaussian distributed
+        random numbers. */
+  virtual void fillGaussian( float *x, int n );
+    /*! Fill the \a n elements of \a x with unit gaussian distributed
+        random numbers. */
+  template < typename T >
+  void fillGaussian( T *x, int n );
+
     /*! The name of the random number generator. */
   virtual string name( void ) = 0;
 
 };
 
 
+template < typename T >
+void RandomBase::fill( T *x, int n )
+{
+  for ( int k=0; k<n; k++ )
+    x[k] = uniform();
+}
+
+
+template < typename T >
+void RandomBase::fillGaussian( T *x, int n )
+{
+  for ( int k=0; k<n; k++ )
+    x[k] = gaussian();
+}
+
+
 /*!
 \class RandomStd
 \author Jan Benda
@@ -249,6 +289,131 @@ private:
 };
 
 
+/*!
+\class RandomXoshiro
+\author Jan Benda
+\version 1.0
+\brief An implementation of RandomBase 
+  with the xoshiro256+ random number generator
+  optimized for generating many random numbers at once.
+
+The xoshiro256+ generator by David Blackman and Sebastiano Vigna
+has a period of 2^256-1 and a state of four 64-bit words.
+RandomXoshiro runs four interleaved copies of the generator (lanes),
+that are 2^128 steps apart from each other.
+The lanes are advanced together using SIMD instructions.
+
+fill() and fillGaussian() generate many random numbers in one go
+and should be used whenever more than a few numbers are needed.
+Gaussian random numbers are generated with the ziggurat algorithm.
+The single number functions uniform() and gaussian()
+take the numbers from internal buffers that are refilled in bulk.
+
+Generators constructed with the same seed but different \a stream numbers
+produce independent sequences of random numbers (they are 2^192 steps
+apart). Give each thread its own stream to get reproducible results
+independent of the order in which the threads run:
+\code
+RandomXoshiro rand( seed, thread );
+SampleDataF noise( 100000, 0.0, 0.0001 );
+rand.fillGaussian( noise.data(), noise.size() );
+\endcode
+
+Only the upper bits of the random numbers of xoshiro256+ pass
+all statistical tests. They are used for the floating point numbers.
+ */
+
+class RandomXoshiro : public RandomBase
+{
+
+public:
+
+    /*! Construct a random number generator seeded from the system time. */
+  RandomXoshiro( void );
+    /*! Construct a random number generator for stream \a stream
+        with seed \a seed. */
+  RandomXoshiro( unsigned long seed, int stream=0 );
+  virtual ~RandomXoshiro( void );
+
+    /*! Set the seed of the random number generator to \a seed.
+        If \a seed is 0, then the system time is used to generate a seed
+        to imitate real randomness.
+        Returns the seed. */
+  virtual unsigned long setSeed( unsigned long seed );
+    /*! Set the seed of the random number generator to \a seed
+        and select stream \a stream.
+        Returns the seed. */
+  unsigned long setSeed( unsigned long seed, int stream );
+    /*! The stream of random numbers. */
+  int stream( void ) const;
+
+    /*! Returns a uniformly distributed random integer between min() and max(). */
+  virtual unsigned long integer( void );
+    /*! The minimum value integer() returns. */
+  virtual unsigned long min( void ) const;
+    /*! The maximum value integer() returns. */
+  virtual unsigned long max( void ) const;
+    /*! Returns an uniformly distributed integer random number between zero
+        and \a n.
+        The range includes 0 but excludes \a n.
+        This operator conforms to the STL RandomNumberGenerator specification.
+        This function is NOT virtual in order to speed up computation. */
+  unsigned long operator()( unsigned long n )
+    { return (unsigned long)( uniform53() * n ); };
+
+    /*! Returns a uniformly distributed random number between zero and one.
+        The range includes 0.0 but excludes 1.0.
+        This function is NOT virtual in order to speed up computation. */
+  inline double operator()( void )
+    { return uniform53(); };
+    /*! Returns a uniformly distributed random number between zero and one.
+        The range includes 0.0 but excludes 1.0. */
+  virtual double uniform( void );
+
+    /*! Returns a unit gaussian distributed random number. */
+  virtual double gaussian( void );
+
+  using RandomBase::fill;
+  using RandomBase::fillGaussian;
+  virtual void fill( double *x, int n );
+  virtual void fill( float *x, int n );
+  virtual void fillGaussian( double *x, int n );
+  virtual void fillGaussian( float *x, int n );
+
+    /*! The name of the random number generator ("xoshiro256+"). */
+  virtual string name( void );
+
+
+private:
+
+    /*! Fill \a n random 64-bit words into \a bits.
+        \a n must be a multiple of Lanes. */
+  void next( uint64_t *bits, int n );
+    /*! The next random 64-bit word. */
+  inline uint64_t next( void )
+    { if ( BitsPos >= BitsSize ) { next( Bits, BitsSize ); BitsPos = 0; }
+      return Bits[BitsPos++]; };
+    /*! A uniformly distributed random number with 53 bits resolution. */
+  inline double uniform53( void )
+    { return ( next() >> 11 ) * ( 1.0 / 9007199254740992.0 ); };
+    /*! Gaussian random numbers from the ziggurat algorithm. */
+  void ziggurat( double *x, int n );
+
+  static const int Lanes = 4;
+  uint64_t State[4][Lanes];
+  int Stream;
+
+  static const int BitsSize = 64;
+  uint64_t Bits[BitsSize];
+  int BitsPos;
+
+  static const int GaussSize = 64;
+  double Gauss[GaussSize];
+  int GaussPos;
+
+};
+
+
 #ifdef HAVE_LIBRAND55
 
 /*!
@@ -32,6 +32,7 @@
 #include <relacs/array.h>
 #include <relacs/linearrange.h>
 #include <relacs/containerfuncs.h>
+#include <relacs/kernel.h>
 #include <relacs/spectrum.h>
 #include <relacs/eventdata.h>
 #include <relacs/detector.h>
@@ -49,7 +50,6 @@ namespace relacs {
 \author Jan Benda
 \brief A template defining an one-dimensional Array of data with an associated Range.
 \todo colored noise
-\todo interface to class Kernel
 \todo Handle mismatch of stepsize() in various functions.
 
 
@@ -170,6 +170,10 @@ class SampleData : public Array< T >
         Creates a SampleData with the same size, range, and content
         as \a sa. */
   SampleData( const SampleData< T > &sa );
+    /*! Move constructor.
+        Takes over the data buffer and the range of \a sa
+        and leaves \a sa empty. */
+  SampleData( SampleData< T > &&sa );
     /*! The destructor. */
   virtual ~SampleData( void );
 
@@ -185,6 +189,9 @@ class SampleData : public Array< T >
     /*! Set the size(), capacity(), range() and content of the array to \a a.
         \sa assign() */
   const SampleData< T > &operator=( const SampleData< T > &a );
+    /*! Take over the data buffer and the range of \a a
+        and leave \a a empty. */
+  const SampleData< T > &operator=( SampleData< T > &&a );
 
     /*! Set the size() and capacity() of the array to \a n and
         its content to \a a without affecting the offset() and stepsize(). */
@@ -250,6 +257,14 @@ class SampleData : public Array< T >
         savitzkyGolay() function defined in fitalgorithm.h . */
   template < typename R >
   const SampleData< T > &smooth( const SampleData< R > &sa, const ArrayD &weights, int nl );
+    /*! Assign the content and the range of the array \a sa to \a this
+        smoothed by \a kernel, i.e. convolved with the kernel sampled
+        with the stepsize of \a sa and normalized to the sum of the
+        kernel values.
+        The kernel values are computed once by Kernel::sample()
+        and need to include the kernel at zero. */
+  template < typename R >
+  const SampleData< T > &smooth( const SampleData< R > &sa, const Kernel &kernel );
 
     /*! Resize the array to \a n data elements sampled 
         with stepsize \a step and initialize the data elements
@@ -665,30 +680,51 @@ class SampleData : public Array< T >
 
 /* Generates declarations for binary class friend operators
    that take the class and a scalar as argument.
+   A temporary SampleData argument is reused for the result.
    \a COP is the operator name (like operator+ ). */
 #define SAMPLEDARRAYOPS2SCALARDEC( COP )	\
   template < typename TT > friend SampleData<TT> COP( float x, const SampleData<TT> &y ); \
+  template < typename TT > friend SampleData<TT> COP( float x, SampleData<TT> &&y ); \
   template < typename TT > friend SampleData<TT> COP( const SampleData<TT> &x, float y ); \
+  template < typename TT > friend SampleData<TT> COP( SampleData<TT> &&x, float y ); \
   template < typename TT > friend SampleData<TT> COP( double x, const SampleData<TT> &y ); \
+  template < typename TT > friend SampleData<TT> COP( double x, SampleData<TT> &&y ); \
   template < typename TT > friend SampleData<TT> COP( const SampleData<TT> &x, double y ); \
+  template < typename TT > friend SampleData<TT> COP( SampleData<TT> &&x, double y ); \
   template < typename TT > friend SampleData<TT> COP( long double x, const SampleData<TT> &y ); \
+  template < typename TT > friend SampleData<TT> COP( long double x, SampleData<TT> &&y ); \
   template < typename TT > friend SampleData<TT> COP( const SampleData<TT> &x, long double y ); \
+  template < typename TT > friend SampleData<TT> COP( SampleData<TT> &&x, long double y ); \
   template < typename TT > friend SampleData<TT> COP( signed char x, const SampleData<TT> &y ); \
+  template < typename TT > friend SampleData<TT> COP( signed char x, SampleData<TT> &&y ); \
   template < typename TT > friend SampleData<TT> COP( const SampleData<TT> &x, signed char y ); \
+  template < typename TT > friend SampleData<TT> COP( SampleData<TT> &&x, signed char y ); \
   template < typename TT > friend SampleData<TT> COP( unsigned char x, const SampleData<TT> &y ); \
+  template < typename TT > friend SampleData<TT> COP( unsigned char x, SampleData<TT> &&y ); \
   template < typename TT > friend SampleData<TT> COP( const SampleData<TT> &x, unsigned char y ); \
+  template < typename TT > friend SampleData<TT> COP( SampleData<TT> &&x, unsigned char y ); \
   template < typename TT > friend SampleData<TT> COP( signed int x, const SampleData<TT> &y ); \
+  template < typename TT > friend SampleData<TT> COP( signed int x, SampleData<TT> &&y ); \
   template < typename TT > friend SampleData<TT> COP( const SampleData<TT> &x, signed int y ); \
+  template < typename TT > friend SampleData<TT> COP( SampleData<TT> &&x, signed int y ); \
   template < typename TT > friend SampleData<TT> COP( unsigned int x, const SampleData<TT> &y ); \
+  template < typename TT > friend SampleData<TT> COP( unsigned int x, SampleData<TT> &&y ); \
   template < typename TT > friend SampleData<TT> COP( const SampleData<TT> &x, unsigned int y ); \
+  template < typename TT > friend SampleData<TT> COP( SampleData<TT> &&x, unsigned int y ); \
   template < typename TT > friend SampleData<TT> COP( signed long x, const SampleData<TT> &y ); \
+  template < typename TT > friend SampleData<TT> COP( signed long x, SampleData<TT> &&y ); \
   template < typename TT > friend SampleData<TT> COP( const SampleData<TT> &x, signed long y ); \
+  template < typename TT > friend SampleData<TT> COP( SampleData<TT> &&x, signed long y ); \
   template < typename TT > friend SampleData<TT> COP( unsigned long x, const SampleData<TT> &y ); \
-  template < typename TT > friend SampleData<TT> COP( const SampleData<TT> &x, unsigned long y );
+  template < typename TT > friend SampleData<TT> COP( unsigned long x, SampleData<TT> &&y ); \
+  template < typename TT > friend SampleData<TT> COP( const SampleData<TT> &x, unsigned long y ); \
+  template < typename TT > friend SampleData<TT> COP( SampleData<TT> &&x, unsigned long y );
 
     /*! Return the sum of the containers \a x and \a y computed for each element. */
   template < typename TT, typename RR >
   friend SampleData<TT> operator+( const SampleData<TT> &x,  const RR &y );
+  template < typename TT, typename RR >
+  friend SampleData<TT> operator+( SampleData<TT> &&x,  const RR &y );
     /*! Return the sum of \a x and \a y computed for each element. 
         One of the parameters is a scalar type
 	like \c float, \c double, \c int, etc.,
@@ -697,6 +733,8 @@ class SampleData : public Array< T >
     /*! Return the difference of the containers \a x and \a y computed for each element. */
   template < typename TT, typename RR >
   friend SampleData<TT> operator-( const SampleData<TT> &x,  const RR &y );
+  template < typename TT, typename RR >
+  friend SampleData<TT> operator-( SampleData<TT> &&x,  const RR &y );
     /*! Return the difference of \a x and \a y computed for each element. 
         One of the parameters is a scalar type
 	like \c float, \c double, \c int, etc.,
@@ -705,6 +743,8 @@ class SampleData : public Array< T >
     /*! Return the product of the containers \a x and \a y computed for each element. */
   template < typename TT, typename RR >
   friend SampleData<TT> operator*( const SampleData<TT> &x,  const RR &y );
+  template < typename TT, typename RR >
+  friend SampleData<TT> operator*( SampleData<TT> &&x,  const RR &y );
     /*! Return the product of \a x and \a y computed for each element. 
         One of the parameters is a scalar type
 	like \c float, \c double, \c int, etc.,
@@ -713,6 +753,8 @@ class SampleData : public Array< T >
     /*! Return container \a x divided by container \a y computed for each element. */
   template < typename TT, typename RR >
   friend SampleData<TT> operator/( const SampleData<TT> &x,  const RR &y );
+  template < typename TT, typename RR >
+  friend SampleData<TT> operator/( SampleData<TT> &&x,  const RR &y );
     /*! Return \a x divided by \a y computed for each element. 
         One of the parameters is a scalar type
 	like \c float, \c double, \c int, etc.,
@@ -721,6 +763,8 @@ class SampleData : public Array< T >
     /*! Return the remainder of container \a x divided by container \a y computed for each element. */
   template < typename TT, typename RR >
   friend SampleData<TT> operator%( const SampleData<TT> &x,  const RR &y );
+  template < typename TT, typename RR >
+  friend SampleData<TT> operator%( SampleData<TT> &&x,  const RR &y );
     /*! Return the remainder of \a x divided by \a y computed for each element. 
         One of the parameters is a scalar type
 	like \c float, \c double, \c int, etc.,
@@ -1905,6 +1949,16 @@ SampleData< T >::SampleData( const SampleData< T > &sa )
 }
 
 
+template < typename T >
+SampleData< T >::SampleData( SampleData< T > &&sa )
+  : Array<T>::Array( static_cast< Array<T>&& >( sa ) ),
+    Samples( sa.Samples )
+{
+  Samples.resize( Array<T>::size() );
+  sa.Samples.resize( 0 );
+}
+
+
 template < typename T > 
 SampleData< T >::~SampleData( void )
 {
@@ -1933,6 +1987,19 @@ const SampleData< T > &SampleData< T >::operator=( const SampleData< T > &a )
 }
 
 
+template < typename T >
+const SampleData< T > &SampleData< T >::operator=( SampleData< T > &&a )
+{
+  if ( &a == this )
+    return *this;
+
+  Samples = a.range();
+  Array<T>::operator=( static_cast< Array<T>&& >( a ) );
+  a.Samples.resize( 0 );
+  return *this;
+}
+
+
 template < typename T > template < typename R >
 const SampleData< T > &SampleData< T >::assign( const R *a, int n )
 {
@@ -2167,6 +2234,20 @@ const SampleData< T > &SampleData< T >::smooth( const SampleData< R > &sa,
 }
 
 
+template < typename T > template < typename R >
+const SampleData< T > &SampleData< T >::smooth( const SampleData< R > &sa,
+						const Kernel &kernel )
+{
+  vector< double > kv;
+  int i0 = kernel.sample( 0.0, sa.stepsize(), kv );
+  // the weights are the kernel values in reversed order:
+  ArrayD weights( kv.size() );
+  for ( unsigned int k=0; k<kv.size(); k++ )
+    weights[k] = kv[kv.size()-1-k];
+  return smooth( sa, weights, i0 + weights.size() - 1 );
+}
+
+
 template < typename T > template < typename R >
 SampleData< T > &SampleData< T >::whiteNoise( int n, double step,
 					      double cflow, double cfup, 
@@ -2199,17 +2280,24 @@ SampleData< T > &SampleData< T >::whiteNoise( int n, double step,
   Array<T> whitef( nn, 0 );
 
   // generating noise in fourier space:
+  int ninx1 = inx1 < nn/2 ? inx1 : nn/2-1;
+  int ng = ( inx0 <= 0 ? 1 : 0 ) + ( inx1 >= nn/2 ? 1 : 0 );
+  int i0 = inx0 <= 0 ? 1 : inx0;
+  if ( ninx1 >= i0 )
+    ng += 2*( ninx1 - i0 + 1 );
+  Array<T> gauss;
+  gauss.randNorm( ng, r );
+  int g = 0;
   if ( inx0 <= 0 ) {
-    whitef[0] = r.gaussian();
+    whitef[0] = gauss[g++];
     inx0++;
   }
-  int ninx1 = inx1 < nn/2 ? inx1 : nn/2-1;
   for ( int i=inx0; i <= ninx1; i++ ) {
-    whitef[i] = r.gaussian();
-    whitef[nn-i] = r.gaussian();
+    whitef[i] = gauss[g++];
+    whitef[nn-i] = gauss[g++];
   }
   if ( inx1 >= nn/2 )
-    whitef[nn/2] = r.gaussian();
+    whitef[nn/2] = gauss[g++];
 
   // fourier inversion and renormalization:
   hcFFT( whitef );
@@ -2685,6 +2773,8 @@ bool operator<( const SampleData<TT> &a, const SampleData<TT> &b )
 /* Used by macro SAMPLEDARRAYOPS2SCALARDEF to generate
    definitions for binary class friend operators 
    that take the class and a scalar as argument. 
+   A temporary SampleData argument is modified in place
+   and moved into the result.
    \a COPNAME is the operator name (like operator+ ),
    \a COP is the operator (like + ), and
    \a SCALAR is the type of the scalar argument. */
@@ -2714,6 +2804,30 @@ bool operator<( const SampleData<TT> &a, const SampleData<TT> &b )
     };									\
     return z;								\
   }									\
+									\
+  template < typename TT >						\
+  SampleData<TT> COPNAME( SCALAR x, SampleData<TT> &&y )		\
+  {									\
+    typename SampleData<TT>::iterator iter1 = y.begin();		\
+    typename SampleData<TT>::iterator end1 = y.end();			\
+    while ( iter1 != end1 ) {						\
+      (*iter1) = static_cast< typename SampleData<TT>::value_type >( x COP (*iter1) ); \
+      ++iter1;								\
+    };									\
+    return std::move( y );						\
+  }									\
+									\
+  template < typename TT >						\
+  SampleData<TT> COPNAME( SampleData<TT> &&x, SCALAR y )		\
+  {									\
+    typename SampleData<TT>::iterator iter1 = x.begin();		\
+    typename SampleData<TT>::iterator end1 = x.end();			\
+    while ( iter1 != end1 ) {						\
+      (*iter1) = static_cast< typename SampleData<TT>::value_type >( (*iter1) COP y ); \
+      ++iter1;								\
+    };									\
+    return std::move( x );						\
+  }									\
 
 
 /* Generates definitions for binary class member operators. 
@@ -2734,6 +2848,7 @@ bool operator<( const SampleData<TT> &a, const SampleData<TT> &b )
 
 /* Generates declarations for binary class friend operators
    that take other containers as the second argument or a scalar as either argument.
+   If the first argument is a temporary, the result is computed in place.
    \a COPNAME is the operator name (like operator+ ), and
    \a COP is the operator name (like += ). */
 #define SAMPLEDARRAYOPS2DEF( COPNAME, COP ) \
@@ -2753,6 +2868,21 @@ bool operator<( const SampleData<TT> &a, const SampleData<TT> &b )
     return z;								\
   }									\
 									\
+  template < typename TT, typename COT >				\
+    SampleData<TT> COPNAME( SampleData<TT> &&x, const COT &y )		\
+  {									\
+    typename SampleData<TT>::iterator iter1 = x.begin();		\
+    typename SampleData<TT>::iterator end1 = x.end();			\
+    typename COT::const_iterator iter2 = y.begin();			\
+    typename COT::const_iterator end2 = y.end();			\
+    while ( iter1 != end1 && iter2 != end2 ) {				\
+      (*iter1) = (*iter1) COP (*iter2);					\
+      ++iter1;								\
+      ++iter2;								\
+    };									\
+    return std::move( x );						\
+  }									\
+									\
   SAMPLEDARRAYOPS2SCALARDEF( COPNAME, COP ) \
 
 
@@ -1222,6 +1222,107 @@ template < typename ContainerX >
 void detrend( ContainerX &vecx );
 
 
+  /* Specializations for contiguous ranges of doubles and floats,
+     i.e. for Array, SampleData, and plain pointers.
+     They are implemented in stats.cc with SIMD instructions
+     and several independent accumulators.
+     Sums are computed by pairwise summation. */
+
+  /*! Minimum value of the range \a first, \a last of doubles. */
+double min( const double *first, const double *last );
+inline double min( double *first, double *last )
+{ return min( (const double*)first, (const double*)last ); }
+  /*! Maximum value of the range \a first, \a last of doubles. */
+double max( const double *first, const double *last );
+inline double max( double *first, double *last )
+{ return max( (const double*)first, (const double*)last ); }
+  /*! Minimum value \a min and maximum value \a max
+      of the range \a first, \a last of doubles. */
+void minMax( double &min, double &max, const double *first, const double *last );
+inline void minMax( double &min, double &max, double *first, double *last )
+{ minMax( min, max, (const double*)first, (const double*)last ); }
+  /*! Mean of the range \a firstx, \a lastx of doubles. */
+double mean( const double *firstx, const double *lastx );
+inline double mean( double *firstx, double *lastx )
+{ return mean( (const double*)firstx, (const double*)lastx ); }
+  /*! Mean and unbiased standard deviation \a stdev
+      of the range \a firstx, \a lastx of doubles. */
+double meanStdev( double &stdev, const double *firstx, const double *lastx );
+inline double meanStdev( double &stdev, double *firstx, double *lastx )
+{ return meanStdev( stdev, (const double*)firstx, (const double*)lastx ); }
+  /*! Unbiased variance of the range \a firstx, \a lastx of doubles. */
+double variance( const double *firstx, const double *lastx );
+inline double variance( double *firstx, double *lastx )
+{ return variance( (const double*)firstx, (const double*)lastx ); }
+  /*! Unbiased standard deviation of the range \a firstx, \a lastx of doubles. */
+double stdev( const double *firstx, const double *lastx );
+inline double stdev( double *firstx, double *lastx )
+{ return stdev( (const double*)firstx, (const double*)lastx ); }
+  /*! Root-mean-square of the range \a first, \a last of doubles. */
+double rms( const double *first, const double *last );
+inline double rms( double *first, double *last )
+{ return rms( (const double*)first, (const double*)last ); }
+  /*! Covariance of the two ranges \a firstx, \a lastx
+      and \a firsty, \a lasty of doubles. */
+double cov( const double *firstx, const double *lastx,
+	    const double *firsty, const double *lasty );
+inline double cov( double *firstx, double *lastx, double *firsty, double *lasty )
+{ return cov( (const double*)firstx, (const double*)lastx, (const double*)firsty, (const double*)lasty ); }
+  /*! Correlation coefficient of the two ranges \a firstx, \a lastx
+      and \a firsty, \a lasty of doubles. */
+double corrCoef( const double *firstx, const double *lastx,
+		 const double *firsty, const double *lasty );
+inline double corrCoef( double *firstx, double *lastx, double *firsty, double *lasty )
+{ return corrCoef( (const double*)firstx, (const double*)lastx, (const double*)firsty, (const double*)lasty ); }
+
+  /*! Minimum value of the range \a first, \a last of floats. */
+float min( const float *first, const float *last );
+inline float min( float *first, float *last )
+{ return min( (const float*)first, (const float*)last ); }
+  /*! Maximum value of the range \a first, \a last of floats. */
+float max( const float *first, const float *last );
+inline float max( float *first, float *last )
+{ return max( (const float*)first, (const float*)last ); }
+  /*! Minimum value \a min and maximum value \a max
+      of the range \a first, \a last of floats. */
+void minMax( float &min, float &max, const float *first, const float *last );
+inline void minMax( float &min, float &max, float *first, float *last )
+{ minMax( min, max, (const float*)first, (const float*)last ); }
+  /*! Mean of the range \a firstx, \a lastx of floats. */
+float mean( const float *firstx, const float *lastx );
+inline float mean( float *firstx, float *lastx )
+{ return mean( (const float*)firstx, (const float*)lastx ); }
+  /*! Mean and unbiased standard deviation \a stdev
+      of the range \a firstx, \a lastx of floats. */
+float meanStdev( float &stdev, const float *firstx, const float *lastx );
+inline float meanStdev( float &stdev, float *firstx, float *lastx )
+{ return meanStdev( stdev, (const float*)firstx, (const float*)lastx ); }
+  /*! Unbiased variance of the range \a firstx, \a lastx of floats. */
+float variance( const float *firstx, const float *lastx );
+inline float variance( float *firstx, float *lastx )
+{ return variance( (const float*)firstx, (const float*)lastx ); }
+  /*! Unbiased standard deviation of the range \a firstx, \a lastx of floats. */
+float stdev( const float *firstx, const float *lastx );
+inline float stdev( float *firstx, float *lastx )
+{ return stdev( (const float*)firstx, (const float*)lastx ); }
+  /*! Root-mean-square of the range \a first, \a last of floats. */
+float rms( const float *first, const float *last );
+inline float rms( float *first, float *last )
+{ return rms( (const float*)first, (const float*)last ); }
+  /*! Covariance of the two ranges \a firstx, \a lastx
+      and \a firsty, \a lasty of floats. */
+double cov( const float *firstx, const float *lastx,
+	    const float *firsty, const float *lasty );
+inline double cov( float *firstx, float *lastx, float *firsty, float *lasty )
+{ return cov( (const float*)firstx, (const float*)lastx, (const float*)firsty, (const float*)lasty ); }
+  /*! Correlation coefficient of the two ranges \a firstx, \a lastx
+      and \a firsty, \a lasty of floats. */
+double corrCoef( const float *firstx, const float *lastx,
+		 const float *firsty, const float *lasty );
+inline double corrCoef( float *firstx, float *lastx, float *firsty, float *lasty )
+{ return corrCoef( (const float*)firstx, (const float*)lastx, (const float*)firsty, (const float*)lasty ); }
+
+
 template < typename RandomIter >
 typename iterator_traits<RandomIter>::value_type
   median( RandomIter first, RandomIter last )
@@ -1872,7 +1973,7 @@ typename numerical_iterator_traits<ForwardIterX>::variance_type
       v += ( s*s - v ) / k;
     }
     k--;
-    v *= k/(k-1);
+    v *= double( k )/( k-1 );
   }
   return v;
 }
@@ -1899,7 +2000,7 @@ typename numerical_iterator_traits<ForwardIterX>::variance_type
   }
   if ( k > 2 ) {
     k--;
-    v *= k/(k-1);
+    v *= double( k )/( k-1 );
   }
   return v;
 }
@@ -2018,7 +2119,7 @@ typename numerical_iterator_traits<ForwardIterX>::variance_type
       v += ( s*s - v ) / k;
     }
     k--;
-    v *= k/(k-1);
+    v *= double( k )/( k-1 );
   }
   return ::sqrt( v );
 }
@@ -2045,7 +2146,7 @@ typename numerical_iterator_traits<ForwardIterX>::variance_type
   }
   if ( k > 2 ) {
     k--;
-    v *= k/(k-1);
+    v *= double( k )/( k-1 );
   }
   return ::sqrt( v );
 }
@@ -2593,7 +2694,8 @@ double cov( ForwardIterX firstx, ForwardIterX lastx,
     ++itery;
   }
 
-  return cv * (k/(k-1));
+  k--;
+  return k > 1 ? cv * k / ( k-1 ) : 0.0;
 }
 
 
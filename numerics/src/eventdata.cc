@@ -2508,6 +2508,67 @@ void EventData::setMeanRatio( double ratio )
 }
 
 
+  /*! Search the sorted \a buffer between indices \a l and \a r for
+      the first element larger than or equal to \a time (\a upper = \c false)
+      or larger than \a time (\a upper = \c true).
+      \a buffer[\a l] must be smaller than (or equal to) \a time
+      and \a buffer[\a r] must be larger than or equal to (larger than)
+      \a time, i.e. the returned index is in the range \a l+1 to \a r.
+      Since event rates are usually fairly constant,
+      the position is first guessed by linear interpolation
+      and then bracketed by an exponential search
+      around the guess, before bisecting in the remaining small interval.
+      For regular event times this touches only a few elements
+      close to the result instead of log2(r-l) elements all over the buffer. */
+static int searchEventTime( const double *buffer, int l, int r,
+			    double time, bool upper )
+{
+  if ( r-l > 16 ) {
+    double tl = buffer[l];
+    double tr = buffer[r];
+    int h = l + 1 + (int)( ( r-l-1 )*( ( time - tl )/( tr - tl ) ) );
+    if ( h <= l )
+      h = l+1;
+    else if ( h >= r )
+      h = r-1;
+    if ( buffer[h] < time || ( upper && buffer[h] == time ) ) {
+      // result is above h:
+      l = h;
+      for ( int step = 1; l+step < r; step *= 2 ) {
+	if ( buffer[l+step] < time || ( upper && buffer[l+step] == time ) )
+	  l += step;
+	else {
+	  r = l+step;
+	  break;
+	}
+      }
+    }
+    else {
+      // result is at or below h:
+      r = h;
+      for ( int step = 1; r-step > l; step *= 2 ) {
+	if ( buffer[r-step] < time || ( upper && buffer[r-step] == time ) ) {
+	  l = r-step;
+	  break;
+	}
+	else
+	  r -= step;
+      }
+    }
+  }
+
+  // bisect:
+  while ( r-l > 1 ) {
+    int h = (l+r)/2;
+    if ( buffer[h] < time || ( upper && buffer[h] == time ) )
+      l = h;
+    else
+      r = h;
+  }
+  return r;
+}
+
+
 int EventData::next( double time ) const
 {
   int l = 0;
@@ -2555,14 +2616,8 @@ int EventData::next( double time ) const
     return Index+l;
   }
 
-  // bisect:
-  while ( r-l > 1 ) {
-    int h = (l+r)/2;
-    if ( TimeBuffer[h] < time )
-      l = h;
-    else
-      r = h;
-  }
+  // search:
+  r = searchEventTime( TimeBuffer, l, r, time, false );
 
   if ( r >= R )
     r -= NBuffer;
@@ -2592,7 +2647,7 @@ int EventData::previous( double time ) const
   int r = 0;
 
   if ( !Cyclic || Index == 0 || R == NBuffer ||
-       Index < minEvent() || TimeBuffer[0] < time ) {
+       Index < minEvent() || TimeBuffer[0] <= time ) {
     // bisect in lower readable part of buffer:
     int n = R - NBuffer + NWrite;
     l = n < 0 ? 0 : n;
@@ -2628,14 +2683,8 @@ int EventData::previous( double time ) const
     return Index+r;
   }
 
-  // bisect:
-  while ( r-l > 1 ) {
-    int h = (l+r)/2;
-    if ( TimeBuffer[h] <= time )
-      l = h;
-    else
-      r = h;
-  }
+  // search:
+  l = searchEventTime( TimeBuffer, l, r, time, true ) - 1;
   
   if ( l >= R )
     l -= NBuffer;
@@ -2694,6 +2743,142 @@ int EventData::count( double time ) const
 }
 
 
+int EventData::nextFrom( int index, int step, double time, bool upper ) const
+{
+  int n = size();
+  if ( index >= n )
+    return n;
+  if ( index < minEvent() )
+    index = minEvent();
+
+  // contiguous part of the cyclic buffer containing index:
+  int l = index - Index;
+  int end = R;
+  if ( l < 0 ) {
+    l += NBuffer;
+    end = NBuffer;
+    if ( TimeBuffer[NBuffer-1] < time ||
+	 ( upper && TimeBuffer[NBuffer-1] == time ) ) {
+      // continue in the lower part of the buffer:
+      l = 0;
+      end = R;
+      if ( R == 0 )
+	return n;
+    }
+  }
+  if ( TimeBuffer[l] > time || ( ! upper && TimeBuffer[l] == time ) )
+    return l >= R ? Index + l - NBuffer : Index + l;
+
+  // exponential search starting with the expected distance:
+  int r = end;
+  if ( step < 1 )
+    step = 1;
+  for ( ; l+step < end; step *= 2 ) {
+    double t = TimeBuffer[l+step];
+    if ( t < time || ( upper && t == time ) )
+      l += step;
+    else {
+      r = l+step;
+      break;
+    }
+  }
+  if ( r >= end ) {
+    if ( r-l <= 1 || TimeBuffer[end-1] < time ||
+	 ( upper && TimeBuffer[end-1] == time ) )
+      // the end of the upper part continues with the lower part:
+      return end == NBuffer && R < NBuffer ? Index : n;
+    r = end-1;
+  }
+  r = searchEventTime( TimeBuffer, l, r, time, upper );
+  return r >= R ? Index + r - NBuffer : Index + r;
+}
+
+
+void EventData::next( const ArrayD &times, ArrayI &indices ) const
+{
+  indices.resize( times.size() );
+  if ( times.empty() )
+    return;
+  int index = next( times[0] );
+  int step = 1;
+  indices[0] = index;
+  for ( int k=1; k<times.size(); k++ ) {
+    int prev = index;
+    if ( times[k] < times[k-1] )
+      index = next( times[k] );
+    else
+      index = nextFrom( index, step, times[k], false );
+    step = index - prev;
+    indices[k] = index;
+  }
+}
+
+
+void EventData::previous( const ArrayD &times, ArrayI &indices ) const
+{
+  indices.resize( times.size() );
+  if ( times.empty() )
+    return;
+  int index = previous( times[0] );
+  int step = 1;
+  indices[0] = index;
+  for ( int k=1; k<times.size(); k++ ) {
+    int prev = index;
+    if ( times[k] < times[k-1] )
+      index = previous( times[k] );
+    else {
+      // index behind the previous event:
+      int first = index < minEvent() ? minEvent() : index + 1;
+      index = nextFrom( first, step, times[k], true ) - 1;
+      if ( index < minEvent() )
+	index = -1;
+    }
+    step = index - prev;
+    indices[k] = index;
+  }
+}
+
+
+void EventData::count( const ArrayD &tbegin, const ArrayD &tend,
+		       ArrayI &counts ) const
+{
+  int m = tbegin.size() < tend.size() ? tbegin.size() : tend.size();
+  counts.resize( m );
+  if ( m == 0 )
+    return;
+  // merge the begins and the ends of the windows in a single pass,
+  // so that both work on the same part of the buffer:
+  int n = next( tbegin[0] );
+  int p = previous( tend[0] );
+  int nstep = 1;
+  int pstep = 1;
+  for ( int k=0; k<m; k++ ) {
+    if ( k > 0 ) {
+      int prevn = n;
+      if ( tbegin[k] < tbegin[k-1] )
+	n = next( tbegin[k] );
+      else
+	n = nextFrom( n, nstep, tbegin[k], false );
+      nstep = n - prevn;
+      int prevp = p;
+      if ( tend[k] < tend[k-1] )
+	p = previous( tend[k] );
+      else {
+	int first = p < minEvent() ? minEvent() : p + 1;
+	p = nextFrom( first, pstep, tend[k], true ) - 1;
+	if ( p < minEvent() )
+	  p = -1;
+      }
+      pstep = p - prevp;
+    }
+    if ( p < n || p < 0 || tend[k] <= tbegin[k] )
+      counts[k] = 0;
+    else
+      counts[k] = p - n + 1;
+  }
+}
+
+
 double EventData::rate( double tbegin, double tend ) const
 {
   int n = next( tbegin );
@@ -2841,16 +3026,16 @@ void EventData::rate( SampleDataD &rate, const Kernel &kernel,
   double offs = time + rate.pos( 0 );
   int n = next( offs );
   int p = previous( offs + rate.length() );
+  vector< double > kv;
   for ( int k=n; k<=p; k++ ) {
     int bin = rate.index( (*this)[k] - time );
     double dt = (*this)[k] - time - rate.pos( bin );
-    for ( int i = rate.indices( kernel.left() ); 
-	  i<rate.indices( kernel.right() );
-	  i++ ) {
-      int inx = bin+i;
-      if ( inx >= 0 && inx < rate.size() )
-	rate[inx] += kernel.value( rate.interval( i ) + dt );
-    }
+    // stamp the kernel around the event:
+    int inx = bin + kernel.sample( dt, rate.stepsize(), kv );
+    int i0 = inx < 0 ? -inx : 0;
+    int i1 = inx + (int)kv.size() > rate.size() ? rate.size() - inx : kv.size();
+    for ( int i=i0; i<i1; i++ )
+      rate[inx+i] += kv[i];
   }
 }
 
@@ -2863,16 +3048,16 @@ void EventData::addRate( SampleDataD &rate, int &trials, const Kernel &kernel,
   double offs = time + rate.pos( 0 );
   int n = next( offs );
   int p = previous( offs + rate.length() );
+  vector< double > kv;
   for ( int k=n; k<=p; k++ ) {
     int bin = rate.index( (*this)[k] - time );
     double dt = (*this)[k] - time - rate.pos( bin );
-    for ( int i = rate.indices( kernel.left() ); 
-	  i<rate.indices( kernel.right() );
-	  i++ ) {
-      int inx = bin+i;
-      if ( inx >= 0 && inx < rr.size() )
-	rr[inx] += kernel.value( rate.interval( i ) + dt );
-    }
+    // stamp the kernel around the event:
+    int inx = bin + kernel.sample( dt, rate.stepsize(), kv );
+    int i0 = inx < 0 ? -inx : 0;
+    int i1 = inx + (int)kv.size() > rr.size() ? rr.size() - inx : kv.size();
+    for ( int i=i0; i<i1; i++ )
+      rr[inx+i] += kv[i];
   }
 
   trials++;
@@ -2899,18 +3084,20 @@ void EventData::addCyclicRate( SampleDataD &rate, int &trials,
 
   int n = next( time + rate.rangeFront() );
   int p = previous( time + rate.rangeBack() );
+  vector< double > kv;
   for ( int k=n; k<=p; k++ ) {
     int bin = rate.index( (*this)[k] - time );
     double dt = (*this)[k] - time - rate.pos( bin );
-    for ( int i = rate.indices( kernel.left() ); 
-	  i<rate.indices( kernel.right() );
-	  i++ ) {
-      int inx = bin+i;
-      while ( inx < 0 )
-	inx += rate.size();
-      while ( inx >= rate.size() )
-	inx -= rate.size();
-      rr[inx] += kernel.value( rate.interval( i ) + dt );
+    // stamp the kernel around the event:
+    int inx = bin + kernel.sample( dt, rate.stepsize(), kv );
+    while ( inx < 0 )
+      inx += rate.size();
+    while ( inx >= rate.size() )
+      inx -= rate.size();
+    for ( unsigned int i=0; i<kv.size(); i++ ) {
+      rr[inx] += kv[i];
+      if ( ++inx >= rate.size() )
+	inx = 0;
     }
   }
 
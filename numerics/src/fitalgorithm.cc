@@ -112,6 +112,44 @@ void covarSort( vector< ArrayD > &covar, const ArrayI &paramfit, int mfit )
 }
 
 
+MarquardtStats::MarquardtStats( void )
+  : Error( 0 ),
+    Iterations( 0 ),
+    DataPoints( 0 ),
+    ChiSq( HUGE_VAL ),
+    ResidualMean( 0.0 ),
+    ResidualRMS( 0.0 )
+{
+}
+
+
+MarquardtWorkspace::MarquardtWorkspace( void )
+  : FitFlag( true )
+{
+}
+
+
+void MarquardtWorkspace::resize( int nparams, int ndata )
+{
+  X.resize( ndata );
+  Y.resize( ndata );
+  W.resize( ndata );
+  F.resize( ndata );
+  if ( (int)DFDP.size() != nparams )
+    DFDP.resize( nparams );
+  for ( int k=0; k<nparams; k++ )
+    DFDP[k].resize( ndata );
+  if ( (int)Alpha.size() != nparams ) {
+    Alpha.assign( nparams, ArrayD( nparams, 0.0 ) );
+    Covar.assign( nparams, ArrayD( nparams, 0.0 ) );
+    Beta.resize( nparams );
+    OneDA.resize( nparams );
+    DA.resize( nparams );
+    ATry.resize( nparams );
+  }
+}
+
+
 double expFunc( double x, const ArrayD &p )
 {
   return p[0] * ::exp( x / p[1] ) + p[2];
@@ -129,6 +167,22 @@ double expFuncDerivs( double x, const ArrayD &p, ArrayD &dfdp )
 }
 
 
+void expFuncJacobian( const ArrayD &x, const ArrayD &p,
+		      ArrayD &y, vector< ArrayD > &dfdp )
+{
+  double p0 = p[0];
+  double p1 = p[1];
+  double p2 = p[2];
+  for ( int i=0; i<x.size(); i++ ) {
+    double ex = ::exp( x[i] / p1 );
+    y[i] = p0 * ex + p2;
+    dfdp[0][i] = ex;
+    dfdp[1][i] = -p0 * ex * ( x[i] / p1 ) / p1;
+    dfdp[2][i] = 1.0;
+  }
+}
+
+
 void expGuess( ArrayD &p, double y0, double x1, double y1,
 	       double x2, double y2 )
 {
@@ -160,6 +214,27 @@ double sineFuncDerivs( double x, const ArrayD &p, ArrayD &dfdp )
 }
 
 
+void sineFuncJacobian( const ArrayD &x, const ArrayD &p,
+		       ArrayD &y, vector< ArrayD > &dfdp )
+{
+  double p0 = p[0];
+  double p1 = p[1];
+  double p2 = p[2];
+  double p3 = p[3];
+  for ( int i=0; i<x.size(); i++ ) {
+    double t = 2.0*M_PI*x[i];
+    double a = t*p2 + p3;
+    double s = ::sin( a );
+    double c = p1*::cos( a );
+    y[i] = p0 + p1*s;
+    dfdp[0][i] = 1.0;
+    dfdp[1][i] = s;
+    dfdp[2][i] = c*t;
+    dfdp[3][i] = c;
+  }
+}
+
+
 int ludcmp( vector< ArrayD > &a, int n, ArrayI &indx, double *d )
 {
   const double TINY = 1.0e-20;
@@ -31,6 +31,78 @@ double Kernel::value( double x ) const
 }
 
 
+void Kernel::values( double x, double dx, int n, double *y ) const
+{
+  for ( int k=0; k<n; k++ )
+    y[k] = value( x + k*dx );
+}
+
+
+int Kernel::sample( double dt, double stepsize, vector< double > &y ) const
+{
+  if ( tabulated( stepsize ) ) {
+    y.resize( TableSize );
+    double q = dt * TableResolution / TableStep;
+    int p = (int)::floor( q );
+    if ( p < 0 )
+      p = 0;
+    else if ( p >= TableResolution )
+      p = TableResolution - 1;
+    double f = q - p;
+    const double *t0 = &Table[p*TableSize];
+    const double *t1 = t0 + TableSize;
+    for ( int i=0; i<TableSize; i++ )
+      y[i] = t0[i] + f * ( t1[i] - t0[i] );
+    return TableOffset;
+  }
+
+  int i0 = (int)::floor( left()/stepsize + 1.0e-6 );
+  int i1 = (int)::floor( right()/stepsize + 1.0e-6 );
+  int n = i1 > i0 ? i1 - i0 : 0;
+  y.resize( n );
+  if ( n > 0 )
+    values( i0*stepsize + dt, stepsize, n, &y[0] );
+  return i0;
+}
+
+
+void Kernel::tabulate( double stepsize, int resolution )
+{
+  if ( resolution < 1 )
+    resolution = 1;
+  TableStep = stepsize;
+  TableScale = scale();
+  TableResolution = resolution;
+  TableOffset = (int)::floor( left()/stepsize + 1.0e-6 );
+  int i1 = (int)::floor( right()/stepsize + 1.0e-6 );
+  TableSize = i1 > TableOffset ? i1 - TableOffset : 0;
+  Table.resize( ( resolution + 1 ) * TableSize );
+  if ( TableSize <= 0 )
+    return;
+  for ( int p=0; p<=resolution; p++ )
+    values( TableOffset*stepsize + p*stepsize/resolution, stepsize,
+	    TableSize, &Table[p*TableSize] );
+}
+
+
+bool Kernel::tabulated( double stepsize ) const
+{
+  return ( TableResolution > 0 && TableScale == scale() &&
+	   ::fabs( stepsize - TableStep ) <= 1.0e-8 * TableStep );
+}
+
+
+void Kernel::clearTable( void )
+{
+  Table.clear();
+  TableStep = 0.0;
+  TableScale = 0.0;
+  TableResolution = 0;
+  TableOffset = 0;
+  TableSize = 0;
+}
+
+
 void Kernel::setScale( double scale )
 {
   Scale = scale;
@@ -138,6 +210,13 @@ double RectKernel::value( double x ) const
 }
 
 
+void RectKernel::values( double x, double dx, int n, double *y ) const
+{
+  for ( int k=0; k<n; k++ )
+    y[k] = operator()( x + k*dx );
+}
+
+
 void RectKernel::setScale( double scale )
 {
   Kernel::setScale( scale );
@@ -198,6 +277,13 @@ double TriangularKernel::value( double x ) const
 }
 
 
+void TriangularKernel::values( double x, double dx, int n, double *y ) const
+{
+  for ( int k=0; k<n; k++ )
+    y[k] = operator()( x + k*dx );
+}
+
+
 void TriangularKernel::setScale( double scale )
 {
   Kernel::setScale( scale );
@@ -271,6 +357,13 @@ double EpanechnikovKernel::value( double x ) const
 }
 
 
+void EpanechnikovKernel::values( double x, double dx, int n, double *y ) const
+{
+  for ( int k=0; k<n; k++ )
+    y[k] = operator()( x + k*dx );
+}
+
+
 void EpanechnikovKernel::setScale( double scale )
 {
   setStdev( ::pow( 0.75, 1.0/3.0 ) * ::pow( scale, 2.0/3.0 ) / sqrt( 5.0 ) );
@@ -347,6 +440,33 @@ double GaussKernel::value( double x ) const
 }
 
 
+void GaussKernel::values( double x, double dx, int n, double *y ) const
+{
+  // exp( -z^2/2 ) at z+dz is exp( -z^2/2 ) times exp( -z*dz - dz^2/2 ),
+  // and this factor is multiplied by exp( -dz^2 ) for each step:
+  double dz = dx/scale();
+  double c = exp( -dz*dz );
+  for ( int k=0; k<n; ) {
+    // start with an exact value every 32 steps:
+    double z = ( x + k*dx )/scale();
+    double g = Norm * exp( -0.5*z*z );
+    double r = exp( -z*dz - 0.5*dz*dz );
+    int kn = k + 32 < n ? k + 32 : n;
+    if ( g == 0.0 || r > 1.0e300 ) {
+      // far in the tails:
+      for ( ; k<kn; k++ )
+	y[k] = operator()( x + k*dx );
+      continue;
+    }
+    for ( ; k<kn; k++ ) {
+      y[k] = g;
+      g *= r;
+      r *= c;
+    }
+  }
+}
+
+
 void GaussKernel::setScale( double scale )
 {
   Kernel::setScale( scale );
@@ -432,6 +552,13 @@ double GammaKernel::value( double x ) const
 }
 
 
+void GammaKernel::values( double x, double dx, int n, double *y ) const
+{
+  for ( int k=0; k<n; k++ )
+    y[k] = operator()( x + k*dx );
+}
+
+
 void GammaKernel::setScale( double scale )
 {
   Kernel::setScale( scale );
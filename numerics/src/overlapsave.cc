@@ -0,0 +1,157 @@
+/*
+  overlapsave.cc
+  Convolution of a stream of data with a filter by FFT overlap-save.
+
+  RELACS - Relaxed ELectrophysiological data Acquisition, Control, and Stimulation
+  Copyright (C) 2002-2015 Jan Benda <jan.benda@uni-tuebingen.de>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+  
+  RELACS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <relacs/spectrum.h>
+#include <relacs/overlapsave.h>
+
+namespace relacs {
+
+
+OverlapSave::OverlapSave( void )
+  : Size( 0 ),
+    Offset( 0 ),
+    NFFT( 0 ),
+    Block( 0 ),
+    Skip( 0 ),
+    BufferIndex( 0 ),
+    OutputOffset( 0 )
+{
+}
+
+
+OverlapSave::OverlapSave( const double *h, int n, int offs )
+{
+  setFilter( h, n, offs );
+}
+
+
+void OverlapSave::setFilter( const double *h, int n, int offs, int minfft )
+{
+  Size = n > 0 ? n : 0;
+  Offset = offs;
+  NFFT = Size > 0 ? nextPowerOfTwo( 4*Size > minfft ? 4*Size : minfft ) : 0;
+  Block = NFFT - Size + 1;
+  H.assign( NFFT, 0.0 );
+  for ( int k=0; k<Size; k++ )
+    H[k] = h[k];
+  rFFT( H.begin(), H.end() );
+  // include normalization of the inverse transform:
+  for ( int k=0; k<NFFT; k++ )
+    H[k] /= NFFT;
+  Buffer.assign( NFFT, 0.0 );
+  Output.assign( NFFT, 0.0 );
+  reset();
+}
+
+
+void OverlapSave::reset( void )
+{
+  for ( unsigned int k=0; k<Buffer.size(); k++ )
+    Buffer[k] = 0.0;
+  BufferIndex = Size > 0 ? Size - 1 : 0;
+  OutputOffset = 0;
+  Skip = Offset;
+}
+
+
+int OverlapSave::filterSize( void ) const
+{
+  return Size;
+}
+
+
+int OverlapSave::blockSize( void ) const
+{
+  return Block;
+}
+
+
+int OverlapSave::fftSize( void ) const
+{
+  return NFFT;
+}
+
+
+int OverlapSave::push( double x )
+{
+  if ( NFFT <= 0 )
+    return 0;
+
+  Buffer[BufferIndex++] = x;
+  if ( BufferIndex < NFFT )
+    return 0;
+
+  process();
+
+  // valid output is in the last Block elements:
+  int n = Block;
+  OutputOffset = Size - 1;
+  if ( Skip > 0 ) {
+    // discard non-causal part:
+    int s = Skip < n ? Skip : n;
+    OutputOffset += s;
+    n -= s;
+    Skip -= s;
+  }
+  else if ( Skip < 0 ) {
+    // delay by prepending zeros:
+    int s = -Skip;
+    vector< double > delayed( s + n, 0.0 );
+    for ( int k=0; k<n; k++ )
+      delayed[s+k] = Output[OutputOffset+k];
+    Output.swap( delayed );
+    OutputOffset = 0;
+    n += s;
+    Skip = 0;
+  }
+  return n;
+}
+
+
+void OverlapSave::process( void )
+{
+  if ( (int)Output.size() != NFFT )
+    Output.resize( NFFT );
+  for ( int k=0; k<NFFT; k++ )
+    Output[k] = Buffer[k];
+
+  // convolve:
+  rFFT( Output.begin(), Output.end() );
+  int n2 = NFFT/2;
+  Output[0] *= H[0];
+  Output[n2] *= H[n2];
+  for ( int k=1; k<n2; k++ ) {
+    double re = Output[k];
+    double im = Output[NFFT-k];
+    Output[k] = re*H[k] - im*H[NFFT-k];
+    Output[NFFT-k] = re*H[NFFT-k] + im*H[k];
+  }
+  hcFFT( Output.begin(), Output.end() );
+
+  // keep the last Size-1 data elements:
+  for ( int k=0; k<Size-1; k++ )
+    Buffer[k] = Buffer[Block+k];
+  BufferIndex = Size > 0 ? Size - 1 : 0;
+}
+
+
+}; /* namespace relacs */
+
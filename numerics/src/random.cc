@@ -20,7 +20,12 @@
 */
 
 #include <cmath>
+#include <cstring>
+#include <climits>
 #include <iostream>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 #include <relacs/random.h>
 using namespace std;
 
@@ -70,6 +75,34 @@ double RandomBase::gamma( int a )
 }
 
 
+void RandomBase::fill( double *x, int n )
+{
+  for ( int k=0; k<n; k++ )
+    x[k] = uniform();
+}
+
+
+void RandomBase::fill( float *x, int n )
+{
+  for ( int k=0; k<n; k++ )
+    x[k] = uniform();
+}
+
+
+void RandomBase::fillGaussian( double *x, int n )
+{
+  for ( int k=0; k<n; k++ )
+    x[k] = gaussian();
+}
+
+
+void RandomBase::fillGaussian( float *x, int n )
+{
+  for ( int k=0; k<n; k++ )
+    x[k] = gaussian();
+}
+
+
 RandomStd::RandomStd( void )
   : ISet( 0 ) 
 {
@@ -359,6 +392,352 @@ string Ran3::name( void )
 }
 
 
+namespace {
+
+
+inline uint64_t rotl( uint64_t x, int k )
+{
+  return ( x << k ) | ( x >> ( 64 - k ) );
+}
+
+
+  /* One step of a single xoshiro256 generator. */
+inline void xoshiroStep( uint64_t s[4] )
+{
+  uint64_t t = s[1] << 17;
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = rotl( s[3], 45 );
+}
+
+
+  /* Advance the generator s by the jump polynomial jp. */
+void xoshiroJump( uint64_t s[4], const uint64_t jp[4] )
+{
+  uint64_t j[4] = { 0, 0, 0, 0 };
+  for ( int i=0; i<4; i++ ) {
+    for ( int b=0; b<64; b++ ) {
+      if ( jp[i] & ( uint64_t(1) << b ) ) {
+	for ( int k=0; k<4; k++ )
+	  j[k] ^= s[k];
+      }
+      xoshiroStep( s );
+    }
+  }
+  for ( int k=0; k<4; k++ )
+    s[k] = j[k];
+}
+
+
+  /* Jump by 2^128 steps. */
+const uint64_t XoshiroJump[4] = { 0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+				  0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+  /* Jump by 2^192 steps. */
+const uint64_t XoshiroLongJump[4] = { 0x76e15d3efefdcbbfULL, 0xc5004e441c522fb3ULL,
+				      0x77710069854ee241ULL, 0x39109bb02acbe635ULL };
+
+
+  /* Tables of the ziggurat algorithm with 256 layers
+     (Marsaglia & Tsang 2000, Doornik 2005). */
+struct ZigguratTables
+{
+  static const int Layers = 256;
+  double X[Layers+1];
+  double Ratio[Layers];
+  static constexpr double R = 3.6541528853610088;
+  static constexpr double V = 0.00492867323399;
+
+  ZigguratTables( void )
+  {
+    double f = ::exp( -0.5*R*R );
+    X[0] = V / f;
+    X[1] = R;
+    for ( int i=2; i<Layers; i++ ) {
+      X[i] = ::sqrt( -2.0*::log( V/X[i-1] + f ) );
+      f = ::exp( -0.5*X[i]*X[i] );
+    }
+    X[Layers] = 0.0;
+    for ( int i=0; i<Layers; i++ )
+      Ratio[i] = X[i+1]/X[i];
+  }
+};
+
+
+const ZigguratTables &zigguratTables( void )
+{
+  static const ZigguratTables zt;
+  return zt;
+}
+
+
+  /* A uniform random number in [0,1) with 52 bits resolution
+     from the upper bits of \a b. */
+inline double uniform52( uint64_t b )
+{
+  uint64_t u = ( b >> 12 ) | 0x3ff0000000000000ULL;
+  double d;
+  memcpy( &d, &u, sizeof( d ) );
+  return d - 1.0;
+}
+
+
+}
+
+
+RandomXoshiro::RandomXoshiro( void )
+{
+  setSeed( 0, 0 );
+}
+
+
+RandomXoshiro::RandomXoshiro( unsigned long seed, int stream )
+{
+  setSeed( seed, stream );
+}
+
+
+RandomXoshiro::~RandomXoshiro( void )
+{
+}
+
+
+unsigned long RandomXoshiro::setSeed( unsigned long seed )
+{
+  return setSeed( seed, Stream );
+}
+
+
+unsigned long RandomXoshiro::setSeed( unsigned long seed, int stream )
+{
+  if ( seed == 0 )
+    seed = (long)( time(NULL) | 1 );
+  Stream = stream >= 0 ? stream : 0;
+
+  // initialize state with splitmix64:
+  uint64_t x = seed;
+  uint64_t s[4];
+  for ( int k=0; k<4; k++ ) {
+    uint64_t z = ( x += 0x9e3779b97f4a7c15ULL );
+    z = ( z ^ ( z >> 30 ) ) * 0xbf58476d1ce4e5b9ULL;
+    z = ( z ^ ( z >> 27 ) ) * 0x94d049bb133111ebULL;
+    s[k] = z ^ ( z >> 31 );
+  }
+
+  // select stream:
+  for ( int k=0; k<Stream; k++ )
+    xoshiroJump( s, XoshiroLongJump );
+
+  // lanes:
+  for ( int l=0; l<Lanes; l++ ) {
+    if ( l > 0 )
+      xoshiroJump( s, XoshiroJump );
+    for ( int k=0; k<4; k++ )
+      State[k][l] = s[k];
+  }
+
+  BitsPos = BitsSize;
+  GaussPos = GaussSize;
+  return seed;
+}
+
+
+int RandomXoshiro::stream( void ) const
+{
+  return Stream;
+}
+
+
+void RandomXoshiro::next( uint64_t *bits, int n )
+{
+#ifdef __SSE2__
+  __m128i s0a = _mm_loadu_si128( (const __m128i*)&State[0][0] );
+  __m128i s0b = _mm_loadu_si128( (const __m128i*)&State[0][2] );
+  __m128i s1a = _mm_loadu_si128( (const __m128i*)&State[1][0] );
+  __m128i s1b = _mm_loadu_si128( (const __m128i*)&State[1][2] );
+  __m128i s2a = _mm_loadu_si128( (const __m128i*)&State[2][0] );
+  __m128i s2b = _mm_loadu_si128( (const __m128i*)&State[2][2] );
+  __m128i s3a = _mm_loadu_si128( (const __m128i*)&State[3][0] );
+  __m128i s3b = _mm_loadu_si128( (const __m128i*)&State[3][2] );
+  for ( int k=0; k<n; k += Lanes ) {
+    _mm_storeu_si128( (__m128i*)&bits[k], _mm_add_epi64( s0a, s3a ) );
+    _mm_storeu_si128( (__m128i*)&bits[k+2], _mm_add_epi64( s0b, s3b ) );
+    __m128i ta = _mm_slli_epi64( s1a, 17 );
+    __m128i tb = _mm_slli_epi64( s1b, 17 );
+    s2a = _mm_xor_si128( s2a, s0a );
+    s2b = _mm_xor_si128( s2b, s0b );
+    s3a = _mm_xor_si128( s3a, s1a );
+    s3b = _mm_xor_si128( s3b, s1b );
+    s1a = _mm_xor_si128( s1a, s2a );
+    s1b = _mm_xor_si128( s1b, s2b );
+    s0a = _mm_xor_si128( s0a, s3a );
+    s0b = _mm_xor_si128( s0b, s3b );
+    s2a = _mm_xor_si128( s2a, ta );
+    s2b = _mm_xor_si128( s2b, tb );
+    s3a = _mm_or_si128( _mm_slli_epi64( s3a, 45 ), _mm_srli_epi64( s3a, 19 ) );
+    s3b = _mm_or_si128( _mm_slli_epi64( s3b, 45 ), _mm_srli_epi64( s3b, 19 ) );
+  }
+  _mm_storeu_si128( (__m128i*)&State[0][0], s0a );
+  _mm_storeu_si128( (__m128i*)&State[0][2], s0b );
+  _mm_storeu_si128( (__m128i*)&State[1][0], s1a );
+  _mm_storeu_si128( (__m128i*)&State[1][2], s1b );
+  _mm_storeu_si128( (__m128i*)&State[2][0], s2a );
+  _mm_storeu_si128( (__m128i*)&State[2][2], s2b );
+  _mm_storeu_si128( (__m128i*)&State[3][0], s3a );
+  _mm_storeu_si128( (__m128i*)&State[3][2], s3b );
+#else
+  for ( int k=0; k<n; k += Lanes ) {
+    for ( int l=0; l<Lanes; l++ ) {
+      uint64_t s[4] = { State[0][l], State[1][l], State[2][l], State[3][l] };
+      bits[k+l] = s[0] + s[3];
+      xoshiroStep( s );
+      for ( int i=0; i<4; i++ )
+	State[i][l] = s[i];
+    }
+  }
+#endif
+}
+
+
+unsigned long RandomXoshiro::integer( void )
+{
+  return (unsigned long)( next() >> ( 64 - 8*sizeof( unsigned long ) ) );
+}
+
+
+unsigned long RandomXoshiro::min( void ) const
+{
+  return 0;
+}
+
+
+unsigned long RandomXoshiro::max( void ) const
+{
+  return ULONG_MAX;
+}
+
+
+double RandomXoshiro::uniform( void )
+{
+  return uniform53();
+}
+
+
+double RandomXoshiro::gaussian( void )
+{
+  if ( GaussPos >= GaussSize ) {
+    ziggurat( Gauss, GaussSize );
+    GaussPos = 0;
+  }
+  return Gauss[GaussPos++];
+}
+
+
+void RandomXoshiro::fill( double *x, int n )
+{
+  const int bn = 256;
+  uint64_t b[bn];
+  while ( n > 0 ) {
+    int m = n < bn ? n : bn;
+    next( b, ( m + Lanes - 1 ) / Lanes * Lanes );
+    for ( int k=0; k<m; k++ )
+      x[k] = uniform52( b[k] );
+    x += m;
+    n -= m;
+  }
+}
+
+
+void RandomXoshiro::fill( float *x, int n )
+{
+  const int bn = 256;
+  uint64_t b[bn];
+  while ( n > 0 ) {
+    // two floats with 23 bits resolution from each word:
+    int m = n < 2*bn ? n : 2*bn;
+    next( b, ( (m+1)/2 + Lanes - 1 ) / Lanes * Lanes );
+    for ( int k=0; k<m; k++ ) {
+      uint32_t u = ( k & 1 ) ? uint32_t( b[k/2] >> 41 ) : uint32_t( b[k/2] >> 9 ) & 0x7fffff;
+      u |= 0x3f800000;
+      float f;
+      memcpy( &f, &u, sizeof( f ) );
+      x[k] = f - 1.0f;
+    }
+    x += m;
+    n -= m;
+  }
+}
+
+
+void RandomXoshiro::ziggurat( double *x, int n )
+{
+  const ZigguratTables &zt = zigguratTables();
+  const int bn = 256;
+  uint64_t b[bn];
+  int bi = bn;
+  for ( int k=0; k<n; ) {
+    if ( bi >= bn ) {
+      next( b, bn );
+      bi = 0;
+    }
+    uint64_t r = b[bi++];
+    // layer from bits 3-10, signed uniform from bits 12-63:
+    int i = ( r >> 3 ) & 0xff;
+    double u = 2.0*uniform52( r ) - 1.0;
+    // inside the rectangle of the layer (about 99% of the cases):
+    if ( ::fabs( u ) < zt.Ratio[i] ) {
+      x[k++] = u*zt.X[i];
+      continue;
+    }
+    if ( i == 0 ) {
+      // sample from the tail:
+      double xt, yt;
+      do {
+	xt = -::log( 1.0 - uniform53() ) / ZigguratTables::R;
+	yt = -::log( 1.0 - uniform53() );
+      } while ( yt + yt < xt*xt );
+      x[k++] = u < 0.0 ? -ZigguratTables::R - xt : ZigguratTables::R + xt;
+      continue;
+    }
+    // wedge:
+    double xw = u*zt.X[i];
+    double f0 = ::exp( -0.5*( zt.X[i]*zt.X[i] - xw*xw ) );
+    double f1 = ::exp( -0.5*( zt.X[i+1]*zt.X[i+1] - xw*xw ) );
+    if ( f1 + uniform53()*( f0 - f1 ) < 1.0 )
+      x[k++] = xw;
+  }
+}
+
+
+void RandomXoshiro::fillGaussian( double *x, int n )
+{
+  ziggurat( x, n );
+}
+
+
+void RandomXoshiro::fillGaussian( float *x, int n )
+{
+  const int bn = 256;
+  double g[bn];
+  while ( n > 0 ) {
+    int m = n < bn ? n : bn;
+    ziggurat( g, m );
+    for ( int k=0; k<m; k++ )
+      x[k] = g[k];
+    x += m;
+    n -= m;
+  }
+}
+
+
+string RandomXoshiro::name( void )
+{
+  return "xoshiro256+";
+}
+
+
 #ifdef HAVE_LIBRAND55
 
 
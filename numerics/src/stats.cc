@@ -0,0 +1,551 @@
+/*
+  stats.cc
+  Vectorized kernels of the statistics functions for contiguous ranges of doubles and floats.
+
+  RELACS - Relaxed ELectrophysiological data Acquisition, Control, and Stimulation
+  Copyright (C) 2002-2015 Jan Benda <jan.benda@uni-tuebingen.de>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+  
+  RELACS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cmath>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include <relacs/stats.h>
+
+namespace relacs {
+
+
+namespace {
+
+
+  /* Ranges up to this size are summed up directly,
+     larger ranges are split in halves (pairwise summation). */
+const int PairwiseBlock = 256;
+
+
+  /* A vector of Width numbers of type T.
+     This is the scalar fallback with Width equal one. */
+template < typename T >
+struct SimdVec
+{
+  static const int Width = 1;
+  T V;
+  static SimdVec load( const T *p ) { SimdVec r; r.V = *p; return r; }
+  static SimdVec set( T x ) { SimdVec r; r.V = x; return r; }
+  SimdVec operator+( const SimdVec &b ) const { return set( V + b.V ); }
+  SimdVec operator-( const SimdVec &b ) const { return set( V - b.V ); }
+  SimdVec operator*( const SimdVec &b ) const { return set( V * b.V ); }
+  SimdVec min( const SimdVec &b ) const { return set( b.V < V ? b.V : V ); }
+  SimdVec max( const SimdVec &b ) const { return set( b.V > V ? b.V : V ); }
+  T sum( void ) const { return V; }
+  T minValue( void ) const { return V; }
+  T maxValue( void ) const { return V; }
+};
+
+
+#ifdef __SSE2__
+
+template <>
+struct SimdVec< double >
+{
+  static const int Width = 2;
+  __m128d V;
+  static SimdVec load( const double *p ) { SimdVec r; r.V = _mm_loadu_pd( p ); return r; }
+  static SimdVec set( double x ) { SimdVec r; r.V = _mm_set1_pd( x ); return r; }
+  static SimdVec make( __m128d v ) { SimdVec r; r.V = v; return r; }
+  SimdVec operator+( const SimdVec &b ) const { return make( _mm_add_pd( V, b.V ) ); }
+  SimdVec operator-( const SimdVec &b ) const { return make( _mm_sub_pd( V, b.V ) ); }
+  SimdVec operator*( const SimdVec &b ) const { return make( _mm_mul_pd( V, b.V ) ); }
+  SimdVec min( const SimdVec &b ) const { return make( _mm_min_pd( V, b.V ) ); }
+  SimdVec max( const SimdVec &b ) const { return make( _mm_max_pd( V, b.V ) ); }
+  double sum( void ) const
+  {
+    return _mm_cvtsd_f64( _mm_add_sd( V, _mm_unpackhi_pd( V, V ) ) );
+  }
+  double minValue( void ) const
+  {
+    return _mm_cvtsd_f64( _mm_min_sd( V, _mm_unpackhi_pd( V, V ) ) );
+  }
+  double maxValue( void ) const
+  {
+    return _mm_cvtsd_f64( _mm_max_sd( V, _mm_unpackhi_pd( V, V ) ) );
+  }
+};
+
+
+template <>
+struct SimdVec< float >
+{
+  static const int Width = 4;
+  __m128 V;
+  static SimdVec load( const float *p ) { SimdVec r; r.V = _mm_loadu_ps( p ); return r; }
+  static SimdVec set( float x ) { SimdVec r; r.V = _mm_set1_ps( x ); return r; }
+  static SimdVec make( __m128 v ) { SimdVec r; r.V = v; return r; }
+  SimdVec operator+( const SimdVec &b ) const { return make( _mm_add_ps( V, b.V ) ); }
+  SimdVec operator-( const SimdVec &b ) const { return make( _mm_sub_ps( V, b.V ) ); }
+  SimdVec operator*( const SimdVec &b ) const { return make( _mm_mul_ps( V, b.V ) ); }
+  SimdVec min( const SimdVec &b ) const { return make( _mm_min_ps( V, b.V ) ); }
+  SimdVec max( const SimdVec &b ) const { return make( _mm_max_ps( V, b.V ) ); }
+  float sum( void ) const
+  {
+    __m128 h = _mm_add_ps( V, _mm_movehl_ps( V, V ) );
+    return _mm_cvtss_f32( _mm_add_ss( h, _mm_shuffle_ps( h, h, 1 ) ) );
+  }
+  float minValue( void ) const
+  {
+    __m128 h = _mm_min_ps( V, _mm_movehl_ps( V, V ) );
+    return _mm_cvtss_f32( _mm_min_ss( h, _mm_shuffle_ps( h, h, 1 ) ) );
+  }
+  float maxValue( void ) const
+  {
+    __m128 h = _mm_max_ps( V, _mm_movehl_ps( V, V ) );
+    return _mm_cvtss_f32( _mm_max_ss( h, _mm_shuffle_ps( h, h, 1 ) ) );
+  }
+};
+
+#endif
+
+
+  /* Partial sums returned by the kernels. */
+template < typename T, int N >
+struct Sums
+{
+  T S[N];
+  Sums operator+( const Sums &b ) const
+  {
+    Sums r;
+    for ( int k=0; k<N; k++ )
+      r.S[k] = S[k] + b.S[k];
+    return r;
+  }
+};
+
+
+  /* Sum of x-a and of (x-a)^2 over n elements of x.
+     Four independent accumulators hide the latency of the additions. */
+template < typename T >
+struct DevSums
+{
+  typedef Sums< T, 2 > Result;
+  const T *X;
+  T A;
+  Result operator()( int i, int n ) const
+  {
+    typedef SimdVec< T > V;
+    const int w = V::Width;
+    const T *x = X + i;
+    V a = V::set( A );
+    V s0 = V::set( 0 ), s1 = s0, s2 = s0, s3 = s0;
+    V q0 = s0, q1 = s0, q2 = s0, q3 = s0;
+    int k = 0;
+    for ( ; k+4*w <= n; k += 4*w ) {
+      V d0 = V::load( x+k ) - a;
+      V d1 = V::load( x+k+w ) - a;
+      V d2 = V::load( x+k+2*w ) - a;
+      V d3 = V::load( x+k+3*w ) - a;
+      s0 = s0 + d0;
+      s1 = s1 + d1;
+      s2 = s2 + d2;
+      s3 = s3 + d3;
+      q0 = q0 + d0*d0;
+      q1 = q1 + d1*d1;
+      q2 = q2 + d2*d2;
+      q3 = q3 + d3*d3;
+    }
+    Result r;
+    r.S[0] = ( ( s0 + s1 ) + ( s2 + s3 ) ).sum();
+    r.S[1] = ( ( q0 + q1 ) + ( q2 + q3 ) ).sum();
+    for ( ; k<n; k++ ) {
+      T d = x[k] - A;
+      r.S[0] += d;
+      r.S[1] += d*d;
+    }
+    return r;
+  }
+};
+
+
+  /* Sum of x, or of x^2 if Square is true, over n elements of x. */
+template < typename T, bool Square >
+struct PlainSum
+{
+  typedef Sums< T, 1 > Result;
+  const T *X;
+  PlainSum( const T *x ) : X( x ) {}
+  Result operator()( int i, int n ) const
+  {
+    typedef SimdVec< T > V;
+    const int w = V::Width;
+    const T *x = X + i;
+    V s0 = V::set( 0 ), s1 = s0, s2 = s0, s3 = s0;
+    int k = 0;
+    for ( ; k+4*w <= n; k += 4*w ) {
+      V x0 = V::load( x+k );
+      V x1 = V::load( x+k+w );
+      V x2 = V::load( x+k+2*w );
+      V x3 = V::load( x+k+3*w );
+      if ( Square ) {
+	x0 = x0*x0;
+	x1 = x1*x1;
+	x2 = x2*x2;
+	x3 = x3*x3;
+      }
+      s0 = s0 + x0;
+      s1 = s1 + x1;
+      s2 = s2 + x2;
+      s3 = s3 + x3;
+    }
+    Result r;
+    r.S[0] = ( ( s0 + s1 ) + ( s2 + s3 ) ).sum();
+    for ( ; k<n; k++ )
+      r.S[0] += Square ? x[k]*x[k] : x[k];
+    return r;
+  }
+};
+
+
+  /* Sums of x-ax, y-ay, (x-ax)^2, (y-ay)^2, and (x-ax)(y-ay)
+     over n elements of x and y. */
+template < typename T >
+struct CrossSums
+{
+  typedef Sums< T, 5 > Result;
+  const T *X;
+  const T *Y;
+  T AX;
+  T AY;
+  Result operator()( int i, int n ) const
+  {
+    typedef SimdVec< T > V;
+    const int w = V::Width;
+    const T *x = X + i;
+    const T *y = Y + i;
+    V ax = V::set( AX );
+    V ay = V::set( AY );
+    V sx0 = V::set( 0 ), sx1 = sx0, sy0 = sx0, sy1 = sx0;
+    V xx0 = sx0, xx1 = sx0, yy0 = sx0, yy1 = sx0, xy0 = sx0, xy1 = sx0;
+    int k = 0;
+    for ( ; k+2*w <= n; k += 2*w ) {
+      V dx0 = V::load( x+k ) - ax;
+      V dx1 = V::load( x+k+w ) - ax;
+      V dy0 = V::load( y+k ) - ay;
+      V dy1 = V::load( y+k+w ) - ay;
+      sx0 = sx0 + dx0;
+      sx1 = sx1 + dx1;
+      sy0 = sy0 + dy0;
+      sy1 = sy1 + dy1;
+      xx0 = xx0 + dx0*dx0;
+      xx1 = xx1 + dx1*dx1;
+      yy0 = yy0 + dy0*dy0;
+      yy1 = yy1 + dy1*dy1;
+      xy0 = xy0 + dx0*dy0;
+      xy1 = xy1 + dx1*dy1;
+    }
+    Result r;
+    r.S[0] = ( sx0 + sx1 ).sum();
+    r.S[1] = ( sy0 + sy1 ).sum();
+    r.S[2] = ( xx0 + xx1 ).sum();
+    r.S[3] = ( yy0 + yy1 ).sum();
+    r.S[4] = ( xy0 + xy1 ).sum();
+    for ( ; k<n; k++ ) {
+      T dx = x[k] - AX;
+      T dy = y[k] - AY;
+      r.S[0] += dx;
+      r.S[1] += dy;
+      r.S[2] += dx*dx;
+      r.S[3] += dy*dy;
+      r.S[4] += dx*dy;
+    }
+    return r;
+  }
+};
+
+
+  /* Pairwise summation of the results of the kernel \a kernel
+     over n elements starting at index i. */
+template < typename Kernel >
+typename Kernel::Result pairwise( const Kernel &kernel, int i, int n )
+{
+  if ( n <= PairwiseBlock )
+    return kernel( i, n );
+  int h = n/2;
+  return pairwise( kernel, i, h ) + pairwise( kernel, i+h, n-h );
+}
+
+
+template < typename T >
+void simdMinMax( T &min, T &max, const T *x, int n )
+{
+  typedef SimdVec< T > V;
+  const int w = V::Width;
+  if ( n <= 0 ) {
+    min = 0;
+    max = 0;
+    return;
+  }
+  int k = 0;
+  if ( n >= 2*w ) {
+    V mn0 = V::load( x );
+    V mn1 = V::load( x+w );
+    V mx0 = mn0;
+    V mx1 = mn1;
+    for ( k=2*w; k+2*w <= n; k += 2*w ) {
+      V x0 = V::load( x+k );
+      V x1 = V::load( x+k+w );
+      mn0 = mn0.min( x0 );
+      mn1 = mn1.min( x1 );
+      mx0 = mx0.max( x0 );
+      mx1 = mx1.max( x1 );
+    }
+    min = mn0.min( mn1 ).minValue();
+    max = mx0.max( mx1 ).maxValue();
+  }
+  else {
+    min = x[0];
+    max = x[0];
+    k = 1;
+  }
+  for ( ; k<n; k++ ) {
+    if ( min > x[k] )
+      min = x[k];
+    if ( max < x[k] )
+      max = x[k];
+  }
+}
+
+
+template < typename T >
+T simdMean( const T *x, int n )
+{
+  if ( n <= 0 )
+    return 0;
+  return pairwise( PlainSum< T, false >( x ), 0, n ).S[0] / n;
+}
+
+
+template < typename T >
+T simdMeanVariance( T &var, const T *x, int n )
+{
+  var = 0;
+  if ( n <= 0 )
+    return 0;
+  DevSums< T > ds;
+  ds.X = x;
+  ds.A = simdMean( x, n );
+  if ( n < 2 )
+    return ds.A;
+  Sums< T, 2 > s = pairwise( ds, 0, n );
+  // the sum of deviations corrects for rounding errors of the mean:
+  var = ( s.S[1] - s.S[0]*s.S[0]/n )/( n-1 );
+  if ( var < 0 )
+    var = 0;
+  return ds.A + s.S[0]/n;
+}
+
+
+template < typename T >
+T simdRms( const T *x, int n )
+{
+  if ( n <= 0 )
+    return 0;
+  return ::sqrt( pairwise( PlainSum< T, true >( x ), 0, n ).S[0] / n );
+}
+
+
+template < typename T >
+Sums< T, 5 > simdCross( const T *x, const T *y, int n )
+{
+  CrossSums< T > cs;
+  cs.X = x;
+  cs.Y = y;
+  cs.AX = simdMean( x, n );
+  cs.AY = simdMean( y, n );
+  return pairwise( cs, 0, n );
+}
+
+
+template < typename T >
+double simdCov( const T *x, const T *y, int n )
+{
+  if ( n < 2 )
+    return 0.0;
+  Sums< T, 5 > s = simdCross( x, y, n );
+  return ( (double)s.S[4] - (double)s.S[0]*s.S[1]/n )/( n-1 );
+}
+
+
+template < typename T >
+double simdCorrCoef( const T *x, const T *y, int n )
+{
+  if ( n < 2 )
+    return 0.0;
+  Sums< T, 5 > s = simdCross( x, y, n );
+  double vx = s.S[2] - (double)s.S[0]*s.S[0]/n;
+  double vy = s.S[3] - (double)s.S[1]*s.S[1]/n;
+  double cv = s.S[4] - (double)s.S[0]*s.S[1]/n;
+  double s12 = ::sqrt( vx*vy );
+  return s12 > 0.0 ? cv / s12 : 0.0;
+}
+
+
+}
+
+
+double min( const double *first, const double *last )
+{
+  double mn, mx;
+  simdMinMax( mn, mx, first, last - first );
+  return mn;
+}
+
+
+float min( const float *first, const float *last )
+{
+  float mn, mx;
+  simdMinMax( mn, mx, first, last - first );
+  return mn;
+}
+
+
+double max( const double *first, const double *last )
+{
+  double mn, mx;
+  simdMinMax( mn, mx, first, last - first );
+  return mx;
+}
+
+
+float max( const float *first, const float *last )
+{
+  float mn, mx;
+  simdMinMax( mn, mx, first, last - first );
+  return mx;
+}
+
+
+void minMax( double &min, double &max, const double *first, const double *last )
+{
+  simdMinMax( min, max, first, last - first );
+}
+
+
+void minMax( float &min, float &max, const float *first, const float *last )
+{
+  simdMinMax( min, max, first, last - first );
+}
+
+
+double mean( const double *firstx, const double *lastx )
+{
+  return simdMean( firstx, lastx - firstx );
+}
+
+
+float mean( const float *firstx, const float *lastx )
+{
+  return simdMean( firstx, lastx - firstx );
+}
+
+
+double meanStdev( double &stdev, const double *firstx, const double *lastx )
+{
+  double a = simdMeanVariance( stdev, firstx, lastx - firstx );
+  stdev = ::sqrt( stdev );
+  return a;
+}
+
+
+float meanStdev( float &stdev, const float *firstx, const float *lastx )
+{
+  float a = simdMeanVariance( stdev, firstx, lastx - firstx );
+  stdev = ::sqrt( stdev );
+  return a;
+}
+
+
+double variance( const double *firstx, const double *lastx )
+{
+  double v;
+  simdMeanVariance( v, firstx, lastx - firstx );
+  return v;
+}
+
+
+float variance( const float *firstx, const float *lastx )
+{
+  float v;
+  simdMeanVariance( v, firstx, lastx - firstx );
+  return v;
+}
+
+
+double stdev( const double *firstx, const double *lastx )
+{
+  return ::sqrt( variance( firstx, lastx ) );
+}
+
+
+float stdev( const float *firstx, const float *lastx )
+{
+  return ::sqrt( variance( firstx, lastx ) );
+}
+
+
+double rms( const double *first, const double *last )
+{
+  return simdRms( first, last - first );
+}
+
+
+float rms( const float *first, const float *last )
+{
+  return simdRms( first, last - first );
+}
+
+
+double cov( const double *firstx, const double *lastx,
+	    const double *firsty, const double *lasty )
+{
+  int n = lastx - firstx < lasty - firsty ? lastx - firstx : lasty - firsty;
+  return simdCov( firstx, firsty, n );
+}
+
+
+double cov( const float *firstx, const float *lastx,
+	    const float *firsty, const float *lasty )
+{
+  int n = lastx - firstx < lasty - firsty ? lastx - firstx : lasty - firsty;
+  return simdCov( firstx, firsty, n );
+}
+
+
+double corrCoef( const double *firstx, const double *lastx,
+		 const double *firsty, const double *lasty )
+{
+  int n = lastx - firstx < lasty - firsty ? lastx - firstx : lasty - firsty;
+  return simdCorrCoef( firstx, firsty, n );
+}
+
+
+double corrCoef( const float *firstx, const float *lastx,
+		 const float *firsty, const float *lasty )
+{
+  int n = lastx - firstx < lasty - firsty ? lastx - firstx : lasty - firsty;
+  return simdCorrCoef( firstx, firsty, n );
+}
+
+
+}; /* namespace relacs */
@@ -25,6 +25,7 @@
 
 #include <vector>
 #include <QWidget>
+#include <QImage>
 #include <QMutex>
 #include <QReadWriteLock>
 #include <QWaitCondition>
@@ -37,10 +38,13 @@ namespace relacs {
 \class MultiPlot
 \author Jan Benda
 \brief Having several Plots in a single widget.
+
+Like a single Plot, all Plots are drawn by the PlotRenderer thread
+into an off-screen image that is copied to the screen by paintEvent().
 */
 
 
-class MultiPlot : public QWidget
+class MultiPlot : public QWidget, public PlotRenderer::Target
 {
   Q_OBJECT
 
@@ -174,9 +178,14 @@ public slots:
 
 protected:
 
-    /*! Paints the entire plot. */
+    /*! Renders all Plots into the back buffer.
+        Called from the PlotRenderer thread. */
+  virtual void render( void );
+    /*! Copies the last rendered frame onto the widget. */
   void paintEvent( QPaintEvent *qpe );
   void resizeEvent( QResizeEvent *qre );
+    /*! Updates the background color on palette changes. */
+  void changeEvent( QEvent *qce );
   void customEvent( QEvent *qce );
 
   void doResize( int plots, Plot::KeepMode keep );
@@ -227,6 +236,17 @@ private:
   bool DrawBackground;
   bool DrawData;
 
+    /*! The color of the widget background. */
+  QColor Background;
+    /*! The size of the widget. */
+  QSize FrameSize;
+    /*! The frame that is shown on the screen. */
+  QImage Frame;
+    /*! The frame the PlotRenderer is drawing into. */
+  QImage BackFrame;
+    /*! Protects Frame. */
+  QMutex FrameMutex;
+
 };
 
 
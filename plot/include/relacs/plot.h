@@ -29,7 +29,9 @@
 #include <deque>
 #include <map>
 #include <QWidget>
+#include <QImage>
 #include <QMutex>
+#include <QFont>
 #include <QReadWriteLock>
 #include <QAction>
 #include <QMenu>
@@ -39,6 +41,7 @@
 #include <relacs/map.h>
 #include <relacs/sampledata.h>
 #include <relacs/eventdata.h>
+#include <relacs/plotrenderer.h>
 
 #ifdef HAVE_LIBRELACSDAQ
 #include <relacs/indata.h>
@@ -58,6 +61,15 @@ namespace relacs {
 \author Jan Benda
 \brief Plotting various data in a single widget.
 
+The plot is drawn by the PlotRenderer thread into an off-screen image
+that is copied to the screen by paintEvent().
+The data are locked (see setDataMutex()) only while the plot ranges
+are determined and the visible parts of the data are copied.
+The number of frames per second is limited by setMaxFrameRate().
+If text cannot be drawn outside the GUI thread
+(see QFontDatabase::supportsThreadedFontRendering()),
+the frames are rendered in the GUI thread instead.
+
 \bug autoscale with zero interval
 \bug check initTics algorithmns. Make them iterative!
 \todo execute init* routines immediately in draw(), only draw* routines should be posted.
@@ -70,7 +82,7 @@ namespace relacs {
 class MultiPlot;
 
 
-class Plot : public QWidget
+class Plot : public QWidget, public PlotRenderer::Target
 {
   Q_OBJECT
 
@@ -623,7 +635,8 @@ public:
         and the axis coordinates. */
   int fontPixel( double w ) const;
 
-    /*! Set the size of the standard fontb to \a pixel pixels. */
+    /*! Set the size of the standard fontb to \a pixel pixels.
+        Must be called from the GUI thread without holding lock(). */
   void setFontSize( double pixel );
 
   int addColor( const RGBColor &rgb );
@@ -1155,12 +1168,20 @@ signals:
 
 protected:
 
-    /*! Redraws the plot widget. */
-  void draw( QPaintDevice *qpm, bool drawdata );
+    /*! Draws the plot into \a frame.
+        If \a drawdata is \c false the entire plot is redrawn,
+        otherwise only new data are added to the existing plot.
+        \return \c false if the data could not be locked. */
+  bool draw( QImage *frame, bool drawdata );
+    /*! Renders the plot into the back buffer.
+        Called from the PlotRenderer thread. */
+  virtual void render( void );
     /*! Handles the resize event. */
   void resizeEvent( QResizeEvent *qre );
-    /*! Paints the entire plot. */
+    /*! Copies the last rendered frame onto the widget. */
   void paintEvent( QPaintEvent *qpe );
+    /*! Updates the background color on palette changes. */
+  void changeEvent( QEvent *qce );
   void customEvent( QEvent *qce );
 
     /*! Handles all kinds of mouse events.
@@ -1278,6 +1299,11 @@ private:
   void drawLabels( QPainter &paint );
   void drawData( QPainter &paint );
   void drawMouse( QPainter &paint );
+    /*! Scroll the plot area of \a frame by \a dx pixels to the right. */
+  void scrollFrame( QImage *frame, int dx );
+    /*! Copy the font of the widget to PlotFont and
+        update the font sizes. Must be called from the GUI thread. */
+  void setPlotFont( void );
 
 
 #ifdef HAVE_LIBRELACSSHAPES
@@ -1307,6 +1333,9 @@ private:
   vector< int > MousePInx;
   int Id;
 
+    /*! Copy of the font of the widget for drawing in the PlotRenderer thread.
+        Set by setPlotFont() in the GUI thread. Protected by PMutex. */
+  QFont PlotFont;
     /*! Basic font size. */
   int FontSize;
     /*! Width of a '0' in the basic font. */
@@ -1696,6 +1725,36 @@ private:
   };
 
 
+  /*! 
+    \class DataSnapshot
+    \brief A copy of the data points of a DataElement that are drawn next.
+
+    The indices of the points are the same as the ones of the copied
+    DataElement, starting at Offset. The index ranges of the line and
+    the points to be drawn are LineFirst to LineLast and
+    PointFirst to PointLast.
+  */
+
+  class DataSnapshot : public DataElement
+  {
+  public:
+    DataSnapshot( void );
+    virtual ~DataSnapshot( void ) {};
+
+    virtual long first( double x1, double y1, double x2, double y2 ) const { return Offset; };
+    virtual long last( double x1, double y1, double x2, double y2 ) const { return Offset + X.size(); };
+    virtual void point( long index, double &x, double &y ) const { x = X[index-Offset]; y = Y[index-Offset]; };
+
+    long LineFirst;
+    long LineLast;
+    long PointFirst;
+    long PointLast;
+    long Offset;
+      // DataElement::vector() hides std::vector in here:
+    std::vector< double > X;
+    std::vector< double > Y;
+  };
+
   SurfaceElement* SData;
   uchar* SurfaceData;
 #ifdef HAVE_LIBRELACSSHAPES
@@ -1719,14 +1778,31 @@ private:
   QReadWriteLock *DRWMutex;
   QThread *GUIThread;
 
+    /*! Copies of the data to be drawn. */
+  vector< DataSnapshot > Snapshots;
+    /*! The frame that is shown on the screen. */
+  QImage Frame;
+    /*! The frame the PlotRenderer is drawing into. */
+  QImage BackFrame;
+    /*! Protects Frame. */
+  QMutex FrameMutex;
+
   int addData( DataElement *d );
   int setSurface( SurfaceElement *s );
   void drawSurface( QPainter &paint );
 #ifdef HAVE_LIBRELACSSHAPES
   void drawPolygon( QPainter &paint, PolygonElement *d );
 #endif
-  void drawLine( QPainter &paint, DataElement *d, int addpx );
-  int drawPoints( QPainter &paint, DataElement *d );
+    /*! The index range of the line of \a d that needs to be drawn. */
+  void lineRange( DataElement *d, int addpx, long &f, long &l );
+    /*! The index range of the points of \a d that needs to be drawn.
+        \return the number of pixels the points extend beyond their position. */
+  int pointRange( DataElement *d, long &f, long &l );
+    /*! Determine the data ranges to be drawn for all data elements
+        and copy them into Snapshots. */
+  void snapshotData( void );
+  void drawLine( QPainter &paint, DataSnapshot *d );
+  void drawPoints( QPainter &paint, DataSnapshot *d );
 
 };
 
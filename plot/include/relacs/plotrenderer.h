@@ -0,0 +1,153 @@
+/*
+  plotrenderer.h
+  Renders plots into off-screen images in a background thread.
+
+  RELACS - Relaxed ELectrophysiological data Acquisition, Control, and Stimulation
+  Copyright (C) 2002-2015 Jan Benda <jan.benda@uni-tuebingen.de>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+  
+  RELACS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _RELACS_PLOTRENDERER_H_
+#define _RELACS_PLOTRENDERER_H_ 1
+
+
+#include <deque>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+using namespace std;
+
+namespace relacs {
+
+
+/*! 
+\class PlotRenderer
+\author Jan Benda
+\brief Renders plots into off-screen images in a background thread.
+
+A single PlotRenderer thread is shared by all Plot and MultiPlot widgets.
+Widgets request a new frame via Target::requestFrame().
+The render thread then calls Target::render() of the widget,
+which draws the plot into an off-screen image and
+posts an update of the widget to the GUI thread.
+The GUI thread merely copies the finished image onto the screen.
+
+Requests for a widget that is already waiting for being rendered
+are merged into a single frame and are counted as dropped frames.
+The rate of frames of each widget is limited by Target::setMaxFrameRate().
+*/
+
+class PlotRenderer : public QThread
+{
+
+public:
+
+  /*! 
+    \class Target
+    \author Jan Benda
+    \brief Interface for widgets that are rendered by the PlotRenderer.
+  */
+
+  class Target
+  {
+    friend class PlotRenderer;
+
+  public:
+
+    Target( void );
+      /*! Removes the target from the render thread. */
+    virtual ~Target( void );
+
+      /*! The maximum number of frames per second. */
+    double maxFrameRate( void ) const;
+      /*! Limit the number of frames per second to \a rate.
+          If \a rate is zero or negative, the frame rate is not limited. */
+    void setMaxFrameRate( double rate );
+      /*! The number of frames that have been rendered. */
+    long frames( void ) const;
+      /*! The number of requested frames that have been dropped,
+	  because a frame was still waiting for being rendered. */
+    long droppedFrames( void ) const;
+
+  protected:
+
+      /*! Request rendering of a new frame.
+	  Can be called from any thread. */
+    void requestFrame( void );
+      /*! Request rendering of the frame again in \a delay milliseconds,
+	  because not all of it could be rendered. */
+    void retryFrame( int delay );
+      /*! Count a finished frame. */
+    void frameDone( void );
+      /*! Remove all pending requests from the render thread
+	  and wait for the current frame to be finished.
+	  Must be called at the beginning of the destructor of
+	  the implementing class. */
+    void cancelFrames( void );
+      /*! Render a frame. This function is called from the render thread. */
+    virtual void render( void ) = 0;
+
+  private:
+
+    int FrameInterval;
+    qint64 LastFrame;
+    long Frames;
+    long DroppedFrames;
+
+  };
+
+
+private:
+
+  PlotRenderer( void );
+  ~PlotRenderer( void );
+
+    /*! The render thread. It is started on the first call. */
+  static PlotRenderer *renderer( void );
+    /*! Stops the render thread when the application quits. */
+  static void quit( void );
+
+    /*! Queue \a target for rendering in \a delay milliseconds
+        and respecting its maximum frame rate. */
+  void request( Target *target, int delay );
+    /*! Remove \a target from the queue and wait for it being rendered. */
+  void cancel( Target *target );
+
+  virtual void run( void );
+
+  struct Request
+  {
+    Target *T;
+    qint64 Due;
+  };
+  deque< Request > Requests;
+  Target *Current;
+  bool Quit;
+  QElapsedTimer Clock;
+  QMutex Mutex;
+  QWaitCondition Wait;
+  QWaitCondition Finished;
+
+  static PlotRenderer *Renderer;
+  static QMutex RendererMutex;
+
+};
+
+
+}; /* namespace relacs */
+
+#endif /* ! _RELACS_PLOTRENDERER_H_ */
+
@@ -24,6 +24,7 @@
 #include <QApplication>
 #include <QDesktopWidget>
 #include <QThread>
+#include <QFontDatabase>
 #include <QPainter>
 #include <QEvent>
 #include <QMouseEvent>
@@ -94,6 +95,7 @@ MultiPlot::MultiPlot( QWidget *parent )
 
 MultiPlot::~MultiPlot( void )
 {
+  cancelFrames();
   clear();
 }
 
@@ -124,6 +126,8 @@ void MultiPlot::construct( int plots, int columns, bool horizontal, Plot::KeepMo
   DrawData = false;
   DrawBackground = true;
   UpdatePlotList.clear();
+  Background = palette().color( QPalette::Window );
+  FrameSize = QWidget::size();
 
   layout();
 
@@ -502,18 +506,33 @@ void MultiPlot::draw( void )
   Painting = false;
   UpdatePlotList.clear();
   DrawData = true;
-  if ( QThread::currentThread() != GUIThread )
-    QCoreApplication::postEvent( this, new MultiPlotEvent( 100 ) ); // update
-  else
-    update();
+  requestFrame();
 }
 
 
-void MultiPlot::paintEvent( QPaintEvent *qpe )
+void MultiPlot::render( void )
 {
+  if ( ! QFontDatabase::supportsThreadedFontRendering() &&
+       QThread::currentThread() != GUIThread ) {
+    // text can only be drawn in the GUI thread:
+    QCoreApplication::postEvent( this, new MultiPlotEvent( 104 ) );
+    return;
+  }
+
   PMutex.lock();
   Painting = true;
-  bool newlist = false;
+  bool drawdata = ( DrawData && ! DrawBackground );
+  if ( BackFrame.size() != FrameSize ) {
+    BackFrame = QImage( FrameSize, QImage::Format_ARGB32_Premultiplied );
+    UpdatePlotList.clear();
+    drawdata = false;
+  }
+  if ( BackFrame.isNull() ) {
+    Painting = false;
+    PMutex.unlock();
+    return;
+  }
+
   // initialize list of plots that need to be updated:
   if ( UpdatePlotList.empty() ) {
     UpdatePlotList = PlotList;
@@ -525,86 +544,68 @@ void MultiPlot::paintEvent( QPaintEvent *qpe )
       else
 	++p;
     }
-    newlist = true;
+    // redraw background:
+    if ( ! drawdata )
+      BackFrame.fill( Background.rgb() );
   }
 
   // loop through the subplots:
   PlotListType::iterator p = UpdatePlotList.begin(); 
   while ( p != UpdatePlotList.end() ) {
-
-    PMutex.unlock();
-
     Plot *cp = *p;
-
-    // if the data are not available there is no need to lock the plot.
-    if ( ! cp->tryLockData( 5 ) ) {
+    cp->scale( BackFrame.width(), BackFrame.height() );
+    if ( cp->draw( &BackFrame, drawdata ) )
+      p = UpdatePlotList.erase( p );
+    else {
       // we do not get the lock for the data now,
-      // so we check the other plots first:
-      PMutex.lock();
-      if ( ! Painting )  // the subplots have been changed in the meantime!
-	break;
+      // so we skip the plots with the same data lock:
       for ( ++p; p != UpdatePlotList.end() && (**p).equalDataMutex( *cp ); ++p );
-      continue;
     }
-
-    PMutex.lock();
-    if ( ! Painting ) {  // the subplots have been changed in the meantime!
-      cp->unlockData();
+    if ( ! Painting )  // the subplots have been changed in the meantime!
       break;
-    }
+  }
 
-    if ( newlist ) {
-      // redraw background:
-      if ( DrawBackground || ! DrawData ) {
-	QPainter qp( this );
-	qp.eraseRect( rect() );
-      }
-    }
+  bool completed = UpdatePlotList.empty();
+  if ( Painting && completed ) {
+    DrawBackground = false;
+    DrawData = false;
+  }
+  Painting = false;
+  PMutex.unlock();
 
-    // draw subplot:
-    cp->scale( width(), height() );
-    cp->draw( this, DrawData );
-
-    // draw subplots with the same or no data lock:
-    PlotListType::iterator sp = UpdatePlotList.erase( p ); 
-    bool setp = false;
-    while ( sp != UpdatePlotList.end() ) {
-      if ( (**sp).equalDataMutex( *cp ) || (**sp).noDataMutex() ) {
-	(**sp).scale( width(), height() );
-	(**sp).draw( this, DrawData );
-	sp = UpdatePlotList.erase( sp );
-      }
-      else {
-	if ( ! setp )
-	  p = sp;
-	setp = true;
-	++sp;
-      }
-    }
-    if ( ! setp )
-      p = UpdatePlotList.end();
+  // publish the new frame:
+  FrameMutex.lock();
+  Frame = BackFrame;
+  FrameMutex.unlock();
+  QCoreApplication::postEvent( this, new MultiPlotEvent( 100 ) ); // update
 
-    PMutex.unlock();
-    cp->unlockData();
-
-    PMutex.lock();
-    if ( ! Painting )  // the subplots have been changed in the meantime!
-      break;
+  if ( completed )
+    frameDone();
+  else {
+    // we did not get the lock for the data of some plots now,
+    // so we draw the remaining subplots a little bit later.
+    retryFrame( 5 );
   }
+}
 
-  if ( Painting && ! UpdatePlotList.empty() ) {
-    Painting = false;
-    PMutex.unlock();
-    // we did not get the lock for the data of some plots now,
-    // so we repost the paintEvent() for the remaining subplots to a later time.
-    update();
+
+void MultiPlot::paintEvent( QPaintEvent *qpe )
+{
+  FrameMutex.lock();
+  QImage frame = Frame;
+  FrameMutex.unlock();
+
+  QPainter paint( this );
+  if ( frame.isNull() ) {
+    paint.eraseRect( rect() );
+    requestFrame();
     return;
   }
-
-  DrawBackground = false;
-  DrawData = false;
-  Painting = false;
-  PMutex.unlock();
+  paint.drawImage( qpe->rect(), frame, qpe->rect() );
+  if ( frame.width() < width() || frame.height() < height() ) {
+    paint.eraseRect( frame.width(), 0, width() - frame.width(), height() );
+    paint.eraseRect( 0, frame.height(), frame.width(), height() - frame.height() );
+  }
 }
 
 
@@ -621,8 +622,25 @@ void MultiPlot::resizeEvent( QResizeEvent *qre )
   }
   UpdatePlotList.clear();
   DrawBackground = true;
+  FrameSize = qre->size();
   PMutex.unlock();
   QWidget::resizeEvent( qre );
+
+  // render the plots with the new size:
+  requestFrame();
+}
+
+
+void MultiPlot::changeEvent( QEvent *qce )
+{
+  if ( qce->type() == QEvent::PaletteChange ) {
+    PMutex.lock();
+    Background = palette().color( QPalette::Window );
+    DrawBackground = true;
+    PMutex.unlock();
+    requestFrame();
+  }
+  QWidget::changeEvent( qce );
 }
 
 
@@ -795,6 +813,10 @@ void MultiPlot::customEvent( QEvent *qce )
     WaitGUI.wakeAll();
     break;
   }
+  case 104: {
+    render();
+    break;
+  }
   default:
     QWidget::customEvent( qce );
   }
@@ -20,9 +20,9 @@
 */
 
 #include <cmath>
+#include <cstring>
 #include <iostream>
 #include <algorithm>
-#include <QBitmap>
 #include <QPainter>
 #include <QPainterPath>
 #include <QPolygon>
@@ -32,6 +32,7 @@
 #include <QApplication>
 #include <QDesktopWidget>
 #include <QThread>
+#include <QFontDatabase>
 #include <QActionGroup>
 #include <relacs/str.h>
 #include <relacs/multiplot.h>
@@ -165,9 +166,7 @@ void Plot::construct( KeepMode keep, bool subwidget, int id, MultiPlot *mp )
   ScreenX2 = width() - 1;
   ScreenY2 = 0;
 
-  FontSize = fontMetrics().height();
-  FontWidth = fontMetrics().width( "00" ) - fontMetrics().width( "0" );
-  FontHeight = fontMetrics().ascent();
+  setPlotFont();
 
   for ( int k=0; k<MaxAxis; k++ ) {
     XMin[k] = -10.0;
@@ -349,6 +348,7 @@ void Plot::construct( KeepMode keep, bool subwidget, int id, MultiPlot *mp )
 
 Plot::~Plot( void )
 {
+  cancelFrames();
   clear();
   delete MouseZoom;
   delete MouseMove;
@@ -1178,11 +1178,18 @@ void Plot::setFontSize( double pixel )
   if ( newfontsize < 8 )
     newfontsize = 8;
   fnt.setPixelSize( newfontsize );
+  // changeEvent() updates PlotFont:
   setFont( fnt );
+}
+
 
-  FontSize = fontMetrics().height();
-  FontWidth = fontMetrics().width( "00" ) - fontMetrics().width( "0" );
-  FontHeight = fontMetrics().ascent();
+void Plot::setPlotFont( void )
+{
+  PlotFont = font();
+  QFontMetrics fm( PlotFont );
+  FontSize = fm.height();
+  FontWidth = fm.width( "00" ) - fm.width( "0" );
+  FontHeight = fm.ascent();
 }
 
 
@@ -1474,6 +1481,9 @@ void Plot::resizeEvent( QResizeEvent *qre )
   PMutex.unlock();
 
   QWidget::resizeEvent( qre );
+
+  // render the plot with the new size:
+  requestFrame();
 }
 
 
@@ -1856,9 +1866,9 @@ void Plot::initTics( void )
 	}
       }
       if ( k == 1 )
-	Y2TicsMarg += 2 + (int)::ceil( fontMetrics().width( yticstr.c_str() ) * TicsLabelSize );
+	Y2TicsMarg += 2 + (int)::ceil( QFontMetrics( PlotFont ).width( yticstr.c_str() ) * TicsLabelSize );
       else
-	Y1TicsMarg += 2 + (int)::ceil( fontMetrics().width( yticstr.c_str() ) * TicsLabelSize );
+	Y1TicsMarg += 2 + (int)::ceil( QFontMetrics( PlotFont ).width( yticstr.c_str() ) * TicsLabelSize );
     }
 
     // x tic marks:
@@ -2260,7 +2270,7 @@ void Plot::drawTicLabels( QPainter &paint, int axis )
       if ( ! XTicsFormat[axis].empty() ) {
 	QString xt;
 	xt.sprintf( XTicsFormat[axis].c_str(), x );
-	int w = fontMetrics().width( xt );
+	int w = paint.fontMetrics().width( xt );
 	if ( axis == 1 )
 	  paint.drawText( xp-w/2, PlotY2-BorderStyle.width()-X2TicsLen-2, xt );
 	else
@@ -2281,7 +2291,7 @@ void Plot::drawTicLabels( QPainter &paint, int axis )
       if ( ! YTicsFormat[axis].empty() ) {
 	QString yt;
 	yt.sprintf( YTicsFormat[axis].c_str(), y );
-	int w = fontMetrics().width( yt );
+	int w = paint.fontMetrics().width( yt );
 	int h = (int)::ceil( TicsLabelSize*FontHeight );
 	if ( axis == 1 )
 	  paint.drawText( PlotX2+BorderStyle.width()+Y2TicsLen+2, yp+h/2, yt );
@@ -2310,8 +2320,8 @@ void Plot::drawLabel( QPainter &paint, const Label &label )
     paint.save();
     paint.translate( xp, yp );
     paint.rotate( label.Angle );
-    QFont fnt( font() );
-    int newfontsize = (int)::ceil( fontInfo().pixelSize()*label.LSize );
+    QFont fnt( PlotFont );
+    int newfontsize = (int)::ceil( QFontInfo( PlotFont ).pixelSize()*label.LSize );
     if ( newfontsize < 5 )
       newfontsize = 5;
     fnt.setPixelSize( newfontsize );
@@ -2559,24 +2569,17 @@ void Plot::drawPolygon( QPainter &paint, PolygonElement *d )
 
 #endif
 
-void Plot::drawLine( QPainter &paint, DataElement *d, int addpx )
+void Plot::lineRange( DataElement *d, int addpx, long &f, long &l )
 {
+  f = 0;
+  l = 0;
   if ( d->Line.color() != Transparent && d->Line.width() > 0 ) {
-    // set pen:
-    RGBColor c = color( d->Line.color() );
-    QColor qcolor( c.red(), c.green(), c.blue() );
-    Qt::PenStyle dash = QtDash.find( d->Line.dash() )->second;
-    paint.setPen( QPen( qcolor, d->Line.width(), dash ) );
-    // no brush:
-    paint.setBrush( QBrush( Qt::black, Qt::NoBrush ) );
 
     // axis:
     int xaxis = d->XAxis;
     int yaxis = d->YAxis;
     
     // init data:
-    long f = 0;
-    long l = 0;
     if ( NewData ) {
       f = d->first( XMin[xaxis], YMin[yaxis], XMax[xaxis], YMax[yaxis] );
       l = d->last( XMin[xaxis], YMin[yaxis], XMax[xaxis], YMax[yaxis] );
@@ -2611,6 +2614,28 @@ void Plot::drawLine( QPainter &paint, DataElement *d, int addpx )
       }
     }
     d->setLineIndex( l );
+  }
+}
+
+
+void Plot::drawLine( QPainter &paint, DataSnapshot *d )
+{
+  if ( d->Line.color() != Transparent && d->Line.width() > 0 ) {
+    // set pen:
+    RGBColor c = color( d->Line.color() );
+    QColor qcolor( c.red(), c.green(), c.blue() );
+    Qt::PenStyle dash = QtDash.find( d->Line.dash() )->second;
+    paint.setPen( QPen( qcolor, d->Line.width(), dash ) );
+    // no brush:
+    paint.setBrush( QBrush( Qt::black, Qt::NoBrush ) );
+
+    // axis:
+    int xaxis = d->XAxis;
+    int yaxis = d->YAxis;
+    
+    // data range:
+    long f = d->LineFirst;
+    long l = d->LineLast;
     if ( f >= l )
       return;
     long k = f;
@@ -2811,8 +2836,10 @@ void Plot::drawLine( QPainter &paint, DataElement *d, int addpx )
 }
 
 
-int Plot::drawPoints( QPainter &paint, DataElement *d )
+int Plot::pointRange( DataElement *d, long &f, long &l )
 {
+  f = 0;
+  l = 0;
   if ( ( d->Point.color() != Transparent || 
 	 d->Point.fillColor() != Transparent ) && 
        ( d->Point.size() > 0 || d->Point.type() == Box ) ) {
@@ -2822,8 +2849,6 @@ int Plot::drawPoints( QPainter &paint, DataElement *d )
     int yaxis = d->YAxis;
 
     // index range:
-    long f = 0;
-    long l = 0;
     if ( NewData ) {
       f = d->first( XMin[xaxis], YMin[yaxis], XMax[xaxis], YMax[yaxis] );
       l = d->last( XMin[xaxis], YMin[yaxis], XMax[xaxis], YMax[yaxis] );
@@ -2852,15 +2877,52 @@ int Plot::drawPoints( QPainter &paint, DataElement *d )
     if ( f >= l )
       return 0;
 
+    // extent of the points:
+    if ( d->Point.type() == Box ) {
+      if ( l-f >= 2 ) {
+	int wp = d->Point.size();
+	if ( wp <= 0 ) {
+	  double x1, x2, y;
+	  d->point( f, x1, y );
+	  d->point( l-1, x2, y );
+	  double w = (x2-x1)/(l-f-1);
+	  wp = (int)::rint( double(PlotX2-PlotX1)/(XMax[xaxis]-XMin[xaxis])*w );
+	}
+	int wpl = wp/2;
+	int wpr = wp - wpl;
+	return wpl > wpr ? wpl : wpr;
+      }
+    }
+    else
+      return d->Point.size() > 0 ? d->Point.size() : 1;
+  }
+  return 0;
+}
+
+
+void Plot::drawPoints( QPainter &paint, DataSnapshot *d )
+{
+  if ( ( d->Point.color() != Transparent || 
+	 d->Point.fillColor() != Transparent ) && 
+       ( d->Point.size() > 0 || d->Point.type() == Box ) ) {
+
+    // axis:
+    int xaxis = d->XAxis;
+    int yaxis = d->YAxis;
+
+    // index range:
+    long f = d->PointFirst;
+    long l = d->PointLast;
+    if ( f >= l )
+      return;
+
     // single point pixmap:
     int offs = d->Point.size();
     if ( offs <= 0 )
       offs = 1;
-    QPixmap point( 2*offs, 2*offs );
+    QImage point( 2*offs, 2*offs, QImage::Format_ARGB32_Premultiplied );
+    point.fill( 0 );
     QPainter ppaint( &point );
-    QBitmap mask( 2*offs, 2*offs );
-    mask.fill( Qt::color0 );
-    QPainter mpaint( &mask );
 
     // set pen:
     if ( d->Point.color() != Transparent ) {
@@ -2868,12 +2930,10 @@ int Plot::drawPoints( QPainter &paint, DataElement *d )
       QColor qcolor( c.red(), c.green(), c.blue() );
       paint.setPen( QPen( qcolor, d->Line.width(), Qt::SolidLine ) );
       ppaint.setPen( QPen( qcolor, d->Line.width(), Qt::SolidLine ) );
-      mpaint.setPen( QPen( Qt::color1, d->Line.width(), Qt::SolidLine ) );
     }
     else {
       paint.setPen( QPen( Qt::black, 0, Qt::NoPen ) );
       ppaint.setPen( QPen( Qt::black, 0, Qt::NoPen ) );
-      mpaint.setPen( QPen( Qt::color0, 0, Qt::NoPen ) );
     }
     
     // set brush:
@@ -2882,12 +2942,10 @@ int Plot::drawPoints( QPainter &paint, DataElement *d )
       QColor qcolor( c.red(), c.green(), c.blue() );
       paint.setBrush( QBrush( qcolor ) );
       ppaint.setBrush( QBrush( qcolor ) );
-      mpaint.setBrush( QBrush( Qt::color1 ) );
     }
     else {
       paint.setBrush( QBrush( Qt::black, Qt::NoBrush ) );
       ppaint.setBrush( QBrush( Qt::black, Qt::NoBrush ) );
-      mpaint.setBrush( QBrush( Qt::color0 ) );
     }
 
     // draw Box:
@@ -2925,7 +2983,7 @@ int Plot::drawPoints( QPainter &paint, DataElement *d )
 	    paint.drawPolygon( pa );
 	  }
 	}
-	return wpl > wpr ? wpl : wpr;
+	return;
       }
     }
     else {
@@ -2935,7 +2993,6 @@ int Plot::drawPoints( QPainter &paint, DataElement *d )
       case Circle: {
 	int r = (int)::rint( d->Point.size()*0.564 );
 	ppaint.drawEllipse( offs - r, offs - r, 2*r, 2*r );
-	mpaint.drawEllipse( offs - r, offs - r, 2*r, 2*r );
       }
 	break;
 
@@ -2943,8 +3000,6 @@ int Plot::drawPoints( QPainter &paint, DataElement *d )
 	int r = (int)::rint( d->Point.size()*0.564 );
 	ppaint.drawEllipse( offs - r, offs - r, 2*r, 2*r );
 	ppaint.drawPoint( offs, offs ); 
-	mpaint.drawEllipse( offs - r, offs - r, 2*r, 2*r );
-	mpaint.drawPoint( offs, offs ); 
       }
 	break;
 
@@ -2956,7 +3011,6 @@ int Plot::drawPoints( QPainter &paint, DataElement *d )
 	pa.setPoint( 2, offs + c, offs );
 	pa.setPoint( 3, offs, offs - c );
 	ppaint.drawPolygon( pa );
-	mpaint.drawPolygon( pa );
       }
 	break;
 
@@ -2969,8 +3023,6 @@ int Plot::drawPoints( QPainter &paint, DataElement *d )
 	pa.setPoint( 3, offs, offs - c );
 	ppaint.drawPolygon( pa );
 	ppaint.drawPoint( offs, offs ); 
-	mpaint.drawPolygon( pa );
-	mpaint.drawPoint( offs, offs ); 
       }
 	break;
 
@@ -2978,8 +3030,6 @@ int Plot::drawPoints( QPainter &paint, DataElement *d )
 	int r = d->Point.size()/2;
 	ppaint.drawRect( offs - r, offs - r, 
 			 d->Point.size(), d->Point.size() );
-	mpaint.drawRect( offs - r, offs - r, 
-			 d->Point.size(), d->Point.size() );
       }
 	break;
 
@@ -2988,9 +3038,6 @@ int Plot::drawPoints( QPainter &paint, DataElement *d )
 	ppaint.drawRect( offs - r, offs - r, 
 			 d->Point.size(), d->Point.size() );
 	ppaint.drawPoint( offs, offs ); 
-	mpaint.drawRect( offs - r, offs - r, 
-			 d->Point.size(), d->Point.size() );
-	mpaint.drawPoint( offs, offs ); 
       }
 	break;
 
@@ -3002,7 +3049,6 @@ int Plot::drawPoints( QPainter &paint, DataElement *d )
 	pa.setPoint( 1, offs, offs - 2*c );
 	pa.setPoint( 2, offs + a, offs + c );
 	ppaint.drawPolygon( pa );
-	mpaint.drawPolygon( pa );
       }
 	break;
 
@@ -3015,8 +3061,6 @@ int Plot::drawPoints( QPainter &paint, DataElement *d )
 	pa.setPoint( 2, offs + a, offs + c );
 	ppaint.drawPolygon( pa );
 	ppaint.drawPoint( offs, offs ); 
-	mpaint.drawPolygon( pa );
-	mpaint.drawPoint( offs, offs ); 
       }
 	break;
 
@@ -3028,7 +3072,6 @@ int Plot::drawPoints( QPainter &paint, DataElement *d )
 	pa.setPoint( 1, offs, offs + 2*c );
 	pa.setPoint( 2, offs + a, offs - c );
 	ppaint.drawPolygon( pa );
-	mpaint.drawPolygon( pa );
       }
 	break;
 
@@ -3041,8 +3084,6 @@ int Plot::drawPoints( QPainter &paint, DataElement *d )
 	pa.setPoint( 2, offs + a, offs - c );
 	ppaint.drawPolygon( pa );
 	ppaint.drawPoint( offs, offs ); 
-	mpaint.drawPolygon( pa );
-	mpaint.drawPoint( offs, offs ); 
       }
 	break;
 
@@ -3054,7 +3095,6 @@ int Plot::drawPoints( QPainter &paint, DataElement *d )
 	pa.setPoint( 1, offs - 2*c, offs );
 	pa.setPoint( 2, offs + c, offs + a );
 	ppaint.drawPolygon( pa );
-	mpaint.drawPolygon( pa );
       }
 	break;
 
@@ -3067,8 +3107,6 @@ int Plot::drawPoints( QPainter &paint, DataElement *d )
 	pa.setPoint( 2, offs + c, offs + a );
 	ppaint.drawPolygon( pa );
 	ppaint.drawPoint( offs, offs ); 
-	mpaint.drawPolygon( pa );
-	mpaint.drawPoint( offs, offs ); 
       }
 	break;
 
@@ -3080,7 +3118,6 @@ int Plot::drawPoints( QPainter &paint, DataElement *d )
 	pa.setPoint( 1, offs + 2*c, offs );
 	pa.setPoint( 2, offs - c, offs + a );
 	ppaint.drawPolygon( pa );
-	mpaint.drawPolygon( pa );
       }
 	break;
 
@@ -3093,8 +3130,6 @@ int Plot::drawPoints( QPainter &paint, DataElement *d )
 	pa.setPoint( 2, offs - c, offs + a );
 	ppaint.drawPolygon( pa );
 	ppaint.drawPoint( offs, offs ); 
-	mpaint.drawPolygon( pa );
-	mpaint.drawPoint( offs, offs ); 
       }
 	break;
 
@@ -3105,7 +3140,6 @@ int Plot::drawPoints( QPainter &paint, DataElement *d )
 	pa.setPoint( 1, offs, offs + offs );
 	pa.setPoint( 2, offs + a, offs );
 	ppaint.drawPolygon( pa );
-	mpaint.drawPolygon( pa );
       }
 	break;
 
@@ -3116,7 +3150,6 @@ int Plot::drawPoints( QPainter &paint, DataElement *d )
 	pa.setPoint( 1, offs, offs - offs );
 	pa.setPoint( 2, offs + a, offs );
 	ppaint.drawPolygon( pa );
-	mpaint.drawPolygon( pa );
       }
 	break;
 
@@ -3127,7 +3160,6 @@ int Plot::drawPoints( QPainter &paint, DataElement *d )
 	pa.setPoint( 1, offs + offs, offs );
 	pa.setPoint( 2, offs, offs + a );
 	ppaint.drawPolygon( pa );
-	mpaint.drawPolygon( pa );
       }
 	break;
 
@@ -3138,87 +3170,74 @@ int Plot::drawPoints( QPainter &paint, DataElement *d )
 	pa.setPoint( 1, offs - offs, offs );
 	pa.setPoint( 2, offs, offs + a );
 	ppaint.drawPolygon( pa );
-	mpaint.drawPolygon( pa );
       }
 	break;
 
       case CircleNorth: {
 	int r = (int)::rint( offs * 0.606 ); // *sqrt( 2 / pi / sqrt( 3 ) )
 	ppaint.drawPie( offs - r, offs - r, 2*r, 2*r, 16*180+1, 16*180-2 );
-	mpaint.drawPie( offs - r, offs - r, 2*r, 2*r, 16*180+1, 16*180-2 );
       }
 	break;
 
       case CircleSouth: {
 	int r = (int)::rint( offs * 0.606 ); // *sqrt( 2 / pi / sqrt( 3 ) )
 	ppaint.drawPie( offs - r, offs - r, 2*r, 2*r, 0, 16*180+1 );
-	mpaint.drawPie( offs - r, offs - r, 2*r, 2*r, 0, 16*180+1 );
       }
 	break;
 
       case CircleWest: {
 	int r = (int)::rint( offs * 0.606 ); // *sqrt( 2 / pi / sqrt( 3 ) )
 	ppaint.drawPie( offs - r, offs - r, 2*r, 2*r, -16*90, 16*180+1 );
-	mpaint.drawPie( offs - r, offs - r, 2*r, 2*r, -16*90, 16*180+1 );
       }
 	break;
 
       case CircleEast: {
 	int r = (int)::rint( offs * 0.606 ); // *sqrt( 2 / pi / sqrt( 3 ) )
 	ppaint.drawPie( offs - r, offs - r, 2*r, 2*r, 16*90, 16*180+1 );
-	mpaint.drawPie( offs - r, offs - r, 2*r, 2*r, 16*90, 16*180+1 );
       }
 	break;
 
       case SquareNorth: {
 	int r = (int)::rint( offs / sqrt( sqrt( 3.0 ) ) );
 	ppaint.drawRect( offs - r/2, offs, r, r );
-	mpaint.drawRect( offs - r/2, offs, r, r );
       }
 	break;
 
       case SquareSouth: {
 	int r = (int)::rint( offs / sqrt( sqrt( 3.0 ) ) );
 	ppaint.drawRect( offs - r/2, offs, r, -r );
-	mpaint.drawRect( offs - r/2, offs, r, -r );
       }
 	break;
 
       case SquareWest: {
 	int r = (int)::rint( offs / sqrt( sqrt( 3.0 ) ) );
 	ppaint.drawRect( offs, offs - r/2, r, r );
-	mpaint.drawRect( offs, offs - r/2, r, r );
       }
 	break;
 
       case SquareEast: {
 	int r = (int)::rint( offs / sqrt( sqrt( 3.0 ) ) );
 	ppaint.drawRect( 0, offs - r/2, r, r );
-	mpaint.drawRect( 0, offs - r/2, r, r );
       }
 	break;
 
       case Dot:
 	ppaint.drawPoint( offs, offs ); 
-	mpaint.drawPoint( offs, offs ); 
 	break;
 
       case StrokeUp:
 	ppaint.drawLine( offs, offs, offs, offs - d->Point.size() ); 
-	mpaint.drawLine( offs, offs, offs, offs - d->Point.size() ); 
 	break;
 
       case StrokeVertical: {
 	int r = d->Point.size()/2;
 	ppaint.drawLine( offs, offs - r, offs, offs + r ); 
-	mpaint.drawLine( offs, offs - r, offs, offs + r ); 
       }
 	break;
 
       case StrokeHorizontal: {
 	int r = d->Point.size()/2;
 	ppaint.drawLine( offs - r, offs, offs + r, offs ); 
-	mpaint.drawLine( offs - r, offs, offs + r, offs ); 
       }
 	break;
 
@@ -3226,8 +3245,6 @@ int Plot::drawPoints( QPainter &paint, DataElement *d )
 	cerr << "point type not supported!\n";
       }
       ppaint.end();
-      mpaint.end();
-      point.setMask( mask );
 
       // draw points:
       for ( long k=f; k<l; k++ ) {
@@ -3236,30 +3253,57 @@ int Plot::drawPoints( QPainter &paint, DataElement *d )
 	if ( XMin[xaxis] <= x && XMax[xaxis] >= x && YMin[yaxis] <= y && YMax[yaxis] >= y ) {
 	  int xp = PlotX1 + (int)::rint( double(PlotX2-PlotX1)/(XMax[xaxis]-XMin[xaxis])*(x-XMin[xaxis]) );
 	  int yp = PlotY1 + (int)::rint( double(PlotY2-PlotY1)/(YMax[yaxis]-YMin[yaxis])*(y-YMin[yaxis]) );
-	  paint.drawPixmap( xp-offs, yp-offs, point );
+	  paint.drawImage( xp-offs, yp-offs, point );
 	}
       }
 
-      return offs;
     }
   }
-  return 0;
 }
 
 
-void Plot::drawData( QPainter &paint )
+void Plot::snapshotData( void )
 {
-  drawSurface( paint );
-#ifdef HAVE_LIBRELACSSHAPES
-  for ( PolygonDataType::iterator d = PolygonData.begin(); d != PolygonData.end(); ++d )
-    drawPolygon( paint, *d );
-#endif
+  Snapshots.resize( LineData.size() );
   int addpx = 0;
-  for ( LineDataType::iterator d = LineData.begin(); d != LineData.end(); ++d ) {
-    drawLine( paint, *d, addpx );
-    int apx = drawPoints( paint, *d );
+  int k = 0;
+  for ( LineDataType::iterator d = LineData.begin(); d != LineData.end(); ++d, ++k ) {
+    DataSnapshot &ds = Snapshots[k];
+    ds.XAxis = (*d)->XAxis;
+    ds.YAxis = (*d)->YAxis;
+    ds.DataType = (*d)->DataType;
+    ds.Line = (*d)->Line;
+    ds.Point = (*d)->Point;
+    // index ranges to be drawn:
+    lineRange( *d, addpx, ds.LineFirst, ds.LineLast );
+    int apx = pointRange( *d, ds.PointFirst, ds.PointLast );
     if ( apx > addpx )
       addpx = apx;
+    // copy the data points:
+    long f = ds.LineFirst;
+    long l = ds.LineLast;
+    if ( ds.PointFirst < ds.PointLast ) {
+      if ( f >= l || ds.PointFirst < f )
+	f = ds.PointFirst;
+      if ( f >= l || ds.PointLast > l )
+	l = ds.PointLast;
+    }
+    if ( f >= l )
+      f = l = 0;
+    ds.Offset = f;
+    ds.X.resize( l - f );
+    ds.Y.resize( l - f );
+    for ( long i=f; i<l; i++ )
+      (*d)->point( i, ds.X[i-f], ds.Y[i-f] );
+  }
+}
+
+
+void Plot::drawData( QPainter &paint )
+{
+  for ( unsigned int k=0; k<Snapshots.size(); k++ ) {
+    drawLine( paint, &Snapshots[k] );
+    drawPoints( paint, &Snapshots[k] );
   }
 }
 
@@ -3383,23 +3427,14 @@ void Plot::drawMouse( QPainter &paint )
 }
 
 
-void Plot::draw( QPaintDevice *qpm, bool drawdata )
+bool Plot::draw( QImage *frame, bool drawdata )
 {
   // the order of locking is important here!
   // if the data are not available there is no need to lock the plot.
-  if ( ! SubWidget ) {
-    if ( ! tryLockData( 5 ) ) {
-      // we do not get the lock for the data now,
-      // so we repost the paintEvent() to a later time.
-      update();
-      return;
-    }
-  }
+  if ( ! tryLockData( 5 ) )
+    return false;
   PMutex.lock();
 
-  QColor pbc = palette().color( QPalette::Window );
-  Colors[WidgetBackground] = RGBColor( pbc.red(), pbc.green(), pbc.blue() );
-
   init();
   initRange();
   initTics();
@@ -3476,24 +3511,31 @@ void Plot::draw( QPaintDevice *qpm, bool drawdata )
 	XMin[k] = XMinPrev[k] + ShiftX[k];
 	XMax[k] = XMaxPrev[k] + ShiftX[k];
       }
-      // get widget:
-      QWidget *w = this;
-      if ( SubWidget && MP != 0 )
-	w = MP;
-      // scroll widget:
+      // scroll the plot:
       if ( ShiftXPix != 0 )
-	w->scroll( -ShiftXPix, 0,
-		   QRect( PlotX1, PlotY2, PlotX2-PlotX1+1, PlotY1-PlotY2+1 ) );
+	scrollFrame( frame, -ShiftXPix );
     }
   }
 
-  QPainter paint( qpm );
+  QPainter paint( frame );
+  // a painter on an image does not use the font of the widget:
+  paint.setFont( PlotFont );
   // the painter coordinate system has its origin in 
   // the upper left corner of the widget!
   if ( NewData || ShiftData ) {
     drawBorder( paint );
     drawAxis( paint );
   }
+  drawSurface( paint );
+#ifdef HAVE_LIBRELACSSHAPES
+  for ( PolygonDataType::iterator d = PolygonData.begin(); d != PolygonData.end(); ++d )
+    drawPolygon( paint, *d );
+#endif
+
+  // copy the data to be drawn and release the data:
+  snapshotData();
+  unlockData();
+
   drawData( paint );
   if ( NewData || ShiftData )
     drawLabels( paint );
@@ -3509,8 +3551,48 @@ void Plot::draw( QPaintDevice *qpm, bool drawdata )
   NewData = false;
 
   PMutex.unlock();
-  if ( ! SubWidget )
-    unlockData();
+  return true;
+}
+
+
+void Plot::render( void )
+{
+  if ( ! QFontDatabase::supportsThreadedFontRendering() &&
+       QThread::currentThread() != GUIThread ) {
+    // text can only be drawn in the GUI thread:
+    QCoreApplication::postEvent( this, new QEvent( QEvent::Type( QEvent::User+102 ) ) );
+    return;
+  }
+
+  PMutex.lock();
+  int w = screenWidth();
+  int h = screenHeight();
+  bool drawdata = DrawData;
+  RGBColor bc = Colors[WidgetBackground];
+  PMutex.unlock();
+
+  if ( w <= 0 || h <= 0 )
+    return;
+
+  if ( BackFrame.width() != w || BackFrame.height() != h ) {
+    BackFrame = QImage( w, h, QImage::Format_ARGB32_Premultiplied );
+    BackFrame.fill( QColor( bc.red(), bc.green(), bc.blue() ).rgb() );
+    drawdata = false;
+  }
+
+  if ( ! draw( &BackFrame, drawdata ) ) {
+    // we do not get the lock for the data now,
+    // so we try again a little bit later:
+    retryFrame( 5 );
+    return;
+  }
+
+  // publish the new frame:
+  FrameMutex.lock();
+  Frame = BackFrame;
+  FrameMutex.unlock();
+  frameDone();
+  QCoreApplication::postEvent( this, new QEvent( QEvent::Type( QEvent::User+100 ) ) ); // update
 }
 
 
@@ -3521,19 +3603,73 @@ void Plot::draw( void )
       MP->draw();
   }
   else {
+    PMutex.lock();
     DrawData = true;
-    if ( QThread::currentThread() != GUIThread )
-      QCoreApplication::postEvent( this, new QEvent( QEvent::Type( QEvent::User+100 ) ) ); // update
-    else
-      update();
+    PMutex.unlock();
+    requestFrame();
   }
 }
 
 
 void Plot::paintEvent( QPaintEvent *qpe )
 {
-  if ( !SubWidget )
-    draw( this, DrawData );
+  if ( SubWidget )
+    return;
+
+  FrameMutex.lock();
+  QImage frame = Frame;
+  FrameMutex.unlock();
+
+  QPainter paint( this );
+  if ( frame.isNull() ) {
+    paint.eraseRect( rect() );
+    requestFrame();
+    return;
+  }
+  paint.drawImage( qpe->rect(), frame, qpe->rect() );
+  if ( frame.width() < width() || frame.height() < height() ) {
+    paint.eraseRect( frame.width(), 0, width() - frame.width(), height() );
+    paint.eraseRect( 0, frame.height(), frame.width(), height() - frame.height() );
+  }
+}
+
+
+void Plot::changeEvent( QEvent *qce )
+{
+  if ( qce->type() == QEvent::PaletteChange ) {
+    QColor pbc = palette().color( QPalette::Window );
+    PMutex.lock();
+    Colors[WidgetBackground] = RGBColor( pbc.red(), pbc.green(), pbc.blue() );
+    setPlotFont();
+    NewData = true;
+    PMutex.unlock();
+    draw();
+  }
+  else if ( qce->type() == QEvent::FontChange ) {
+    PMutex.lock();
+    setPlotFont();
+    NewData = true;
+    PMutex.unlock();
+    draw();
+  }
+  QWidget::changeEvent( qce );
+}
+
+
+void Plot::scrollFrame( QImage *frame, int dx )
+{
+  // the plot area:
+  QRect r( PlotX1, PlotY2, PlotX2-PlotX1+1, PlotY1-PlotY2+1 );
+  r &= frame->rect();
+  int w = r.width() - ::abs( dx );
+  if ( w <= 0 || frame->depth() != 32 )
+    return;
+  int sx = dx > 0 ? r.left() : r.left() - dx;
+  int tx = sx + dx;
+  for ( int y=r.top(); y<=r.bottom(); y++ ) {
+    uint *line = (uint *)frame->scanLine( y );
+    memmove( line + tx, line + sx, w*sizeof( uint ) );
+  }
 }
 
 
@@ -3549,12 +3685,27 @@ void Plot::customEvent( QEvent *qce )
     mouseAnalyse( pme->ME );
     break;
   }
+  case 102: {
+    render();
+    break;
+  }
   default:
     QWidget::customEvent( qce );
   }
 }
 
 
+Plot::DataSnapshot::DataSnapshot( void )
+  : DataElement( Map ),
+    LineFirst( 0 ),
+    LineLast( 0 ),
+    PointFirst( 0 ),
+    PointLast( 0 ),
+    Offset( 0 )
+{
+}
+
+
 Plot::RangeCopy::RangeCopy( void ) 
 {
   for ( int k=0; k<MaxAxis; k++ ) {
@@ -0,0 +1,216 @@
+/*
+  plotrenderer.cc
+  Renders plots into off-screen images in a background thread.
+
+  RELACS - Relaxed ELectrophysiological data Acquisition, Control, and Stimulation
+  Copyright (C) 2002-2015 Jan Benda <jan.benda@uni-tuebingen.de>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+  
+  RELACS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QCoreApplication>
+#include <relacs/plotrenderer.h>
+
+namespace relacs {
+
+
+PlotRenderer::Target::Target( void )
+  : FrameInterval( 40 ),
+    LastFrame( -1000000 ),
+    Frames( 0 ),
+    DroppedFrames( 0 )
+{
+}
+
+
+PlotRenderer::Target::~Target( void )
+{
+  cancelFrames();
+}
+
+
+double PlotRenderer::Target::maxFrameRate( void ) const
+{
+  return FrameInterval > 0 ? 1000.0/FrameInterval : 0.0;
+}
+
+
+void PlotRenderer::Target::setMaxFrameRate( double rate )
+{
+  FrameInterval = rate > 0.0 ? (int)( 1000.0/rate ) : 0;
+}
+
+
+long PlotRenderer::Target::frames( void ) const
+{
+  return Frames;
+}
+
+
+long PlotRenderer::Target::droppedFrames( void ) const
+{
+  return DroppedFrames;
+}
+
+
+void PlotRenderer::Target::requestFrame( void )
+{
+  PlotRenderer::renderer()->request( this, 0 );
+}
+
+
+void PlotRenderer::Target::retryFrame( int delay )
+{
+  PlotRenderer::renderer()->request( this, delay );
+}
+
+
+void PlotRenderer::Target::frameDone( void )
+{
+  Frames++;
+}
+
+
+void PlotRenderer::Target::cancelFrames( void )
+{
+  RendererMutex.lock();
+  PlotRenderer *r = Renderer;
+  RendererMutex.unlock();
+  if ( r != 0 )
+    r->cancel( this );
+}
+
+
+PlotRenderer *PlotRenderer::Renderer = 0;
+QMutex PlotRenderer::RendererMutex;
+
+
+PlotRenderer::PlotRenderer( void )
+  : QThread(),
+    Current( 0 ),
+    Quit( false )
+{
+  Clock.start();
+}
+
+
+PlotRenderer::~PlotRenderer( void )
+{
+}
+
+
+PlotRenderer *PlotRenderer::renderer( void )
+{
+  QMutexLocker locker( &RendererMutex );
+  if ( Renderer == 0 ) {
+    Renderer = new PlotRenderer;
+    Renderer->start( QThread::LowPriority );
+    qAddPostRoutine( PlotRenderer::quit );
+  }
+  return Renderer;
+}
+
+
+void PlotRenderer::quit( void )
+{
+  RendererMutex.lock();
+  PlotRenderer *r = Renderer;
+  Renderer = 0;
+  RendererMutex.unlock();
+  if ( r == 0 )
+    return;
+  r->Mutex.lock();
+  r->Quit = true;
+  r->Requests.clear();
+  r->Wait.wakeAll();
+  r->Mutex.unlock();
+  r->wait();
+  delete r;
+}
+
+
+void PlotRenderer::request( Target *target, int delay )
+{
+  QMutexLocker locker( &Mutex );
+  if ( Quit )
+    return;
+  qint64 due = Clock.elapsed() + delay;
+  // limit the frame rate:
+  if ( delay == 0 && due < target->LastFrame + target->FrameInterval )
+    due = target->LastFrame + target->FrameInterval;
+  for ( deque< Request >::iterator rp = Requests.begin(); rp != Requests.end(); ++rp ) {
+    if ( rp->T == target ) {
+      // the pending frame will show the new data as well:
+      if ( delay == 0 )
+	target->DroppedFrames++;
+      return;
+    }
+  }
+  Request r;
+  r.T = target;
+  r.Due = due;
+  Requests.push_back( r );
+  Wait.wakeAll();
+}
+
+
+void PlotRenderer::cancel( Target *target )
+{
+  QMutexLocker locker( &Mutex );
+  for ( deque< Request >::iterator rp = Requests.begin(); rp != Requests.end(); ) {
+    if ( rp->T == target )
+      rp = Requests.erase( rp );
+    else
+      ++rp;
+  }
+  while ( Current == target )
+    Finished.wait( &Mutex );
+}
+
+
+void PlotRenderer::run( void )
+{
+  Mutex.lock();
+  while ( ! Quit ) {
+    if ( Requests.empty() ) {
+      Wait.wait( &Mutex );
+      continue;
+    }
+    // find the next due request:
+    deque< Request >::iterator np = Requests.begin();
+    for ( deque< Request >::iterator rp = Requests.begin()+1; rp != Requests.end(); ++rp ) {
+      if ( rp->Due < np->Due )
+	np = rp;
+    }
+    qint64 now = Clock.elapsed();
+    if ( np->Due > now ) {
+      Wait.wait( &Mutex, (unsigned long)( np->Due - now ) );
+      continue;
+    }
+    // render the frame:
+    Current = np->T;
+    Requests.erase( np );
+    Current->LastFrame = now;
+    Mutex.unlock();
+    Current->render();
+    Mutex.lock();
+    Current = 0;
+    Finished.wakeAll();
+  }
+  Mutex.unlock();
+}
+
+
+}; /* namespace relacs */
+
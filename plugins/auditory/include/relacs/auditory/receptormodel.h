@@ -91,6 +91,7 @@ option with default values and data type):
 - \c noise=0: Standard deviation of current noise (\c number)
 - \c deltat=0.005ms: Delta t (\c number)
 - \c integrator=Euler: Method of integration (\c string)
+- \c tolerance=0.0001: Tolerance of adaptive integrator (\c number)
 - Square = ax^2+imin, a=(imax-imin)/cut^2
 - Square saturated = imax, for |x|>=cut
 - Linear = b|x|+imin, b=(imax-imin)/cut
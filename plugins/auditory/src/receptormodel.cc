@@ -203,19 +203,19 @@ void ReceptorModel::main( void )
 
   // equilibrium:
   for ( int c=0; c<100; c++ ) {
-    double t = c * timeStep();
+    double t = c * integrationStep();
     (*neuron())( t, 0.0, simx+sigdimension, dxdt+sigdimension, neuron()->dimension() );
     for ( int k=sigdimension; k<simn; k++ )
-      simx[k] += timeStep()*dxdt[k];
+      simx[k] += integrationStep()*dxdt[k];
   }
 
   // integrate:
-  Random rand;
+  RandomXoshiro rand;
   double pv = simx[sigdimension];
   double t = 1000.0*time( 0 );  // time must be syncrhonous to recorded trace!
   while ( ! interrupt() ) {
 
-    Integrate( t, simx, dxdt, simn, timeStep(), *this );
+    integrateStep( t, simx, dxdt, simn );
 
     cs++;
     if ( cs == maxs ) {
@@ -246,6 +246,15 @@ void ReceptorModel::process( const OutData &source, OutData &dest )
   int inx = source.indices( 5.0*TDec );
   dest.reserve( source.size() + inx );
   dest = source;
+  if ( dest.streaming() ) {
+    // the nonlinearity is applied to each sample, expand the stream:
+    OutData sd( source );
+    int n = sd.deviceSize();
+    dest.clearSource();
+    dest.resize( n );
+    for ( int k=0; k<n; k++ )
+      dest[k] = sd.streamValue( k );
+  }
 
   // tympanum:
   if ( TympanumModel == 1 ) {
@@ -287,15 +296,13 @@ void ReceptorModel::process( const OutData &source, OutData &dest )
 
 void ReceptorModel::operator()( double t, double *x, double *dxdt, int n )
 {
-  static Random rand;
-
   double s = signal( 0.001 * t, LeftSpeaker[0] );
   s += signal( 0.001 * t, RightSpeaker[0] );
   if ( TympanumModel == 2 ) {
     dxdt[0] = x[1];
     dxdt[1] = -Beta*x[0] - Alpha*x[1] + s;
     double s = ( (this->*Nonlinearity)( x[0] ) + neuron()->offset() ) * neuron()->gain();
-    s += noiseFac() * rand.gaussian();
+    s += noiseFac() * whiteNoise( 0 );
     if ( MMCInx >= 0 )
       s -= GMC*x[MMCInx]*(x[2]-EMC);
     if ( MMHCInx >= 0 )
@@ -313,7 +320,7 @@ void ReceptorModel::operator()( double t, double *x, double *dxdt, int n )
     }
   }
   else {
-    s += noiseFac() * rand.gaussian();
+    s += noiseFac() * whiteNoise( 0 );
     if ( MMCInx >= 0 )
       s -= GMC*x[MMCInx]*(x[0]-EMC);
     if ( MMHCInx >= 0 )
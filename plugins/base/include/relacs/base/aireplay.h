@@ -0,0 +1,204 @@
+/*
+  base/aireplay.h
+  Replays recorded traces as analog input.
+
+  RELACS - Relaxed ELectrophysiological data Acquisition, Control, and Stimulation
+  Copyright (C) 2002-2015 Jan Benda <jan.benda@uni-tuebingen.de>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+  
+  RELACS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _RELACS_BASE_AIREPLAY_H_
+#define _RELACS_BASE_AIREPLAY_H_ 1
+
+#include <cstdio>
+#include <vector>
+#include <QTime>
+#include <relacs/analoginput.h>
+#ifdef HAVE_NIX
+#include <nix.hpp>
+#endif
+using namespace std;
+using namespace relacs;
+
+namespace base {
+
+
+/*! 
+\class AIReplay
+\author Jan Benda
+\version 1.0
+\brief [AnalogInput] Replays recorded traces as analog input.
+
+AIReplay streams the traces of a previous recording through the
+normal analog input path of RELACS, so that filters, detectors, and
+RePros can be tuned and tested on real data.  The device is the path
+of a recording, i.e. either a directory containing the \c trace-*.raw
+files written by RELACS or a NIX file. Channel \c n of the device
+replays the \c n-th trace of the recording (\c trace-n+1.raw).  The
+sampling rate of the input traces needs to match the one of the
+recording. The recorded data are already in the units of the input
+traces, so use a scale of one and the same unit as in the recording.
+
+The stimuli and restarts stored in \c stimulus-events.dat and \c
+restart-events.dat (or the corresponding event arrays of the NIX file)
+are replayed at their recorded times as Stimulus and Restart events
+(see replayedEvents()).
+
+When the end of the recording is reached, the analog input stops.
+
+\par Options:
+- \c speed: Replay speed relative to the recording, 0 replays as fast as possible
+- \c starttime: Time in the recording at which the replay starts
+
+\par Example
+\code
+*Analog Input Devices
+  Device1:
+      plugin: AIReplay
+      device: 2015-03-10-aa
+      ident : ai-1
+      speed : 1
+\endcode
+*/
+
+class AIReplay : public AnalogInput
+{
+
+public:
+
+    /*! Device type id for replaying recorded data. */
+  static const int ReplayAnalogInputType = 5;
+
+    /*! Create a new AIReplay without opening a device. */
+  AIReplay( void );
+    /*! Stop analog input and close the recording. */
+  virtual ~AIReplay( void );
+
+    /*! Open the recording at \a device, i.e. a directory with
+        trace-*.raw files or a NIX file. */
+  virtual int open( const string &device ) override;
+    /*! Returns true if a recording is open. */
+  virtual bool isOpen( void ) const;
+    /*! Close the recording. */
+  virtual void close( void );
+
+    /*! The number of traces in the recording. */
+  virtual int channels( void ) const;
+    /*! Resolution in bits of analog input. */
+  virtual int bits( void ) const;
+    /*! The sampling rate of the recording. */
+  virtual double maxRate( void ) const;
+
+    /*! A single range. */
+  virtual int maxRanges( void ) const;
+    /*! The data are already scaled, so the range is a dummy value. */
+  virtual double unipolarRange( int index ) const;
+    /*! The data are already scaled, so the range is a dummy value. */
+  virtual double bipolarRange( int index ) const;
+
+    /*! Prepare replay of the input traces \a traces. */
+  virtual int prepareRead( InList &traces );
+    /*! Start replaying the data. */
+  virtual int startRead( QSemaphore *sp=0, QReadWriteLock *datamutex=0,
+			 QWaitCondition *datawait=0, QSemaphore *aosp=0 );
+    /*! Read the data that are due from the recording into the internal buffer. */
+  virtual int readData( void );
+    /*! Push the data from the internal buffer into the input traces. */
+  virtual int convertData( void );
+
+    /*! Stop replay. */
+  virtual int stop( void );
+    /*! Reset the replay. */
+  virtual int reset( void );
+
+    /*! The replayed stimuli and restarts. */
+  virtual void replayedEvents( vector< double > &signaltimes,
+			       vector< double > &signaldurations,
+			       vector< double > &restarttimes );
+
+
+protected:
+
+    /*! Check the sampling rates and channels of \a traces. */
+  virtual int testReadDevice( InList &traces );
+    /*! Options of the replay. */
+  virtual void initOptions( void );
+
+
+private:
+
+    /*! Open the trace-*.raw files in the directory \a path. */
+  int openRelacs( const string &path );
+    /*! Read the event times from the first column and, if \a sizes
+        is not null, the values of the second column
+        of the RELACS event file \a file into \a times. */
+  void loadEvents( const string &file, vector< double > &times,
+		   vector< double > *sizes );
+#ifdef HAVE_NIX
+    /*! Open the sampled data arrays of the NIX file \a path. */
+  int openNix( const string &path );
+#endif
+    /*! Read \a n data elements of channel \a channel starting at index \a index
+        of the recording into \a buffer.
+        \return the number of read data elements. */
+  long readChannel( int channel, long index, float *buffer, long n );
+
+  bool IsOpen;
+  bool IsPrepared;
+  bool IsRunning;
+
+    /*! The trace-*.raw files of a RELACS recording. */
+  vector< FILE* > Files;
+#ifdef HAVE_NIX
+  nix::File NixFile;
+  vector< nix::DataArray > NixArrays;
+#endif
+    /*! Number of data elements per channel in the recording. */
+  long Samples;
+    /*! The sampling rate of the recording. */
+  double SampleRate;
+
+    /*! Recorded stimulus times, durations, and restart times. */
+  vector< double > StimulusTimes;
+  vector< double > StimulusDurations;
+  vector< double > RestartTimes;
+  int StimulusIndex;
+  int RestartIndex;
+    /*! Stimuli and restarts replayed but not yet reported. */
+  vector< double > SignalTimes;
+  vector< double > SignalDurations;
+  vector< double > Restarts;
+    /*! Time of the input traces corresponding to the start of the recording. */
+  double TimeOffset;
+
+  InList *Traces;
+    /*! Data read from the recording for each trace. */
+  vector< vector< float > > Buffer;
+    /*! Number of data elements per trace in Buffer. */
+  long BufferN;
+    /*! Index of the next data element in the recording. */
+  long Index;
+    /*! Index at which the replay started. */
+  long StartIndex;
+    /*! Measures the time since the start of the replay. */
+  QTime Timer;
+
+};
+
+
+}; /* namespace base */
+
+#endif /* ! _RELACS_BASE_AIREPLAY_H_ */
+
@@ -0,0 +1,111 @@
+/*
+  base/convolution.h
+  Convolves the data with a kernel by FFTs
+
+  RELACS - Relaxed ELectrophysiological data Acquisition, Control, and Stimulation
+  Copyright (C) 2002-2015 Jan Benda <jan.benda@uni-tuebingen.de>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+  
+  RELACS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _RELACS_BASE_CONVOLUTION_H_
+#define _RELACS_BASE_CONVOLUTION_H_ 1
+
+#include <vector>
+#include <relacs/optwidget.h>
+#include <relacs/indata.h>
+#include <relacs/overlapsave.h>
+#include <relacs/filter.h>
+using namespace relacs;
+
+namespace base {
+
+
+/*! 
+\class Convolution
+\brief [Filter] Convolves the data with a kernel by FFTs
+\author Jan Benda
+
+The input \a x(t) is convolved with a kernel \a K(t) of unit area
+\f[ y(t) = \int K(\tau) x(t-\tau) \, d\tau \f]
+by means of the overlap-save method (see OverlapSave).
+The kernel is centered at zero, i.e. it is non-causal and
+the filtered data do not have a delay.
+
+The filtered data are computed in blocks of at least three times the
+kernel length. Therefore they lag behind the input by the block size
+plus half the kernel width. 
+For short kernels and lower latencies use the LowPass filter.
+
+Add the convolution filter with the following lines to a \c relacs.cfg %file:
+\verbatim
+*FilterDetectors
+  Filter1
+        name: SV-1
+      filter: Convolution
+  inputtrace: V-1
+        save: false
+        plot: true
+  buffersize: 500000
+\endverbatim
+
+\par Options
+- \c kernel=Gauss: Kernel (\c string)
+- \c width=1ms: Standard deviation of the kernel (\c number)
+
+\version 1.0 (Oct 18 2026)
+*/
+
+
+class Convolution : public Filter
+{
+  Q_OBJECT
+
+public:
+
+    /*! The constructor. */
+  Convolution( const string &ident="", int mode=0 );
+    /*! The destructor. */
+  ~Convolution( void );
+
+  virtual int init( const InData &indata, InData &outdata );
+  virtual int adjust( const InData &indata, InData &outdata );
+  virtual void notify( void );
+  virtual int filter( const InData &indata, InData &outdata );
+
+
+protected:
+
+    /*! Sample the kernel and set up the overlap-save filter
+        such that the next filtered sample is the one at 
+        index \a outdata.size(). */
+  void setKernel( const InData &indata, const InData &outdata );
+
+  OptWidget CFW;
+
+  int KernelType;
+  double Width;
+
+  bool Changed;
+  OverlapSave OS;
+  int Index;
+    /*! Number of filtered samples to be discarded after setKernel(). */
+  int Discard;
+
+};
+
+
+}; /* namespace base */
+
+#endif /* ! _RELACS_BASE_CONVOLUTION_H_ */
@@ -0,0 +1,546 @@
+/*
+  base/aireplay.cc
+  Replays recorded traces as analog input.
+
+  RELACS - Relaxed ELectrophysiological data Acquisition, Control, and Stimulation
+  Copyright (C) 2002-2015 Jan Benda <jan.benda@uni-tuebingen.de>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+  
+  RELACS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cstring>
+#include <fstream>
+#include <QMutexLocker>
+#include <relacs/str.h>
+#include <relacs/base/aireplay.h>
+#include <relacs/relacsplugin.h>
+using namespace relacs;
+
+namespace base {
+
+
+AIReplay::AIReplay( void )
+  : AnalogInput( "AIReplay", ReplayAnalogInputType )
+{
+  IsOpen = false;
+  IsPrepared = false;
+  IsRunning = false;
+  Samples = 0;
+  SampleRate = 0.0;
+  StimulusIndex = 0;
+  RestartIndex = 0;
+  TimeOffset = 0.0;
+  Traces = 0;
+  BufferN = 0;
+  Index = 0;
+  StartIndex = 0;
+  initOptions();
+}
+
+
+AIReplay::~AIReplay( void )
+{
+  close();
+}
+
+
+void AIReplay::initOptions( void )
+{
+  AnalogInput::initOptions();
+
+  addNumber( "speed", "Replay speed relative to the recording (0: as fast as possible)",
+	     1.0, 0.0, 1000.0, 0.1 );
+  addNumber( "starttime", "Start replay at", 0.0, 0.0, 1.0e8, 1.0, "s" );
+}
+
+
+int AIReplay::open( const string &device )
+{
+  clearError();
+  Info.clear();
+  Settings.clear();
+
+  int r = InvalidDevice;
+  Str path = device;
+  path.preventLast( Str::dirSep() );
+  if ( path.suffix() == ".nix" ) {
+#ifdef HAVE_NIX
+    r = openNix( path );
+#else
+    setErrorStr( "RELACS was compiled without NIX support: cannot replay " + path );
+#endif
+  }
+  else
+    r = openRelacs( path );
+  if ( r != 0 ) {
+    close();
+    return r;
+  }
+
+  // start time:
+  Index = (long)::floor( number( "starttime" )*SampleRate );
+  if ( Index > Samples )
+    Index = Samples;
+  StimulusIndex = 0;
+  while ( StimulusIndex < (int)StimulusTimes.size() &&
+	  StimulusTimes[StimulusIndex]*SampleRate < Index )
+    StimulusIndex++;
+  RestartIndex = 0;
+  while ( RestartIndex < (int)RestartTimes.size() &&
+	  RestartTimes[RestartIndex]*SampleRate < Index )
+    RestartIndex++;
+
+  setDeviceName( "Replay of recorded data" );
+  setDeviceVendor( "RELACS" );
+  setDeviceFile( device );
+  IsOpen = true;
+  IsPrepared = false;
+  IsRunning = false;
+  setInfo();
+  Info.addInteger( "traces", channels() );
+  Info.addNumber( "duration", Samples/SampleRate, "s", "%.1f" );
+  Info.addInteger( "stimuli", StimulusTimes.size() );
+  Info.addInteger( "restarts", RestartTimes.size() );
+  return 0;
+}
+
+
+int AIReplay::openRelacs( const string &path )
+{
+  Str dir = path;
+  dir.provideLast( Str::dirSep() );
+  Samples = -1;
+  // the trace numbers are zero padded for more than 9 traces:
+  const char *formats[3] = { "%d", "%02d", "%03d" };
+  string format = formats[0];
+  for ( int i=0; i<3; i++ ) {
+    FILE *f = fopen( ( dir + "trace-" + Str( 1, formats[i] ) + ".raw" ).c_str(), "rb" );
+    if ( f != 0 ) {
+      fclose( f );
+      format = formats[i];
+      break;
+    }
+  }
+  for ( int k=1; ; k++ ) {
+    string file = dir + "trace-" + Str( k, format ) + ".raw";
+    FILE *f = fopen( file.c_str(), "rb" );
+    if ( f == 0 )
+      break;
+    fseek( f, 0, SEEK_END );
+    long n = ftell( f )/sizeof( float );
+    fseek( f, 0, SEEK_SET );
+    if ( Samples < 0 || n < Samples )
+      Samples = n;
+    Files.push_back( f );
+  }
+  if ( Files.empty() ) {
+    setErrorStr( "no trace-*.raw files found in " + path );
+    return InvalidDevice;
+  }
+
+  // sampling rate from the recording's data index:
+  SampleRate = 0.0;
+  ifstream sf( ( dir + "stimuli.dat" ).c_str() );
+  string line;
+  while ( getline( sf, line ) ) {
+    Str s( line );
+    int i = s.find( "sample interval1" );
+    if ( i < 0 )
+      continue;
+    double si = s.number( -1.0, s.find( ':', i ) + 1 );
+    Str u = s.unit( "", s.find( ':', i ) + 1 );
+    if ( u == "ms" )
+      si *= 0.001;
+    else if ( u == "us" )
+      si *= 1.0e-6;
+    if ( si > 0.0 )
+      SampleRate = 1.0/si;
+    break;
+  }
+  if ( SampleRate <= 0.0 ) {
+    setErrorStr( "no sampling rate found in " + dir + "stimuli.dat" );
+    return InvalidDevice;
+  }
+
+  loadEvents( dir + "stimulus-events.dat", StimulusTimes, &StimulusDurations );
+  loadEvents( dir + "restart-events.dat", RestartTimes, 0 );
+  return 0;
+}
+
+
+void AIReplay::loadEvents( const string &file, vector< double > &times,
+			   vector< double > *sizes )
+{
+  times.clear();
+  if ( sizes != 0 )
+    sizes->clear();
+  ifstream sf( file.c_str() );
+  string line;
+  while ( getline( sf, line ) ) {
+    Str s( line );
+    if ( s.empty() || s[0] == '#' )
+      continue;
+    int next = 0;
+    double t = s.number( -1.0, 0, &next );
+    if ( next <= 0 )
+      continue;
+    times.push_back( t );
+    if ( sizes != 0 )
+      sizes->push_back( s.number( 0.0, next ) );
+  }
+}
+
+
+#ifdef HAVE_NIX
+int AIReplay::openNix( const string &path )
+{
+  try {
+    NixFile = nix::File::open( path, nix::FileMode::ReadOnly );
+    if ( NixFile.blockCount() == 0 ) {
+      setErrorStr( "no data found in " + path );
+      return InvalidDevice;
+    }
+    nix::Block block = NixFile.blocks()[0];
+    Samples = -1;
+    SampleRate = 0.0;
+    StimulusTimes.clear();
+    StimulusDurations.clear();
+    RestartTimes.clear();
+    for ( nix::DataArray da : block.dataArrays() ) {
+      string type = da.type();
+      if ( type.find( "relacs.data.sampled." ) == 0 &&
+	   type.find( "relacs.data.sampled.Filtered-" ) != 0 ) {
+	long n = da.dataExtent()[0];
+	if ( Samples < 0 || n < Samples )
+	  Samples = n;
+	if ( SampleRate <= 0.0 ) {
+	  nix::Dimension dim = da.getDimension( 1 );
+	  if ( dim.dimensionType() == nix::DimensionType::Sample )
+	    SampleRate = 1.0/dim.asSampledDimension().samplingInterval();
+	}
+	NixArrays.push_back( da );
+      }
+      else if ( type == "relacs.data.events.Stimulus" ||
+		type == "relacs.data.events.Restart" ) {
+	vector< double > &times = type == "relacs.data.events.Stimulus" ?
+	  StimulusTimes : RestartTimes;
+	times.resize( da.dataExtent()[0] );
+	if ( ! times.empty() )
+	  da.getData( nix::DataType::Double, times.data(),
+		      { (nix::ndsize_t)times.size() }, { 0 } );
+      }
+    }
+    // NIX files do not store the stimulus durations as event widths:
+    StimulusDurations.assign( StimulusTimes.size(), 0.0 );
+  }
+  catch ( std::exception &e ) {
+    setErrorStr( "failed to open " + path + ": " + e.what() );
+    return InvalidDevice;
+  }
+  if ( NixArrays.empty() || SampleRate <= 0.0 ) {
+    setErrorStr( "no sampled traces found in " + path );
+    return InvalidDevice;
+  }
+  return 0;
+}
+#endif
+
+
+bool AIReplay::isOpen( void ) const
+{
+  lock();
+  bool o = IsOpen;
+  unlock();
+  return o;
+}
+
+
+void AIReplay::close( void )
+{
+  if ( ! isOpen() && Files.empty() )
+    return;
+
+  reset();
+
+  lock();
+  for ( unsigned int k=0; k<Files.size(); k++ )
+    fclose( Files[k] );
+  Files.clear();
+#ifdef HAVE_NIX
+  NixArrays.clear();
+  if ( NixFile )
+    NixFile.close();
+#endif
+  Samples = 0;
+  SampleRate = 0.0;
+  StimulusTimes.clear();
+  StimulusDurations.clear();
+  RestartTimes.clear();
+  IsOpen = false;
+  Info.clear();
+  unlock();
+}
+
+
+int AIReplay::channels( void ) const
+{
+#ifdef HAVE_NIX
+  if ( ! NixArrays.empty() )
+    return NixArrays.size();
+#endif
+  return Files.size();
+}
+
+
+int AIReplay::bits( void ) const
+{
+  return 32;
+}
+
+
+double AIReplay::maxRate( void ) const
+{
+  return SampleRate;
+}
+
+
+int AIReplay::maxRanges( void ) const
+{
+  return 1;
+}
+
+
+double AIReplay::unipolarRange( int index ) const
+{
+  return index == 0 ? 10.0 : -1.0;
+}
+
+
+double AIReplay::bipolarRange( int index ) const
+{
+  return index == 0 ? 10.0 : -1.0;
+}
+
+
+int AIReplay::testReadDevice( InList &traces )
+{
+  if ( ::fabs( traces[0].sampleRate() - SampleRate ) > 1.0e-6*SampleRate ) {
+    traces.addErrorStr( "sampling rate must match the one of the recording ("
+			+ Str( SampleRate, 0, 0, 'f' ) + "Hz)" );
+    traces.addError( DaqError::InvalidSampleRate );
+    traces.setSampleRate( SampleRate );
+  }
+  for ( int k=0; k<traces.size(); k++ ) {
+    if ( traces[k].continuous() == false ) {
+      traces[k].addError( DaqError::InvalidContinuous );
+      traces[k].setContinuous();
+    }
+  }
+  return traces.failed() ? -1 : 0;
+}
+
+
+int AIReplay::prepareRead( InList &traces )
+{
+  if ( ! isOpen() )
+    return -1;
+
+  QMutexLocker locker( mutex() );
+
+  // replay rate:
+  double speed = number( "speed" );
+  long buffern = speed > 0.0 ? (long)::ceil( 0.1*speed*SampleRate ) : (long)::ceil( 0.1*SampleRate );
+  if ( buffern > traces[0].capacity()/4 )
+    buffern = traces[0].capacity()/4;
+  if ( buffern < 1 )
+    buffern = 1;
+  Buffer.resize( traces.size() );
+  for ( int k=0; k<traces.size(); k++ )
+    Buffer[k].resize( buffern );
+  BufferN = 0;
+
+  setSettings( traces, buffern*traces.size()*sizeof( float ) );
+  Traces = &traces;
+  IsPrepared = true;
+  return 0;
+}
+
+
+int AIReplay::startRead( QSemaphore *sp, QReadWriteLock *datamutex,
+			 QWaitCondition *datawait, QSemaphore *aosp )
+{
+  QMutexLocker locker( mutex() );
+
+  if ( ! IsPrepared || Traces == 0 ) {
+    cerr << "AIReplay::startRead(): not prepared or no traces!\n";
+    return -1;
+  }
+
+  // recording time zero in terms of the input traces:
+  TimeOffset = (*Traces)[0].currentTime() - Index/SampleRate;
+  SignalTimes.clear();
+  SignalDurations.clear();
+  Restarts.clear();
+  StartIndex = Index;
+  Timer.start();
+  IsRunning = true;
+  startThread( sp, datamutex, datawait );
+  return 0;
+}
+
+
+long AIReplay::readChannel( int channel, long index, float *buffer, long n )
+{
+#ifdef HAVE_NIX
+  if ( ! NixArrays.empty() ) {
+    try {
+      NixArrays[channel].getData( nix::DataType::Float, buffer,
+				  { (nix::ndsize_t)n }, { (nix::ndsize_t)index } );
+    }
+    catch ( std::exception &e ) {
+      return -1;
+    }
+    return n;
+  }
+#endif
+  FILE *f = Files[channel];
+  if ( ftell( f ) != long( index*sizeof( float ) ) )
+    fseek( f, index*sizeof( float ), SEEK_SET );
+  return fread( buffer, sizeof( float ), n, f );
+}
+
+
+int AIReplay::readData( void )
+{
+  if ( Traces == 0 || Buffer.empty() )
+    return -1;
+
+  // end of recording:
+  if ( Index >= Samples ) {
+    IsRunning = false;
+    return -1;
+  }
+
+  // number of data elements that are due:
+  long n = Buffer[0].size() - BufferN;
+  double speed = number( "speed" );
+  if ( speed > 0.0 ) {
+    long due = StartIndex + (long)::floor( 0.001*Timer.elapsed()*speed*SampleRate );
+    if ( due - Index < n )
+      n = due - Index;
+  }
+  if ( Index + n > Samples )
+    n = Samples - Index;
+  if ( n <= 0 )
+    return 0;
+
+  for ( int k=0; k<Traces->size(); k++ ) {
+    long r = readChannel( (*Traces)[k].channel(), Index, &Buffer[k][BufferN], n );
+    if ( r < n ) {
+      Traces->addErrorStr( "failed to read from recording " + deviceFile() );
+      Traces->addError( DaqError::DeviceError );
+      return -2;
+    }
+  }
+  BufferN += n;
+  Index += n;
+  return n;
+}
+
+
+int AIReplay::convertData( void )
+{
+  if ( Traces == 0 || Buffer.empty() )
+    return -1;
+
+  // the recorded data are already in the units of the traces:
+  for ( int k=0; k<Traces->size(); k++ ) {
+    InData &trace = (*Traces)[k];
+    int n = BufferN;
+    const float *bp = &Buffer[k][0];
+    while ( n > 0 ) {
+      int m = trace.maxPush();
+      if ( m > n )
+	m = n;
+      memcpy( trace.pushBuffer(), bp, m*sizeof( float ) );
+      trace.push( m );
+      bp += m;
+      n -= m;
+    }
+  }
+
+  // replay events that have been passed:
+  while ( StimulusIndex < (int)StimulusTimes.size() &&
+	  StimulusTimes[StimulusIndex]*SampleRate < Index ) {
+    SignalTimes.push_back( StimulusTimes[StimulusIndex] + TimeOffset );
+    SignalDurations.push_back( StimulusDurations[StimulusIndex] );
+    StimulusIndex++;
+  }
+  while ( RestartIndex < (int)RestartTimes.size() &&
+	  RestartTimes[RestartIndex]*SampleRate < Index ) {
+    Restarts.push_back( RestartTimes[RestartIndex] + TimeOffset );
+    RestartIndex++;
+  }
+
+  int n = BufferN;
+  BufferN = 0;
+  return n;
+}
+
+
+void AIReplay::replayedEvents( vector< double > &signaltimes,
+			       vector< double > &signaldurations,
+			       vector< double > &restarttimes )
+{
+  QMutexLocker locker( mutex() );
+  signaltimes.swap( SignalTimes );
+  signaldurations.swap( SignalDurations );
+  restarttimes.swap( Restarts );
+  SignalTimes.clear();
+  SignalDurations.clear();
+  Restarts.clear();
+}
+
+
+int AIReplay::stop( void )
+{
+  if ( ! isOpen() )
+    return NotOpen;
+
+  stopRead();
+
+  lock();
+  IsRunning = false;
+  unlock();
+  return 0;
+}
+
+
+int AIReplay::reset( void )
+{
+  lock();
+  Buffer.clear();
+  BufferN = 0;
+  Settings.clear();
+  IsPrepared = false;
+  IsRunning = false;
+  Traces = 0;
+  unlock();
+  return 0;
+}
+
+
+addAnalogInput( AIReplay, base );
+
+}; /* namespace base */
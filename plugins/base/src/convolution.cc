@@ -0,0 +1,154 @@
+/*
+  base/convolution.cc
+  Convolves the data with a kernel by FFTs
+
+  RELACS - Relaxed ELectrophysiological data Acquisition, Control, and Stimulation
+  Copyright (C) 2002-2015 Jan Benda <jan.benda@uni-tuebingen.de>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+  
+  RELACS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <relacs/kernel.h>
+#include <relacs/base/convolution.h>
+using namespace relacs;
+
+namespace base {
+
+
+Convolution::Convolution( const string &ident, int mode )
+  : Filter( ident, mode, SingleAnalogFilter, 1,
+	    "Convolution", "base", "Jan Benda", "1.0", "Oct 18 2026" )
+{
+  // parameter:
+  KernelType = 0;
+  Width = 0.001;
+  Changed = false;
+  Index = 0;
+  Discard = 0;
+
+  // options:
+  newSection( "Convolution filter", 1, OptWidget::LabelBold );
+  addSelection( "kernel", "Kernel", "Gauss|Epanechnikov|Triangular|Rectangular" );
+  addNumber( "width", "Standard deviation of the kernel", Width, 0.0, 10000.0, 0.0001, "s", "ms", "%.2f", 2 );
+  setDialogSelectMask( 2 );
+
+  CFW.assign( ((Options*)this), 0, 0, true, 0, mutex() );
+  setWidget( &CFW );
+}
+
+
+Convolution::~Convolution( void )
+{
+}
+
+
+int Convolution::init( const InData &indata, InData &outdata )
+{
+  setKernel( indata, outdata );
+  return 0;
+}
+
+
+int Convolution::adjust( const InData &indata, InData &outdata )
+{
+  outdata.setMinValue( indata.minValue() );
+  outdata.setMaxValue( indata.maxValue() );
+  return 0;
+}
+
+
+void Convolution::notify( void )
+{
+  int kerneltype = index( "kernel" );
+  if ( kerneltype != KernelType ) {
+    KernelType = kerneltype;
+    Changed = true;
+  }
+  double width = number( "width" );
+  if ( width > 0.0 ) {
+    if ( width != Width ) {
+      Width = width;
+      Changed = true;
+    }
+  }
+  else
+    setNumber( "width", Width );
+  CFW.updateValues( OptWidget::changedFlag() );
+}
+
+
+void Convolution::setKernel( const InData &indata, const InData &outdata )
+{
+  Kernel *kernel = 0;
+  if ( KernelType == 1 )
+    kernel = new EpanechnikovKernel( Width );
+  else if ( KernelType == 2 )
+    kernel = new TriangularKernel( Width );
+  else if ( KernelType == 3 )
+    kernel = new RectKernel( Width );
+  else
+    kernel = new GaussKernel( Width );
+  double deltat = indata.sampleInterval();
+  vector< double > h;
+  int i0 = kernel->sample( 0.0, deltat, h );
+  delete kernel;
+  if ( h.empty() ) {
+    // kernel narrower than the sampling interval:
+    h.push_back( 1.0 );
+    i0 = 0;
+  }
+  else {
+    for ( unsigned int k=0; k<h.size(); k++ )
+      h[k] *= deltat;
+  }
+  int offs = -i0;
+  OS.setFilter( &h[0], h.size(), offs );
+
+  // continue with the next filtered sample,
+  // including the data the filter needs before it:
+  int next = outdata.size();
+  Index = next + offs - (int)h.size() + 1;
+  if ( Index > next )
+    Index = next;
+  if ( Index < indata.minIndex() )
+    Index = indata.minIndex();
+  Discard = next - Index;
+  Changed = false;
+}
+
+
+int Convolution::filter( const InData &indata, InData &outdata )
+{
+  if ( Changed )
+    setKernel( indata, outdata );
+
+  for ( ; Index < indata.size(); ++Index ) {
+    int n = OS.push( indata[Index] );
+    int k = 0;
+    if ( Discard > 0 ) {
+      k = Discard < n ? Discard : n;
+      Discard -= k;
+    }
+    for ( ; k<n; k++ )
+      outdata.push( (float)OS[k] );
+  }
+  return 0;
+}
+
+
+addFilter( Convolution, base );
+
+}; /* namespace base */
+
+#include "moc_convolution.cc"
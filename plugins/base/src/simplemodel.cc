@@ -61,10 +61,11 @@ void SimpleModel::main( void )
   double sinefreq = number( "sinefreq" );
 
   // integrate:
+  RandomXoshiro rand;
   while ( ! interrupt() ) {
     double v = 0.0;
     v += stimulusgain * signal( time( 0 ) );
-    v += noisegain * rnd.gaussian();
+    v += noisegain * rand.gaussian();
     v += sinegain * ::sin( 6.28318530717959*sinefreq*time( 0 ) );
     for ( int k=0; k<traces(); k++ ) {
       if ( trace( k ).source() == 0 && trace( k ).rawChannel() )
@@ -22,6 +22,7 @@
 #ifndef _RELACS_CALIBRATION_RESTARTDELAY_H_
 #define _RELACS_CALIBRATION_RESTARTDELAY_H_ 1
 
+#include <relacs/fitalgorithm.h>
 #include <relacs/plot.h>
 #include <relacs/repro.h>
 using namespace relacs;
@@ -66,6 +67,7 @@ public:
 protected:
 
   Plot P;
+  MarquardtWorkspace FitWork;
 
 };
 
@@ -156,17 +156,17 @@ int RestartDelay::analyze( const InData &data, double duration,
   ArrayI pi2( 4, 0 );  // phase only
   pi2[3] = 1;
   ArrayD uncert( 4 );
-  double chisq;
+  MarquardtStats stats;
 
   marquardtFit( d.range().begin(), d.range().begin()+d2,
 		d.begin(), d.begin()+d2,
 		s.begin(), s.begin()+d2,
-		sineFuncDerivs, p, pi1, uncert, chisq );
+		sineFuncJacobian, p, pi1, uncert, FitWork, stats );
   /*
   marquardtFit( d.range().begin(), d.range().begin()+d2,
 		d.begin(), d.begin()+d2,
 		s.begin(), s.begin()+d2,
-		sineFuncDerivs, p, pi2, uncert, chisq );
+		sineFuncJacobian, p, pi2, uncert, FitWork, stats );
   */
   double phase1 = p[3];
   SampleDataF s1( -duration, 0.0, d.stepsize() );
@@ -187,7 +187,7 @@ int RestartDelay::analyze( const InData &data, double duration,
   marquardtFit( d.range().begin()+d2, d.range().end(),
 		d.begin()+d2, d.end(),
 		s.begin()+d2, s.end(),
-		sineFuncDerivs, p, pi2, uncert, chisq );
+		sineFuncJacobian, p, pi2, uncert, FitWork, stats );
   double phase2 = p[3];
   SampleDataF s2( 0.0, duration, d.stepsize() );
   for ( int k=0; k<s2.size(); k++ )
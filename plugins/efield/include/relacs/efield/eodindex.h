@@ -0,0 +1,226 @@
+/*
+  efield/eodindex.h
+  A persistent, incrementally updated index of EOD peaks and troughs.
+
+  RELACS - Relaxed ELectrophysiological data Acquisition, Control, and Stimulation
+  Copyright (C) 2002-2015 Jan Benda <jan.benda@uni-tuebingen.de>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+  
+  RELACS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _RELACS_EFIELD_EODINDEX_H_
+#define _RELACS_EFIELD_EODINDEX_H_ 1
+
+#include <map>
+#include <string>
+#include <QMutex>
+#include <relacs/cyclicarray.h>
+#include <relacs/eventdata.h>
+#include <relacs/indata.h>
+using namespace std;
+using namespace relacs;
+
+namespace efield {
+
+
+/*!
+\class EODIndex
+\brief [lib] A persistent, incrementally updated index of EOD peaks and troughs.
+\author Jan Benda
+\version 1.0 (Oct 18, 2026)
+
+EODIndex keeps the times and sizes of all peaks and troughs of an EOD
+trace. Each call of update() analyzes only the data that were recorded
+since the previous call. Analysis windows of RePros can then be
+evaluated from the index by time range without scanning the raw
+data again.
+
+Peaks and troughs are detected with a hysteresis threshold that is
+set to ratio() times the peak-to-peak amplitude of the previous EOD
+cycle. This way the threshold follows amplitude modulations like beats
+and chirps. If no EOD cycle was detected within maxPeriod(), the
+threshold is re-estimated from the data of the last maxPeriod().
+
+Times and sizes of the peaks and troughs are the position and value
+of the extremum of a parabola fitted through the three data points
+around the detected maximum or minimum, respectively.
+
+The index stores as many EOD cycles as fit into the buffer of the
+analyzed InData at a maximum EOD frequency of maxRate().
+In addition, cumulative sums of the peak and trough sizes are kept,
+such that mean sizes and standard deviations over arbitrary time ranges
+are computed without iterating over the EOD cycles.
+Minimum and maximum sizes of blocks of 64 peaks and troughs
+speed up minMax() and matches() on long time ranges.
+
+Detecting peaks and troughs with a fixed threshold, as done by
+EODTools, may result in different EOD cycles. Use matches() to check
+whether the index can be used in place of such a detection.
+
+Use index() or updated() to retrieve the index that is shared by all plugins
+for a given trace. All member functions are thread safe.
+*/
+
+
+class EODIndex
+{
+
+public:
+
+    /*! Constructs an empty index. */
+  EODIndex( void );
+    /*! Destructor. */
+  ~EODIndex( void );
+
+    /*! The index shared by all plugins that analyzes
+        the trace with the same ident() as \a data.
+        The index is not updated by this function. */
+  static EODIndex &index( const InData &data );
+    /*! Update the shared index of \a data with the newly recorded data
+        and return it. */
+  static EODIndex &updated( const InData &data );
+
+    /*! Analyze the data of \a data that have been recorded since the
+        last call of update(). If the trace was restarted or the index
+        fell behind the buffer of \a data, the index is reset. */
+  void update( const InData &data );
+    /*! Clear the index. */
+  void clear( void );
+
+    /*! \return \c true if the EOD cycles in the time range
+        \a tbegin to \a tend are all contained in the index. */
+  bool contains( double tbegin, double tend ) const;
+    /*! The time since which the index contains all EOD cycles. */
+  double beginTime( void ) const;
+    /*! The time up to which data have been analyzed. */
+  double endTime( void ) const;
+
+    /*! The current threshold used for detecting peaks and troughs. */
+  double threshold( void ) const;
+    /*! The threshold relative to the peak-to-peak amplitude of the
+        previous EOD cycle. */
+  double ratio( void ) const;
+    /*! Set the relative threshold to \a ratio. */
+  void setRatio( double ratio );
+    /*! The maximum expected EOD period in seconds. */
+  double maxPeriod( void ) const;
+    /*! Set the maximum expected EOD period to \a period seconds. */
+  void setMaxPeriod( double period );
+    /*! The maximum expected EOD frequency in Hertz
+        that determines the capacity of the index. */
+  double maxRate( void ) const;
+    /*! Set the maximum expected EOD frequency to \a rate Hertz.
+        Takes effect on the next reset of the index. */
+  void setMaxRate( double rate );
+
+    /*! Copy the peaks between \a tbegin and \a tend to \a peaks. */
+  void peaks( double tbegin, double tend, EventData &peaks ) const;
+    /*! Copy the troughs between \a tbegin and \a tend to \a troughs. */
+  void troughs( double tbegin, double tend, EventData &troughs ) const;
+    /*! The number of peaks between \a tbegin and \a tend. */
+  int peakCount( double tbegin, double tend ) const;
+    /*! The number of troughs between \a tbegin and \a tend. */
+  int troughCount( double tbegin, double tend ) const;
+
+    /*! The mean size of the peaks between \a tbegin and \a tend.
+        Their standard deviation is returned in \a stdev. */
+  double meanPeaks( double tbegin, double tend, double &stdev ) const;
+    /*! The mean size of the peaks between \a tbegin and \a tend. */
+  double meanPeaks( double tbegin, double tend ) const;
+    /*! The mean size of the troughs between \a tbegin and \a tend.
+        Their standard deviation is returned in \a stdev. */
+  double meanTroughs( double tbegin, double tend, double &stdev ) const;
+    /*! The mean size of the troughs between \a tbegin and \a tend. */
+  double meanTroughs( double tbegin, double tend ) const;
+    /*! The mean EOD amplitude (0.5 * p-p amplitude)
+        between \a tbegin and \a tend. */
+  double amplitude( double tbegin, double tend ) const;
+    /*! The smallest trough in \a min and the largest peak in \a max
+        between \a tbegin and \a tend.
+        \return the number of EOD cycles in this time range,
+	i.e. the smaller one of the number of peaks and troughs.
+	Zero if there are no peaks or no troughs. */
+  int minMax( double tbegin, double tend, double &min, double &max ) const;
+    /*! \return \c true if detecting peaks and troughs with the fixed
+        \a threshold between \a tbegin and \a tend results in the
+        same EOD cycles as the ones of the index.  This is assumed if
+        \a threshold is smaller than the peak-to-peak amplitude of each
+        EOD cycle, but at least ratio() times of it.  The amplitude is
+        estimated from the smallest peak and the largest trough. */
+  bool matches( double tbegin, double tend, double threshold ) const;
+
+
+private:
+
+  void reset( const InData &data, int index );
+  void estimateThreshold( const InData &data, int index );
+  void addExtremum( const InData &data, int index, bool peak );
+  double meanSize( const EventData &events, const CyclicArrayD &sum,
+		   const CyclicArrayD &sqsum, double offset,
+		   double tbegin, double tend, double &stdev ) const;
+  void copy( const EventData &events, double tbegin, double tend,
+	     EventData &out ) const;
+  int count( const EventData &events, double tbegin, double tend ) const;
+  void addBlock( CyclicArrayD &mins, CyclicArrayD &maxs,
+		 int index, double size );
+  double extremum( const EventData &events, const CyclicArrayD &blocks,
+		   int first, int last, bool max ) const;
+
+  EventData Peaks;
+  EventData Troughs;
+    /*! Cumulative sums of peak and trough sizes and squared sizes
+        relative to the size of the first peak or trough, respectively. */
+  CyclicArrayD PeakSum;
+  CyclicArrayD PeakSqSum;
+  CyclicArrayD TroughSum;
+  CyclicArrayD TroughSqSum;
+  double PeakOffset;
+  double TroughOffset;
+    /*! Minimum and maximum sizes of blocks of BlockSize
+        peaks and troughs. */
+  CyclicArrayD PeakMins;
+  CyclicArrayD PeakMaxs;
+  CyclicArrayD TroughMins;
+  CyclicArrayD TroughMaxs;
+  static const int BlockSize = 64;
+
+  double Ratio;
+  double MaxPeriod;
+  double MaxRate;
+  double Threshold;
+
+  double Offset;
+  double StepSize;
+  int StartIndex;
+  int BeginIndex;
+  int Index;
+  int Dir;
+  int ExtremumIndex;
+  double ExtremumValue;
+  int LastEventIndex;
+  double LastPeak;
+  double LastTrough;
+
+  mutable QMutex Mutex;
+
+  static map< string, EODIndex* > Indices;
+  static QMutex IndicesMutex;
+
+};
+
+
+}; /* namespace efield */
+
+#endif /* ! _RELACS_EFIELD_EODINDEX_H_ */
+
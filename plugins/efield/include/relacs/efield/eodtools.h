@@ -33,7 +33,14 @@ namespace efield {
 \class EODTools
 \brief [lib] Functions for analyzing EODs of weakly electric fish.
 \author Jan Benda
-\version 1.0 (Nov 27, 2009)
+\version 1.1 (Oct 18, 2026)
+
+eodThreshold(), eodAmplitude(), beatAmplitudes(), beatAmplitude(), and
+beatContrast() evaluate the EOD peaks and troughs from the EODIndex
+that is shared by all plugins for the analyzed trace. The raw data are
+scanned if the index does not cover the requested time range, or if
+the threshold resulting from the requested contrast would detect other
+EOD cycles than the index (see EODIndex::matches()).
 */
 
 
@@ -160,6 +167,18 @@ public:
 
     };
 
+
+protected:
+
+    /*! Mean sizes and standard deviations of the EOD peaks
+        (\a uppermean, \a uppersd) and troughs (\a lowermean, \a lowersd)
+        between \a wbegin and \a wend, detected in \a eodd
+        between \a tbegin and \a tend. */
+  void beatSizes( const InData &eodd, double tbegin, double tend,
+		  double wbegin, double wend, double contrast,
+		  double &uppermean, double &uppersd,
+		  double &lowermean, double &lowersd );
+
 };
 
 
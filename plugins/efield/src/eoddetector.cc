@@ -25,6 +25,7 @@
 #include <relacs/stats.h>
 #include <relacs/basisfunction.h>
 #include <relacs/fitalgorithm.h>
+#include <relacs/efield/eodindex.h>
 #include <relacs/efield/eoddetector.h>
 using namespace relacs;
 
@@ -193,6 +194,9 @@ int EODDetector::detect( const InData &data, EventData &outevents,
   D.peak( data.minBegin(), data.end(), outevents,
 	  Threshold, MinThresh, MaxThresh, *this );
 
+  // keep the shared index of EOD peaks and troughs up to date:
+  EODIndex::updated( data );
+
   if ( outevents.count( currentTime() - 0.1 ) <= 0 )
     outevents.updateMean( 1 );
   unsetNotify();
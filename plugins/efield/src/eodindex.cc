@@ -0,0 +1,585 @@
+/*
+  efield/eodindex.cc
+  A persistent, incrementally updated index of EOD peaks and troughs.
+
+  RELACS - Relaxed ELectrophysiological data Acquisition, Control, and Stimulation
+  Copyright (C) 2002-2015 Jan Benda <jan.benda@uni-tuebingen.de>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+  
+  RELACS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cmath>
+#include <QMutexLocker>
+#include <relacs/efield/eodindex.h>
+using namespace relacs;
+
+namespace efield {
+
+
+map< string, EODIndex* > EODIndex::Indices;
+QMutex EODIndex::IndicesMutex;
+
+
+EODIndex::EODIndex( void )
+  : Peaks( 0, true ),
+    Troughs( 0, true ),
+    PeakOffset( 0.0 ),
+    TroughOffset( 0.0 ),
+    Ratio( 0.5 ),
+    MaxPeriod( 0.1 ),
+    MaxRate( 2500.0 ),
+    Threshold( 0.0 ),
+    Offset( 0.0 ),
+    StepSize( 0.0 ),
+    StartIndex( 0 ),
+    BeginIndex( -1 ),
+    Index( -1 ),
+    Dir( 0 ),
+    ExtremumIndex( 0 ),
+    ExtremumValue( 0.0 ),
+    LastEventIndex( 0 ),
+    LastPeak( 0.0 ),
+    LastTrough( 0.0 )
+{
+  Peaks.setCyclic( true );
+  Peaks.setIdent( "EOD peaks" );
+  Troughs.setCyclic( true );
+  Troughs.setIdent( "EOD troughs" );
+  Troughs.setSource( 1 );
+}
+
+
+EODIndex::~EODIndex( void )
+{
+}
+
+
+EODIndex &EODIndex::index( const InData &data )
+{
+  QMutexLocker locker( &IndicesMutex );
+  map< string, EODIndex* >::iterator ip = Indices.find( data.ident() );
+  if ( ip != Indices.end() )
+    return *ip->second;
+  EODIndex *ei = new EODIndex;
+  Indices[ data.ident() ] = ei;
+  return *ei;
+}
+
+
+EODIndex &EODIndex::updated( const InData &data )
+{
+  EODIndex &ei = index( data );
+  ei.update( data );
+  return ei;
+}
+
+
+void EODIndex::update( const InData &data )
+{
+  QMutexLocker locker( &Mutex );
+
+  if ( data.stepsize() <= 0.0 )
+    return;
+
+  // restart:
+  int start = data.restartIndex();
+  if ( start < data.minIndex() )
+    start = data.minIndex();
+  if ( Index < 0 || data.stepsize() != StepSize ||
+       data.size() < StartIndex || Index < data.minIndex() ||
+       data.restartIndex() > StartIndex )
+    reset( data, start );
+
+  int nperiod = (int)::ceil( MaxPeriod/StepSize );
+  if ( nperiod < 3 )
+    nperiod = 3;
+
+  for ( int n = data.size(); Index < n; ++Index ) {
+
+    // (re-)estimate threshold:
+    if ( Index - LastEventIndex >= nperiod ) {
+      estimateThreshold( data, Index );
+      LastEventIndex = Index;
+    }
+    if ( Threshold <= 0.0 )
+      continue;
+
+    double v = data[Index];
+    if ( Dir == 0 ) {
+      // first data point, do not record the first peak:
+      Dir = 2;
+      ExtremumIndex = Index;
+      ExtremumValue = v;
+    }
+    else if ( Dir > 0 ) {
+      // search peak:
+      if ( v > ExtremumValue ) {
+	ExtremumIndex = Index;
+	ExtremumValue = v;
+      }
+      else if ( ExtremumValue - v >= Threshold ) {
+	if ( Dir == 1 )
+	  addExtremum( data, ExtremumIndex, true );
+	Dir = -1;
+	ExtremumIndex = Index;
+	ExtremumValue = v;
+      }
+    }
+    else {
+      // search trough:
+      if ( v < ExtremumValue ) {
+	ExtremumIndex = Index;
+	ExtremumValue = v;
+      }
+      else if ( v - ExtremumValue >= Threshold ) {
+	addExtremum( data, ExtremumIndex, false );
+	Dir = 1;
+	ExtremumIndex = Index;
+	ExtremumValue = v;
+      }
+    }
+
+  }
+}
+
+
+void EODIndex::clear( void )
+{
+  QMutexLocker locker( &Mutex );
+  Peaks.clear();
+  Troughs.clear();
+  PeakSum.clear();
+  PeakSqSum.clear();
+  TroughSum.clear();
+  TroughSqSum.clear();
+  PeakMins.clear();
+  PeakMaxs.clear();
+  TroughMins.clear();
+  TroughMaxs.clear();
+  Threshold = 0.0;
+  BeginIndex = -1;
+  Index = -1;
+  Dir = 0;
+}
+
+
+void EODIndex::reset( const InData &data, int index )
+{
+  Offset = data.pos( 0 );
+  StepSize = data.stepsize();
+
+  int n = (int)::ceil( data.capacity()*StepSize*MaxRate );
+  if ( n < 100 )
+    n = 100;
+  Peaks.clear();
+  Troughs.clear();
+  PeakSum.clear();
+  PeakSqSum.clear();
+  TroughSum.clear();
+  TroughSqSum.clear();
+  PeakMins.clear();
+  PeakMaxs.clear();
+  TroughMins.clear();
+  TroughMaxs.clear();
+  if ( Peaks.capacity() != n ) {
+    Peaks.free( n );
+    Troughs.free( n );
+    PeakSum.free( n );
+    PeakSqSum.free( n );
+    TroughSum.free( n );
+    TroughSqSum.free( n );
+    int nb = n/BlockSize + 2;
+    PeakMins.free( nb );
+    PeakMaxs.free( nb );
+    TroughMins.free( nb );
+    TroughMaxs.free( nb );
+  }
+
+  Threshold = 0.0;
+  StartIndex = index;
+  BeginIndex = -1;
+  Index = index;
+  Dir = 0;
+  ExtremumIndex = index;
+  ExtremumValue = 0.0;
+  LastEventIndex = index;
+  LastPeak = 0.0;
+  LastTrough = 0.0;
+}
+
+
+void EODIndex::estimateThreshold( const InData &data, int index )
+{
+  int nperiod = (int)::ceil( MaxPeriod/StepSize );
+  int first = index - nperiod;
+  if ( first < StartIndex )
+    first = StartIndex;
+  if ( first < data.minIndex() )
+    first = data.minIndex();
+  if ( first >= index )
+    return;
+  double min = data[first];
+  double max = min;
+  for ( int k=first+1; k<index; k++ ) {
+    double v = data[k];
+    if ( v < min )
+      min = v;
+    else if ( v > max )
+      max = v;
+  }
+  Threshold = Ratio*(max - min);
+  if ( Threshold <= 0.0 )
+    Dir = 0;
+}
+
+
+void EODIndex::addExtremum( const InData &data, int index, bool peak )
+{
+  LastEventIndex = index;
+  if ( index <= StartIndex || index-1 < data.minIndex() ||
+       index+1 >= data.size() )
+    return;
+
+  // parabola through the three data points around the extremum:
+  double y1 = data[index-1];
+  double y2 = data[index];
+  double y3 = data[index+1];
+  double d = y1 - 2.0*y2 + y3;
+  double time = Offset + index*StepSize;
+  double size = y2;
+  if ( ::fabs( d ) > 1.0e-8 ) {
+    double delta = 0.5*(y1 - y3)/d;
+    if ( delta > 1.0 )
+      delta = 1.0;
+    else if ( delta < -1.0 )
+      delta = -1.0;
+    time += delta*StepSize;
+    size = y2 - 0.25*(y1 - y3)*delta;
+  }
+
+  EventData &events = peak ? Peaks : Troughs;
+  CyclicArrayD &sum = peak ? PeakSum : TroughSum;
+  CyclicArrayD &sqsum = peak ? PeakSqSum : TroughSqSum;
+  double &offset = peak ? PeakOffset : TroughOffset;
+  if ( events.size() > 0 && time <= events.back() )
+    return;
+  if ( events.size() == 0 )
+    offset = size;
+  double s = size - offset;
+  if ( peak )
+    addBlock( PeakMins, PeakMaxs, events.size(), size );
+  else
+    addBlock( TroughMins, TroughMaxs, events.size(), size );
+  events.push( time, size );
+  sum.push( ( sum.size() > 0 ? sum.back() : 0.0 ) + s );
+  sqsum.push( ( sqsum.size() > 0 ? sqsum.back() : 0.0 ) + s*s );
+
+  // adapt threshold to the amplitude of the last EOD cycle:
+  if ( peak )
+    LastPeak = size;
+  else
+    LastTrough = size;
+  if ( Peaks.size() > 0 && Troughs.size() > 0 && LastPeak > LastTrough )
+    Threshold = Ratio*(LastPeak - LastTrough);
+
+  if ( BeginIndex < 0 )
+    BeginIndex = index;
+}
+
+
+bool EODIndex::contains( double tbegin, double tend ) const
+{
+  QMutexLocker locker( &Mutex );
+  if ( BeginIndex < 0 || tend < tbegin )
+    return false;
+  if ( tbegin < Offset + BeginIndex*StepSize ||
+       tend > Offset + Index*StepSize + StepSize )
+    return false;
+  // cycles dropped from the buffers:
+  if ( Peaks.minEvent() > 0 && tbegin < Peaks.minTime() )
+    return false;
+  if ( Troughs.minEvent() > 0 && tbegin < Troughs.minTime() )
+    return false;
+  return true;
+}
+
+
+double EODIndex::beginTime( void ) const
+{
+  QMutexLocker locker( &Mutex );
+  if ( BeginIndex < 0 )
+    return HUGE_VAL;
+  double t = Offset + BeginIndex*StepSize;
+  if ( Peaks.minEvent() > 0 && Peaks.minTime() > t )
+    t = Peaks.minTime();
+  if ( Troughs.minEvent() > 0 && Troughs.minTime() > t )
+    t = Troughs.minTime();
+  return t;
+}
+
+
+double EODIndex::endTime( void ) const
+{
+  QMutexLocker locker( &Mutex );
+  return Index < 0 ? -HUGE_VAL : Offset + Index*StepSize;
+}
+
+
+double EODIndex::threshold( void ) const
+{
+  QMutexLocker locker( &Mutex );
+  return Threshold;
+}
+
+
+double EODIndex::ratio( void ) const
+{
+  QMutexLocker locker( &Mutex );
+  return Ratio;
+}
+
+
+void EODIndex::setRatio( double ratio )
+{
+  QMutexLocker locker( &Mutex );
+  if ( ratio > 0.0 && ratio < 1.0 )
+    Ratio = ratio;
+}
+
+
+double EODIndex::maxPeriod( void ) const
+{
+  QMutexLocker locker( &Mutex );
+  return MaxPeriod;
+}
+
+
+void EODIndex::setMaxPeriod( double period )
+{
+  QMutexLocker locker( &Mutex );
+  if ( period > 0.0 )
+    MaxPeriod = period;
+}
+
+
+double EODIndex::maxRate( void ) const
+{
+  QMutexLocker locker( &Mutex );
+  return MaxRate;
+}
+
+
+void EODIndex::setMaxRate( double rate )
+{
+  QMutexLocker locker( &Mutex );
+  if ( rate > 0.0 )
+    MaxRate = rate;
+}
+
+
+void EODIndex::copy( const EventData &events, double tbegin, double tend,
+		     EventData &out ) const
+{
+  out.clear();
+  int n = events.next( tbegin );
+  int p = events.previous( tend );
+  if ( p < n )
+    return;
+  if ( out.capacity() < p-n+1 )
+    out.reserve( p-n+1 );
+  for ( int k=n; k<=p; k++ )
+    out.push( events[k], events.eventSize( k ) );
+}
+
+
+void EODIndex::peaks( double tbegin, double tend, EventData &peaks ) const
+{
+  QMutexLocker locker( &Mutex );
+  copy( Peaks, tbegin, tend, peaks );
+}
+
+
+void EODIndex::troughs( double tbegin, double tend, EventData &troughs ) const
+{
+  QMutexLocker locker( &Mutex );
+  copy( Troughs, tbegin, tend, troughs );
+}
+
+
+int EODIndex::count( const EventData &events, double tbegin, double tend ) const
+{
+  int n = events.next( tbegin );
+  int p = events.previous( tend );
+  return p < n ? 0 : p-n+1;
+}
+
+
+int EODIndex::peakCount( double tbegin, double tend ) const
+{
+  QMutexLocker locker( &Mutex );
+  return count( Peaks, tbegin, tend );
+}
+
+
+int EODIndex::troughCount( double tbegin, double tend ) const
+{
+  QMutexLocker locker( &Mutex );
+  return count( Troughs, tbegin, tend );
+}
+
+
+double EODIndex::meanSize( const EventData &events, const CyclicArrayD &sum,
+			   const CyclicArrayD &sqsum, double offset,
+			   double tbegin, double tend, double &stdev ) const
+{
+  stdev = 0.0;
+  int n = events.next( tbegin );
+  int p = events.previous( tend );
+  if ( p < n )
+    return 0.0;
+  if ( n-1 < sum.minIndex() && n > 0 )
+    return events.meanSize( tbegin, tend, stdev );
+  double m = p-n+1;
+  double s = sum[p];
+  double ss = sqsum[p];
+  if ( n > 0 ) {
+    s -= sum[n-1];
+    ss -= sqsum[n-1];
+  }
+  double mean = s/m;
+  double var = ss/m - mean*mean;
+  stdev = var > 0.0 ? ::sqrt( var ) : 0.0;
+  return mean + offset;
+}
+
+
+double EODIndex::meanPeaks( double tbegin, double tend, double &stdev ) const
+{
+  QMutexLocker locker( &Mutex );
+  return meanSize( Peaks, PeakSum, PeakSqSum, PeakOffset,
+		   tbegin, tend, stdev );
+}
+
+
+double EODIndex::meanPeaks( double tbegin, double tend ) const
+{
+  double stdev = 0.0;
+  return meanPeaks( tbegin, tend, stdev );
+}
+
+
+double EODIndex::meanTroughs( double tbegin, double tend, double &stdev ) const
+{
+  QMutexLocker locker( &Mutex );
+  return meanSize( Troughs, TroughSum, TroughSqSum, TroughOffset,
+		   tbegin, tend, stdev );
+}
+
+
+double EODIndex::meanTroughs( double tbegin, double tend ) const
+{
+  double stdev = 0.0;
+  return meanTroughs( tbegin, tend, stdev );
+}
+
+
+double EODIndex::amplitude( double tbegin, double tend ) const
+{
+  QMutexLocker locker( &Mutex );
+  double stdev = 0.0;
+  double peaksize = meanSize( Peaks, PeakSum, PeakSqSum, PeakOffset,
+			      tbegin, tend, stdev );
+  double troughsize = meanSize( Troughs, TroughSum, TroughSqSum, TroughOffset,
+				tbegin, tend, stdev );
+  return 0.5*(peaksize - troughsize);  // 0.5 * p-p amplitude
+}
+
+
+void EODIndex::addBlock( CyclicArrayD &mins, CyclicArrayD &maxs,
+			 int index, double size )
+{
+  if ( index % BlockSize == 0 ) {
+    mins.push( size );
+    maxs.push( size );
+  }
+  else {
+    if ( size < mins.back() )
+      mins.back() = size;
+    if ( size > maxs.back() )
+      maxs.back() = size;
+  }
+}
+
+
+double EODIndex::extremum( const EventData &events, const CyclicArrayD &blocks,
+			   int first, int last, bool max ) const
+{
+  double e = events.eventSize( first );
+  for ( int k=first; k<=last; ) {
+    double v = 0.0;
+    int b = k/BlockSize;
+    if ( k % BlockSize == 0 && k + BlockSize - 1 <= last &&
+	 b >= blocks.minIndex() ) {
+      // whole block:
+      v = blocks[b];
+      k += BlockSize;
+    }
+    else
+      v = events.eventSize( k++ );
+    if ( max ? v > e : v < e )
+      e = v;
+  }
+  return e;
+}
+
+
+int EODIndex::minMax( double tbegin, double tend, double &min, double &max ) const
+{
+  QMutexLocker locker( &Mutex );
+  min = 0.0;
+  max = 0.0;
+  int n = Peaks.next( tbegin );
+  int p = Peaks.previous( tend );
+  int c = p < n ? 0 : p-n+1;
+  if ( c > 0 )
+    max = extremum( Peaks, PeakMaxs, n, p, true );
+  n = Troughs.next( tbegin );
+  p = Troughs.previous( tend );
+  if ( p >= n )
+    min = extremum( Troughs, TroughMins, n, p, false );
+  // an EOD cycle needs a peak and a trough:
+  if ( p-n+1 < c )
+    c = p < n ? 0 : p-n+1;
+  return c;
+}
+
+
+bool EODIndex::matches( double tbegin, double tend, double threshold ) const
+{
+  QMutexLocker locker( &Mutex );
+  int pn = Peaks.next( tbegin );
+  int pp = Peaks.previous( tend );
+  int tn = Troughs.next( tbegin );
+  int tp = Troughs.previous( tend );
+  if ( pp < pn || tp < tn )
+    return false;
+  double amplitude = extremum( Peaks, PeakMins, pn, pp, false ) -
+    extremum( Troughs, TroughMaxs, tn, tp, true );
+  return ( amplitude > 0.0 && threshold < amplitude &&
+	   threshold >= Ratio*amplitude );
+}
+
+
+}; /* namespace efield */
+
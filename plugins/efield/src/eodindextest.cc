@@ -0,0 +1,141 @@
+/*
+  efield/eodindextest.cc
+  Compares the EOD amplitudes of EODIndex with a scan of the raw data
+
+  RELACS - Relaxed ELectrophysiological data Acquisition, Control, and Stimulation
+  Copyright (C) 2002-2015 Jan Benda <jan.benda@uni-tuebingen.de>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+
+  RELACS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <relacs/random.h>
+#include <relacs/efield/eodindex.h>
+using namespace std;
+using namespace relacs;
+using namespace efield;
+
+
+/*
+  Usage: eodindextest [trace.raw samplerate]
+
+  Without arguments a synthetic EOD of a wave-type fish with a beat,
+  a DC offset, and noise is analyzed. Otherwise the recorded EOD
+  in the float file trace.raw (e.g. trace-1.raw of a RELACS recording)
+  sampled with samplerate Hertz is used.
+
+  For analysis windows of 0.5 to 500 EOD periods, the largest peak and the
+  smallest trough of EODIndex::minMax() are compared with the raw
+  maximum and minimum of the data. Since the extrema are interpolated,
+  they may lie up to one sample away from their data points.
+  They have to be within the raw extrema of the window shrunken and
+  extended by one sample on both sides, with a tolerance of 3%
+  of the peak-to-peak amplitude. Windows without a trough or without a peak
+  have to return zero EOD cycles.
+*/
+
+int main( int argc, char **argv )
+{
+  InData data;
+  if ( argc > 2 ) {
+    FILE *f = fopen( argv[1], "rb" );
+    if ( f == 0 ) {
+      cerr << "cannot open " << argv[1] << '\n';
+      return 1;
+    }
+    fseek( f, 0, SEEK_END );
+    long n = ftell( f )/sizeof( float );
+    fseek( f, 0, SEEK_SET );
+    data = InData( n, 1.0/atof( argv[2] ) );
+    float buffer[4096];
+    for ( long k=0; k<n; ) {
+      int m = fread( buffer, sizeof( float ), 4096, f );
+      if ( m <= 0 )
+	break;
+      for ( int j=0; j<m; j++ )
+	data.push( buffer[j] );
+      k += m;
+    }
+    fclose( f );
+  }
+  else {
+    // 10s of an EOD of 800Hz beating with 830Hz:
+    double samplerate = 20000.0;
+    int n = 10*(int)samplerate;
+    data = InData( n, 1.0/samplerate );
+    RandomXoshiro rand( 1 );
+    for ( int k=0; k<n; k++ ) {
+      double t = k/samplerate;
+      double eod = ::sin( 2.0*M_PI*800.0*t ) + 0.3*::sin( 4.0*M_PI*800.0*t + 0.5 );
+      double beat = 0.2*::sin( 2.0*M_PI*830.0*t );
+      data.push( float( 1.5 + eod + beat + 0.01*rand.gaussian() ) );
+    }
+  }
+  data.setIdent( "EOD" );
+  cout << "analyzing " << data.size() << " samples of " << data.length() << "s\n";
+
+  EODIndex ei;
+  ei.update( data );
+
+  float fmin=0.0, fmax=0.0;
+  data.minMax( fmin, fmax, data.minTime(), data.currentTime() );
+  double pp = fmax - fmin;
+  double period = 1.0/ei.peakCount( data.minTime(), data.currentTime() )*data.length();
+
+  int windows = 0;
+  int errors = 0;
+  int empty = 0;
+  for ( double width=0.5*period; width<=500.0*period; width*=1.7 ) {
+    for ( double tbegin=data.minTime()+0.3*period;
+	  tbegin+width<data.currentTime()-period;
+	  tbegin+=0.37*width ) {
+      double tend = tbegin + width;
+      if ( ! ei.contains( tbegin, tend ) )
+	continue;
+      double min=0.0, max=0.0;
+      int c = ei.minMax( tbegin, tend, min, max );
+      int np = ei.peakCount( tbegin, tend );
+      int nt = ei.troughCount( tbegin, tend );
+      windows++;
+      if ( np == 0 || nt == 0 ) {
+	// the index cannot tell the amplitude:
+	empty++;
+	if ( c != 0 )
+	  errors++;
+	continue;
+      }
+      // the interpolated extrema may lie up to one sample away
+      // from their data points, so they have to be within the raw
+      // extrema of the window shrunken and extended by one sample:
+      data.minMax( fmin, fmax, tbegin+data.stepsize(), tend-data.stepsize() );
+      float wmin=0.0, wmax=0.0;
+      data.minMax( wmin, wmax, tbegin-data.stepsize(), tend+data.stepsize() );
+      double tol = 0.03*pp;
+      if ( c <= 0 || max < fmax - tol || max > wmax + tol ||
+	   min > fmin + tol || min < wmin - tol ) {
+	errors++;
+	if ( errors < 10 )
+	  cerr << "window " << tbegin << "s - " << tend << "s with " << c << " cycles: "
+	       << "index " << min << " - " << max << ", raw " << fmin << " - " << fmax << '\n';
+      }
+    }
+  }
+  cout << windows << " windows, " << empty << " without peaks or troughs, "
+       << errors << " errors\n";
+
+  return errors > 0 || windows == 0 ? 1 : 0;
+}
@@ -99,7 +99,7 @@ void EODModel::main( void )
   }
 
   // integrate:
-  Random rand;
+  RandomXoshiro rand;
   double eodf = 0.0;
   double phase = 0.0;
   while ( ! interrupt() ) {
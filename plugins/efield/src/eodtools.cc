@@ -19,6 +19,7 @@
   along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <relacs/efield/eodindex.h>
 #include <relacs/efield/eodtools.h>
 using namespace relacs;
 
@@ -36,8 +37,15 @@ double EODTools::eodThreshold( const InData &data, double tbegin, double tend,
   contrast = fabs( contrast );
   if ( contrast > 0.99 )
     contrast = 0.99;
-  float min=0.0, max=0.0;
-  data.minMax( min, max, tbegin, tend );
+  EODIndex &ei = EODIndex::updated( data );
+  double min=0.0, max=0.0;
+  if ( ! ei.contains( tbegin, tend ) ||
+       ei.minMax( tbegin, tend, min, max ) <= 0 ) {
+    float fmin=0.0, fmax=0.0;
+    data.minMax( fmin, fmax, tbegin, tend );
+    min = fmin;
+    max = fmax;
+  }
   return 0.75*(max-min)*(1.0-contrast)/(1.0+contrast);
 }
 
@@ -291,6 +299,10 @@ double EODTools::meanTroughs( const InData &data, double tbegin, double tend,
 double EODTools::eodAmplitude( const InData &eodd, double tbegin, double tend )
 {
   double threshold = eodThreshold( eodd, tbegin, tend, 0.0 );
+  EODIndex &ei = EODIndex::index( eodd );
+  if ( ei.contains( tbegin, tend ) && ei.matches( tbegin, tend, threshold ) )
+    return ei.amplitude( tbegin, tend );
+
   EventData peaks( 0, true );
   EventData troughs( 0, true );
   eodPeaksTroughs( eodd, tbegin, tend, threshold, peaks, troughs );
@@ -304,6 +316,31 @@ double EODTools::eodAmplitude( const InData &eodd, double tbegin, double tend )
 }
 
 
+void EODTools::beatSizes( const InData &eodd, double tbegin, double tend,
+			  double wbegin, double wend, double contrast,
+			  double &uppermean, double &uppersd,
+			  double &lowermean, double &lowersd )
+{
+  // threshold:
+  double threshold = eodThreshold( eodd, tbegin, tend, contrast );
+
+  EODIndex &ei = EODIndex::index( eodd );
+  if ( ei.contains( tbegin, tend ) && ei.matches( tbegin, tend, threshold ) ) {
+    uppermean = ei.meanPeaks( wbegin, wend, uppersd );
+    lowermean = ei.meanTroughs( wbegin, wend, lowersd );
+    return;
+  }
+
+  // EOD peaks and troughs:
+  EventData uppereod( (int)::floor( 2000.0*(tend-tbegin) ), true );
+  EventData lowereod( (int)::floor( 2000.0*(tend-tbegin) ), true );
+  eodPeaksTroughs( eodd, tbegin, tend, threshold, uppereod, lowereod );
+
+  uppermean = uppereod.meanSize( wbegin, wend, uppersd );
+  lowermean = lowereod.meanSize( wbegin, wend, lowersd );
+}
+
+
 void EODTools::beatAmplitudes( const InData &eodd, double tbegin, double tend,
 			       double period, double contrast,
 			       double &uppermean, double &upperampl,
@@ -314,20 +351,11 @@ void EODTools::beatAmplitudes( const InData &eodd, double tbegin, double tend,
   double window = floor( duration/period )*period;
   double offset = 0.5*(duration - window);
 
-  // threshold:
-  double threshold = eodThreshold( eodd, tbegin, tend, contrast );
-
-  // EOD peaks and troughs:
-  EventData uppereod( (int)::floor( 2000.0*(tend-tbegin) ), true );
-  EventData lowereod( (int)::floor( 2000.0*(tend-tbegin) ), true );
-  eodPeaksTroughs( eodd, tbegin, tend, threshold, uppereod, lowereod );
-
   upperampl = 0.0;
-  uppermean = uppereod.meanSize( tbegin+offset, tend-offset, upperampl );
-  upperampl *= ::sqrt( 2.0 );  // 0.5 * p-p amplitude for sine wave
-
   lowerampl = 0.0;
-  lowermean = lowereod.meanSize( tbegin+offset, tend-offset, lowerampl );
+  beatSizes( eodd, tbegin, tend, tbegin+offset, tend-offset, contrast,
+	     uppermean, upperampl, lowermean, lowerampl );
+  upperampl *= ::sqrt( 2.0 );  // 0.5 * p-p amplitude for sine wave
   lowerampl *= ::sqrt( 2.0 );  // 0.5 * p-p amplitude for sine wave
 }
 
@@ -340,19 +368,12 @@ double EODTools::beatAmplitude( const InData &eodd, double tbegin, double tend,
   double window = floor( duration/period )*period;
   double offset = 0.5*(duration - window);
 
-  // threshold:
-  double threshold = eodThreshold( eodd, tbegin, tend, contrast );
-
-  // EOD peaks and troughs:
-  EventData uppereod( (int)::floor( 2000.0*(tend-tbegin) ), true );
-  EventData lowereod( (int)::floor( 2000.0*(tend-tbegin) ), true );
-  eodPeaksTroughs( eodd, tbegin, tend, threshold, uppereod, lowereod );
-
+  double uppera = 0.0;
   double uppersd = 0.0;
-  uppereod.meanSize( tbegin+offset, tend-offset, uppersd );
-
+  double lowera = 0.0;
   double lowersd = 0.0;
-  lowereod.meanSize( tbegin+offset, tend-offset, lowersd );
+  beatSizes( eodd, tbegin, tend, tbegin+offset, tend-offset, contrast,
+	     uppera, uppersd, lowera, lowersd );
 
   return ::sqrt( 2.0 )*0.5*(uppersd + lowersd);  // 0.5 * p-p amplitude
 }
@@ -366,19 +387,12 @@ double EODTools::beatContrast( const InData &eodd, double tbegin, double tend,
   double window = floor( duration/period )*period;
   double offset = 0.5*(duration - window);
 
-  // threshold:
-  double threshold = eodThreshold( eodd, tbegin, tend, contrast );
-
-  // EOD peaks and troughs:
-  EventData uppereod( (int)::floor( 2000.0*(tend-tbegin) ), true );
-  EventData lowereod( (int)::floor( 2000.0*(tend-tbegin) ), true );
-  eodPeaksTroughs( eodd, tbegin, tend, threshold, uppereod, lowereod );
-
+  double uppera = 0.0;
   double uppersd = 0.0;
-  double uppera = uppereod.meanSize( tbegin+offset, tend-offset, uppersd );
-
+  double lowera = 0.0;
   double lowersd = 0.0;
-  double lowera = lowereod.meanSize( tbegin+offset, tend-offset, lowersd );
+  beatSizes( eodd, tbegin, tend, tbegin+offset, tend-offset, contrast,
+	     uppera, uppersd, lowera, lowersd );
 
   return ::sqrt( 2.0 )*(uppersd + lowersd)/fabs(uppera - lowera);
 }
@@ -53,6 +53,7 @@ namespace efish {
     - \c noised=0: Intensity of current noise (\c number)
     - \c deltat=0.005ms: Delta t (\c number)
     - \c integrator=Euler: Method of integration (\c string)
+    - \c tolerance=0.0001: Tolerance of adaptive integrator (\c number)
 - \c Voltage-gated current 1 - activation only
     - \c gmc=0: Conductivity (\c number)
     - \c emc=-90mV: Reversal potential (\c number)
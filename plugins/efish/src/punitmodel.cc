@@ -150,17 +150,17 @@ void PUnitModel::main( void )
 
   // equilibrium:
   for ( int c=0; c<100; c++ ) {
-    double t = c * timeStep();
+    double t = c * integrationStep();
     (*neuron())( t, 0.0, simx+sigdimension, dxdt+sigdimension, neuron()->dimension() );
     for ( int k=sigdimension; k<simn; k++ )
-      simx[k] += timeStep()*dxdt[k];
+      simx[k] += integrationStep()*dxdt[k];
   }
 
   // integrate:
   double t = 1000.0*time( 0 );  // time must be syncrhonous to recorded trace!
   while ( ! interrupt() ) {
 
-    Integrate( t, simx, dxdt, simn, timeStep(), *this );
+    integrateStep( t, simx, dxdt, simn );
 
     cs++;
     if ( cs == maxs ) {
@@ -216,10 +216,8 @@ void PUnitModel::process( const OutData &source, OutData &dest )
 
 void PUnitModel::operator()( double t, double *x, double *dxdt, int n )
 {
-  static Random rand;
-
   // O-U noise for EOD frequency:
-  dxdt[0] = ( -x[0] + EODFreqFac*rand.gaussian() ) / EODFreqTau;
+  dxdt[0] = ( -x[0] + EODFreqFac*whiteNoise( 1 ) ) / EODFreqTau;
   // phase of EOD frequency:
   dxdt[1] = EODFreq + EODFreqSD * x[0];
   double v = 0.0;
@@ -242,7 +240,7 @@ void PUnitModel::operator()( double t, double *x, double *dxdt, int n )
   Signal *= StimulusGain;
   LocalSignal *= LocalStimulusGain;
   double s = EODLocal * neuron()->gain() + neuron()->offset();
-  s += noiseFac() * rand.gaussian();
+  s += noiseFac() * whiteNoise( 0 );
   if ( MMCInx >= 0 )
     s -= GMC*x[MMCInx]*(x[2]-EMC);
   if ( MMHCInx >= 0 )
@@ -22,7 +22,10 @@
 #ifndef _RELACS_EPHYS_NEURONMODELS_H_
 #define _RELACS_EPHYS_NEURONMODELS_H_ 1
 
+#include <vector>
 #include <relacs/model.h>
+#include <relacs/odealgorithm.h>
+#include <relacs/random.h>
 #include <relacs/ephys/traces.h>
 #include <relacs/spikingneuron.h>
 using namespace relacs;
@@ -41,12 +44,19 @@ The Gaussian white noise and the optional additional voltage gated
 currents are added to the input after the offset and gain for the
 input current has been applied.
 
+With the \c Dormand-Prince \c 5(4) integrator the step size is
+adapted to the dynamics of the model and each integration ends
+exactly on a sample of the input traces, since the stimulus is
+only known up to the current time. \c deltat is then the initial
+step size. The noise is held constant for each sample interval.
+
 \par Options
 - Spike generator
 - \c spikemodel=Stimulus: Spike model (\c string)
 - \c noised=0: Intensity of current noise (\c number)
 - \c deltat=0.005ms: Delta t (\c number)
 - \c integrator=Euler: Method of integration (\c string)
+- \c tolerance=0.0001: Tolerance of adaptive integrator (\c number)
 - Voltage-gated current 1 (activation only)
 - \c gmc=0: Conductivity (\c number)
 - \c emc=-90mV: Reversal potential (\c number)
@@ -120,6 +130,18 @@ public:
   
   void (*Integrate)( double, double*, double*, int, double, NeuronModels& );
 
+    /*! Integrate the state \a x of size \a n from time \a t
+        over timeStep() with the selected integration method.
+        \a dxdt is used as workspace by the fixed-step methods. */
+  void integrateStep( double t, double *x, double *dxdt, int n );
+    /*! The step size of the fixed-step integration methods,
+        or the initial step size of the adaptive one. */
+  double integrationStep( void ) const { return Adaptive ? AdaptiveStep : SimDT; };
+    /*! A Gaussian white noise value with zero mean and unit
+        variance for noise source \a k (0 or 1). For the adaptive
+        integrator the value is constant within a sample interval. */
+  double whiteNoise( int k );
+
     /*! Add the options of the models as tabs to the dialog \a od.
         To be used in dialogOptions(). */
   void dialogModelOptions( OptDialog *od, string *tabhotkeys );
@@ -161,6 +183,12 @@ public:
   double NoiseFac;
   double SimDT;
 
+  bool Adaptive;
+  double AdaptiveStep;
+  DormandPrince DP;
+  RandomXoshiro Rand;
+  double NoiseValues[2];
+
 };
 
 
@@ -32,6 +32,10 @@ namespace ephys {
 NeuronModels::NeuronModels( void )
   : Model( "NeuronModels", "ephys", "Jan Benda", "1.0", "Jan 10, 2006" )
 {
+  Adaptive = false;
+  AdaptiveStep = 0.0;
+  NoiseValues[0] = 0.0;
+  NoiseValues[1] = 0.0;
   addOptions();
   addModels();
   MMCInx = -1;
@@ -47,8 +51,12 @@ NeuronModels::NeuronModels( const string &name,
 			    const string &author, 
 			    const string &version,
 			    const string &date )
-  : Model( name, pluginset, author, version, date )
+  : Model( name, pluginset, author, version, date ),
+    Adaptive( false ),
+    AdaptiveStep( 0.0 )
 {
+  NoiseValues[0] = 0.0;
+  NoiseValues[1] = 0.0;
 }
 
 
@@ -86,7 +94,7 @@ void NeuronModels::main( void )
 
   // state variables:
   int simn = neuron()->dimension();
-  if ( VCTau >= 10.0*timeStep() ) {
+  if ( VCTau >= 10.0*integrationStep() ) {
     VCInx = simn;
     simn++;
   }
@@ -116,17 +124,17 @@ void NeuronModels::main( void )
 
   // equilibrium:
   for ( int c=0; c<100; c++ ) {
-    double t = c * timeStep();
+    double t = c * integrationStep();
     (*neuron())( t, 0.0, simx, dxdt, simn );
     for ( int k=0; k<simn; k++ )
-      simx[k] += timeStep()*dxdt[k];
+      simx[k] += integrationStep()*dxdt[k];
   }
 
   // integrate:
   double t = 1000.0*time( 0 );  // time must be syncrhonous to recorded trace!
   while ( ! interrupt() ) {
 
-    Integrate( t, simx, dxdt, simn, timeStep(), *this );
+    integrateStep( t, simx, dxdt, simn );
 
     cs++;
     if ( cs == maxs ) {
@@ -152,7 +160,7 @@ void NeuronModels::process( const OutData &source, OutData &dest )
 void NeuronModels::operator()( double t, double *x, double *dxdt, int n )
 {
   // current noise:
-  double s = noiseFac() * rnd.gaussian();
+  double s = noiseFac() * whiteNoise( 0 );
   CurrentInput = 0.0;
   double vcerror = 0.0;
   if ( VCMode ) {
@@ -196,6 +204,41 @@ void NeuronModels::operator()( double t, double *x, double *dxdt, int n )
 }
 
 
+void NeuronModels::integrateStep( double t, double *x, double *dxdt, int n )
+{
+  if ( ! Adaptive ) {
+    Integrate( t, x, dxdt, n, timeStep(), *this );
+    return;
+  }
+
+  // noise is frozen within a sample interval:
+  NoiseValues[0] = Rand.gaussian();
+  NoiseValues[1] = Rand.gaussian();
+
+  // restart the integrator if the state was changed from outside:
+  bool restart = ( DP.size() != n || DP.x() != t );
+  for ( int k=0; k<n && ! restart; k++ )
+    restart = ( DP.y()[k] != x[k] );
+  if ( restart )
+    DP.init( t, x, n, AdaptiveStep, *this );
+  else
+    // the first stage must see the new noise values:
+    DP.refresh( *this );
+
+  if ( DP.integrate( t + timeStep(), x, *this ) < 0 ) {
+    // step size underflow, fall back to a single fixed step:
+    rk4Step( t, x, dxdt, n, timeStep(), *this );
+    DP.init( t + timeStep(), x, n, AdaptiveStep, *this );
+  }
+}
+
+
+double NeuronModels::whiteNoise( int k )
+{
+  return Adaptive ? NoiseValues[k] : Rand.gaussian();
+}
+
+
 void NeuronModels::notifyStimulusData( void )
 {
   VCMode = ( stimulusData().text( "AmplifierMode" ) == "VC" );
@@ -256,7 +299,8 @@ void NeuronModels::addOptions( void )
   addSelection( "spikemodel", "Spike model", "" );
   addNumber( "noised", "Intensity of current noise", 0.0, 0.0, 100.0, 1.0 );
   addNumber( "deltat", "Delta t", 0.005, 0.0, 1.0, 0.001, "ms" );
-  addSelection( "integrator", "Method of integration", "Euler|Midpoint|Runge-Kutta 4" );
+  addSelection( "integrator", "Method of integration", "Euler|Midpoint|Runge-Kutta 4|Dormand-Prince 5(4)" );
+  addNumber( "tolerance", "Tolerance of adaptive integrator", 1.0e-4, 1.0e-10, 1.0, 1.0e-4 ).setActivation( "integrator", "Dormand-Prince 5(4)" );
   newSubSection( "Voltage clamp" );
   addNumber( "vcgain", "Voltage-clamp gain", 10.0, 0.0, 100000.0, 10.0 );
   addNumber( "vctau", "Voltage-clamp time constant", 0.1, 0.0, 10.0, 0.01, "ms" );
@@ -289,12 +333,22 @@ void NeuronModels::readOptions( void )
   NM = Models[ index( "spikemodel" ) ];
   NM->notify();
   int integrator = index( "integrator" );
+  Adaptive = ( integrator == 3 );
   if ( integrator == 1 )
     Integrate = midpointStep;
-  else if ( integrator == 2 )
+  else if ( integrator == 2 || integrator == 3 )
     Integrate = rk4Step;
   else
     Integrate = eulerStep;
+  if ( Adaptive ) {
+    // integrate from sample to sample, deltat is the initial step:
+    AdaptiveStep = timeStep();
+    if ( AdaptiveStep > 1000.0 * deltat( 0 ) )
+      AdaptiveStep = 1000.0 * deltat( 0 );
+    setTimeStep( 1000.0 * deltat( 0 ) );
+    double tol = number( "tolerance" );
+    DP = DormandPrince( tol, tol );
+  }
 
   VCGain = number( "vcgain" );
   VCTau = number( "vctau" );
@@ -0,0 +1,62 @@
+/*
+  comedi/comedicalibration.h
+  Cache of parsed comedi calibration files.
+
+  RELACS - Relaxed ELectrophysiological data Acquisition, Control, and Stimulation
+  Copyright (C) 2002-2015 Jan Benda <jan.benda@uni-tuebingen.de>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+  
+  RELACS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _COMEDI_COMEDICALIBRATION_H_
+#define _COMEDI_COMEDICALIBRATION_H_
+
+#include <comedilib.h>
+using namespace std;
+
+namespace comedi {
+
+
+/*! 
+\class ComediCalibration
+\author Jan Benda
+\brief Cache of parsed comedi calibration files.
+
+Parsing a calibration file takes a while. Both ComediAnalogInput and
+ComediAnalogOutput need the calibration of the same board, and both
+are reopened on every restart of the acquisition.  ComediCalibration
+parses each calibration file only once and hands out the parsed
+calibration as long as the file is not modified. The functions are
+thread safe, such that devices can be opened concurrently.
+*/
+
+class ComediCalibration
+{
+
+public:
+
+    /*! The parsed default calibration of the comedi device \a device.
+        Returns zero if there is no calibration file.
+	Each call needs to be followed by a call to release(). */
+  static comedi_calibration_t *acquire( comedi_t *device );
+    /*! Release the \a calibration obtained from acquire().
+        The parsed calibration stays in the cache. */
+  static void release( comedi_calibration_t *calibration );
+
+};
+
+
+}; /* namespace comedi */
+
+#endif /* ! _COMEDI_COMEDICALIBRATION_H_ */
@@ -28,6 +28,7 @@
 #include <fcntl.h>
 #include <QMutexLocker>
 #include <relacs/str.h>
+#include <relacs/comedi/comedicalibration.h>
 #include <relacs/comedi/comedianalogoutput.h>
 #include <relacs/comedi/comedianaloginput.h>
 using namespace std;
@@ -142,15 +143,7 @@ int ComediAnalogInput::open( const string &device )
   ReadBufferSize = comedi_get_buffer_size( DeviceP, SubDevice );
 
   // get calibration:
-  {
-    char *calibpath = comedi_get_default_calibration_path( DeviceP );
-    ifstream cf( calibpath );
-    if ( cf.good() )
-      Calibration = comedi_parse_calibration_file( calibpath );
-    else
-      Calibration = 0;
-    free( calibpath );
-  }
+  Calibration = ComediCalibration::acquire( DeviceP );
 
   // initialize ranges:
   UnipolarRange.clear();
@@ -274,9 +267,8 @@ void ComediAnalogInput::close( void )
 
   reset();
 
-  // cleanup calibration:
-  if ( Calibration != 0 )
-    comedi_cleanup_calibration( Calibration );
+  // release calibration:
+  ComediCalibration::release( Calibration );
   Calibration = 0;
 
   // unlock:
@@ -27,9 +27,12 @@
 #include <fcntl.h>
 #include <iostream>
 #include <sstream>
+#include <vector>
 #include <QMutexLocker>
 #include <relacs/str.h>
+#include <relacs/aoconversion.h>
 #include <relacs/comedi/comedianaloginput.h>
+#include <relacs/comedi/comedicalibration.h>
 #include <relacs/comedi/comedianalogoutput.h>
 using namespace std;
 using namespace relacs;
@@ -145,15 +148,7 @@ int ComediAnalogOutput::open( const string &device )
   comedi_set_buffer_size( DeviceP, SubDevice, buffersize );
 
   // get calibration:
-  {
-    char *calibpath = comedi_get_default_calibration_path( DeviceP );
-    ifstream cf( calibpath );
-    if ( cf.good() )
-      Calibration = comedi_parse_calibration_file( calibpath );
-    else
-      Calibration = 0;
-    free( calibpath );
-  }
+  Calibration = ComediCalibration::acquire( DeviceP );
 
   // external reference:
   double extr = number( "extref", -1.0, "V" );
@@ -289,9 +284,8 @@ void ComediAnalogOutput::close( void )
     delete[] ChannelValues;
   ChannelValues = 0;
 
-  // cleanup calibration:
-  if ( Calibration != 0 )
-    comedi_cleanup_calibration( Calibration );
+  // release calibration:
+  ComediCalibration::release( Calibration );
   Calibration = 0;
 
   // unlock:
@@ -450,71 +444,31 @@ int ComediAnalogOutput::convert( char *cbuffer, int nbuffer )
     return 0;
 
   // conversion polynomials and scale factors:
-  double minval[ Sigs.size() ];
-  double maxval[ Sigs.size() ];
-  T maxdata[ Sigs.size() ];
-  double scale[ Sigs.size() ];
-  const comedi_polynomial_t* polynomial[Sigs.size()];
+  vector< AOConversion > conv( Sigs.size() );
   T zeros[ Sigs.size() ];
   for ( int k=0; k<Sigs.size(); k++ ) {
-    minval[k] = Sigs[k].minValue();
-    maxval[k] = Sigs[k].maxValue();
-    maxdata[k] = MaxData[Sigs[k].channel()];
-    scale[k] = Sigs[k].scale();
-    polynomial[k] = (const comedi_polynomial_t *)Sigs[k].gainData();
-    float v = ChannelValues[Sigs[k].channel()];
-    if ( v > maxval[k] )
-      v = maxval[k];
-    else if ( v < minval[k] ) 
-      v = minval[k];
-    v *= scale[k];
-    zeros[k] = comedi_from_physical( v, polynomial[k] );
-    if ( zeros[k] > maxdata[k] )
-      zeros[k] = maxdata[k];
+    const comedi_polynomial_t* polynomial = (const comedi_polynomial_t *)Sigs[k].gainData();
+    conv[k].setRange( Sigs[k].minValue(), Sigs[k].maxValue() );
+    conv[k].setScale( Sigs[k].scale() );
+    if ( polynomial != 0 )
+      conv[k].setPolynomial( polynomial->coefficients, polynomial->order,
+			     polynomial->expansion_origin );
+    conv[k].setDataRange( 0.0, MaxData[Sigs[k].channel()] );
+    zeros[k] = conv[k].convert<T>( ChannelValues[Sigs[k].channel()] );
   }
 
-  // buffer pointer:
-  T *bp = (T*)cbuffer;
-  int maxn = nbuffer/sizeof( T )/Sigs.size();
-  int n = 0;
-
   // convert data and multiplex into buffer:
-  for ( int i=0; i<maxn && Sigs[0].deviceWriting(); i++ ) {
-    for ( int k=0; k<Sigs.size(); k++ ) {
-      if ( Sigs[k].deviceCount() < 0 ) {
-	*bp = zeros[k];
-	Sigs[k].incrDeviceIndex();
-	if ( Sigs[k].deviceIndex() >= Sigs[k].deviceDelay() )
-	  Sigs[k].incrDeviceCount();
-      }
-      else {
-	float v = Sigs[k].deviceValue();
-	if ( v > maxval[k] )
-	  v = maxval[k];
-	else if ( v < minval[k] ) 
-	  v = minval[k];
-	v *= scale[k];
-	T d = comedi_from_physical( v, polynomial[k] );
-	if ( d > maxdata[k] )
-	  d = maxdata[k];
-	*bp = d;	
-	if ( Sigs[k].deviceIndex() >= Sigs[k].size() )
-	  Sigs[k].incrDeviceCount();
-      }
-      ++bp;
-      ++n;
-    }
-  }
+  int maxn = nbuffer/sizeof( T )/Sigs.size();
+  int n = convertAO( Sigs, &conv[0], zeros, (T*)cbuffer, maxn );
 
   // memorize last values:
   for ( int k=0; k<Sigs.size(); k++ ) {
-    if ( Sigs[k].deviceCount() >= 0 && Sigs[k].deviceIndex() > 0 )
-      ChannelValues[Sigs[k].channel()] = Sigs[k][Sigs[k].deviceIndex()-1];
-    else if ( Sigs[k].deviceCount() > 0 && Sigs[k].deviceIndex() == 0 )
-      ChannelValues[Sigs[k].channel()] = Sigs[k].back();
+    if ( ( Sigs[k].deviceCount() >= 0 && Sigs[k].deviceIndex() > 0 ) ||
+	 ( Sigs[k].deviceCount() > 0 && Sigs[k].deviceIndex() == 0 ) )
+      ChannelValues[Sigs[k].channel()] = Sigs[k].deviceLastValue();
   }
 
-  return n * sizeof( T );
+  return n * Sigs.size() * sizeof( T );
 }
 
 
@@ -723,7 +677,7 @@ int ComediAnalogOutput::setupCommand( OutList &sigs, comedi_cmd &cmd, bool setsc
   if ( !sigs[0].continuous() ) {
     cmd.stop_src = TRIG_COUNT;
     // set length of acquisition as number of scans:
-    cmd.stop_arg = sigs[0].size() + sigs[0].indices( sigs[0].delay() ) + ExtendedData;
+    cmd.stop_arg = sigs[0].deviceSize() + sigs[0].indices( sigs[0].delay() ) + ExtendedData;
     if ( deviceName() == "pci-6052e" )
       cmd.stop_arg -= 1; // XXX pci-6052e (all NI E Series ?) - comedi-bug? 
   }
@@ -884,7 +838,7 @@ int ComediAnalogOutput::prepareWrite( OutList &sigs )
     // Fix DAQCard bug: add 2k of data to the signals:
     ExtendedData = 2048;
   }
-  else if ( ol[0].size() == 1 ) {
+  else if ( ol[0].deviceSize() == 1 ) {
     // fix SDF_RUNNING bug, we need more than a single sample:
     ExtendedData = 1;
   }
@@ -899,8 +853,12 @@ int ComediAnalogOutput::prepareWrite( OutList &sigs )
 
   if ( ExtendedData > 0 ) {
     // continous and DAQCard bug:
-    for ( int k=0; k<ol.size(); k++ )
-      ol[k].SampleDataF::append( ol[k].back(), ExtendedData );
+    for ( int k=0; k<ol.size(); k++ ) {
+      if ( ol[k].streaming() )
+	ol[k].setStreamPadding( ExtendedData );
+      else
+	ol[k].SampleDataF::append( ol[k].back(), ExtendedData );
+    }
   }
 
   // apply calibration:
@@ -1107,8 +1065,12 @@ int ComediAnalogOutput::reset( void )
 void ComediAnalogOutput::clearBuffers( void ) 
 { 
   if ( ExtendedData > 0 ) {
-    for ( int k=0; k<Sigs.size(); k++ )
-      Sigs[k].resize( Sigs[k].size()-ExtendedData );
+    for ( int k=0; k<Sigs.size(); k++ ) {
+      if ( Sigs[k].streaming() )
+	Sigs[k].setStreamPadding( 0 );
+      else
+	Sigs[k].resize( Sigs[k].size()-ExtendedData );
+    }
     ExtendedData = 0;
   }
 
@@ -0,0 +1,104 @@
+/*
+  comedi/comedicalibration.cc
+  Cache of parsed comedi calibration files.
+
+  RELACS - Relaxed ELectrophysiological data Acquisition, Control, and Stimulation
+  Copyright (C) 2002-2015 Jan Benda <jan.benda@uni-tuebingen.de>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+  
+  RELACS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <sys/stat.h>
+#include <QMutex>
+#include <QMutexLocker>
+#include <relacs/comedi/comedicalibration.h>
+using namespace std;
+
+namespace comedi {
+
+
+namespace {
+
+struct CalibrationEntry
+{
+  comedi_calibration_t *Calibration;
+  time_t ModificationTime;
+  int Count;
+};
+
+QMutex CalibrationMutex;
+map< string, CalibrationEntry > Calibrations;
+
+}
+
+
+comedi_calibration_t *ComediCalibration::acquire( comedi_t *device )
+{
+  char *calibpath = comedi_get_default_calibration_path( device );
+  if ( calibpath == 0 )
+    return 0;
+  string path( calibpath );
+  free( calibpath );
+
+  struct stat fs;
+  if ( stat( path.c_str(), &fs ) != 0 )
+    return 0;
+
+  QMutexLocker locker( &CalibrationMutex );
+  map< string, CalibrationEntry >::iterator cp = Calibrations.find( path );
+  if ( cp != Calibrations.end() ) {
+    CalibrationEntry &ce = cp->second;
+    // reuse calibration if the file was not modified or if it is in use:
+    if ( ce.ModificationTime == fs.st_mtime || ce.Count > 0 ) {
+      ce.Count++;
+      return ce.Calibration;
+    }
+    if ( ce.Calibration != 0 )
+      comedi_cleanup_calibration( ce.Calibration );
+    Calibrations.erase( cp );
+  }
+
+  comedi_calibration_t *calibration = comedi_parse_calibration_file( path.c_str() );
+  if ( calibration == 0 )
+    return 0;
+  CalibrationEntry ce;
+  ce.Calibration = calibration;
+  ce.ModificationTime = fs.st_mtime;
+  ce.Count = 1;
+  Calibrations[ path ] = ce;
+  return calibration;
+}
+
+
+void ComediCalibration::release( comedi_calibration_t *calibration )
+{
+  if ( calibration == 0 )
+    return;
+  QMutexLocker locker( &CalibrationMutex );
+  for ( map< string, CalibrationEntry >::iterator cp = Calibrations.begin();
+	cp != Calibrations.end();
+	++cp ) {
+    if ( cp->second.Calibration == calibration ) {
+      if ( cp->second.Count > 0 )
+	cp->second.Count--;
+      return;
+    }
+  }
+}
+
+
+}; /* namespace comedi */
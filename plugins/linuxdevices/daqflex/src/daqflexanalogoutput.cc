@@ -23,8 +23,10 @@
 #include <sstream>
 #include <cstdio>
 #include <cmath>
+#include <vector>
 #include <QMutexLocker>
 #include <relacs/str.h>
+#include <relacs/aoconversion.h>
 #include <relacs/daqflex/daqflexanalogoutput.h>
 using namespace std;
 using namespace relacs;
@@ -336,77 +338,41 @@ int DAQFlexAnalogOutput::convert( char *cbuffer, int nbuffer )
 
   // conversion polynomials and scale factors:
   unsigned int maxAOData = DAQFlexDevice->maxAOData();
-  double minval[ Sigs.size() ];
-  double maxval[ Sigs.size() ];
-  double gain[ Sigs.size() ];
+  vector< AOConversion > conv( Sigs.size() );
   //  const Calibration* calib[Sigs.size()];
   T zeros[ Sigs.size() ];
   for ( int k=0; k<Sigs.size(); k++ ) {
-    minval[k] = Sigs[k].minVoltage()/Sigs[k].scale();
-    maxval[k] = Sigs[k].maxVoltage()/Sigs[k].scale();
-    gain[k] = maxAOData/(maxval[k]-minval[k]);
+    double minval = Sigs[k].minVoltage()/Sigs[k].scale();
+    double maxval = Sigs[k].maxVoltage()/Sigs[k].scale();
     // calib[k] = (const Calibration *)Sigs[k].gainData();
     // XXX calibration?
-    float v = ChannelValues[Sigs[k].channel()];
     if ( ::fabs( Sigs[k].scale() ) < 1.0e-8 ) {
-      minval[k] = Sigs[k].minVoltage();
-      maxval[k] = Sigs[k].maxVoltage();
-      gain[k] = maxAOData/(maxval-minval);
-      v = 0.0;
+      minval = Sigs[k].minVoltage();
+      maxval = Sigs[k].maxVoltage();
+      conv[k].setRange( 0.0, 0.0 );
     }
-    else if ( v > maxval[k] )
-      v = maxval[k];
-    else if ( v < minval[k] ) 
-      v = minval[k];
-    zeros[k] = (unsigned short)( (v-minval[k])*gain[k] );
-    if ( zeros[k] > maxAOData )
-      zeros[k] = maxAOData;
+    else
+      conv[k].setRange( minval, maxval );
+    // (v-minval)*gain:
+    double coefficients[2] = { 0.0, maxAOData/(maxval-minval) };
+    conv[k].setPolynomial( coefficients, 1, minval );
+    conv[k].setDataRange( 0.0, maxAOData );
+    conv[k].setRounding( false );
+    zeros[k] = conv[k].convert<T>( ChannelValues[Sigs[k].channel()] );
   }
 
-  // buffer pointer:
-  T *bp = (T*)cbuffer;
-  int maxn = nbuffer/sizeof( T )/Sigs.size();
-  int n = 0;
-
   // convert data and multiplex into buffer:
-  for ( int i=0; i<maxn && Sigs[0].deviceWriting(); i++ ) {
-    for ( int k=0; k<Sigs.size(); k++ ) {
-      if ( Sigs[k].deviceCount() < 0 ) {
-	*bp = zeros[k];
-	Sigs[k].incrDeviceIndex();
-	if ( Sigs[k].deviceIndex() >= Sigs[k].deviceDelay() )
-	  Sigs[k].incrDeviceCount();
-      }
-      else {
-	float v = Sigs[k].deviceValue();
-	if ( ::fabs( Sigs[k].scale() ) < 1.0e-8 )
-	  v = 0.0;
-	else if ( v > maxval[k] )
-	  v = maxval[k];
-	else if ( v < minval[k] )
-	  v = minval[k];
-	// XXX calibration?
-	T d = (unsigned short)( (v-minval[k])*gain[k] );
-	if ( d > maxAOData )
-	  d = maxAOData;
-	*bp = d;
-	if ( Sigs[k].deviceIndex() >= Sigs[k].size() )
-	  Sigs[k].incrDeviceCount();
-      }
-      ++bp;
-      ++n;
-    }
-  }
+  int maxn = nbuffer/sizeof( T )/Sigs.size();
+  int n = convertAO( Sigs, &conv[0], zeros, (T*)cbuffer, maxn );
 
   // memorize last values:
   for ( int k=0; k<Sigs.size(); k++ ) {
-    if ( Sigs[k].deviceCount() >= 0 && Sigs[k].deviceIndex() > 0 )
-      ChannelValues[Sigs[k].channel()] = Sigs[k][Sigs[k].deviceIndex()-1];
-    else if ( Sigs[k].deviceCount() > 0 && Sigs[k].deviceIndex() == 0 )
-      ChannelValues[Sigs[k].channel()] = Sigs[k].back();
+    if ( ( Sigs[k].deviceCount() >= 0 && Sigs[k].deviceIndex() > 0 ) ||
+	 ( Sigs[k].deviceCount() > 0 && Sigs[k].deviceIndex() == 0 ) )
+      ChannelValues[Sigs[k].channel()] = Sigs[k].deviceLastValue();
   }
 
-  return n * sizeof( T );
+  return n * Sigs.size() * sizeof( T );
 }
 
 
@@ -29,6 +29,7 @@
 #include <sys/ioctl.h>
 #include <fcntl.h>   
 #include <relacs/stats.h>
+#include <relacs/aoconversion.h>
 #include <relacs/nieseries/niai.h>
 #include <relacs/nieseries/niao.h>
 using namespace std;
@@ -135,6 +136,12 @@ int NIAO::directWrite( OutList &sigs )
 
 int NIAO::testWriteDevice( OutList &sigs )
 {
+  // the whole signal is transferred at once:
+  for ( int k=0; k<sigs.size(); k++ ) {
+    if ( sigs[k].streaming() )
+      sigs[k].addErrorStr( "streamed signals are not supported" );
+  }
+
   // check channel ordering:
   if ( sigs.size() > 1 ) {
     vector< unsigned int > chs( sigs.size() );
@@ -272,14 +279,14 @@ int NIAO::convertData( OutList &sigs )
   ol.sortByChannel();
 
   // set scaling factors:
-  double scale[ ol.size() ];
-  double minval[ ol.size() ];
-  double maxval[ ol.size() ];
+  vector< AOConversion > conv( ol.size() );
+  const float *src[ ol.size() ];
   for ( int k=0; k<ol.size(); k++ ) {
     double *gainp = (double *)ol[k].gainData();
-    scale[k] = (*gainp) * ol[k].scale();
-    minval[k] = ol[k].minValue();
-    maxval[k] = ol[k].maxValue();
+    conv[k].setRange( ol[k].minValue(), ol[k].maxValue() );
+    conv[k].setScale( (*gainp) * ol[k].scale() );
+    conv[k].setDataRange( -32768.0, 32767.0 );
+    src[k] = ol[k].data();
   }
 
   // allocate buffer:
@@ -287,18 +294,7 @@ int NIAO::convertData( OutList &sigs )
   signed short *buffer = new signed short[nbuffer];
 
   // convert data and multiplex into buffer:
-  signed short *bp = buffer;
-  for ( int i=0; i<ol[0].size(); i++ ) {
-    for ( int k=0; k<ol.size(); k++ ) {
-      float v = ol[k][i];
-      if ( v > maxval[k] )
-	v = maxval[k];
-      else if ( v < minval[k] ) 
-	v = minval[k];
-      *bp = (signed short) ::rint( v * scale[k] );
-      ++bp;
-    }
-  }
+  convertAO( &conv[0], src, ol.size(), ol[0].size(), buffer );
 
   sigs[0].setDeviceBuffer( (char *)buffer, nbuffer, sizeof( signed short ) );
 
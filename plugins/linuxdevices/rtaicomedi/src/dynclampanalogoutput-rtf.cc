@@ -775,7 +775,7 @@ int DynClampAnalogOutput::prepareWrite( OutList &sigs )
     syncCmdIOC.type = SUBDEV_OUT;
     syncCmdIOC.frequency = (unsigned int)::rint( ol[0].sampleRate() );
     syncCmdIOC.delay = ol[0].indices( ol[0].delay() );
-    syncCmdIOC.duration = ol[0].size();
+    syncCmdIOC.duration = ol[0].deviceSize();
     syncCmdIOC.continuous = ol[0].continuous();
     syncCmdIOC.startsource = ol[0].startSource();
     syncCmdIOC.buffersize = BufferSize;
@@ -904,7 +904,7 @@ int DynClampAnalogOutput::writeData( void )
     for ( int i=0; i<maxn && Sigs[0].deviceWriting(); i++ ) {
       for ( int k=0; k<Sigs.size(); k++ ) {
 	*bp = Sigs[k].deviceValue();
-	if ( Sigs[k].deviceIndex() >= Sigs[k].size() )
+	if ( Sigs[k].deviceIndex() >= Sigs[k].deviceSize() )
 	  Sigs[k].incrDeviceCount();
 	++bp;
 	++bytesConverted;
@@ -24,6 +24,7 @@
 
 #include <vector>
 #include <relacs/multiplot.h>
+#include <relacs/spiketriggeredaverage.h>
 #include <relacs/repro.h>
 #include <relacs/ephys/traces.h>
 using namespace std;
@@ -44,12 +45,15 @@ namespace multielectrode {
 - \c stamint=-100ms: Minimum STA time (\c number)
 - \c stamaxt=10ms: Maximum STA time (\c number)
 - \c plotsnippets=true: Plot the individual snippets (\c boolean)
+- \c nsnippets=20: Number of snippets kept for plotting (\c integer)
 
 \par Files
 No output files.
 
 \par Plots
-The STAs. All snippets in red, the STA (blue) and the standard deviation (cyan).
+The STAs accumulated over all spikes since the start of the RePro.
+A random sample of \c nsnippets snippets in red,
+the STA (blue) and the standard deviation (cyan).
 
 \par Requirements
 - At least one voltage trace
@@ -74,24 +78,16 @@ public:
     /*! Provide a list of existing input traces to select from. */
   virtual void preConfig( void );
 
-    /*! Analyze the data. */
-  void analyze( const EventData &spiketrain, double interval );
+    /*! Add the new spikes of \a spiketrain to the STAs. */
+  void analyze( const EventData &spiketrain );
     /*! Plot the results. */
   void plot( bool snippets );
 
 
 protected:
 
-    /*! Stores data for STA of a single traces. 
-        SampleDataF is from numerics/include/relacs/sampledata.h
-        vector is from the STL */
-  struct STA {
-    vector< SampleDataF > Snippets;
-    SampleDataF Average;
-    SampleDataF StDev;
-  };
-    /*! The STA data for all input traces. */
-  vector< STA > STAs;
+    /*! The STAs of all input traces. */
+  SpikeTriggeredAverage STA;
 
     /*! We need lots of plots for the STAs. */
   MultiPlot P;
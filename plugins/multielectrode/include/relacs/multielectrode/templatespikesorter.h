@@ -0,0 +1,287 @@
+/*
+  templatespikesorter.h
+  Online multi-channel spike sorting by template matching
+
+  RELACS - Relaxed ELectrophysiological data Acquisition, Control, and Stimulation
+  Copyright (C) 2002-2015 Jan Benda <jan.benda@uni-tuebingen.de>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+  
+  RELACS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _RELACS_MULTIELECTRODE_TEMPLATESPIKESORTER_H_
+#define _RELACS_MULTIELECTRODE_TEMPLATESPIKESORTER_H_ 1
+
+#include <vector>
+#include <atomic>
+#include <QThread>
+#include <relacs/optwidget.h>
+#include <relacs/plot.h>
+#include <relacs/filter.h>
+using namespace std;
+using namespace relacs;
+
+namespace multielectrode {
+
+
+class TemplateLearner;
+
+
+/*!
+\class TemplateSpikeSorter
+\brief [Detector] Online spike sorting across multiple channels by template matching
+\author Jan Benda
+\version 1.0 (Oct 18, 2026)
+
+The detector operates on all its input traces at once, e.g. the four
+channels of a tetrode or the channels of a multi-electrode array.
+All input traces need to be sampled with the same rate
+and should be high-pass filtered.
+
+\par Learning
+autoConfigure() (the "Learn" button) estimates the baseline of each
+channel from its mean and the noise level
+from the median of the absolute deviations from this mean.
+The detection thresholds are set to \c threshfac times the noise level
+relative to the baseline. Then it extracts
+the waveforms around all threshold crossings on all channels
+(from \c before the peak to \c after the peak), subtracts the baselines, and
+clusters them into at most \c nunits clusters by k-means.
+Clusters with less than \c minspikes waveforms are discarded.
+The means of the remaining clusters are the templates of the units,
+sorted by decreasing amplitude.
+If no templates are available yet, the first \c learntime seconds of
+data are used for learning automatically.
+Only copying the data is done by the calling thread.
+The clustering runs on a separate thread, so that
+filtering and detection are not interrupted.
+The learned thresholds and templates are used from the next call of detect()
+after the learning has been finished on. Sorting then starts with the data
+recorded at that time.
+
+\par Sorting
+Each threshold crossing is aligned to the largest excursion
+on any channel within \c before after the crossing.
+The waveform across all channels is then compared to all templates.
+The waveform is assigned to the unit with the smallest residual,
+i.e. the squared distance between waveform and template relative to the
+squared norm of the template, if this residual is smaller than \c maxresidual.
+Distances are only computed on the channels where the template
+exceeds half of the detection threshold.
+Otherwise the waveform is discarded.
+After a spike no further threshold crossings are considered for \c deadtime.
+
+\par Output
+The detector produces one event trace for each of up to eight units.
+The size of each event is the amplitude of the waveform relative to the
+baseline on the channel where the template of the unit is largest.
+The width of each event is the residual of the template match
+and serves as a quality measure.
+
+\par Options
+- \c Detector
+    - \c threshfac=5: Threshold in multiples of the noise level (\c number)
+    - \c detectpeaks=false: Detect peaks (or troughs if unchecked) (\c boolean)
+    - \c before=0.5ms: Waveform before peak (\c number)
+    - \c after=1ms: Waveform after peak (\c number)
+    - \c deadtime=1ms: Dead time after a spike (\c number)
+- \c Templates
+    - \c nunits=3: Maximum number of units (\c integer)
+    - \c minspikes=20: Minimum number of spikes of a unit (\c integer)
+    - \c maxresidual=0.5: Maximum residual of the template match (\c number)
+    - \c learntime=10sec: Duration of data used for learning the templates (\c number)
+*/
+
+
+class TemplateSpikeSorter : public Filter
+{
+  Q_OBJECT
+
+public:
+
+    /*! Maximum number of units, i.e. of output event traces. */
+  static const int MaxUnits = 8;
+
+  TemplateSpikeSorter( const string &ident="", int mode=0 );
+  ~TemplateSpikeSorter( void );
+  virtual int init( const InList &data, EventList &outevents,
+		    const EventList &other, const EventData &stimuli );
+  virtual void readConfig( StrQueue &sq );
+  virtual void notify( void );
+    /*! Copy the data between \a tbegin and \a tend and start estimating
+        the detection thresholds and learning the templates from them
+        on a separate thread.
+	\return 0 on success, -1 if the data range is too short
+	or the templates are still being learned. */
+  virtual int autoConfigure( const InList &data, double tbegin, double tend );
+    /*! Detect and sort spikes in the traces of \a data. */
+  virtual int detect( const InList &data, EventList &outevents,
+		      const EventList &other, const EventData &stimuli );
+
+
+public slots:
+
+  void customEvent( QEvent *qce );
+    /*! Learn the templates from the last \c learntime seconds of data. */
+  void autoConfigure( void );
+
+
+protected:
+
+  friend class TemplateLearner;
+
+    /*! Estimate the detection thresholds and learn the templates
+        from LearnData. Executed by the TemplateLearner thread. */
+  void learn( void );
+    /*! Abort learning and wait for the TemplateLearner thread to finish.
+        Discards any learned templates that are not used yet. */
+  void stopLearning( void );
+    /*! Use the thresholds and templates from the last learning. */
+  void installTemplates( void );
+
+    /*! Set the number of data elements of the waveforms according to
+        the sampling interval \a stepsize. */
+  void setSnippetSize( double stepsize );
+    /*! Search for the next crossing of \a thresholds relative to
+        \a baselines in \a data starting at \a index up to \a end.
+        \a data[c][i] is the i-th data element of channel c.
+        \return the index of the aligned peak or -1 if no crossing was found.
+        \a index is set to the index where to continue searching. */
+  template < typename D >
+  int nextSpike( const D &data, const vector< float > &baselines,
+		 const vector< float > &thresholds, int &index, int end ) const;
+    /*! Copy the waveforms of all channels of \a data
+        around \a peak relative to \a baselines into \a snippet. */
+  template < typename D >
+  void extract( const D &data, const vector< float > &baselines,
+		int peak, float *snippet ) const;
+    /*! Compare \a snippet with all templates.
+        \return the index of the best matching template
+        and its residual in \a residual, -1 if there are no templates. */
+  int classify( const float *snippet, double &residual ) const;
+    /*! Plot the templates. */
+  void plotTemplates( void );
+
+    /*! Sign of the spikes (1 for peaks, -1 for troughs). */
+  float Sign;
+    /*! Threshold factor for the noise level. */
+  double ThreshFac;
+    /*! Time before the peak. */
+  double Before;
+    /*! Time after the peak. */
+  double After;
+    /*! Dead time after a spike. */
+  double DeadTime;
+    /*! Maximum number of units. */
+  int MaxNUnits;
+    /*! Minimum number of spikes of a unit. */
+  int MinSpikes;
+    /*! Maximum residual of the template match. */
+  double MaxResidual;
+    /*! Duration of data used for learning. */
+  double LearnTime;
+
+    /*! Number of channels. */
+  int NChannels;
+    /*! Number of data elements before the peak. */
+  int NBefore;
+    /*! Number of data elements after the peak. */
+  int NAfter;
+    /*! Number of data elements of the dead time. */
+  int NDead;
+    /*! Number of data elements of a waveform on a single channel. */
+  int Length;
+    /*! Length padded to a multiple of four. */
+  int Stride;
+    /*! Size of a waveform across all channels. */
+  int Dim;
+    /*! Baseline (mean) of each channel. */
+  vector< float > Baselines;
+    /*! Detection threshold for each channel relative to its baseline. */
+  vector< float > Thresholds;
+    /*! The number of templates. */
+  int NUnits;
+    /*! The templates, each of size Dim. */
+  vector< float > Templates;
+    /*! The squared norms of the templates on each channel. */
+  vector< double > Norms;
+    /*! The channels on which each template is compared. */
+  vector< vector< int > > Channels;
+    /*! The channel with the largest amplitude of each template. */
+  vector< int > PeakChannels;
+    /*! Buffer for a single waveform. */
+  mutable vector< float > Snippet;
+    /*! Squared norms of the waveform on each channel. */
+  mutable vector< double > SnippetNorms;
+    /*! Index of the next data element to be analyzed. */
+  int NextIndex;
+    /*! Time of the first call of detect() after init(). */
+  double StartTime;
+
+    /*! Thread learning the templates. */
+  TemplateLearner *Learner;
+    /*! Set by the learner when new templates are available. */
+  atomic< bool > Learned;
+    /*! Tells the learner to quit. */
+  atomic< bool > AbortLearning;
+    /*! Copy of the data the templates are learned from. */
+  vector< vector< float > > LearnData;
+    /*! Index into LearnData of the first data element
+        where to search for spikes. */
+  int LearnBegin;
+    /*! Index into LearnData of the data element
+        where to stop searching for spikes. */
+  int LearnEnd;
+    /*! The learned baselines. */
+  vector< float > LearnBaselines;
+    /*! The learned thresholds. */
+  vector< float > LearnThresholds;
+    /*! The number of learned templates. */
+  int LearnNUnits;
+    /*! The learned templates. */
+  vector< float > LearnTemplates;
+    /*! The squared norms of the learned templates on each channel. */
+  vector< double > LearnNorms;
+    /*! The channels on which each learned template is compared. */
+  vector< vector< int > > LearnChannels;
+    /*! The channel with the largest amplitude of each learned template. */
+  vector< int > LearnPeakChannels;
+
+  const InList *Data;
+  string Unit;
+  double StepSize;
+  OptWidget SDW;
+  Plot *TP;
+
+};
+
+
+class TemplateLearner : public QThread
+{
+
+public:
+
+  TemplateLearner( TemplateSpikeSorter *tss );
+  virtual void run( void );
+
+
+private:
+
+  TemplateSpikeSorter *TSS;
+
+};
+
+
+}; /* namespace multielectrode */
+
+#endif /* ! _RELACS_MULTIELECTRODE_TEMPLATESPIKESORTER_H_ */
@@ -19,7 +19,6 @@
   along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
-#include <relacs/stats.h>
 #include <relacs/multielectrode/multista.h>
 using namespace relacs;
 
@@ -36,6 +35,7 @@ MultiSTA::MultiSTA( void )
   addNumber( "stamint", "Minimum STA time", -0.1, -1000.0, 1000.0, 0.01, "sec", "ms" );
   addNumber( "stamaxt", "Maximum STA time", 0.01, -1000.0, 1000.0, 0.01, "sec", "ms" );
   addBoolean( "plotsnippets", "Plot the individual snippets", true );
+  addInteger( "nsnippets", "Number of snippets kept for plotting", 20, 1, 10000, 1 ).setActivation( "plotsnippets", "true" );
 
   // plot:
   setWidget( &P );
@@ -51,15 +51,16 @@ int MultiSTA::main( void )
   double stamint = number( "stamint" );
   double stamaxt = number( "stamaxt" );
   bool plotsnippets = boolean( "plotsnippets" );
+  int nsnippets = plotsnippets ? integer( "nsnippets" ) : 0;
 
   // init STAs:
+  InList intraces;
+  intraces.add( &trace( intrace ) );
   STAs.resize( SpikeTraces );   // SpikeTraces is the number of available traces with spikes (from plugins/ephys/include/relacs/ephys/traces.h)
   for ( unsigned int k=0; k<STAs.size(); k++ ) {
-    STAs[k].Snippets.clear();                               // we have no data yet
-    STAs[k].Snippets.reserve( (int)floor( interval*500 ) ); // reserve enough memory (assumes 500Hz spike rate)
-    // the STA goes from stamint to stamaxt with the same sample interval as the corresponding input trace:
-    STAs[k].Average.resize( stamint, stamaxt, trace( SpikeTrace[k] ).sampleInterval(), 0.0 );
-    STAs[k].StDev.resize( stamint, stamaxt, trace( SpikeTrace[k] ).sampleInterval(), 0.0 );
+    // the STA goes from stamint to stamaxt with the same sample interval as the input trace,
+    // snippets are not stored, the STA is accumulated spike by spike:
+    STAs[k].init( intraces, stamint, stamaxt, nsnippets );
   }
 
   // init plots:
@@ -97,7 +98,7 @@ int MultiSTA::main( void )
       return count > 2 ? Completed : Aborted;
     }
 
-    analyze( trace( intrace ), interval );
+    analyze();
 
     plot( plotsnippets );
 
@@ -110,30 +111,11 @@ int MultiSTA::main( void )
 }
 
 
-void MultiSTA::analyze( const InData &intrace, double interval )
+void MultiSTA::analyze( void )
 {
-  // room to leave at the end of the input trace:
-  double skip = 2.0*STAs[0].Average.rangeBack();
-
-  // go through the spike trains:
-  for ( unsigned int k=0; k<STAs.size(); k++ ) {
-    STAs[k].Snippets.clear();
-    // for each spike find corresponding snippet in intrace:
-    const EventData &spikes = events( SpikeEvents[k] ); //  numerics/include/relacs/eventdata.h
-    int n = spikes.next( currentTime() - skip - interval ); // index to first spike in interval
-    int p = spikes.previous( currentTime() - skip ); // index to last spike in interval
-    for ( int i=n; i<=p; i++ ) {
-      STAs[k].Snippets.push_back( SampleDataF( STAs[k].Average.range(), 0.0 ) );
-      SampleDataF &snippet = STAs[k].Snippets.back();
-      // copy data from trace into snippet:
-      for ( int j=0; j<snippet.size(); j++ )
-	snippet[j] = intrace[ intrace.index( spikes[i] + snippet.pos( j ) ) ];
-    }
-
-    // compute the average (from numerics/include/relacs/stats.h):
-    average( STAs[k].Average.array(), STAs[k].StDev.array(), STAs[k].Snippets );
-
-  }
+  // add the new spikes of each spike train:
+  for ( unsigned int k=0; k<STAs.size(); k++ )
+    STAs[k].update( events( SpikeEvents[k] ) );
 }
 
 
@@ -144,11 +126,16 @@ void MultiSTA::plot( bool snippets )
     P[k].clear();
     P[k].plotVLine( 0.0, Plot::White, 2 );
     if ( snippets ) {
-      for ( unsigned int j=0; j<STAs[k].Snippets.size(); j++ )
-	P[k].plot( STAs[k].Snippets[j], 1000.0, Plot::Red, 1, Plot::Solid );
+      const vector< SampleDataF > &sn = STAs[k].snippets( 0 );
+      for ( unsigned int j=0; j<sn.size(); j++ )
+	P[k].plot( sn[j], 1000.0, Plot::Red, 1, Plot::Solid );
     }
-    P[k].plot( STAs[k].Average, 1000.0, Plot::Blue, 4, Plot::Solid );
-    P[k].plot( STAs[k].StDev, 1000.0, Plot::Cyan, 2, Plot::Solid );
+    SampleDataF average;
+    STAs[k].average( 0, average );
+    SampleDataF stdev;
+    STAs[k].stdev( 0, stdev );
+    P[k].plot( average, 1000.0, Plot::Blue, 4, Plot::Solid );
+    P[k].plot( stdev, 1000.0, Plot::Cyan, 2, Plot::Solid );
   }
   P.draw();
   P.unlock();
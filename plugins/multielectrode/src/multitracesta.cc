@@ -19,7 +19,6 @@
   along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
-#include <relacs/stats.h>
 #include <relacs/multielectrode/multitracesta.h>
 using namespace relacs;
 
@@ -36,6 +35,7 @@ MultiTraceSTA::MultiTraceSTA( void )
   addNumber( "stamint", "Minimum STA time", -0.1, -1000.0, 1000.0, 0.01, "sec", "ms" );
   addNumber( "stamaxt", "Maximum STA time", 0.01, -1000.0, 1000.0, 0.01, "sec", "ms" );
   addBoolean( "plotsnippets", "Plot the individual snippets", true );
+  addInteger( "nsnippets", "Number of snippets kept for plotting", 20, 1, 10000, 1 ).setActivation( "plotsnippets", "true" );
 
   // plot:
   setWidget( &P );
@@ -51,25 +51,21 @@ int MultiTraceSTA::main( void )
   double stamint = number( "stamint" );
   double stamaxt = number( "stamaxt" );
   bool plotsnippets = boolean( "plotsnippets" );
+  int nsnippets = plotsnippets ? integer( "nsnippets" ) : 0;
 
   // init STAs:
-  STAs.resize( traces().size() );
-  for ( unsigned int k=0; k<STAs.size(); k++ ) {
-    STAs[k].Snippets.clear();                               // we have no data yet
-    STAs[k].Snippets.reserve( (int)floor( interval*500 ) ); // reserve enough memory (assumes 500Hz spike rate)
-    // the STA goes from stamint to stamaxt with the same sample interval as the corresponding input trace:
-    STAs[k].Average.resize( stamint, stamaxt, trace( SpikeTrace[k] ).sampleInterval(), 0.0 );
-    STAs[k].StDev.resize( stamint, stamaxt, trace( SpikeTrace[k] ).sampleInterval(), 0.0 );
-  }
+  // the STAs go from stamint to stamaxt with the same sample intervals as the input traces,
+  // snippets are not stored, the STAs are accumulated spike by spike:
+  STA.init( traces(), stamint, stamaxt, nsnippets );
 
   // init plots:
   P.lock();
   P.clear();
-  P.resize( STAs.size(), 4, true );  // set the number of plots and arrange them in 4 columns
+  P.resize( STA.traces(), 4, true );  // set the number of plots and arrange them in 4 columns
   for ( int k=0; k<P.size(); k++ ) {
     if ( SpikeTrace[inspikes] == k )
       P[k].setPlotColor( Plot::Gray );
-    P[k].setLabel( trace( SpikeTrace[k] ).ident(), 0.05, Plot::Graph, 0.8, Plot::Graph );
+    P[k].setLabel( trace( k ).ident(), 0.05, Plot::Graph, 0.8, Plot::Graph );
     P[k].setXRange( 1000.0*stamint, 1000.0*stamaxt );
     /*
     P[k].setXLabel( "msec" );
@@ -93,11 +89,11 @@ int MultiTraceSTA::main( void )
     sleep( interval );
     if ( interrupt() ) {
       // user interruption (by starting a different RePro), we have to return:
-      STAs.clear();
+      STA.reset();
       return count > 2 ? Completed : Aborted;
     }
 
-    analyze( events( SpikeEvents[inspikes] ), interval );
+    analyze( events( SpikeEvents[inspikes] ) );
 
     plot( plotsnippets );
 
@@ -105,52 +101,35 @@ int MultiTraceSTA::main( void )
 
   }
 
-  STAs.clear();
+  STA.reset();
   return Completed;
 }
 
 
-void MultiTraceSTA::analyze( const EventData &spiketrain, double interval )
+void MultiTraceSTA::analyze( const EventData &spiketrain )
 {
-  cerr << "spikes " << spiketrain.ident() << endl;
-
-  // room to leave at the end of the input traces:
-  double skip = 2.0*STAs[0].Average.rangeBack();
-
-  // go through the traces:
-  for ( unsigned int k=0; k<STAs.size(); k++ ) {
-    STAs[k].Snippets.clear();
-    // for each spike find corresponding snippet in the input trace:
-    const InData &intrace = trace( SpikeTrace[k] );  // numerics/include/relacs/eventdata.h
-    int n = spiketrain.next( currentTime() - skip - interval ); // index to first spike in interval
-    int p = spiketrain.previous( currentTime() - skip ); // index to last spike in interval
-    for ( int i=n; i<=p; i++ ) {
-      STAs[k].Snippets.push_back( SampleDataF( STAs[k].Average.range(), 0.0 ) );
-      SampleDataF &snippet = STAs[k].Snippets.back();
-      // copy data from trace into snippet:
-      for ( int j=0; j<snippet.size(); j++ )
-	snippet[j] = intrace[ intrace.index( spiketrain[i] + snippet.pos( j ) ) ];
-    }
-
-    // compute the average (from numerics/include/relacs/stats.h):
-    average( STAs[k].Average.array(), STAs[k].StDev.array(), STAs[k].Snippets );
-
-  }
+  // add the new spikes to the STAs of all traces:
+  STA.update( spiketrain );
 }
 
 
 void MultiTraceSTA::plot( bool snippets )
 {
   P.lock();
-  for ( unsigned int k=0; k<STAs.size(); k++ ) {
+  for ( int k=0; k<STA.traces(); k++ ) {
     P[k].clear();
     P[k].plotVLine( 0.0, Plot::White, 2 );
     if ( snippets ) {
-      for ( unsigned int j=0; j<STAs[k].Snippets.size(); j++ )
-	P[k].plot( STAs[k].Snippets[j], 1000.0, Plot::Red, 1, Plot::Solid );
+      const vector< SampleDataF > &sn = STA.snippets( k );
+      for ( unsigned int j=0; j<sn.size(); j++ )
+	P[k].plot( sn[j], 1000.0, Plot::Red, 1, Plot::Solid );
     }
-    P[k].plot( STAs[k].Average, 1000.0, Plot::Blue, 4, Plot::Solid );
-    P[k].plot( STAs[k].StDev, 1000.0, Plot::Cyan, 2, Plot::Solid );
+    SampleDataF average;
+    STA.average( k, average );
+    SampleDataF stdev;
+    STA.stdev( k, stdev );
+    P[k].plot( average, 1000.0, Plot::Blue, 4, Plot::Solid );
+    P[k].plot( stdev, 1000.0, Plot::Cyan, 2, Plot::Solid );
   }
   P.draw();
   P.unlock();
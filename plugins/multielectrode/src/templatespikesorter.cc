@@ -0,0 +1,758 @@
+/*
+  templatespikesorter.cc
+  Online multi-channel spike sorting by template matching
+
+  RELACS - Relaxed ELectrophysiological data Acquisition, Control, and Stimulation
+  Copyright (C) 2002-2015 Jan Benda <jan.benda@uni-tuebingen.de>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+  
+  RELACS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QPushButton>
+#include <QLabel>
+#include <relacs/sampledata.h>
+#include <relacs/multielectrode/templatespikesorter.h>
+using namespace relacs;
+
+namespace multielectrode {
+
+
+namespace {
+
+
+  /* Dot product of the \a n floats of \a a and \a b.
+     \a n must be a multiple of four. */
+double dot( const float *a, const float *b, int n )
+{
+#ifdef __SSE2__
+  __m128 s0 = _mm_setzero_ps();
+  __m128 s1 = _mm_setzero_ps();
+  int i = 0;
+  for ( ; i+8<=n; i+=8 ) {
+    s0 = _mm_add_ps( s0, _mm_mul_ps( _mm_loadu_ps( a+i ), _mm_loadu_ps( b+i ) ) );
+    s1 = _mm_add_ps( s1, _mm_mul_ps( _mm_loadu_ps( a+i+4 ), _mm_loadu_ps( b+i+4 ) ) );
+  }
+  if ( i < n )
+    s0 = _mm_add_ps( s0, _mm_mul_ps( _mm_loadu_ps( a+i ), _mm_loadu_ps( b+i ) ) );
+  float r[4];
+  _mm_storeu_ps( r, _mm_add_ps( s0, s1 ) );
+  return ( r[0] + r[1] ) + ( r[2] + r[3] );
+#else
+  double s = 0.0;
+  for ( int i=0; i<n; i++ )
+    s += a[i]*b[i];
+  return s;
+#endif
+}
+
+
+  /* Lloyd's algorithm for clustering the \a n waveforms of size \a dim
+     in \a snippets into \a k clusters starting from \a centers.
+     Returns the cluster of each waveform in \a units and the number
+     of waveforms in each cluster in \a counts.
+     Returns early as soon as \a abort is set. */
+void kMeans( const vector< float > &snippets, int n, int dim, int k,
+	     vector< float > &centers, vector< int > &units,
+	     vector< int > &counts, const atomic< bool > &abort )
+{
+  counts.assign( k, 0 );
+  vector< double > norms( k );
+  vector< double > sums( k*dim );
+  for ( int iter=0; iter<100 && ! abort; iter++ ) {
+    // assign waveforms to nearest centers:
+    for ( int c=0; c<k; c++ ) {
+      norms[c] = dot( &centers[c*dim], &centers[c*dim], dim );
+      counts[c] = 0;
+    }
+    bool reassigned = false;
+    for ( int i=0; i<n; i++ ) {
+      const float *sp = &snippets[i*dim];
+      int best = 0;
+      double min = HUGE_VAL;
+      for ( int c=0; c<k; c++ ) {
+	double d = norms[c] - 2.0*dot( sp, &centers[c*dim], dim );
+	if ( d < min ) {
+	  min = d;
+	  best = c;
+	}
+      }
+      if ( units[i] != best ) {
+	units[i] = best;
+	reassigned = true;
+      }
+      counts[best]++;
+    }
+    if ( ! reassigned )
+      break;
+    // update centers:
+    sums.assign( k*dim, 0.0 );
+    for ( int i=0; i<n; i++ ) {
+      const float *sp = &snippets[i*dim];
+      double *cp = &sums[units[i]*dim];
+      for ( int j=0; j<dim; j++ )
+	cp[j] += sp[j];
+    }
+    for ( int c=0; c<k; c++ ) {
+      if ( counts[c] > 0 ) {
+	for ( int j=0; j<dim; j++ )
+	  centers[c*dim+j] = sums[c*dim+j]/counts[c];
+      }
+    }
+  }
+}
+
+
+}
+
+
+TemplateSpikeSorter::TemplateSpikeSorter( const string &ident, int mode )
+  : Filter( ident, mode, MultipleAnalogDetector, MaxUnits,
+	    "TemplateSpikeSorter", "multielectrode",
+	    "Jan Benda", "1.0", "Oct 18, 2026" )
+{
+  // parameter:
+  Sign = -1.0;
+  ThreshFac = 5.0;
+  Before = 0.0005;
+  After = 0.001;
+  DeadTime = 0.001;
+  MaxNUnits = 3;
+  MinSpikes = 20;
+  MaxResidual = 0.5;
+  LearnTime = 10.0;
+  NChannels = 0;
+  NBefore = 0;
+  NAfter = 0;
+  NDead = 1;
+  Length = 0;
+  Stride = 0;
+  Dim = 0;
+  NUnits = 0;
+  NextIndex = 0;
+  StartTime = -1.0;
+  Data = 0;
+  Unit = "mV";
+  StepSize = 0.0;
+  Learner = new TemplateLearner( this );
+  Learned = false;
+  AbortLearning = false;
+  LearnBegin = 0;
+  LearnEnd = 0;
+  LearnNUnits = 0;
+
+  // options:
+  int strongstyle = OptWidget::ValueLarge + OptWidget::ValueBold + OptWidget::ValueGreen + OptWidget::ValueBackBlack;
+  newSection( "Detector", 8 );
+  addNumber( "threshfac", "Threshold in multiples of the noise level", ThreshFac, 0.5, 100.0, 0.5, "", "", "%.1f", 2+8 );
+  addBoolean( "detectpeaks", "Detect peaks (or troughs if unchecked)", Sign > 0.0, 8 );
+  addNumber( "before", "Waveform before peak", Before, 0.0, 0.01, 0.0001, "sec", "ms", "%.1f", 8 );
+  addNumber( "after", "Waveform after peak", After, 0.0, 0.01, 0.0001, "sec", "ms", "%.1f", 8 );
+  addNumber( "deadtime", "Dead time after a spike", DeadTime, 0.0, 0.1, 0.0001, "sec", "ms", "%.1f", 8 );
+  newSection( "Templates", 8 );
+  addInteger( "nunits", "Maximum number of units", MaxNUnits, 1, MaxUnits, 1 ).setFlags( 2+8 );
+  addInteger( "minspikes", "Minimum number of spikes of a unit", MinSpikes, 1, 100000, 5 ).setFlags( 8 );
+  addNumber( "maxresidual", "Maximum residual of the template match", MaxResidual, 0.0, 10.0, 0.05, "", "", "%.2f", 2+8 );
+  addNumber( "learntime", "Duration of data used for learning the templates", LearnTime, 0.1, 1000.0, 1.0, "sec", "sec", "%.1f", 8 );
+  addInteger( "units", "Units", 0, 0, MaxUnits, 1 ).setFlags( 2+4 ).setStyle( strongstyle );
+  addNumber( "rate", "Rate of sorted spikes", 0.0, 0.0, 100000.0, 0.1, "Hz", "Hz", "%.0f", 2+4 );
+
+  setDialogSelectMask( 8 );
+  setConfigSelectMask( -8 );
+
+  // main layout:
+  QVBoxLayout *vbox = new QVBoxLayout;
+  vbox->setContentsMargins( 0, 0, 0, 0 );
+  vbox->setSpacing( 0 );
+  setLayout( vbox );
+
+  // parameter widgets:
+  SDW.assign( ((Options*)this), 2, 4, true, 0, mutex() );
+  SDW.setMargins( 4, 2, 4, 0 );
+  SDW.setVerticalSpacing( 1 );
+  vbox->addWidget( &SDW );
+
+  QHBoxLayout *hbox = new QHBoxLayout;
+  vbox->addLayout( hbox );
+  hbox->addWidget( new QLabel( "" ) );
+
+  // dialog button:
+  QPushButton *pb = new QPushButton( "Dialog" );
+  hbox->addWidget( pb );
+  connect( pb, SIGNAL( clicked( void ) ), this, SLOT( dialog( void ) ) );
+  connect( pb, SIGNAL( clicked( void ) ), this, SLOT( removeFocus( void ) ) );
+  hbox->addWidget( new QLabel( "" ) );
+
+  // learn button:
+  pb = new QPushButton( "Learn" );
+  hbox->addWidget( pb );
+  connect( pb, SIGNAL( clicked( void ) ), this, SLOT( autoConfigure( void ) ) );
+  connect( pb, SIGNAL( clicked( void ) ), this, SLOT( removeFocus( void ) ) );
+  hbox->addWidget( new QLabel( "" ) );
+
+  TP = new Plot( Plot::Copy );
+  TP->lock();
+  TP->noGrid();
+  TP->setTMarg( 1 );
+  TP->setBMarg( 2.5 );
+  TP->setLMarg( 5 );
+  TP->setRMarg( 1 );
+  TP->setXLabel( "ms" );
+  TP->setXLabelPos( 1.0, Plot::FirstMargin, 0.0, Plot::FirstAxis, Plot::Left, 0.0 );
+  TP->setXTics();
+  TP->setYRange( Plot::AutoScale, Plot::AutoScale );
+  TP->setYLabel( Unit );
+  TP->unlock();
+  vbox->addWidget( TP );
+}
+
+
+TemplateSpikeSorter::~TemplateSpikeSorter( void )
+{
+  stopLearning();
+}
+
+
+int TemplateSpikeSorter::init( const InList &data, EventList &outevents,
+			       const EventList &other, const EventData &stimuli )
+{
+  stopLearning();
+  Data = &data;
+  NChannels = data.size();
+  Unit = data[0].unit();
+  for ( int k=1; k<data.size(); k++ ) {
+    if ( ::fabs( data[k].stepsize() - data[0].stepsize() ) > 1.0e-8*data[0].stepsize() ) {
+      warning( "Input trace <b>" + data[k].ident() +
+	       "</b> is not sampled with the same rate as trace <b>" +
+	       data[0].ident() + "</b>!" );
+      return 1;
+    }
+  }
+  for ( int k=0; k<outevents.size(); k++ ) {
+    outevents[k].setSizeScale( 1.0 );
+    outevents[k].setSizeUnit( Unit );
+    outevents[k].setSizeFormat( "%5.1f" );
+    outevents[k].setWidthName( "residual" );
+    outevents[k].setWidthScale( 1.0 );
+    outevents[k].setWidthUnit( "1" );
+    outevents[k].setWidthFormat( "%4.2f" );
+  }
+  setNotify();
+  notify();
+  setSnippetSize( data[0].stepsize() );
+  Baselines.assign( NChannels, 0.0f );
+  Thresholds.assign( NChannels, HUGE_VALF );
+  NUnits = 0;
+  NextIndex = 0;
+  StartTime = -1.0;
+  TP->lock();
+  TP->setYLabel( Unit );
+  TP->unlock();
+  unsetNotify();
+  setInteger( "units", NUnits );
+  setNotify();
+  SDW.updateSettings();
+  SDW.updateValues();
+  return 0;
+}
+
+
+void TemplateSpikeSorter::readConfig( StrQueue &sq )
+{
+  unsetNotify(); // we have no input traces yet!
+  Options::read( sq, 0, ":" );
+}
+
+
+void TemplateSpikeSorter::notify( void )
+{
+  bool relearn = ( changed( "threshfac" ) || changed( "detectpeaks" ) ||
+		   changed( "before" ) || changed( "after" ) || changed( "nunits" ) );
+  // the learner uses all of these parameters:
+  if ( relearn || changed( "deadtime" ) || changed( "minspikes" ) )
+    stopLearning();
+  ThreshFac = number( "threshfac" );
+  Sign = boolean( "detectpeaks" ) ? 1.0 : -1.0;
+  Before = number( "before" );
+  After = number( "after" );
+  DeadTime = number( "deadtime" );
+  MaxNUnits = integer( "nunits" );
+  MinSpikes = integer( "minspikes" );
+  MaxResidual = number( "maxresidual" );
+  LearnTime = number( "learntime" );
+  if ( Data != 0 && relearn ) {
+    // templates need to be learned again:
+    setSnippetSize( StepSize );
+    NUnits = 0;
+    StartTime = -1.0;
+  }
+  NDead = StepSize > 0.0 ? (int)::ceil( DeadTime/StepSize ) : 1;
+  if ( NDead < 1 )
+    NDead = 1;
+  SDW.updateValues( OptWidget::changedFlag() );
+}
+
+
+void TemplateSpikeSorter::setSnippetSize( double stepsize )
+{
+  StepSize = stepsize;
+  if ( StepSize <= 0.0 )
+    return;
+  NBefore = (int)::ceil( Before/StepSize );
+  NAfter = (int)::ceil( After/StepSize );
+  NDead = (int)::ceil( DeadTime/StepSize );
+  if ( NDead < 1 )
+    NDead = 1;
+  Length = NBefore + 1 + NAfter;
+  Stride = ( ( Length + 3 )/4 )*4;
+  Dim = NChannels*Stride;
+  Snippet.assign( Dim, 0.0f );
+  SnippetNorms.assign( NChannels, 0.0 );
+}
+
+
+template < typename D >
+int TemplateSpikeSorter::nextSpike( const D &data, const vector< float > &baselines,
+				    const vector< float > &thresholds,
+				    int &index, int end ) const
+{
+  for ( ; index < end; index++ ) {
+    // threshold crossing on any channel?
+    int c = 0;
+    for ( c=0; c<NChannels; c++ ) {
+      if ( Sign*( data[c][index] - baselines[c] ) > thresholds[c] &&
+	   Sign*( data[c][index-1] - baselines[c] ) <= thresholds[c] )
+	break;
+    }
+    if ( c >= NChannels )
+      continue;
+
+    // align to largest excursion on any channel:
+    int peak = index;
+    float max = Sign*( data[c][index] - baselines[c] );
+    for ( int j=index; j<=index+NBefore; j++ ) {
+      for ( int k=0; k<NChannels; k++ ) {
+	float v = Sign*( data[k][j] - baselines[k] );
+	if ( v > max ) {
+	  max = v;
+	  peak = j;
+	}
+      }
+    }
+    index = peak + NDead;
+    return peak;
+  }
+  return -1;
+}
+
+
+template < typename D >
+void TemplateSpikeSorter::extract( const D &data, const vector< float > &baselines,
+				   int peak, float *snippet ) const
+{
+  float *sp = snippet;
+  for ( int c=0; c<NChannels; c++ ) {
+    for ( int j=peak-NBefore; j<=peak+NAfter; j++ )
+      *sp++ = data[c][j] - baselines[c];
+    for ( int j=Length; j<Stride; j++ )
+      *sp++ = 0.0f;
+  }
+}
+
+
+int TemplateSpikeSorter::classify( const float *snippet, double &residual ) const
+{
+  int best = -1;
+  residual = HUGE_VAL;
+  for ( int c=0; c<NChannels; c++ )
+    SnippetNorms[c] = dot( snippet + c*Stride, snippet + c*Stride, Stride );
+  for ( int k=0; k<NUnits; k++ ) {
+    // squared distance on the channels of the template:
+    const float *tp = &Templates[k*Dim];
+    double d = 0.0;
+    double norm = 0.0;
+    for ( unsigned int i=0; i<Channels[k].size(); i++ ) {
+      int c = Channels[k][i];
+      d += SnippetNorms[c] - 2.0*dot( snippet + c*Stride, tp + c*Stride, Stride )
+	+ Norms[k*NChannels+c];
+      norm += Norms[k*NChannels+c];
+    }
+    double r = d / norm;
+    if ( r < residual ) {
+      residual = r;
+      best = k;
+    }
+  }
+  return best;
+}
+
+
+void TemplateSpikeSorter::autoConfigure( void )
+{
+  if ( Data == 0 )
+    return;
+  lock();
+  double tend = (*Data)[0].currentTime();
+  autoConfigure( *Data, tend - LearnTime, tend );
+  unlock();
+}
+
+
+int TemplateSpikeSorter::autoConfigure( const InList &data,
+					double tbegin, double tend )
+{
+  if ( Data == 0 || StepSize <= 0.0 || data.size() != NChannels )
+    return 0;
+  if ( Learner->isRunning() || Learned )
+    return -1;
+
+  // data range:
+  int i0 = data[0].index( tbegin );
+  int i1 = data[0].index( tend );
+  for ( int c=0; c<NChannels; c++ ) {
+    if ( i0 < data[c].minIndex() + NBefore + 1 )
+      i0 = data[c].minIndex() + NBefore + 1;
+    if ( i1 > data[c].size() - 2*NBefore - NAfter - 1 )
+      i1 = data[c].size() - 2*NBefore - NAfter - 1;
+  }
+  if ( i1 - i0 < 10*Length )
+    return -1;
+
+  // copy the data including the margins needed by nextSpike() and extract():
+  int j0 = i0 - NBefore - 1;
+  int j1 = i1 + 2*NBefore + NAfter + 1;
+  LearnData.resize( NChannels );
+  for ( int c=0; c<NChannels; c++ ) {
+    LearnData[c].resize( j1 - j0 );
+    for ( int i=j0; i<j1; ) {
+      int n = 0;
+      const float *buf = data[c].readBuffer( i, n );
+      if ( n <= 0 )
+	break;
+      if ( n > j1 - i )
+	n = j1 - i;
+      memcpy( &LearnData[c][i-j0], buf, n*sizeof( float ) );
+      i += n;
+    }
+  }
+  LearnBegin = i0 - j0;
+  LearnEnd = i1 - j0;
+
+  Learner->start();
+  return 0;
+}
+
+
+void TemplateSpikeSorter::learn( void )
+{
+  const vector< vector< float > > &data = LearnData;
+  int i0 = LearnBegin;
+  int i1 = LearnEnd;
+
+  // baselines, noise levels, and thresholds:
+  LearnBaselines.assign( NChannels, 0.0f );
+  LearnThresholds.assign( NChannels, HUGE_VALF );
+  vector< float > buffer( i1 - i0 );
+  for ( int c=0; c<NChannels; c++ ) {
+    double mean = 0.0;
+    for ( int i=i0; i<i1; i++ )
+      mean += data[c][i];
+    mean /= i1 - i0;
+    LearnBaselines[c] = mean;
+    for ( int i=i0; i<i1; i++ )
+      buffer[i-i0] = ::fabs( data[c][i] - mean );
+    int m = buffer.size()/2;
+    nth_element( buffer.begin(), buffer.begin() + m, buffer.end() );
+    LearnThresholds[c] = ThreshFac * buffer[m] / 0.6745;
+  }
+
+  // collect waveforms:
+  const int maxsnippets = 10000;
+  vector< float > snippets;
+  int n = 0;
+  for ( int index=i0; n < maxsnippets; n++ ) {
+    int peak = nextSpike( data, LearnBaselines, LearnThresholds, index, i1 );
+    if ( peak < 0 )
+      break;
+    snippets.resize( (n+1)*Dim );
+    extract( data, LearnBaselines, peak, &snippets[n*Dim] );
+  }
+
+  // k-means clustering, initialized by successively splitting the
+  // cluster with the largest variance along its first principal component:
+  int nunits = 1;
+  vector< float > centers( Dim, 0.0f );
+  vector< int > units( n, -1 );
+  vector< int > counts( 1, 0 );
+  kMeans( snippets, n, Dim, nunits, centers, units, counts, AbortLearning );
+  vector< double > dev( Dim );
+  vector< double > pc( Dim );
+  vector< double > pcn( Dim );
+  while ( nunits < MaxNUnits && ! AbortLearning ) {
+    // cluster with largest sum of squared deviations:
+    vector< double > var( nunits, 0.0 );
+    for ( int i=0; i<n; i++ ) {
+      const float *sp = &snippets[i*Dim];
+      const float *cp = &centers[units[i]*Dim];
+      var[units[i]] += dot( sp, sp, Dim ) - 2.0*dot( sp, cp, Dim ) + dot( cp, cp, Dim );
+    }
+    int split = -1;
+    for ( int k=0; k<nunits; k++ ) {
+      if ( counts[k] >= 2*MinSpikes && ( split < 0 || var[k] > var[split] ) )
+	split = k;
+    }
+    if ( split < 0 )
+      break;
+    // first principal component by power iteration:
+    float *cp = &centers[split*Dim];
+    for ( int j=0; j<Dim; j++ )
+      pc[j] = 1.0;
+    double lambda = 0.0;
+    for ( int iter=0; iter<10; iter++ ) {
+      for ( int j=0; j<Dim; j++ )
+	pcn[j] = 0.0;
+      lambda = 0.0;
+      for ( int i=0; i<n; i++ ) {
+	if ( units[i] != split )
+	  continue;
+	const float *sp = &snippets[i*Dim];
+	double p = 0.0;
+	for ( int j=0; j<Dim; j++ ) {
+	  dev[j] = sp[j] - cp[j];
+	  p += dev[j]*pc[j];
+	}
+	lambda += p*p;
+	for ( int j=0; j<Dim; j++ )
+	  pcn[j] += p*dev[j];
+      }
+      double norm = 0.0;
+      for ( int j=0; j<Dim; j++ )
+	norm += pcn[j]*pcn[j];
+      norm = ::sqrt( norm );
+      if ( norm <= 0.0 )
+	break;
+      for ( int j=0; j<Dim; j++ )
+	pc[j] = pcn[j]/norm;
+    }
+    // split the cluster:
+    double delta = 0.5*::sqrt( lambda/counts[split] );
+    centers.resize( (nunits+1)*Dim );
+    cp = &centers[split*Dim];
+    float *np = &centers[nunits*Dim];
+    for ( int j=0; j<Dim; j++ ) {
+      np[j] = cp[j] + delta*pc[j];
+      cp[j] -= delta*pc[j];
+    }
+    nunits++;
+    kMeans( snippets, n, Dim, nunits, centers, units, counts, AbortLearning );
+  }
+  if ( AbortLearning )
+    return;
+
+  // keep large clusters sorted by amplitude:
+  vector< pair< float, int > > amplitudes;
+  for ( int k=0; k<nunits; k++ ) {
+    if ( counts[k] < MinSpikes )
+      continue;
+    float max = 0.0;
+    for ( int c=0; c<NChannels; c++ ) {
+      float v = Sign*centers[k*Dim+c*Stride+NBefore];
+      if ( v > max )
+	max = v;
+    }
+    amplitudes.push_back( pair< float, int >( -max, k ) );
+  }
+  sort( amplitudes.begin(), amplitudes.end() );
+  LearnNUnits = amplitudes.size();
+  LearnTemplates.resize( LearnNUnits*Dim );
+  LearnNorms.resize( LearnNUnits*NChannels );
+  LearnPeakChannels.resize( LearnNUnits );
+  LearnChannels.resize( LearnNUnits );
+  for ( int u=0; u<LearnNUnits; u++ ) {
+    int k = amplitudes[u].second;
+    const float *tp = &centers[k*Dim];
+    std::copy( tp, tp + Dim, &LearnTemplates[u*Dim] );
+    LearnPeakChannels[u] = 0;
+    float max = -HUGE_VALF;
+    LearnChannels[u].clear();
+    for ( int c=0; c<NChannels; c++ ) {
+      LearnNorms[u*NChannels+c] = dot( tp + c*Stride, tp + c*Stride, Stride );
+      float v = Sign*tp[c*Stride+NBefore];
+      if ( v > max ) {
+	max = v;
+	LearnPeakChannels[u] = c;
+      }
+      // channels where the template exceeds half the threshold:
+      for ( int j=0; j<Length; j++ ) {
+	if ( ::fabs( tp[c*Stride+j] ) > 0.5*LearnThresholds[c] ) {
+	  LearnChannels[u].push_back( c );
+	  break;
+	}
+      }
+    }
+    if ( LearnChannels[u].empty() )
+      LearnChannels[u].push_back( LearnPeakChannels[u] );
+  }
+
+  Learned = true;
+}
+
+
+void TemplateSpikeSorter::stopLearning( void )
+{
+  AbortLearning = true;
+  Learner->wait();
+  AbortLearning = false;
+  Learned = false;
+}
+
+
+void TemplateSpikeSorter::installTemplates( void )
+{
+  Baselines.swap( LearnBaselines );
+  Thresholds.swap( LearnThresholds );
+  NUnits = LearnNUnits;
+  Templates.swap( LearnTemplates );
+  Norms.swap( LearnNorms );
+  Channels.swap( LearnChannels );
+  PeakChannels.swap( LearnPeakChannels );
+  Learned = false;
+
+  unsetNotify();
+  setInteger( "units", NUnits );
+  setNotify();
+  postCustomEvent( 13 );
+}
+
+
+int TemplateSpikeSorter::detect( const InList &data, EventList &outevents,
+				 const EventList &other, const EventData &stimuli )
+{
+  if ( StepSize <= 0.0 )
+    return 0;
+
+  // range of data to be analyzed:
+  int end = data[0].size();
+  int first = data[0].minIndex();
+  for ( int c=1; c<NChannels; c++ ) {
+    if ( end > data[c].size() )
+      end = data[c].size();
+    if ( first < data[c].minIndex() )
+      first = data[c].minIndex();
+  }
+  end -= NBefore + NAfter + 1;
+
+  // learn templates:
+  if ( Learned )
+    installTemplates();
+  if ( StartTime < 0.0 )
+    StartTime = data[0].currentTime();
+  if ( NUnits == 0 ) {
+    // start sorting with the data recorded after the templates are learned:
+    NextIndex = end;
+    if ( data[0].currentTime() >= StartTime + LearnTime ) {
+      autoConfigure( data, data[0].currentTime() - LearnTime, data[0].currentTime() );
+      StartTime = data[0].currentTime();
+    }
+    return 0;
+  }
+  if ( NextIndex < first + NBefore + 1 )
+    NextIndex = first + NBefore + 1;
+
+  // detect and sort spikes:
+  for ( ; ; ) {
+    int peak = nextSpike( data, Baselines, Thresholds, NextIndex, end );
+    if ( peak < 0 )
+      break;
+    extract( data, Baselines, peak, &Snippet[0] );
+    double residual = 0.0;
+    int unit = classify( &Snippet[0], residual );
+    if ( unit >= 0 && residual <= MaxResidual ) {
+      double size = ::fabs( Snippet[PeakChannels[unit]*Stride+NBefore] );
+      outevents[unit].push( data[0].pos( peak ), size, residual );
+    }
+  }
+
+  double rate = 0.0;
+  for ( int k=0; k<NUnits; k++ )
+    rate += outevents[k].meanRate();
+  unsetNotify();
+  setNumber( "rate", rate );
+  setNotify();
+
+  return 0;
+}
+
+
+void TemplateSpikeSorter::plotTemplates( void )
+{
+  int colors[MaxUnits] = { Plot::Red, Plot::Yellow, Plot::Green, Plot::Cyan,
+			   Plot::Magenta, Plot::Orange, Plot::Blue, Plot::White };
+  lock();
+  TP->lock();
+  TP->clear();
+  double width = 1000.0*StepSize*Length;
+  TP->setXRange( -1000.0*StepSize*NBefore, NChannels*width - 1000.0*StepSize*NBefore );
+  for ( int c=1; c<NChannels; c++ )
+    TP->plotVLine( c*width - 1000.0*StepSize*NBefore, Plot::White, 1 );
+  for ( int k=0; k<NUnits; k++ ) {
+    SampleDataF wave( NChannels*Length, -StepSize*NBefore, StepSize );
+    for ( int c=0; c<NChannels; c++ ) {
+      for ( int j=0; j<Length; j++ )
+	wave[c*Length+j] = Templates[k*Dim+c*Stride+j];
+    }
+    TP->plot( wave, 1000.0, colors[k], 2, Plot::Solid );
+  }
+  TP->draw();
+  TP->unlock();
+  unlock();
+}
+
+
+void TemplateSpikeSorter::customEvent( QEvent *qce )
+{
+  if ( qce->type() == QEvent::User+13 ) {
+    plotTemplates();
+    SDW.updateValues( OptWidget::changedFlag() );
+  }
+  else
+    Filter::customEvent( qce );
+}
+
+
+TemplateLearner::TemplateLearner( TemplateSpikeSorter *tss )
+  : QThread( tss ),
+    TSS( tss )
+{
+}
+
+
+void TemplateLearner::run( void )
+{
+  TSS->learn();
+}
+
+
+addDetector( TemplateSpikeSorter, multielectrode );
+
+}; /* namespace multielectrode */
+
+#include "moc_templatespikesorter.cc"
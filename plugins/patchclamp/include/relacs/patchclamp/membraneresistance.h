@@ -25,6 +25,7 @@
 #include <deque>
 #include <vector>
 #include <relacs/sampledata.h>
+#include <relacs/fitalgorithm.h>
 #include <relacs/plot.h>
 #include <relacs/repro.h>
 #include <relacs/ephys/traces.h>
@@ -110,6 +111,7 @@ protected:
   double TauMOff;
   SampleDataF ExpOn;
   SampleDataF ExpOff;
+  MarquardtWorkspace FitWork;
   int Count;
   vector< string > CheckOutParams;
 
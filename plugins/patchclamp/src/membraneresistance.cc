@@ -313,11 +313,11 @@ void MembraneResistance::analyzeOn( double duration,
     inxon1 = MeanVoltage.index( duration );
   }
   ArrayD u( 3, 1.0 );
-  double ch = 0.0;
+  MarquardtStats stats;
   marquardtFit( MeanVoltage.range().begin()+inxon0, MeanVoltage.range().begin()+inxon1,
 		MeanVoltage.begin()+inxon0, MeanVoltage.begin()+inxon1,
 		StdevVoltage.begin()+inxon0, StdevVoltage.begin()+inxon1,
-		expFuncDerivs, p, pi, u, ch );
+		expFuncJacobian, p, pi, u, FitWork, stats );
   TauMOn = -1000.0*p[1];
   if ( TauMOn <= 0.0 && TauMOn > 1.0e5 )
     TauMOn = 0.0;
@@ -359,13 +359,13 @@ void MembraneResistance::analyzeOff( double duration,
     inxon1 = MeanVoltage.index( duration );
   }
   ArrayD u( 3, 1.0 );
-  double ch = 0.0;
+  MarquardtStats stats;
   if ( inxoff1 > MeanVoltage.size() )
     inxoff1 = MeanVoltage.size();
   marquardtFit( MeanVoltage.range().begin()+inxon0, MeanVoltage.range().begin()+inxon1,
 		MeanVoltage.begin()+inxoff0, MeanVoltage.begin()+inxoff1,
 		StdevVoltage.begin()+inxoff0, StdevVoltage.begin()+inxoff1,
-		expFuncDerivs, p, pi, u, ch );
+		expFuncJacobian, p, pi, u, FitWork, stats );
   TauMOff = -1000.0*p[1];
   if ( TauMOff <= 0.0 && TauMOff > 1.0e5 )
     TauMOff = 0.0;
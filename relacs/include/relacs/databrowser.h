@@ -79,6 +79,10 @@ private:
 \class DataOverviewModel
 \brief The model for viewing an overview of the data of an DataIndex.
 \author Jan Benda
+
+The internal pointer of a QModelIndex is the DataIndex::DataItem
+that is the parent of the indexed item. Children are exposed to the
+view in pages of PageSize rows via canFetchMore() and fetchMore().
 */
 
 
@@ -105,11 +109,14 @@ public:
   int columnCount( const QModelIndex &parent = QModelIndex() ) const;
   bool canFetchMore( const QModelIndex &parent ) const;
   void fetchMore( const QModelIndex &parent );
+    /*! Expose \a n more children of \a parent to the view. */
+  void fetchChildren( DataIndex::DataItem *parent, int n );
   void beginAddChild( DataIndex::DataItem *parent );
   void endAddChild( DataIndex::DataItem *parent );
-  void endAddChild( void );
   void beginPopChild( DataIndex::DataItem *parent );
   void endPopChild( DataIndex::DataItem *parent );
+  void beginResetCells( void );
+  void endResetCells( void );
 
 
 public slots:
@@ -125,6 +132,14 @@ private slots:
 
 private:
 
+    /*! \return the item \a index refers to, 0 for stimuli. */
+  DataIndex::DataItem *item( const QModelIndex &index ) const;
+    /*! \return the model index of \a item. */
+  QModelIndex modelIndex( DataIndex::DataItem *item ) const;
+
+    /*! The number of children exposed by a single fetchMore(). */
+  static const int PageSize = 200;
+
   DataIndex *Data;
   QTreeView *View;
   DataBrowser *Browser;
@@ -23,6 +23,8 @@
 #define _RELACS_DATAINDEX_H_ 1
 
 #include <deque>
+#include <vector>
+#include <map>
 #include <string>
 #include <QTreeView>
 #include <QAbstractItemModel>
@@ -45,6 +47,21 @@ namespace relacs {
 \author Jan Benda
 
 This is the data model used by the DataBrowser class.
+
+The index is a tree of recording sessions (cells, level 1), the
+RePros that have been run during a session (level 2), and the
+stimuli put out by each RePro (level 3). Cells and RePros are
+DataItems, whereas the stimuli of a cell are stored in flat arrays
+of the cell. Names of RePros and stimuli are interned.
+
+Sessions found by loadDirectory() are indexed lazily: the header of
+a stimuli.dat file is read only when it is needed, and the RePros
+and stimuli of a cell only when the cell is expanded in the
+DataOverviewModel. The descriptions (Options) of cells, RePros, and
+stimuli are materialized from stimuli.dat and
+stimulus-descriptions.dat only when they are requested by data().
+The DataOverviewModel exposes the children of an item page by page
+via fetchMore().
 */
 
 
@@ -54,65 +71,128 @@ class DataIndex
 public:
 
 
+    /*! A recording session, a RePro, or the root of the index.
+        The children of a session are RePros, the children of a RePro
+        are the stimuli of the session. Functions taking a \a row
+        refer to the respective child. */
   class DataItem
   {
 
   public:
 
-    DataItem( void );
-    DataItem( const DataItem &data );
-    DataItem( const string &name );
-    DataItem( const string &name, int level, DataItem *parent );
-    DataItem( const string &name, const Options &data,
-	      int level, DataItem *parent );
-    DataItem( const string &name, const Options &data,
-	      int ntraces, int nevents,
-	      int level, DataItem *parent );
-    DataItem( const string &name, const Options &data,
-	      const deque<int> &traceindex, const deque<int> &eventsindex,
-	      double time, int level, DataItem *parent );
+    DataItem( const string &name, int level, DataItem *parent, DataIndex *index );
+    ~DataItem( void );
+
+      /*! \return \c true if the item does not have any children. */
     bool empty( void ) const;
+      /*! \return the number of children of the item. */
     int size( void ) const;
+      /*! \return the number of children exposed by the DataOverviewModel. */
+    int fetched( void ) const;
+      /*! Set the number of children exposed by the DataOverviewModel to \a n. */
+    void setFetched( int n );
+      /*! \return \c true if more children can be exposed
+          or if the index of a cell still needs to be loaded. */
+    bool canFetchMore( void ) const;
+      /*! Remove all children. */
     void clear( void );
+      /*! \return the last child item. */
     DataItem &back( void );
+      /*! Remove the last child. */
     void pop( void );
-    const DataItem &operator[]( int index ) const;
-    DataItem &operator[]( int index );
-    int index( DataItem *data );
+      /*! \return the row of the item within its parent. */
+    int row( void ) const;
+      /*! \return the child item at \a index, or 0 for stimuli. */
     DataItem *child( int index );
     DataItem *parent( void ) const;
-    void addChild( const string &name );
     void addChild( const string &name, const Options &data );
     void addChild( const string &name, const Options &data, int ntraces, int nevents );
-    void addChild( const string &name, const Options &data,
-		   const deque<int> &traceindex, const deque<int> &eventsindex,
-		   double time );
+      /*! Add a cell whose index is read lazily from the stimuli.dat \a file.
+          The DataOverviewModel is not notified. */
+    void addCell( const string &file );
+    void addStimulus( const Options &data, const deque<int> &traceindex,
+		      const deque<int> &eventsindex, double time );
+      /*! Read the RePros and stimuli of a cell from its stimuli.dat file. */
     void loadCell( void );
+      /*! \return \c true if the RePros and stimuli of a cell are known. */
+    bool loaded( void ) const;
     int level( void ) const;
     void setName( const string &name );
     string name( void ) const;
-    const Options &data( void ) const;
+      /*! The description of the item. Materialized on first request. */
     Options &data( void );
     string fileName( void ) const;
     deque<int> traceIndex( void ) const;
     deque<int> eventsIndex( void ) const;
     double time( void ) const;
-    DataOverviewModel *overviewModel( void );
-    void setOverviewModel( DataOverviewModel *model );
+
+      /*! \return the name of the child in \a row. */
+    string name( int row ) const;
+      /*! \return the description of the child in \a row. */
+    Options &data( int row );
+    deque<int> traceIndex( int row ) const;
+    deque<int> eventsIndex( int row ) const;
+    double time( int row ) const;
+
     void print( void );
 
 
   protected:
 
+      /*! Read the meta data from the header of the cell's file. */
+    void loadHeader( void ) const;
+      /*! Add \a item as the last child and notify the DataOverviewModel. */
+    void append( DataItem *item );
+      /*! \return the description of the stimulus with index \a stimulus
+          of the cell. */
+    Options &stimulus( int stimulus );
+      /*! \return the content of the cell's stimulus-descriptions.dat file. */
+    const Options &signalDescriptions( void );
+      /*! \return the index of the stimulus description of the cell
+          that consists of the tab-separated \a signalnames. */
+    int description( const string &signalnames );
+      /*! Append the trace and event indices of a stimulus to the cell. */
+    void addIndices( const deque<int> &traceindex, const deque<int> &eventsindex );
+
     int Level;
-    string Name;
-    Options Data;
-    deque<int> TraceIndex;
-    deque<int> EventsIndex;
-    double Time;
-    deque<DataItem> Children;
+    int Row;
+    int Name;
     DataItem *Parent;
-    DataOverviewModel *OverviewModel;
+    DataIndex *Index;
+    vector< DataItem* > Children;
+    int Fetched;
+    mutable Options *Data;
+
+      /*! Offset of the meta data of a RePro in stimuli.dat, -1 if recorded live. */
+    long Offset;
+      /*! Index of the first stimulus of a RePro in the stimulus arrays of the cell. */
+    int First;
+      /*! Number of stimuli of a RePro. */
+    int Stimuli;
+
+      /*! \c true if the RePros and stimuli of a cell are indexed. */
+    bool Loaded;
+    mutable bool HeaderLoaded;
+    mutable int NTraces;
+    mutable int NEvents;
+      /*! For each stimulus of a cell the index into the stimulus descriptions. */
+    vector< int > StimulusDescriptions;
+      /*! For each stimulus of a cell its time. */
+    vector< double > StimulusTimes;
+      /*! For each stimulus of a cell NTraces trace indices followed by NEvents event indices. */
+    vector< int > StimulusIndices;
+      /*! The different stimulus descriptions of a cell,
+          0 if not materialized yet. */
+    deque< Options* > Descriptions;
+      /*! Interned names of the stimulus descriptions. */
+    vector< int > DescriptionNames;
+      /*! Signal names of stimulus descriptions read from a file, separated by tabs. */
+    deque< string > DescriptionKeys;
+      /*! Maps signal names or the saved stimulus descriptions to Descriptions. */
+    map< string, int > DescriptionIndex;
+      /*! The content of stimulus-descriptions.dat, loaded on first request. */
+    Options *SignalDescriptions;
+
   };
 
 
@@ -146,6 +226,14 @@ public:
 
 private:
 
+    /*! \return the id of the interned string \a s. */
+  int intern( const string &s );
+    /*! \return the interned string with \a id. */
+  const string &interned( int id ) const;
+
+  deque< string > Strings;
+  map< string, int > StringIds;
+
   DataItem Cells;
   bool Session;
 
@@ -27,6 +27,7 @@
 #include <relacs/str.h>
 #include <relacs/configclass.h>
 #include <relacs/relacsplugin.h>
+#include <relacs/deviceopener.h>
 using namespace std;
 
 namespace relacs {
@@ -76,12 +77,30 @@ public:
     /*! Add Device \a d to the list and to the device list \a devices. */
   template < class DD >
   void add( T *d, DD &devices );
+    /*! Remove device \a d from the list and from the device list \a devices
+        without deleting it. */
+  template < class DD >
+  void remove( T *d, DD &devices );
     /*! Move device \a d and its menu entry to the back of the list. */
   void swapBack( T *d );
 
-    /*! Create \a devices from plugins. */
+    /*! Create \a devices from plugins and open them.
+        Same as prepare() followed by DeviceOpener::open() and finish(). */
   template < class DD >
     int create( DD &devices, int n, const string &dflt="0" );
+    /*! Create \a devices from plugins and add them to \a opener
+        for being opened. Devices that are still being opened by
+	\a opener from a previous call are skipped. */
+  template < class DD >
+    void prepare( DD &devices, int n, const string &dflt,
+		  DeviceOpener &opener );
+    /*! Collect the results of opening the devices of the last call
+        of prepare() from \a opener. Devices that timed out are removed
+        from the list and from \a devices and are handed over to
+        \a opener, since they are still being opened.
+        \return the number of successfully opened devices. */
+  template < class DD >
+    int finish( DD &devices, DeviceOpener &opener );
     /*! Returns the warning messages of the last call of create(). */
   Str warnings( void ) const;
     /*! Returns the error messages of the last call of create(). */
@@ -128,6 +147,17 @@ protected:
     /*! Error messages. */
   string Errors;
 
+    /*! A device that is being opened by a DeviceOpener. */
+  struct PendingDevice
+  {
+    T *Dev;
+    string Plugin;
+    string DeviceFile;
+    int Job;
+  };
+    /*! The devices of the last call of prepare(). */
+  deque < PendingDevice > Pending;
+
 };
 
 
@@ -244,6 +274,23 @@ void DeviceList<T,PluginID>::add( T *d, DD &devices )
 }
 
 
+template < class T, int PluginID > template < class DD >
+void DeviceList<T,PluginID>::remove( T *d, DD &devices )
+{
+  for ( unsigned int k=0; k<DVs.size(); k++ ) {
+    if ( DVs[k] == d ) {
+      DVs.erase( DVs.begin() + k );
+      if ( Menus[k] != 0 )
+	delete Menus[k];
+      Menus.erase( Menus.begin() + k );
+      break;
+    }
+  }
+  if ( (void *)&devices != (void *)this )
+    devices.remove( d, devices );
+}
+
+
 template < class T, int PluginID >
 void DeviceList<T,PluginID>::swapBack( T *d )
 {
@@ -262,11 +309,22 @@ void DeviceList<T,PluginID>::swapBack( T *d )
 
 template < class T, int PluginID > template < class DD >
 int DeviceList<T,PluginID>::create( DD &devices, int m, const string &dflt )
+{
+  DeviceOpener opener;
+  prepare( devices, m, dflt, opener );
+  opener.open();
+  return finish( devices, opener );
+}
+
+
+template < class T, int PluginID > template < class DD >
+void DeviceList<T,PluginID>::prepare( DD &devices, int m, const string &dflt,
+				      DeviceOpener &opener )
 {
   Warnings = "";
   Errors = "";
+  Pending.clear();
 
-  int n = 0;
   int failed = 0;
   bool taken = false;
   for ( int j=1; failed<=5; j++ ) {
@@ -332,6 +390,11 @@ int DeviceList<T,PluginID>::create( DD &devices, int m, const string &dflt )
     }
     if ( alreadyopen )
       continue;
+    if ( opener.opening( ident ) ) {
+      Warnings += Name + " plugin <b>" + ms + "</b> with identifier <b>"
+	+ ident + "</b> is still being opened.\n";
+      continue;
+    }
 
     // create plugin:
     void *mp = 0;
@@ -358,15 +421,45 @@ int DeviceList<T,PluginID>::create( DD &devices, int m, const string &dflt )
     }
     // open device:
     Str ds = deviceopts->text( "device" );
-    int ern = 0;
     dv->Options::read( *deviceopts );
     dv->clearError();
     Device *d = devices.device( ds );
-    if ( d != 0 )
-      ern = dv->open( *d );
-    else if ( ! ds.empty() )
-      ern = dv->open( ds );
-    if ( dv->isOpen() ) {
+    PendingDevice pd;
+    pd.Dev = dv;
+    pd.Plugin = ms;
+    pd.DeviceFile = ds;
+    pd.Job = opener.add( dv, ds, d );
+    Pending.push_back( pd );
+  }
+}
+
+
+template < class T, int PluginID > template < class DD >
+int DeviceList<T,PluginID>::finish( DD &devices, DeviceOpener &opener )
+{
+  int n = 0;
+  for ( unsigned int k=0; k<Pending.size(); k++ ) {
+    T *dv = Pending[k].Dev;
+    const string &ms = Pending[k].Plugin;
+    const string &ds = Pending[k].DeviceFile;
+    string ident = dv->deviceIdent();
+    int ern = opener.error( Pending[k].Job );
+    if ( opener.timedOut( Pending[k].Job ) ) {
+      Errors += "Opening " + Name + " plugin <b>" + ms
+	+ "</b> with identifier <b>" + ident + "</b>";
+      if ( ! ds.empty() )
+	Errors += " on device <b>" + ds + "</b>";
+      if ( opener.started( Pending[k].Job ) ) {
+	Errors += " timed out after "
+	  + Str( opener.time( Pending[k].Job ), 0, 1, 'f' ) + "s !\n";
+	// the device is still being opened, keep it away from anybody else:
+	remove( dv, devices );
+	opener.adopt( Pending[k].Job );
+      }
+      else
+	Errors += " failed, because its device did not respond !\n";
+    }
+    else if ( dv->isOpen() ) {
       string es = dv->errorStr();
       if ( ! es.empty() ) {
 	Warnings += "Opening " + Name + " plugin <b>" + ms
@@ -0,0 +1,166 @@
+/*
+  deviceopener.h
+  Opens devices concurrently with per-device timeouts.
+
+  RELACS - Relaxed ELectrophysiological data Acquisition, Control, and Stimulation
+  Copyright (C) 2002-2015 Jan Benda <jan.benda@uni-tuebingen.de>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+  
+  RELACS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _RELACS_DEVICEOPENER_H_
+#define _RELACS_DEVICEOPENER_H_ 1
+
+#include <string>
+#include <vector>
+#include <QObject>
+#include <QString>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QTime>
+#include <relacs/device.h>
+using namespace std;
+
+namespace relacs {
+
+
+/*!
+\class DeviceOpener
+\brief Opens devices concurrently with per-device timeouts.
+\author Jan Benda
+
+Devices are added by add() together with the name of the device file
+or the device they have to be opened with. open() then opens all
+devices, each in its own thread. A device that is opened with
+another device waits until this device is opened.
+This way the time needed for opening all devices is bounded by the
+slowest device and not by the sum of all.
+
+If opening a device takes longer than timeout(), open() gives up on it.
+The thread opening the device keeps running in the background.
+opening() tells whether a device is still being opened this way.
+Such a device must not be used by anybody else. Hand it over by adopt().
+It is then closed and destroyed by the DeviceOpener as soon as
+its thread finishes, at the latest by wait() and the destructor.
+
+While waiting for the devices, open() regularly emits progress()
+and processes pending events, if it is called from the GUI thread.
+*/
+
+
+class DeviceOpener : public QObject
+{
+  Q_OBJECT
+
+public:
+
+    /*! Construct an empty DeviceOpener. */
+  DeviceOpener( void );
+    /*! Destructor. Waits for all devices that are still being opened. */
+  ~DeviceOpener( void );
+
+    /*! Add \a device that is opened with the device file \a devicefile,
+        or with the device \a dependency, if \a dependency is not null.
+        \return the index of the job. */
+  int add( Device *device, const string &devicefile, Device *dependency=0 );
+    /*! The number of jobs. */
+  int size( void ) const;
+    /*! Remove all jobs. */
+  void clear( void );
+
+    /*! \c true if the devices are opened concurrently (default).
+        Otherwise they are opened one after the other. */
+  bool parallel( void ) const;
+    /*! Open the devices concurrently if \a parallel is \c true. */
+  void setParallel( bool parallel );
+    /*! The maximum time in seconds a single device is waited for.
+        A timeout of zero or less disables timeouts. */
+  double timeout( void ) const;
+    /*! Set the maximum time a single device is waited for
+        to \a timeout seconds. */
+  void setTimeout( double timeout );
+
+    /*! Open all devices that have been added since the last call of clear().
+        Returns when all devices have been opened or timed out. */
+  void open( void );
+    /*! Wait for all devices that are still being opened in the background. */
+  void wait( void );
+    /*! \c true if a device with identifier \a ident
+        is still being opened in the background. */
+  bool opening( const string &ident ) const;
+    /*! Take over the device of job \a job that timed out.
+        The device is closed and destroyed as soon as
+        its thread finishes. */
+  void adopt( int job );
+
+    /*! The device of job \a job. */
+  Device *device( int job ) const;
+    /*! \c true if opening the device of job \a job was started. */
+  bool started( int job ) const;
+    /*! The return value of Device::open() of job \a job. */
+  int error( int job ) const;
+    /*! \c true if job \a job did not finish in time. */
+  bool timedOut( int job ) const;
+    /*! The time in seconds it took to open the device of job \a job. */
+  double time( int job ) const;
+
+
+signals:
+
+    /*! Reports the progress of open() in \a message. */
+  void progress( const QString &message );
+
+
+private:
+
+  class Job : public QThread
+  {
+  public:
+    Job( DeviceOpener *opener, Device *device, const string &devicefile,
+	 Device *dependency, int dependencyjob );
+    virtual void run( void );
+
+    DeviceOpener *Opener;
+    Device *Dev;
+    string Ident;
+    string DeviceFile;
+    Device *Dependency;
+    int DependencyJob;
+    bool Started;
+    bool Done;
+    bool TimedOut;
+    bool Owned;
+    int Error;
+    double Time;
+    QTime Timer;
+  };
+
+  void removeFinished( void );
+
+  bool Parallel;
+  double Timeout;
+  vector< Job* > Jobs;
+    /*! Timed out jobs of previous calls of open() that are still running. */
+  vector< Job* > Stray;
+  mutable QMutex Mutex;
+  QWaitCondition DoneWait;
+
+};
+
+
+}; /* namespace relacs */
+
+#endif /* ! _RELACS_DEVICEOPENER_H_ */
+
@@ -268,6 +268,8 @@ class FilterData : public QObject
   int LineWidth;
   bool Init;
   Options* GeneralOptions;
+    /*! Id of the filter or detector for the Profiler, -1 if not yet registered. */
+  int ProfileId;
 
 
 public slots:
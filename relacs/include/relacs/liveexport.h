@@ -0,0 +1,108 @@
+/*
+  liveexport.h
+  Exports input traces and events to POSIX shared memory
+
+  RELACS - Relaxed ELectrophysiological data Acquisition, Control, and Stimulation
+  Copyright (C) 2002-2015 Jan Benda <jan.benda@uni-tuebingen.de>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+  
+  RELACS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _RELACS_LIVEEXPORT_H_
+#define _RELACS_LIVEEXPORT_H_ 1
+
+#include <string>
+#include <vector>
+#include <relacs/relacsshm.h>
+#include <relacs/inlist.h>
+#include <relacs/eventlist.h>
+using namespace std;
+
+namespace relacs {
+
+
+/*!
+\class LiveExport
+\brief Exports input traces and events to POSIX shared memory
+\author Jan Benda
+
+LiveExport makes the acquired input traces and the detected events
+available to other processes while they are recorded. open() creates
+a POSIX shared memory segment with the layout described in relacsshm.h
+that holds for each trace and event trace a cyclic buffer of a given
+duration. update() is called from RELACSWidget::updateData() right
+after the traces and events have been updated and copies the new data
+elements into the segment.
+
+External programs attach to the segment with the reader functions
+declared in relacsshm.h (\c librelacsshm), without any further
+copying or polling of files. The writer never waits on readers:
+readers that are too slow detect that their data have been overwritten.
+*/
+
+class LiveExport
+{
+
+public:
+
+    /*! Constructs an inactive LiveExport. */
+  LiveExport( void );
+    /*! Closes the shared memory segment. */
+  ~LiveExport( void );
+
+    /*! Create the shared memory segment \a name
+        (e.g. "/relacs") for all input traces of \a data and all event
+        traces of \a events. The cyclic buffers in the segment
+        are large enough to hold \a duration seconds of data.
+        \return 0 on success, -1 if the segment could not be created.
+        \sa error() */
+  int open( const InList &data, const EventList &events,
+	    const string &name, double duration=10.0 );
+    /*! \return \c true if a shared memory segment is open. */
+  bool isOpen( void ) const;
+    /*! \return the name of the shared memory segment. */
+  string name( void ) const;
+    /*! \return a description of the last error. */
+  string error( void ) const;
+
+    /*! Copy all new data elements and events into the shared memory segment.
+        Needs to be called from the thread updating the traces and events. */
+  void update( void );
+
+    /*! Mark the segment as inactive, unmap and remove it. */
+  void close( void );
+
+
+private:
+
+  string Name;
+  string Error;
+  char *Segment;
+  size_t Size;
+  relacs_shm_header *Header;
+  relacs_shm_trace *Traces;
+  relacs_shm_events *Events;
+
+  const InList *IL;
+  const EventList *EL;
+  vector< int > TraceIndex;
+  vector< int > EventIndex;
+
+};
+
+
+}; /* namespace relacs */
+
+#endif /* ! _RELACS_LIVEEXPORT_H_ */
+
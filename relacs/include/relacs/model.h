@@ -230,7 +230,7 @@ private:
     {};
     double Onset;
     double Offset;
-    OutData Buffer;
+    mutable OutData Buffer;
     mutable double LastSignal;
     double ModelValue;
     bool Finished;
@@ -0,0 +1,151 @@
+/*
+  nixtracewriter.h
+  Gathers trace data into chunks and writes them to a NIX file in the background.
+
+  RELACS - Relaxed ELectrophysiological data Acquisition, Control, and Stimulation
+  Copyright (C) 2002-2015 Jan Benda <jan.benda@uni-tuebingen.de>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+  
+  RELACS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _RELACS_NIXTRACEWRITER_H_
+#define _RELACS_NIXTRACEWRITER_H_ 1
+
+#ifdef HAVE_NIX
+
+#include <deque>
+#include <vector>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <nix.hpp>
+
+using namespace std;
+
+namespace relacs {
+
+
+/*! 
+\class NixTraceWriter
+\brief Gathers trace data into chunks and writes them to a NIX file in the background.
+\author Jan Benda
+
+Appending each update of the recorded traces directly to a
+nix::DataArray results in many small extensions of the underlying HDF5
+data sets, and, if compression is enabled, in compressing the data
+right in the thread that handles the data acquisition.
+
+Instead, append() collects the data of each trace in a buffer of
+chunkSize() data elements. Only full chunks are handed over to a
+thread that extends the data array and writes the chunk. Since HDF5 is
+not thread safe, any other access to the NIX file has to be protected
+by locking mutex().
+
+Call flush() to write out the remaining partially filled chunks
+before closing the file.
+*/
+
+class NixTraceWriter : public QThread
+{
+
+public:
+
+    /*! Constructor. */
+  NixTraceWriter( void );
+    /*! Destructor. Stops the thread. */
+  ~NixTraceWriter( void );
+
+    /*! The number of data elements collected for a trace sampled
+        with \a samplerate before they are written.  This is roughly
+        one second of data, rounded to a power of two, and at most 128k
+        data elements.  The chunking of the HDF5 data set itself is
+        chosen by NIX. */
+  static size_t chunkSize( double samplerate );
+
+    /*! Add the data array \a data for a trace that is written in chunks
+        of \a chunksize data elements. \a data should be created
+        with an empty extent, it is extended by each written chunk.
+        \return the index of the trace for append(). */
+  int addTrace( const nix::DataArray &data, size_t chunksize );
+    /*! Remove all traces. Call flush() before. */
+  void clearTraces( void );
+    /*! The number of traces. */
+  int traces( void ) const;
+
+    /*! Append \a n data elements from \a data to trace \a trace.
+        If a chunk is full, it is handed over to the writing thread. */
+  void append( int trace, const float *data, size_t n );
+    /*! Hand over all partially filled chunks to the writing thread
+        and wait until all data are written. */
+  void flush( void );
+
+    /*! Start the writing thread. */
+  void start( void );
+    /*! Write all remaining data and stop the writing thread, if running. */
+  void stop( void );
+
+    /*! The mutex that needs to be locked for any access to the NIX file. */
+  QMutex *mutex( void );
+
+    /*! The number of data elements written to the file so far. */
+  size_t written( void ) const;
+    /*! The number of chunks that had to wait for the writing thread,
+        because the queue of chunks was full. */
+  int stalls( void ) const;
+
+
+protected:
+
+    /*! Writes the queued chunks to the NIX file. */
+  virtual void run( void );
+
+
+private:
+
+  struct Trace {
+    nix::DataArray Data;
+    size_t ChunkSize;
+    nix::NDSize Offset;
+    vector< float > Buffer;
+  };
+
+  struct Chunk {
+    nix::DataArray Data;
+    nix::NDSize Offset;
+    vector< float > Buffer;
+  };
+
+    /*! Put the buffer of \a trace into the queue. */
+  void queueChunk( Trace &trace );
+
+  vector< Trace > Traces;
+  deque< Chunk > Queue;
+  int MaxQueue;
+  bool Writing;
+  bool Stop;
+  size_t Written;
+  int Stalls;
+  mutable QMutex QueueMutex;
+  QWaitCondition QueueWait;
+  QWaitCondition DoneWait;
+  QMutex NixMutex;
+
+};
+
+
+}; /* namespace relacs */
+
+#endif /* HAVE_NIX */
+
+#endif /* ! _RELACS_NIXTRACEWRITER_H_ */
@@ -56,6 +56,16 @@ and than opened again.
 The number of library files in the list is returned by size(),
 the list can alos be empty().
 
+Instead of loading all libraries right away, scanPath() only adds
+the library files to the file list and records the plugins they
+contain in a manifest (see setManifest()). Only libraries that are
+not yet listed in the manifest or that have been modified since are
+loaded to obtain their plugins. Libraries are then loaded by
+openReferenced() if any of their plugins is mentioned in a
+configuration file, by openAll(), possibly restricted to libraries
+containing plugins of a given type, or lazily by index() when one of
+their plugins is first requested. Save the manifest with saveManifest().
+
 Each plugin has an identifier string ident(), an index(),
 a type(), and is contained by the library file with file id fileID().
 The type() of a plugin is used to group plugins of different type together,
@@ -159,6 +169,49 @@ public:
         \sa open(), openPath(), close(), erase(), clear(), reopen() */
   static int openFile( const string &file );
 
+    /*! Read the plugin manifest from file \a file.
+        The manifest caches for each library file its modification time,
+	its size, and the identifiers and types of the plugins it contains.
+	It is used by scanPath() to avoid loading libraries
+	and by index() to load the library of a requested plugin.
+	If \a file does not exist or was written by another version
+	of the Plugins class the manifest is empty.
+	\param[in] file the name of the manifest file.
+        \return the number of libraries listed in the manifest.
+        \sa saveManifest(), scanPath() */
+  static int setManifest( const string &file );
+    /*! Write the manifest to the file set by setManifest()
+        if it was changed.
+        \return the number of libraries written to the manifest
+	or -CantGetFiles if the file cannot be written.
+        \sa setManifest() */
+  static int saveManifest( void );
+    /*! Add all libraries specified by the path \a path
+        to the list of library files without loading them.
+	Only libraries that are not contained in the manifest
+	or that have changed since the manifest was written are loaded
+	in order to record their plugins in the manifest.
+	\a path, \a relativepath, and \a pluginhomes are interpreted
+	as in openPath().
+        \return the number of the successfully added libraries. 
+        \sa openReferenced(), openAll(), setManifest() */
+  static int scanPath( const string &path, const string &relativepath,
+		       const StrQueue &pluginhomes );
+    /*! Load all libraries of the file list containing
+        a plugin whose name (without the plugin set) appears
+	as a word in one of the files \a files.
+	\param[in] files the names of configuration files.
+        \return the number of loaded libraries.
+        \sa scanPath(), openAll() */
+  static int openReferenced( const StrQueue &files );
+    /*! Load all libraries of the file list that are not loaded yet.
+        \param[in] type if positive, load only libraries that according
+	to the manifest contain a plugin of this type.
+	Libraries not listed in the manifest are always loaded.
+        \return the number of loaded libraries.
+        \sa scanPath(), openReferenced() */
+  static int openAll( int type=0 );
+
     /*! Close library specified by its id \a id.
         The library is not removed from the list.
         You can open the library again with the open() functions.
@@ -253,6 +306,8 @@ public:
   static string first( int type=0 );
     /*! \return the index of a plugin which is specified by its 
         identifier string \a plugin and its type \a type.
+	If the plugin is not loaded yet, but is listed in the manifest
+	for a library of the file list, this library is loaded first.
         \a -InvalidPlugin is returned if the plugin was not found.
         \param[in] plugin the name of the plugin.
 	\param[in] type the type of the plugins. If negative,
@@ -394,6 +449,42 @@ private:
     /*! The list of libraries. */
   static FilesType Files;
 
+  struct ManifestInfo
+  {
+    ManifestInfo( const string &file, long mtime, long size );
+
+      /*! File name of the library. */  
+    string File;
+      /*! Modification time of the library file. */
+    long MTime;
+      /*! Size of the library file in bytes. */
+    long Size;
+      /*! Identifier strings of the plugins contained in the library. */
+    vector< string > Idents;
+      /*! Types of the plugins contained in the library. */
+    vector< int > Types;
+  };
+
+  typedef vector< ManifestInfo > ManifestType;
+    /*! The manifest of plugins contained in library files. */
+  static ManifestType Manifest;
+    /*! The file name of the manifest. */
+  static string ManifestFile;
+    /*! \c true if the manifest was modified since it was read. */
+  static bool ManifestChanged;
+
+    /*! Add the names of all library files matching \a path to \a files.
+        See openPath() for the interpretation of the arguments. */
+  static void libraryFiles( const string &path, const string &relativepath,
+			    const StrQueue &pluginhomes, StrQueue &files );
+    /*! \return the index of the up-to-date manifest entry
+        of library \a file, or -1. */
+  static int manifestIndex( const string &file );
+    /*! \return \c true if the identifier \a ident matches \a plugin,
+        i.e. they are equal, or \a plugin contains no plugin set
+	and matches \a ident without its plugin set. */
+  static bool match( const string &ident, const string &plugin );
+
     /*! Names of libraries which could not be loaded. */
   static string LibraryErrors;
     /*! Names of classes contained in loaded libraries which could not be loaded. */
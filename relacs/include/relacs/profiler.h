@@ -0,0 +1,156 @@
+/*
+  profiler.h
+  Low-overhead scoped timers for the data path
+
+  RELACS - Relaxed ELectrophysiological data Acquisition, Control, and Stimulation
+  Copyright (C) 2002-2015 Jan Benda <jan.benda@uni-tuebingen.de>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+  
+  RELACS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _RELACS_PROFILER_H_
+#define _RELACS_PROFILER_H_ 1
+
+#include <atomic>
+#include <string>
+#include <vector>
+using namespace std;
+
+namespace relacs {
+
+
+/*!
+\class Profiler
+\brief Low-overhead scoped timers for the data path
+\author Jan Benda
+
+The Profiler collects the durations of the code sections that
+process the acquired data in every update, like
+RELACSWidget::updateData(), each Filter of the FilterDetectors,
+SaveFiles::saveTraces(), Model::next(), and PlotTrace::plot().
+A code section is timed by a ProfileTimer that lives in the scope
+of the section:
+\code
+static const int profileid = Profiler::id( "MyRePro::analyze" );
+ProfileTimer profiletimer( profileid );
+\endcode
+
+Each thread writes its timings into its own cyclic buffer without
+any locking. Older timings get overwritten.
+statistics() summarizes the timings for each code section and
+saveChromeTrace() writes them as a trace that can be viewed with
+chrome://tracing or https://ui.perfetto.dev.
+
+As long as the Profiler is not enabled, a ProfileTimer costs
+a single load of an atomic flag.
+*/
+
+class Profiler
+{
+
+public:
+
+    /*! Summary of the timings of a single code section. */
+  struct Statistics
+  {
+      /*! The name of the code section. */
+    string Name;
+      /*! Number of timings. */
+    long Count;
+      /*! Sum of all durations in seconds. */
+    double Total;
+      /*! Mean duration in seconds. */
+    double Mean;
+      /*! Median of the durations in seconds. */
+    double Median;
+      /*! 99% quantile of the durations in seconds. */
+    double Quantile99;
+      /*! Maximum duration in seconds. */
+    double Max;
+  };
+
+    /*! \return \c true if timings are recorded. */
+  static inline bool enabled( void )
+    { return Enabled.load( memory_order_relaxed ); };
+    /*! Start (\a enable = \c true) or stop recording timings. */
+  static void setEnabled( bool enable );
+
+    /*! \return the id of the code section named \a name.
+        Registers the name if it is not known yet. */
+  static int id( const string &name );
+    /*! \return the name of the code section with id \a id. */
+  static string name( int id );
+
+    /*! \return the current time of the monotonic clock in nanoseconds. */
+  static long long now( void );
+    /*! Add the timing of the code section with id \a id
+        from \a start to \a end (both from now())
+        to the buffer of the calling thread. */
+  static void record( int id, long long start, long long end );
+
+    /*! Discard all timings recorded so far. */
+  static void clear( void );
+    /*! The statistics of all code sections with recorded timings
+        sorted by their total duration. */
+  static void statistics( vector< Statistics > &stats );
+    /*! The time span covered by the recorded timings in seconds. */
+  static double duration( void );
+    /*! Write all recorded timings in the JSON trace event format
+        of Chrome and Perfetto to \a file.
+        \return 0 on success, -1 if \a file could not be written. */
+  static int saveChromeTrace( const string &file );
+
+
+private:
+
+  class Buffer;
+  static Buffer *buffer( void );
+
+  static atomic< bool > Enabled;
+
+};
+
+
+/*!
+\class ProfileTimer
+\brief Records the time spent in the scope of the timer to the Profiler.
+\author Jan Benda
+*/
+
+class ProfileTimer
+{
+
+public:
+
+    /*! Start timing the code section with id \a id (see Profiler::id())
+        if the Profiler is enabled. */
+  ProfileTimer( int id )
+    : Id( id ), Start( Profiler::enabled() ? Profiler::now() : -1 ) {};
+    /*! Record the timing. */
+  ~ProfileTimer( void )
+    { if ( Start >= 0 ) Profiler::record( Id, Start, Profiler::now() ); };
+
+
+private:
+
+  int Id;
+  long long Start;
+
+};
+
+
+}; /* namespace relacs */
+
+#endif /* ! _RELACS_PROFILER_H_ */
+
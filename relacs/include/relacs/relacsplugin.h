@@ -493,6 +493,28 @@ int MyPlugin::main( void )
         \return \c 1 if the input traces contain the required data,
 	\c 0 if interrupted, or \c -1 on error. */
   int getData( double mintracetime=0.0, double prevsignal=-1000.0 );
+    /*! Block until the input traces contain data up to \a tracetime seconds
+        (absolute time as returned by currentTimeRaw()) or until \a timeout
+	seconds elapsed. Then make the data available via getData().
+	In contrast to waiting on each update of the data,
+	the calling thread is only woken up when data up to \a tracetime
+	are available, the analog output or the acquisition is stopped,
+	or RELACS is shutting down.
+	The plugin has to be locked, as it is within main() of a RePro
+	or a Control. The lock is released while waiting.
+	\return \c true if data up to \a tracetime are available.
+	\sa waitOnSignalTime() */
+  bool waitOnTraceTime( double tracetime, double timeout=MAXDOUBLE );
+    /*! Block until a signal was put out later than \a signaltime
+        or until \a timeout seconds elapsed.
+	Then make the data available via getData().
+	Like waitOnTraceTime(), the calling thread is only woken up
+	when a new signal is available, no signal is put out anymore,
+	or the acquisition is stopped.
+	The plugin has to be locked. The lock is released while waiting.
+	\return \c true if the time of the last signal,
+	signalTime(), is larger than \a signaltime. */
+  bool waitOnSignalTime( double signaltime, double timeout=MAXDOUBLE );
 
 
  protected:
@@ -0,0 +1,233 @@
+/*
+  relacsshm.h
+  Layout of and read access to traces and events exported by RELACS to shared memory
+
+  RELACS - Relaxed ELectrophysiological data Acquisition, Control, and Stimulation
+  Copyright (C) 2002-2015 Jan Benda <jan.benda@uni-tuebingen.de>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+  
+  RELACS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _RELACS_RELACSSHM_H_
+#define _RELACS_RELACSSHM_H_ 1
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+\file relacsshm.h
+\author Jan Benda
+\brief Layout of and read access to traces and events exported by RELACS to shared memory.
+
+RELACS (see LiveExport) can export the acquired input traces and the
+detected events into a POSIX shared memory segment (default name
+\c /relacs). The segment starts with a relacs_shm_header, followed by
+one relacs_shm_trace for each input trace and one relacs_shm_events
+for each event trace. The data are stored in cyclic buffers behind
+these descriptions: \c float for the traces and \c double for event
+times and event sizes.
+
+Each buffer is described by two counters that are incremented
+by the writer only. \a writing is the index up to which the writer is
+going to overwrite the buffer, \a written the index up to which data
+are valid. Data element \a i is at position \a i modulo \a capacity
+of the buffer and can be read as long as \a i is larger or equal to
+\a writing minus \a capacity. If the writer had to drop data
+elements, it advances \a writing beyond \a written, such that
+the stale elements in front of the new ones are no longer readable.
+
+The functions declared in this header implement a small reader library
+(\c librelacsshm) that can be used from C, C++, or via a foreign
+function interface from Python or Matlab.
+Any number of processes can attach read-only to the segment.
+relacs_shm_trace_buffer() returns pointers directly into the shared memory.
+Call relacs_shm_trace_valid() after processing the data
+to check whether they have been overwritten in the meantime.
+relacs_shm_read_trace() and relacs_shm_read_events() copy the data
+and perform this check for you.
+
+\code
+relacs_shm *shm = relacs_shm_open( "/relacs" );
+uint64_t index = relacs_shm_trace_index( shm, 0 );
+uint64_t updates = relacs_shm_updates( shm );
+float buffer[1000];
+while ( relacs_shm_wait( shm, updates, 1.0 ) >= 0 ) {
+  updates = relacs_shm_updates( shm );
+  long n = relacs_shm_read_trace( shm, 0, index, buffer, 1000 );
+  if ( n < 0 )
+    index = relacs_shm_trace_min_index( shm, 0 );  // we were too slow
+  else
+    index += n;
+}
+relacs_shm_close( shm );
+\endcode
+*/
+
+  /*! Identifies a RELACS shared memory segment. */
+#define RELACS_SHM_MAGIC "RELACS\0"
+  /*! Version of the shared memory layout. */
+#define RELACS_SHM_VERSION 1
+  /*! Maximum length of identifiers and units including the terminating zero. */
+#define RELACS_SHM_IDENT 64
+#define RELACS_SHM_UNIT 32
+  /*! Alignment of the data buffers in bytes. */
+#define RELACS_SHM_ALIGN 64
+
+  /*! Header at the beginning of the shared memory segment. */
+typedef struct {
+    /*! RELACS_SHM_MAGIC */
+  char magic[8];
+    /*! RELACS_SHM_VERSION */
+  uint32_t version;
+    /*! Number of input traces. */
+  uint32_t ntraces;
+    /*! Number of event traces. */
+  uint32_t nevents;
+    /*! 1 as long as RELACS writes to the segment, 0 afterwards. */
+  uint32_t active;
+    /*! Total size of the segment in bytes. */
+  uint64_t size;
+    /*! Number of completed updates. Incremented after all buffers
+        of an update have been written. */
+  uint64_t updates;
+    /*! The time of the last update in seconds. */
+  double time;
+} relacs_shm_header;
+
+  /*! Description of an input trace. */
+typedef struct {
+    /*! The name of the trace. */
+  char ident[RELACS_SHM_IDENT];
+    /*! The unit of the data values. */
+  char unit[RELACS_SHM_UNIT];
+    /*! The sampling interval in seconds. */
+  double sampleinterval;
+    /*! Offset of the \c float data buffer from the beginning
+        of the segment in bytes. */
+  uint64_t offset;
+    /*! Number of data elements the buffer can hold. */
+  uint64_t capacity;
+    /*! The writer overwrites data elements up to this index.
+        May be ahead of \a written after data were dropped. */
+  uint64_t writing;
+    /*! Data elements are valid up to this index. */
+  uint64_t written;
+} relacs_shm_trace;
+
+  /*! Description of an event trace. */
+typedef struct {
+    /*! The name of the events. */
+  char ident[RELACS_SHM_IDENT];
+    /*! The unit of the event sizes. */
+  char sizeunit[RELACS_SHM_UNIT];
+    /*! Offset of the \c double buffer with the event times in seconds
+        from the beginning of the segment in bytes. */
+  uint64_t offset;
+    /*! Offset of the \c double buffer with the event sizes
+        from the beginning of the segment in bytes,
+        0 if the events do not have sizes. */
+  uint64_t sizeoffset;
+    /*! Number of events the buffers can hold. */
+  uint64_t capacity;
+    /*! The writer overwrites events up to this index.
+        May be ahead of \a written after events were dropped. */
+  uint64_t writing;
+    /*! Events are valid up to this index. */
+  uint64_t written;
+} relacs_shm_events;
+
+
+  /*! Handle of a shared memory segment attached by a reader. */
+typedef struct relacs_shm relacs_shm;
+
+  /*! Attach read-only to the shared memory segment \a name.
+      \return a handle to the segment or \c NULL if the segment does
+      not exist or is not a RELACS segment (\c errno is set). */
+relacs_shm *relacs_shm_open( const char *name );
+  /*! Detach from the segment and free \a shm. */
+void relacs_shm_close( relacs_shm *shm );
+
+  /*! \return the header of the segment. */
+const relacs_shm_header *relacs_shm_info( const relacs_shm *shm );
+  /*! \return 1 as long as RELACS is writing to the segment.
+      If 0 is returned the segment should be closed and reopened. */
+int relacs_shm_active( const relacs_shm *shm );
+  /*! \return the number of completed updates. */
+uint64_t relacs_shm_updates( const relacs_shm *shm );
+  /*! Wait until the number of updates differs from \a updates,
+      but at most \a timeout seconds.
+      \return 1 if new data are available, 0 on timeout,
+      -1 if RELACS stopped writing to the segment. */
+int relacs_shm_wait( const relacs_shm *shm, uint64_t updates, double timeout );
+
+  /*! \return the number of input traces. */
+int relacs_shm_traces( const relacs_shm *shm );
+  /*! \return the description of input trace \a trace
+      or \c NULL if \a trace is invalid. */
+const relacs_shm_trace *relacs_shm_trace_info( const relacs_shm *shm, int trace );
+  /*! \return the index of the input trace with name \a ident, -1 if not found. */
+int relacs_shm_find_trace( const relacs_shm *shm, const char *ident );
+  /*! \return the index behind the last valid data element of trace \a trace. */
+uint64_t relacs_shm_trace_index( const relacs_shm *shm, int trace );
+  /*! \return the index of the first data element of trace \a trace
+      that can still be read. */
+uint64_t relacs_shm_trace_min_index( const relacs_shm *shm, int trace );
+  /*! \return a pointer to the data element \a index of trace \a trace
+      within the shared memory, or \c NULL if this element is not available.
+      In \a n the number of data elements that follow contiguously
+      in the buffer up to the last valid element is returned.
+      After processing the data, check with relacs_shm_trace_valid()
+      whether they have been overwritten in the meantime. */
+const float *relacs_shm_trace_buffer( const relacs_shm *shm, int trace,
+				      uint64_t index, long *n );
+  /*! \return 1 if data element \a index of trace \a trace
+      has not been overwritten yet, 0 otherwise. */
+int relacs_shm_trace_valid( const relacs_shm *shm, int trace, uint64_t index );
+  /*! Copy up to \a n data elements of trace \a trace
+      starting at index \a index into \a buffer.
+      \return the number of copied data elements, or -1 if the data
+      starting at \a index have already been overwritten. */
+long relacs_shm_read_trace( const relacs_shm *shm, int trace,
+			    uint64_t index, float *buffer, long n );
+
+  /*! \return the number of event traces. */
+int relacs_shm_events_size( const relacs_shm *shm );
+  /*! \return the description of event trace \a events
+      or \c NULL if \a events is invalid. */
+const relacs_shm_events *relacs_shm_events_info( const relacs_shm *shm, int events );
+  /*! \return the index of the event trace with name \a ident, -1 if not found. */
+int relacs_shm_find_events( const relacs_shm *shm, const char *ident );
+  /*! \return the index behind the last valid event of event trace \a events. */
+uint64_t relacs_shm_events_index( const relacs_shm *shm, int events );
+  /*! \return the index of the first event of event trace \a events
+      that can still be read. */
+uint64_t relacs_shm_events_min_index( const relacs_shm *shm, int events );
+  /*! Copy up to \a n event times of event trace \a events starting at
+      index \a index into \a times.  If \a sizes is not \c NULL and
+      the events have sizes, the corresponding event sizes are copied
+      into \a sizes.
+      \return the number of copied events, or -1 if the events
+      starting at \a index have already been overwritten. */
+long relacs_shm_read_events( const relacs_shm *shm, int events,
+			     uint64_t index, double *times, double *sizes, long n );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ! _RELACS_RELACSSHM_H_ */
+
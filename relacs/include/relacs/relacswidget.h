@@ -33,8 +33,10 @@
 #include <QMutex>
 #include <QWaitCondition>
 #include <QApplication>
+#include <QTextBrowser>
 #include <deque>
 #include <relacs/strqueue.h>
+#include <relacs/datawaitqueue.h>
 #include <relacs/configclass.h>
 #include <relacs/configureclasses.h>
 #include <relacs/settings.h>
@@ -56,12 +58,14 @@ class DIODevices;
 class TriggerDevices;
 class AttDevices;
 class AttInterfaces;
+class DeviceOpener;
 class Acquire;
 class AudioMonitor;
 class Simulator;
 class Model;
 class PlotTrace;
 class SaveFiles;
+class LiveExport;
 class RePros;
 class Macros;
 class FilterDetectors;
@@ -141,6 +145,16 @@ public:
 	\c 0 if interrupted, or \c -1 on error. */
   int getData( InList &data, EventList &events, double &signaltime,
 	       double mintracetime=0.0, double prevsignal=-1000.0 );
+    /*! Block until the input traces contain data up to \a tracetime
+        seconds or the time of the last signal is larger than \a signaltime,
+	or until \a timeout seconds elapsed.
+	Only the waiting threads whose data are available are woken up
+	by updateData().
+	Returns earlier if the acquisition or the analog output was stopped
+	or wakeAll() was called.
+        \return \c true if the requested data or signal are available. */
+  bool waitOnData( double tracetime, double signaltime=MAXDOUBLE,
+		   double timeout=MAXDOUBLE );
     /*! Take and process new data from the acquisition devices. */
   int updateData( void );
 
@@ -307,6 +321,9 @@ public slots:
     /*! Displays RELACS help. */
   void help( void );
 
+    /*! Displays the timings of the data processing recorded by the Profiler. */
+  void profiler( void );
+
 
     /*! After a signal is written to the daq-board for output
         the function write( OData &OD ) emits this signal.
@@ -326,6 +343,8 @@ protected:
 protected slots:
 
   void helpClosed( int r );
+  void profilerAction( int r );
+  void profilerClosed( int r );
   void simLoadMessage( void );
 
 
@@ -391,6 +410,7 @@ private:
   TriggerDevices *TRIGD;
   AttDevices *ATD;
   AttInterfaces *ATI;
+  DeviceOpener *DO;
 
   Acquire *AQ;
   Acquire *AQD;
@@ -398,6 +418,7 @@ private:
   Model *MD;
   PlotTrace *PT;
   SaveFiles *SF;
+  LiveExport *LE;
   ControlTabs *CW;
   RePros *RP;
   Macros *MC;
@@ -439,7 +460,7 @@ private:
   QLabel *SimLabel;
 
   // synchronization of Session and Control threads:
-  QWaitCondition UpdateDataWait;
+  DataWaitQueue DataWait;
   QWaitCondition ReProSleepWait;
   QWaitCondition ReProAfterWait;
   QWaitCondition SessionStartWait;
@@ -460,6 +481,8 @@ private:
 
   string AIErrorMsg;
   bool Help;
+  QTextBrowser *ProfileView;
+  void updateProfile( void );
 
   bool HandlingEvent;
   class KeyTimeOut *KeyTime;
@@ -43,6 +43,7 @@
 #include <nix.hpp>
 #include <unordered_map>
 #include <sstream>
+#include <relacs/nixtracewriter.h>
 #endif
 
 namespace relacs {
@@ -485,7 +486,6 @@ protected:
     nix::DataArray data;
     size_t         index;
     size_t         written;
-    nix::NDSize    offset;
   };
 
   struct NixEventData {
@@ -544,7 +544,7 @@ protected:
 		      double sessiontime );
     void endRePro ( double current_time );
     void writeTraces ( const InList &IL );
-    void writeChunk ( NixTrace &trace, size_t to_read, const void *data );
+    void writeChunk ( int trace, size_t to_read, const float *data );
     void initEvents ( const EventList &EL, FilterDetectors *FD );
     void writeEvents ( const InList &IL, const EventList &EL );
     void resetIndex ( const InList &IL );
@@ -563,6 +563,9 @@ protected:
 
     vector< NixTrace > traces;
     vector< NixEventData > events;
+      /*! Writes the trace data in chunks in the background.
+          Lock writer.mutex() for any other access to the file. */
+    NixTraceWriter writer;
   };
   NixFile NixIO;
   #endif
@@ -100,7 +100,7 @@ bool Control::interrupt( void ) const
 bool Control::waitOnData( double time )
 {
   unsigned long t = time == MAXDOUBLE ? ULONG_MAX : (unsigned long)::rint(1.0e3*time);
-  RW->UpdateDataWait.wait( mutex(), t );
+  RW->DataWait.wait( mutex(), -MAXDOUBLE, MAXDOUBLE, t );
   getData();
   return interrupt();
 }
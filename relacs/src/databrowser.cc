@@ -94,6 +94,25 @@ void DataOverviewModel::setBrowser( DataBrowser *browser )
 }
 
 
+DataIndex::DataItem *DataOverviewModel::item( const QModelIndex &index ) const
+{
+  if ( ! index.isValid() )
+    return Data->cells();
+
+  DataIndex::DataItem *parentitem =
+    static_cast<DataIndex::DataItem*>( index.internalPointer() );
+  return parentitem->child( index.row() );
+}
+
+
+QModelIndex DataOverviewModel::modelIndex( DataIndex::DataItem *item ) const
+{
+  if ( item == 0 || item->parent() == 0 )
+    return QModelIndex();
+  return createIndex( item->row(), 0, item->parent() );
+}
+
+
 QVariant DataOverviewModel::data( const QModelIndex &index, int role ) const
 {
   if ( ! index.isValid() )
@@ -105,19 +124,19 @@ QVariant DataOverviewModel::data( const QModelIndex &index, int role ) const
   if ( index.column() > 0 )
     return QVariant();
 
-  DataIndex::DataItem *item =
+  DataIndex::DataItem *parentitem =
     static_cast<DataIndex::DataItem*>( index.internalPointer() );
 
-  if ( item->level() == 1 ) {
-    Str file = item->name();
+  if ( parentitem->level() == 0 ) {
+    Str file = parentitem->name( index.row() );
     return QVariant( QString( file.dir().preventedSlash().name().c_str() ) );
   }
-  else if ( item->level() == 3 ) {
-    Str stimulus = item->name();
+  else if ( parentitem->level() == 2 ) {
+    Str stimulus = parentitem->name( index.row() );
     stimulus.eraseFirst( "stimulus/" );
     return QVariant( QString( stimulus.c_str() ) );
   }
-  return QVariant( QString( item->name().c_str() ) );
+  return QVariant( QString( parentitem->name( index.row() ).c_str() ) );
 }
 
 
@@ -146,15 +165,9 @@ QModelIndex DataOverviewModel::index( int row, int column,
   //  if ( !hasIndex( row, column, parent ) )
   //    return QModelIndex();
 
-  DataIndex::DataItem *parentitem = 0;
-  if ( ! parent.isValid() )
-    parentitem = Data->cells();
-  else
-    parentitem = static_cast<DataIndex::DataItem*>( parent.internalPointer() );
-
-  DataIndex::DataItem *childitem = parentitem->child( row );
-  if ( childitem )
-    return createIndex( row, column, childitem );
+  DataIndex::DataItem *parentitem = item( parent );
+  if ( parentitem != 0 && row >= 0 && row < parentitem->fetched() )
+    return createIndex( row, column, parentitem );
 
   return QModelIndex();
 }
@@ -165,12 +178,9 @@ QModelIndex DataOverviewModel::parent( const QModelIndex &index ) const
   if ( ! index.isValid() )
     return QModelIndex();
 
-  DataIndex::DataItem* childitem =
+  DataIndex::DataItem* parentitem =
     static_cast<DataIndex::DataItem*>( index.internalPointer() );
-  DataIndex::DataItem* parentitem = childitem->parent();
-  if ( parentitem == Data->cells() )
-    return QModelIndex();
-  return createIndex( parentitem->parent()->index( parentitem ), 0, parentitem );
+  return modelIndex( parentitem );
 }
 
 
@@ -179,8 +189,7 @@ bool DataOverviewModel::hasChildren( const QModelIndex &parent ) const
   if ( ! parent.isValid() )
     return ! Data->cells()->empty();
 
-  DataIndex::DataItem* parentitem =
-    static_cast<DataIndex::DataItem*>( parent.internalPointer() );
+  DataIndex::DataItem* parentitem = item( parent );
   if ( parentitem == 0 )
     return false;
 
@@ -196,18 +205,11 @@ int DataOverviewModel::rowCount( const QModelIndex &parent ) const
   if ( parent.column() > 0 )
     return 0;
 
-  if ( parent.isValid() ) {
-    DataIndex::DataItem* parentitem =
-      static_cast<DataIndex::DataItem*>( parent.internalPointer() );
-    if ( parentitem->level() == 1 ) {
-      //      cerr << "we need to load cell " << parentitem->name() << '\n';
-    }
-    return parentitem->size();
-  }
-  else
-    return Data->size();
+  DataIndex::DataItem* parentitem = item( parent );
+  if ( parentitem == 0 )
+    return 0;
 
-  return 0;
+  return parentitem->fetched();
 }
 
 
@@ -219,39 +221,45 @@ int DataOverviewModel::columnCount( const QModelIndex &parent ) const
 
 bool DataOverviewModel::canFetchMore( const QModelIndex &parent ) const
 {
-  if ( ! parent.isValid() )
+  DataIndex::DataItem *parentitem = item( parent );
+  if ( parentitem == 0 )
     return false;
 
-  DataIndex::DataItem *item =
-    static_cast<DataIndex::DataItem*>( parent.internalPointer() );
-
-  if ( item->level() == 1 && item->size() == 0 )
-    return true;
-
-  return false;
+  return parentitem->canFetchMore();
 }
 
 
 void DataOverviewModel::fetchMore( const QModelIndex &parent )
 {
-  if ( ! parent.isValid() )
+  DataIndex::DataItem *parentitem = item( parent );
+  if ( parentitem == 0 )
     return;
 
-  DataIndex::DataItem *item =
-    static_cast<DataIndex::DataItem*>( parent.internalPointer() );
+  // index the RePros and stimuli of a cell:
+  parentitem->loadCell();
+
+  int n = parentitem->size() - parentitem->fetched();
+  if ( n > PageSize )
+    n = PageSize;
+  fetchChildren( parentitem, n );
+}
+
+
+void DataOverviewModel::fetchChildren( DataIndex::DataItem *parent, int n )
+{
+  if ( n <= 0 )
+    return;
 
-  item->loadCell();
+  int first = parent->fetched();
+  beginInsertRows( modelIndex( parent ), first, first+n-1 );
+  parent->setFetched( first+n );
+  endInsertRows();
 }
 
 
 void DataOverviewModel::beginAddChild( DataIndex::DataItem *parent )
 {
-  DataIndex::DataItem *parentitem = parent->parent();
-  if ( parentitem == 0 )
-    beginInsertRows( QModelIndex(), parent->size(), parent->size() );
-  else
-    beginInsertRows( createIndex( parentitem->index( parent ), 0, parent ),
-		     parent->size(), parent->size() );
+  beginInsertRows( modelIndex( parent ), parent->size(), parent->size() );
 }
 
 
@@ -260,16 +268,14 @@ void DataOverviewModel::endAddChild( DataIndex::DataItem *parent )
   endInsertRows();
   if ( View != 0 ) {
     if ( parent->size() > 1 ) {
+      View->collapse( createIndex( parent->size()-2, 0, parent ) );
       DataIndex::DataItem *child = parent->child( parent->size()-2 );
-      View->collapse( createIndex( parent->size()-2, 0, child ) );
-      while ( child->level() < 3 && ! child->empty() ) {
-	DataIndex::DataItem *item = child;
-	child = item->child( item->size()-1 );
-	View->collapse( createIndex( item->size()-1, 0, child ) );
+      while ( child != 0 && child->fetched() > 0 ) {
+	View->collapse( createIndex( child->fetched()-1, 0, child ) );
+	child = child->child( child->fetched()-1 );
       }
     }
-    QModelIndex item = createIndex( parent->size()-1, 0,
-				    parent->child( parent->size()-1 ) );
+    QModelIndex item = createIndex( parent->size()-1, 0, parent );
     AutoActivate = true;
     View->expand( item );
     View->scrollTo( item );
@@ -279,29 +285,17 @@ void DataOverviewModel::endAddChild( DataIndex::DataItem *parent )
 }
 
 
-void DataOverviewModel::endAddChild( void )
-{
-  endInsertRows();
-}
-
-
 void DataOverviewModel::beginPopChild( DataIndex::DataItem *parent )
 {
-  DataIndex::DataItem *parentitem = parent->parent();
-  if ( parentitem == 0 )
-    beginRemoveRows( QModelIndex(), parent->size()-1, parent->size()-1 );
-  else
-    beginRemoveRows( createIndex( parentitem->index( parent ), 0, parent ),
-		     parent->size()-1, parent->size()-1 );
+  beginRemoveRows( modelIndex( parent ), parent->size()-1, parent->size()-1 );
 }
 
 
 void DataOverviewModel::endPopChild( DataIndex::DataItem *parent )
 {
   endRemoveRows();
-  if ( View != 0 ) {
-    QModelIndex item = createIndex( parent->size()-1, 0,
-				    parent->child( parent->size()-1 ) );
+  if ( View != 0 && parent->size() > 0 ) {
+    QModelIndex item = createIndex( parent->size()-1, 0, parent );
     AutoActivate = true;
     View->scrollTo( item );
     View->setCurrentIndex( item );
@@ -310,6 +304,20 @@ void DataOverviewModel::endPopChild( DataIndex::DataItem *parent )
 }
 
 
+void DataOverviewModel::beginResetCells( void )
+{
+  beginResetModel();
+}
+
+
+void DataOverviewModel::endResetCells( void )
+{
+  DataIndex::DataItem *cells = Data->cells();
+  cells->setFetched( cells->size() < PageSize ? cells->size() : PageSize );
+  endResetModel();
+}
+
+
 void DataOverviewModel::setDescription( const QModelIndex &index )
 {
   if ( ! index.isValid() )
@@ -318,14 +326,14 @@ void DataOverviewModel::setDescription( const QModelIndex &index )
   if ( index.column() > 0 )
     return;
 
-  DataIndex::DataItem *item =
+  DataIndex::DataItem *parentitem =
     static_cast<DataIndex::DataItem*>( index.internalPointer() );
 
-  if ( item == 0 )
+  if ( parentitem == 0 )
     return;
 
   // inform descriptionModel about new selected data:
-  Data->descriptionModel()->setOptions( &item->data() );
+  Data->descriptionModel()->setOptions( &parentitem->data( index.row() ) );
 }
 
 
@@ -351,17 +359,21 @@ void DataOverviewModel::displayIndex( const QModelIndex &index )
   if ( index.column() > 0 )
     return;
 
-  DataIndex::DataItem *item =
+  DataIndex::DataItem *parentitem =
     static_cast<DataIndex::DataItem*>( index.internalPointer() );
 
-  if ( item == 0 )
+  if ( parentitem == 0 )
     return;
 
-  if ( item->level() < 1 || item->level() > 3 )
+  if ( parentitem->level() < 0 || parentitem->level() > 2 )
     return;
 
+  int row = index.row();
+  string file = parentitem->level() == 2 ?
+    parentitem->fileName() : parentitem->child( row )->fileName();
   if ( Browser != 0 )
-    Browser->display( item->fileName(), item->traceIndex(), item->eventsIndex(), item->time() );
+    Browser->display( file, parentitem->traceIndex( row ),
+		      parentitem->eventsIndex( row ), parentitem->time( row ) );
 }
 
 
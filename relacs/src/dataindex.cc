@@ -21,6 +21,7 @@
 
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <QDir>
 #include <QStringList>
 #include <relacs/datafile.h>
@@ -34,239 +35,346 @@ namespace relacs {
 
 
 
-DataIndex::DataItem::DataItem( void )
-  : Level( 0 ),
-    Time( 0.0 ),
-    Parent( 0 ),
-    OverviewModel( 0 )
+DataIndex::DataItem::DataItem( const string &name, int level,
+			       DataIndex::DataItem *parent, DataIndex *index )
+  : Level( level ),
+    Row( parent == 0 ? 0 : parent->size() ),
+    Name( index->intern( name ) ),
+    Parent( parent ),
+    Index( index ),
+    Fetched( 0 ),
+    Data( 0 ),
+    Offset( -1 ),
+    First( 0 ),
+    Stimuli( 0 ),
+    Loaded( level != 1 ),
+    HeaderLoaded( level != 1 ),
+    NTraces( 0 ),
+    NEvents( 0 ),
+    SignalDescriptions( 0 )
 {
-  TraceIndex.clear();
-  EventsIndex.clear();
-  Data.clear();
-  Children.clear();
 }
 
 
-DataIndex::DataItem::DataItem( const DataIndex::DataItem &data )
-  : Level( data.Level ),
-    Name( data.Name ),
-    Data( data.Data ),
-    TraceIndex( data.TraceIndex ),
-    EventsIndex( data.EventsIndex ),
-    Time( data.Time ),
-    Children( data.Children ),
-    Parent( data.Parent ),
-    OverviewModel( data.OverviewModel )
+DataIndex::DataItem::~DataItem( void )
 {
+  clear();
+  if ( Data != 0 )
+    delete Data;
 }
 
 
-DataIndex::DataItem::DataItem( const string &name )
-  : Level( 0 ),
-    Name( name ),
-    Time( 0.0 ),
-    Parent( 0 ),
-    OverviewModel( 0 )
+bool DataIndex::DataItem::empty( void ) const
 {
-  Data.clear();
-  TraceIndex.clear();
-  EventsIndex.clear();
-  Children.clear();
+  return ( size() == 0 );
 }
 
 
-DataIndex::DataItem::DataItem( const string &name, int level,
-			       DataIndex::DataItem *parent )
-  : Level( level ),
-    Name( name ),
-    Time( 0.0 ),
-    Parent( parent ),
-    OverviewModel( parent->overviewModel() )
+int DataIndex::DataItem::size( void ) const
 {
-  Data.clear();
-  TraceIndex.clear();
-  EventsIndex.clear();
-  Children.clear();
+  if ( Level == 2 )
+    return Stimuli;
+  else
+    return Children.size();
 }
 
 
-DataIndex::DataItem::DataItem( const string &name, const Options &data,
-			       int level, DataIndex::DataItem *parent )
-  : Level( level ),
-    Name( name ),
-    Data( data ),
-    Time( 0.0 ),
-    Parent( parent ),
-    OverviewModel( parent->overviewModel() )
+int DataIndex::DataItem::fetched( void ) const
 {
-  TraceIndex.clear();
-  EventsIndex.clear();
-  Children.clear();
+  return Fetched;
 }
 
 
-DataIndex::DataItem::DataItem( const string &name, const Options &data,
-			       int ntraces, int nevents,
-			       int level, DataIndex::DataItem *parent )
-  : Level( level ),
-    Name( name ),
-    Data( data ),
-    Time( 0.0 ),
-    Parent( parent ),
-    OverviewModel( parent->overviewModel() )
+void DataIndex::DataItem::setFetched( int n )
 {
-  TraceIndex.clear();
-  TraceIndex.resize( ntraces, 0 );
-  EventsIndex.clear();
-  EventsIndex.resize( nevents, 0 );
-  Children.clear();
+  Fetched = n;
 }
 
 
-DataIndex::DataItem::DataItem( const string &name, const Options &data,
-			       const deque<int> &traceindex, const deque<int> &eventsindex,
-			       double time, int level, DataIndex::DataItem *parent )
-  : Level( level ),
-    Name( name ),
-    Data( data ),
-    TraceIndex( traceindex ),
-    EventsIndex( eventsindex ),
-    Time( time ),
-    Parent( parent ),
-    OverviewModel( parent->overviewModel() )
+bool DataIndex::DataItem::canFetchMore( void ) const
+{
+  return ( ! Loaded || Fetched < size() );
+}
+
+
+void DataIndex::DataItem::clear( void )
 {
+  for ( unsigned int k=0; k<Children.size(); k++ )
+    delete Children[k];
   Children.clear();
+  Fetched = 0;
+  StimulusDescriptions.clear();
+  StimulusTimes.clear();
+  StimulusIndices.clear();
+  for ( unsigned int k=0; k<Descriptions.size(); k++ ) {
+    if ( Descriptions[k] != 0 )
+      delete Descriptions[k];
+  }
+  Descriptions.clear();
+  DescriptionNames.clear();
+  DescriptionKeys.clear();
+  DescriptionIndex.clear();
+  if ( SignalDescriptions != 0 )
+    delete SignalDescriptions;
+  SignalDescriptions = 0;
 }
 
 
-bool DataIndex::DataItem::empty( void ) const
+DataIndex::DataItem &DataIndex::DataItem::back( void )
 {
-  return Children.empty();
+  return *Children.back();
 }
 
 
-int DataIndex::DataItem::size( void ) const
+void DataIndex::DataItem::pop( void )
 {
-  return Children.size();
+  bool exposed = ( Fetched == size() );
+  if ( exposed )
+    Index->overviewModel()->beginPopChild( this );
+  delete Children.back();
+  Children.pop_back();
+  if ( exposed ) {
+    Fetched = size();
+    Index->overviewModel()->endPopChild( this );
+  }
 }
 
 
-void DataIndex::DataItem::clear( void )
+int DataIndex::DataItem::row( void ) const
 {
-  Children.clear();
+  return Row;
 }
 
 
-DataIndex::DataItem &DataIndex::DataItem::back( void )
+DataIndex::DataItem *DataIndex::DataItem::child( int index )
 {
-  return Children.back();
+  if ( index >= 0 && index < (int)Children.size() )
+    return Children[index];
+
+  return 0;
 }
 
 
-void DataIndex::DataItem::pop( void )
+DataIndex::DataItem *DataIndex::DataItem::parent( void ) const
 {
-  OverviewModel->beginPopChild( this );
-  Children.pop_back();
-  OverviewModel->endPopChild( this );
+  return Parent;
 }
 
 
-const DataIndex::DataItem &DataIndex::DataItem::operator[]( int index ) const
+void DataIndex::DataItem::append( DataIndex::DataItem *item )
 {
-  return Children[index];
+  DataOverviewModel *model = Index->overviewModel();
+  // make sure all previous children are visible:
+  if ( Fetched < size() )
+    model->fetchChildren( this, size() - Fetched );
+  model->beginAddChild( this );
+  Children.push_back( item );
+  Fetched = size();
+  model->endAddChild( this );
 }
 
 
-DataIndex::DataItem &DataIndex::DataItem::operator[]( int index )
+void DataIndex::DataItem::addChild( const string &name, const Options &data )
 {
-  return Children[index];
+  DataItem *item = new DataItem( name, level()+1, this, Index );
+  item->Data = new Options( data );
+  item->First = StimulusTimes.size();
+  append( item );
 }
 
 
-int DataIndex::DataItem::index( DataItem *data )
+void DataIndex::DataItem::addChild( const string &name, const Options &data,
+				    int ntraces, int nevents )
 {
-  for ( int k=0; k<size(); k++ ) {
-    if ( &Children[k] == data )
-      return k;
-  }
-  return -1;
+  DataItem *item = new DataItem( name, level()+1, this, Index );
+  item->Data = new Options( data );
+  item->Loaded = true;
+  item->HeaderLoaded = true;
+  item->NTraces = ntraces;
+  item->NEvents = nevents;
+  append( item );
 }
 
 
-DataIndex::DataItem *DataIndex::DataItem::child( int index )
+void DataIndex::DataItem::addCell( const string &file )
 {
-  if ( index >= 0 && index < size() )
-    return &Children[index];
+  Children.push_back( new DataItem( file, level()+1, this, Index ) );
+}
 
-  return 0;
+
+void DataIndex::DataItem::addStimulus( const Options &data,
+				       const deque<int> &traceindex,
+				       const deque<int> &eventsindex,
+				       double time )
+{
+  if ( Level != 2 )
+    return;
+  DataItem *cell = Parent;
+  if ( First + Stimuli != (int)cell->StimulusTimes.size() )
+    return;
+
+  // share equal descriptions:
+  ostringstream ss;
+  data.save( ss );
+  string key = ss.str();
+  int d = 0;
+  map< string, int >::const_iterator dp = cell->DescriptionIndex.find( key );
+  if ( dp != cell->DescriptionIndex.end() )
+    d = dp->second;
+  else {
+    d = cell->Descriptions.size();
+    cell->Descriptions.push_back( new Options( data ) );
+    cell->DescriptionNames.push_back( Index->intern( data.type() ) );
+    cell->DescriptionKeys.push_back( "" );
+    cell->DescriptionIndex[key] = d;
+  }
+
+  bool exposed = ( Fetched == Stimuli );
+  DataOverviewModel *model = Index->overviewModel();
+  if ( exposed )
+    model->beginAddChild( this );
+  cell->StimulusDescriptions.push_back( d );
+  cell->StimulusTimes.push_back( time );
+  cell->addIndices( traceindex, eventsindex );
+  Stimuli++;
+  if ( exposed ) {
+    Fetched = Stimuli;
+    model->endAddChild( this );
+  }
 }
 
 
-DataIndex::DataItem *DataIndex::DataItem::parent( void ) const
+void DataIndex::DataItem::addIndices( const deque<int> &traceindex,
+				      const deque<int> &eventsindex )
 {
-  return Parent;
+  for ( int k=0; k<NTraces; k++ )
+    StimulusIndices.push_back( k < (int)traceindex.size() ? traceindex[k] : 0 );
+  for ( int k=0; k<NEvents; k++ )
+    StimulusIndices.push_back( k < (int)eventsindex.size() ? eventsindex[k] : 0 );
 }
 
 
-void DataIndex::DataItem::addChild( const string &name )
+void DataIndex::DataItem::loadHeader( void ) const
 {
-  OverviewModel->beginAddChild( this );
-  Children.push_back( DataItem( name, level()+1, this ) );
-  OverviewModel->endAddChild( this );
+  if ( HeaderLoaded )
+    return;
+  HeaderLoaded = true;
+
+  DataFile sf( name() );
+  sf.readMetaData();
+  // number of traces:
+  int k1 = sf.key().column( "traces>" );
+  NTraces = 0;
+  for ( int k=k1; sf.key().sectionName( k, 2 ) == "traces"; k++ )
+    NTraces++;
+  // number of events:
+  k1 = sf.key().column( "events>" );
+  NEvents = 0;
+  for ( int k=k1; sf.key().sectionName( k, 2 ) == "events"; k++ ) {
+    if ( sf.key().sectionName( k, 0 ) == "index" )
+      NEvents++;
+  }
+  if ( Data != 0 )
+    delete Data;
+  Data = new Options( sf.metaDataOptions( sf.levels()>0 ? sf.levels()-1 : 0 ) );
+  sf.close();
 }
 
 
-void DataIndex::DataItem::addChild( const string &name, const Options &data )
+const Options &DataIndex::DataItem::signalDescriptions( void )
 {
-  OverviewModel->beginAddChild( this );
-  Children.push_back( DataItem( name, data, level()+1, this ) );
-  OverviewModel->endAddChild( this );
+  if ( SignalDescriptions == 0 ) {
+    SignalDescriptions = new Options;
+    string sd = data().text( "stimulus descriptions file", "stimulus-descriptions.dat" );
+    // fix for the first stimulus descriptions implementation until 2014-06-21:
+    if ( sd == "stimlus-descriptions.dat" )
+      sd = "stimulus-descriptions.dat"; 
+    string filename = Str( name() ).dir() + sd;
+    ifstream sf( filename.c_str() );
+    SignalDescriptions->load( sf );
+    if ( SignalDescriptions->sectionsSize() <= 0 )
+      SignalDescriptions->down();
+  }
+  return *SignalDescriptions;
 }
 
 
-  void DataIndex::DataItem::addChild( const string &name, const Options &data,
-				      int ntraces, int nevents )
+int DataIndex::DataItem::description( const string &signalnames )
 {
-  OverviewModel->beginAddChild( this );
-  Children.push_back( DataItem( name, data, ntraces, nevents, level()+1, this ) );
-  OverviewModel->endAddChild( this );
+  map< string, int >::const_iterator dp = DescriptionIndex.find( signalnames );
+  if ( dp != DescriptionIndex.end() )
+    return dp->second;
+
+  // name of the description:
+  StrQueue names( signalnames, "\t" );
+  int nstimuli = 0;
+  string name = "";
+  for ( int k=0; k<names.size(); k++ ) {
+    if ( names[k] != "-" ) {
+      nstimuli++;
+      Options::const_section_iterator sp = signalDescriptions().findSection( names[k] );
+      if ( sp != signalDescriptions().sectionsEnd() )
+	name = (*sp)->type();
+    }
+  }
+  if ( nstimuli > 1 )
+    name = "stimulus";
+
+  int d = Descriptions.size();
+  Descriptions.push_back( 0 );
+  DescriptionNames.push_back( Index->intern( name ) );
+  DescriptionKeys.push_back( signalnames );
+  DescriptionIndex[signalnames] = d;
+  return d;
 }
 
 
-void DataIndex::DataItem::addChild( const string &name, const Options &data,
-				    const deque<int> &traceindex,
-				    const deque<int> &eventsindex,
-				    double time )
+Options &DataIndex::DataItem::stimulus( int stimulus )
 {
-  OverviewModel->beginAddChild( this );
-  Children.push_back( DataItem( name, data, traceindex, eventsindex, time,
-				level()+1, this ) );
-  OverviewModel->endAddChild( this );
+  int d = StimulusDescriptions[stimulus];
+  if ( Descriptions[d] == 0 ) {
+    // materialize stimulus description from the stimulus-descriptions file:
+    Options *description = new Options;
+    StrQueue names( DescriptionKeys[d], "\t" );
+    int nstimuli = 0;
+    for ( int k=0; k<names.size(); k++ ) {
+      if ( names[k] != "-" )
+	nstimuli++;
+    }
+    for ( int k=0; k<names.size(); k++ ) {
+      if ( names[k] != "-" ) {
+	Options::const_section_iterator sp = signalDescriptions().findSection( names[k] );
+	if ( sp != signalDescriptions().sectionsEnd() ) {
+	  if ( nstimuli == 1 ) {
+	    *description = **sp;
+	    break;
+	  }
+	  else
+	    description->newSection( **sp );
+	}
+      }
+    }
+    if ( nstimuli > 1 )
+      description->setType( "stimulus" );
+    Descriptions[d] = description;
+  }
+  return *Descriptions[d];
 }
 
 
 void DataIndex::DataItem::loadCell( void )
 {
-  if ( level() != 1 )
+  if ( level() != 1 || Loaded )
     return;
+  Loaded = true;
+  loadHeader();
+
   DataFile sf( name() );
+  // offset of the next block of meta data:
+  long offset = 0;
 
   // read in meta data:
   sf.readMetaData();
-  // load stimulus descriptions:
-  string sd = sf.metaDataOptions( sf.levels()-1 ).text( "stimulus descriptions file", "stimulus-descriptions.dat" );
-  // fix for the first stimulus descriptions implementation until 2014-06-21:
-  if ( sd == "stimlus-descriptions.dat" )
-    sd = "stimulus-descriptions.dat"; 
-  // load stimulus descriptions:
-  Options stimuli;
-  {
-    string filename = Str( name() ).dir() + sd;
-    ifstream sf( filename.c_str() );
-    stimuli.load( sf );
-    if ( stimuli.sectionsSize() <= 0 )
-      stimuli.down();
-  }
   // get columns for stimulus names:
   int k1 = sf.key().column( "stimulus>" );
   deque< int > stimcols;
@@ -275,9 +383,23 @@ void DataIndex::DataItem::loadCell( void )
       stimcols.push_back( k );
   }
   deque< deque< string > > stimnames( stimcols.size() );
+  // columns of trace and event indices:
+  deque<int> tracecols;
+  k1 = sf.key().column( "traces>" );
+  for ( int k=k1; sf.key().sectionName( k, 2 ) == "traces"; k++ )
+    tracecols.push_back( k );
+  deque<int> eventscols;
+  k1 = sf.key().column( "events>" );
+  for ( int k=k1; sf.key().sectionName( k, 2 ) == "events"; k++ ) {
+    if ( sf.key().sectionName( k, 0 ) == "index" )
+      eventscols.push_back( k );
+  }
+  double deltat = data().number( "sample interval1", "s" );
+  deque<int> traceindex( tracecols.size() );
+  deque<int> eventsindex( eventscols.size() );
 
   do {
-    DataItem *parent = 0;
+    DataItem *repro = 0;
     // read in stimuli:
     if ( ! sf.initData() )
       break;
@@ -301,103 +423,91 @@ void DataIndex::DataItem::loadCell( void )
     // add stimuli:
     if ( sf.data().columns() > 0 ) {
       for ( int j=0; j<sf.data().rows(); j++ ) {
-	// trace indices:
-	k1 = sf.key().column( "traces>" );
-	deque<int> traceindex;
-	for ( int k=k1; sf.key().sectionName( k, 2 ) == "traces"; k++ )
-	  traceindex.push_back( sf.data( k, j ) );
-	// event indices:
-	k1 = sf.key().column( "events>" );
-	deque<int> eventsindex;
-	for ( int k=k1; sf.key().sectionName( k, 2 ) == "events"; k++ ) {
-	  if ( sf.key().sectionName( k, 0 ) == "index" )
-	    eventsindex.push_back( sf.data( k, j ) );
+	// add RePro:
+	if ( repro == 0 ) {
+	  Options &reprodata = sf.metaDataOptions( 0 );
+	  repro = new DataItem( reprodata.text( "RePro" ), level()+1, this, Index );
+	  repro->Offset = offset;
+	  repro->First = StimulusTimes.size();
+	  Children.push_back( repro );
 	}
-	// signal time:
-	double deltat = data().number( "sample interval1", "s" );
-	double signaltime = traceindex[0]*deltat;
 	// signal description:
+	string signalnames = "";
 	int nstimuli = 0;
 	for ( unsigned int k=0; k<stimnames.size(); k++ ) {
+	  if ( k > 0 )
+	    signalnames += '\t';
+	  signalnames += stimnames[k][j];
 	  if ( stimnames[k][j] != "-" )
 	    nstimuli++;
 	}
-	Options description;
-	for ( unsigned int k=0; k<stimnames.size(); k++ ) {
-	  if ( stimnames[k][j] != "-" ) {
-	    Options::const_section_iterator sp = stimuli.findSection( stimnames[k][j] );
-	    if ( sp != stimuli.sectionsEnd() ) {
-	      if ( nstimuli == 1 ) {
-		description = **sp;
-		break;
-	      }
-	      else
-		description.newSection( **sp );
-	    }
-	  }
-	}
-	// add RePro:
-	if ( parent == 0 ) {
-	  Options &repro = sf.metaDataOptions( 0 );
-	  OverviewModel->beginAddChild( this );
-	  Children.push_back( DataItem( repro.text( "RePro" ), repro, traceindex, eventsindex,
-					signaltime, level()+1, this ) );
-	  parent = &Children.back();
-	  OverviewModel->endAddChild();
-	}
 	// add stimulus:
-	if ( nstimuli > 0 && parent != 0 ) {
-	  if ( nstimuli > 1 )
-	    description.setType( "stimulus" );
-	  // add stimulus to tree:
-	  OverviewModel->beginAddChild( parent );
-	  parent->Children.push_back( DataItem( description.type(), description,
-						traceindex, eventsindex,
-						signaltime, level()+2, parent ) );
-	  OverviewModel->endAddChild();
+	if ( nstimuli > 0 ) {
+	  for ( unsigned int k=0; k<tracecols.size(); k++ )
+	    traceindex[k] = sf.data( tracecols[k], j );
+	  for ( unsigned int k=0; k<eventscols.size(); k++ )
+	    eventsindex[k] = sf.data( eventscols[k], j );
+	  StimulusDescriptions.push_back( description( signalnames ) );
+	  StimulusTimes.push_back( traceindex.empty() ? 0.0 : traceindex[0]*deltat );
+	  addIndices( traceindex, eventsindex );
+	  repro->Stimuli++;
 	}
       }
     }
+    // the next block of meta data starts with the current line:
+    if ( sf.good() )
+      offset = (long)sf.tellg() - (long)sf.line().size() - 1;
   } while ( sf.readMetaData() );
   sf.close();
 }
 
 
-int DataIndex::DataItem::level( void ) const
+bool DataIndex::DataItem::loaded( void ) const
 {
-  return Level;
+  return Loaded;
 }
 
 
-string DataIndex::DataItem::name( void ) const
+int DataIndex::DataItem::level( void ) const
 {
-  return Name;
+  return Level;
 }
 
 
-void DataIndex::DataItem::setName( const string &name )
+string DataIndex::DataItem::name( void ) const
 {
-  Name = name;
+  return Index->interned( Name );
 }
 
 
-const Options &DataIndex::DataItem::data( void ) const
+void DataIndex::DataItem::setName( const string &name )
 {
-  return Data;
+  Name = Index->intern( name );
 }
 
 
 Options &DataIndex::DataItem::data( void )
 {
-  return Data;
+  if ( Level == 1 )
+    loadHeader();
+  if ( Data == 0 ) {
+    Data = new Options;
+    if ( Level == 2 && Offset >= 0 ) {
+      // read meta data of the RePro:
+      ifstream df( fileName().c_str() );
+      df.seekg( Offset );
+      DataFile sf( df );
+      if ( sf.readMetaData() > 0 )
+	*Data = sf.metaDataOptions( 0 );
+    }
+  }
+  return *Data;
 }
 
 
 string DataIndex::DataItem::fileName( void ) const
 {
-  if ( level() == 3 )
-    return Parent->Parent->name();
-  else if ( level() == 2 )
+  if ( level() == 2 )
     return Parent->name();
   else if ( level() == 1 )
     return name();
@@ -408,32 +518,84 @@ string DataIndex::DataItem::fileName( void ) const
 
 deque<int> DataIndex::DataItem::traceIndex( void ) const
 {
-  return TraceIndex;
+  if ( Level == 1 ) {
+    loadHeader();
+    return deque<int>( NTraces, 0 );
+  }
+  else if ( Level == 2 && Stimuli > 0 )
+    return traceIndex( 0 );
+  return deque<int>();
 }
 
 
 deque<int> DataIndex::DataItem::eventsIndex( void ) const
 {
-  return EventsIndex;
+  if ( Level == 1 ) {
+    loadHeader();
+    return deque<int>( NEvents, 0 );
+  }
+  else if ( Level == 2 && Stimuli > 0 )
+    return eventsIndex( 0 );
+  return deque<int>();
 }
 
 
 double DataIndex::DataItem::time( void ) const
 {
-  return Time;
+  if ( Level == 2 && Stimuli > 0 )
+    return time( 0 );
+  return 0.0;
 }
 
 
+string DataIndex::DataItem::name( int row ) const
+{
+  if ( Level == 2 )
+    return Index->interned( Parent->DescriptionNames[Parent->StimulusDescriptions[First+row]] );
+  else
+    return Children[row]->name();
+}
 
-DataOverviewModel *DataIndex::DataItem::overviewModel( void )
+
+Options &DataIndex::DataItem::data( int row )
 {
-  return OverviewModel;
+  if ( Level == 2 )
+    return Parent->stimulus( First+row );
+  else
+    return Children[row]->data();
 }
 
 
-void DataIndex::DataItem::setOverviewModel( DataOverviewModel *model )
+deque<int> DataIndex::DataItem::traceIndex( int row ) const
 {
-  OverviewModel = model;
+  if ( Level == 2 ) {
+    int n = Parent->NTraces + Parent->NEvents;
+    vector<int>::const_iterator ip = Parent->StimulusIndices.begin() + (First+row)*n;
+    return deque<int>( ip, ip + Parent->NTraces );
+  }
+  else
+    return Children[row]->traceIndex();
+}
+
+
+deque<int> DataIndex::DataItem::eventsIndex( int row ) const
+{
+  if ( Level == 2 ) {
+    int n = Parent->NTraces + Parent->NEvents;
+    vector<int>::const_iterator ip = Parent->StimulusIndices.begin() + (First+row)*n;
+    return deque<int>( ip + Parent->NTraces, ip + n );
+  }
+  else
+    return Children[row]->eventsIndex();
+}
+
+
+double DataIndex::DataItem::time( int row ) const
+{
+  if ( Level == 2 )
+    return Parent->StimulusTimes[First+row];
+  else
+    return Children[row]->time();
 }
 
 
@@ -443,19 +605,18 @@ void DataIndex::DataItem::print( void )
   for ( int k=0; k<level(); k++ )
     cout << "  ";
   cout << name() << '\n';
-  for ( int k=0; k<size(); k++ )
-    Children[k].print();
+  for ( int k=0; k<(int)Children.size(); k++ )
+    Children[k]->print();
   */
 }
 
 
 DataIndex::DataIndex( void )
-  : Cells( "Data" ),
+  : Cells( "Data", 0, 0, this ),
     Session ( false )
 {
   OverviewModel = new DataOverviewModel( 0 );
   OverviewModel->setDataIndex( this );
-  Cells.setOverviewModel( OverviewModel );
 
   DescriptionModel = new DataDescriptionModel( 0 );
   DescriptionModel->setOptions( 0 );
@@ -473,10 +634,8 @@ DataIndex::~DataIndex( void )
 void DataIndex::addStimulus( const Options &signal, const deque<int> &traceindex,
 			     const deque<int> &eventsindex, double time )
 {
-  if ( ! Cells.empty() && ! Cells.back().empty() && Session ) {
-    string s = signal.type();
-    Cells.back().back().addChild( s, signal, traceindex, eventsindex, time );
-  }
+  if ( ! Cells.empty() && ! Cells.back().empty() && Session )
+    Cells.back().back().addStimulus( signal, traceindex, eventsindex, time );
   print();
 }
 
@@ -529,33 +688,19 @@ void DataIndex::loadDirectory( const string &path )
       if ( ! file.empty() ) {
 	// clear cells:
 	if ( first ) {
+	  OverviewModel->beginResetCells();
 	  Cells.clear();
 	  first = false;
 	}
-	// load data:
-	DataFile sf( file );
-	sf.read( 1 );
-	// number of traces:
-	int k1 = sf.key().column( "traces>" );
-	int ntraces = 0;
-	for ( int k=k1; sf.key().sectionName( k, 2 ) == "traces"; k++ )
-	  ntraces++;
-	// number of events:
-	k1 = sf.key().column( "events>" );
-	int nevents = 0;
-	for ( int k=k1; sf.key().sectionName( k, 2 ) == "events"; k++ ) {
-	  if ( sf.key().sectionName( k, 0 ) == "index" )
-	    nevents++;
-	}
-	// add cell:
-	Cells.addChild( file,
-			sf.metaDataOptions( sf.levels()>0 ? sf.levels()-1 : 0 ),
-			ntraces, nevents );
+	// add cell, its header is read on demand:
+	Cells.addCell( file );
       }
 
     }
 
     Cells.setName( path );
+    if ( ! first )
+      OverviewModel->endResetCells();
 
   }
   print();
@@ -609,6 +754,24 @@ void DataIndex::setDescriptionView( QTreeView *view )
 }
 
 
+int DataIndex::intern( const string &s )
+{
+  map< string, int >::const_iterator sp = StringIds.find( s );
+  if ( sp != StringIds.end() )
+    return sp->second;
+  int id = Strings.size();
+  Strings.push_back( s );
+  StringIds[s] = id;
+  return id;
+}
+
+
+const string &DataIndex::interned( int id ) const
+{
+  return Strings[id];
+}
+
+
 }; /* namespace relacs */
 
 
@@ -0,0 +1,326 @@
+/*
+  deviceopener.cc
+  Opens devices concurrently with per-device timeouts.
+
+  RELACS - Relaxed ELectrophysiological data Acquisition, Control, and Stimulation
+  Copyright (C) 2002-2015 Jan Benda <jan.benda@uni-tuebingen.de>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+  
+  RELACS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QCoreApplication>
+#include <QMutexLocker>
+#include <relacs/str.h>
+#include <relacs/plugins.h>
+#include <relacs/deviceopener.h>
+
+namespace relacs {
+
+
+DeviceOpener::Job::Job( DeviceOpener *opener, Device *device,
+			const string &devicefile, Device *dependency,
+			int dependencyjob )
+  : Opener( opener ),
+    Dev( device ),
+    Ident( device->deviceIdent() ),
+    DeviceFile( devicefile ),
+    Dependency( dependency ),
+    DependencyJob( dependencyjob ),
+    Started( false ),
+    Done( false ),
+    TimedOut( false ),
+    Owned( false ),
+    Error( 0 ),
+    Time( 0.0 )
+{
+}
+
+
+void DeviceOpener::Job::run( void )
+{
+  QTime timer;
+  timer.start();
+  int error = 0;
+  if ( Dependency != 0 )
+    error = Dev->open( *Dependency );
+  else if ( ! DeviceFile.empty() )
+    error = Dev->open( DeviceFile );
+  double time = 0.001*timer.elapsed();
+  Opener->Mutex.lock();
+  Error = error;
+  Time = time;
+  Done = true;
+  Opener->DoneWait.wakeAll();
+  Opener->Mutex.unlock();
+}
+
+
+DeviceOpener::DeviceOpener( void )
+  : Parallel( true ),
+    Timeout( 30.0 )
+{
+}
+
+
+DeviceOpener::~DeviceOpener( void )
+{
+  wait();
+  clear();
+}
+
+
+int DeviceOpener::add( Device *device, const string &devicefile,
+		       Device *dependency )
+{
+  int dependencyjob = -1;
+  if ( dependency != 0 ) {
+    for ( unsigned int k=0; k<Jobs.size(); k++ ) {
+      if ( Jobs[k]->Dev == dependency ) {
+	dependencyjob = k;
+	break;
+      }
+    }
+  }
+  Jobs.push_back( new Job( this, device, devicefile,
+			   dependency, dependencyjob ) );
+  return Jobs.size() - 1;
+}
+
+
+int DeviceOpener::size( void ) const
+{
+  return Jobs.size();
+}
+
+
+void DeviceOpener::clear( void )
+{
+  for ( unsigned int k=0; k<Jobs.size(); k++ ) {
+    if ( Jobs[k]->TimedOut && Jobs[k]->Started )
+      continue;  // owned by Stray
+    Jobs[k]->wait();
+    delete Jobs[k];
+  }
+  Jobs.clear();
+  removeFinished();
+}
+
+
+void DeviceOpener::removeFinished( void )
+{
+  for ( unsigned int k=0; k<Stray.size(); ) {
+    Mutex.lock();
+    bool done = Stray[k]->Done;
+    Mutex.unlock();
+    if ( done ) {
+      Stray[k]->wait();
+      if ( Stray[k]->Owned ) {
+	Device *dev = Stray[k]->Dev;
+	dev->close();
+	Plugins::destroy( dev->deviceClass(), -1 );
+	delete dev;
+      }
+      delete Stray[k];
+      Stray.erase( Stray.begin() + k );
+    }
+    else
+      k++;
+  }
+}
+
+
+bool DeviceOpener::parallel( void ) const
+{
+  return Parallel;
+}
+
+
+void DeviceOpener::setParallel( bool parallel )
+{
+  Parallel = parallel;
+}
+
+
+double DeviceOpener::timeout( void ) const
+{
+  return Timeout;
+}
+
+
+void DeviceOpener::setTimeout( double timeout )
+{
+  Timeout = timeout;
+}
+
+
+void DeviceOpener::open( void )
+{
+  bool guithread = ( QCoreApplication::instance() != 0 &&
+		     QThread::currentThread() == QCoreApplication::instance()->thread() );
+
+  while ( true ) {
+
+    int done = 0;
+    int running = 0;
+    int pending = 0;
+    Str waiting = "";
+
+    Mutex.lock();
+    for ( unsigned int k=0; k<Jobs.size(); k++ ) {
+      Job *job = Jobs[k];
+      if ( job->Done || job->TimedOut ) {
+	done++;
+	continue;
+      }
+      if ( job->Started ) {
+	if ( Timeout > 0.0 && job->Timer.elapsed() > 1000.0*Timeout ) {
+	  // give up on this device:
+	  job->TimedOut = true;
+	  job->Time = 0.001*job->Timer.elapsed();
+	  Stray.push_back( job );
+	  done++;
+	}
+	else {
+	  running++;
+	  if ( ! waiting.empty() )
+	    waiting += ", ";
+	  waiting += job->Dev->deviceIdent();
+	}
+	continue;
+      }
+      // device opened with another device:
+      if ( job->DependencyJob >= 0 ) {
+	Job *dependency = Jobs[job->DependencyJob];
+	if ( dependency->TimedOut ) {
+	  job->TimedOut = true;
+	  done++;
+	  continue;
+	}
+	if ( ! dependency->Done ) {
+	  pending++;
+	  continue;
+	}
+      }
+      else if ( job->Dependency != 0 ) {
+	bool stray = false;
+	for ( unsigned int j=0; j<Stray.size(); j++ ) {
+	  if ( Stray[j]->Dev == job->Dependency && ! Stray[j]->Done ) {
+	    stray = true;
+	    break;
+	  }
+	}
+	if ( stray ) {
+	  job->TimedOut = true;
+	  done++;
+	  continue;
+	}
+      }
+      if ( ! Parallel && running > 0 ) {
+	pending++;
+	continue;
+      }
+      // open device:
+      job->Started = true;
+      job->Timer.start();
+      job->start();
+      running++;
+      if ( ! waiting.empty() )
+	waiting += ", ";
+      waiting += job->Dev->deviceIdent();
+    }
+    Mutex.unlock();
+
+    if ( running == 0 && pending == 0 )
+      break;
+
+    emit progress( QString( "Opening devices: %1 of %2 done, waiting for %3" )
+		   .arg( done ).arg( Jobs.size() ).arg( waiting.c_str() ) );
+
+    Mutex.lock();
+    DoneWait.wait( &Mutex, 100 );
+    Mutex.unlock();
+
+    if ( guithread )
+      QCoreApplication::processEvents( QEventLoop::ExcludeUserInputEvents );
+  }
+
+  emit progress( "" );
+}
+
+
+void DeviceOpener::wait( void )
+{
+  for ( unsigned int k=0; k<Stray.size(); k++ )
+    Stray[k]->wait();
+  removeFinished();
+}
+
+
+bool DeviceOpener::opening( const string &ident ) const
+{
+  QMutexLocker locker( &Mutex );
+  for ( unsigned int k=0; k<Stray.size(); k++ ) {
+    if ( Stray[k]->Ident == ident && ! Stray[k]->Done )
+      return true;
+  }
+  return false;
+}
+
+
+void DeviceOpener::adopt( int job )
+{
+  QMutexLocker locker( &Mutex );
+  if ( Jobs[job]->TimedOut && Jobs[job]->Started )
+    Jobs[job]->Owned = true;
+}
+
+
+Device *DeviceOpener::device( int job ) const
+{
+  return Jobs[job]->Dev;
+}
+
+
+bool DeviceOpener::started( int job ) const
+{
+  QMutexLocker locker( &Mutex );
+  return Jobs[job]->Started;
+}
+
+
+int DeviceOpener::error( int job ) const
+{
+  QMutexLocker locker( &Mutex );
+  return Jobs[job]->Error;
+}
+
+
+bool DeviceOpener::timedOut( int job ) const
+{
+  QMutexLocker locker( &Mutex );
+  return Jobs[job]->TimedOut;
+}
+
+
+double DeviceOpener::time( int job ) const
+{
+  QMutexLocker locker( &Mutex );
+  return Jobs[job]->Time;
+}
+
+
+}; /* namespace relacs */
+
+#include "moc_deviceopener.cc"
+
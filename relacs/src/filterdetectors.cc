@@ -24,6 +24,7 @@
 #include <relacs/str.h>
 #include <relacs/repros.h>
 #include <relacs/filter.h>
+#include <relacs/profiler.h>
 #include <relacs/session.h>
 #include <relacs/savefiles.h>
 #include <relacs/relacsdevices.h>
@@ -980,6 +981,10 @@ string FilterDetectors::filter( double signaltime )
     string ident = (*d)->FilterDetector->ident();
     const EventData &stimulusevents = (*d)->FilterDetector->stimulusEvents();
 
+    if ( (*d)->ProfileId < 0 && Profiler::enabled() )
+      (*d)->ProfileId = Profiler::id( ( (*d)->FilterDetector->type() & Filter::EventDetector ? "Detector " : "Filter " ) + ident );
+    ProfileTimer profiletimer( (*d)->ProfileId );
+
     (*d)->FilterDetector->lock();
     if ( (*d)->FilterDetector->type() & Filter::EventDetector ) {
       if ( (*d)->FilterDetector->type() & Filter::EventInput ) {
@@ -1403,7 +1408,7 @@ FilterData::FilterData( Filter *filter,
     InTraces(), InEvents(), OutTraces(), OutEvents(), OtherEvents(),
     NBuffer( n ), SizeBuffer( size ), WidthBuffer( width ),
     PanelTrace( panel ), LineWidth( linewidth ), Init( true ),
-    GeneralOptions(generalOptions)
+    GeneralOptions(generalOptions), ProfileId( -1 )
 {
   FilterDetector = filter;
   NOut = filter->outTraces();
@@ -1419,7 +1424,7 @@ FilterData::FilterData( const FilterData &fd )
     NBuffer( fd.NBuffer ), SizeBuffer( fd.SizeBuffer ),
     WidthBuffer( fd.WidthBuffer ),
     PanelTrace( fd.PanelTrace ), LineWidth( fd.LineWidth ), Init( fd.Init ),
-    GeneralOptions(fd.GeneralOptions)
+    GeneralOptions(fd.GeneralOptions), ProfileId( fd.ProfileId )
 {
   FilterDetector = fd.FilterDetector;
   Out = fd.Out;
@@ -0,0 +1,286 @@
+/*
+  liveexport.cc
+  Exports input traces and events to POSIX shared memory
+
+  RELACS - Relaxed ELectrophysiological data Acquisition, Control, and Stimulation
+  Copyright (C) 2002-2015 Jan Benda <jan.benda@uni-tuebingen.de>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+  
+  RELACS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <relacs/liveexport.h>
+
+namespace relacs {
+
+
+  /*! Round \a n up to the next multiple of RELACS_SHM_ALIGN. */
+static size_t alignShm( size_t n )
+{
+  return ( ( n + RELACS_SHM_ALIGN - 1 ) / RELACS_SHM_ALIGN ) * RELACS_SHM_ALIGN;
+}
+
+
+  /*! Copy \a s into the zero terminated character array \a dest of size \a n. */
+static void copyString( char *dest, const string &s, size_t n )
+{
+  strncpy( dest, s.c_str(), n-1 );
+  dest[n-1] = '\0';
+}
+
+
+LiveExport::LiveExport( void )
+  : Name( "" ),
+    Error( "" ),
+    Segment( 0 ),
+    Size( 0 ),
+    Header( 0 ),
+    Traces( 0 ),
+    Events( 0 ),
+    IL( 0 ),
+    EL( 0 )
+{
+}
+
+
+LiveExport::~LiveExport( void )
+{
+  close();
+}
+
+
+int LiveExport::open( const InList &data, const EventList &events,
+		      const string &name, double duration )
+{
+  close();
+  Error = "";
+
+  // layout of the segment:
+  int ntraces = data.size();
+  int nevents = events.size();
+  size_t size = alignShm( sizeof( relacs_shm_header ) +
+			  ntraces*sizeof( relacs_shm_trace ) +
+			  nevents*sizeof( relacs_shm_events ) );
+  vector< size_t > traceoffsets( ntraces, 0 );
+  vector< size_t > tracecapacities( ntraces, 0 );
+  for ( int k=0; k<ntraces; k++ ) {
+    size_t capacity = (size_t)::ceil( duration/data[k].sampleInterval() );
+    if ( capacity < 1024 )
+      capacity = 1024;
+    traceoffsets[k] = size;
+    tracecapacities[k] = capacity;
+    size += alignShm( capacity*sizeof( float ) );
+  }
+  vector< size_t > eventoffsets( nevents, 0 );
+  vector< size_t > sizeoffsets( nevents, 0 );
+  vector< size_t > eventcapacities( nevents, 0 );
+  for ( int k=0; k<nevents; k++ ) {
+    size_t capacity = events[k].capacity() > 1024 ? events[k].capacity() : 1024;
+    eventoffsets[k] = size;
+    eventcapacities[k] = capacity;
+    size += alignShm( capacity*sizeof( double ) );
+    if ( events[k].sizeBuffer() ) {
+      sizeoffsets[k] = size;
+      size += alignShm( capacity*sizeof( double ) );
+    }
+  }
+
+  // create segment:
+  shm_unlink( name.c_str() );
+  int fd = shm_open( name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644 );
+  if ( fd < 0 ) {
+    Error = "cannot create shared memory segment " + name + ": " + strerror( errno );
+    return -1;
+  }
+  if ( ftruncate( fd, size ) < 0 ) {
+    Error = "cannot resize shared memory segment " + name + ": " + strerror( errno );
+    ::close( fd );
+    shm_unlink( name.c_str() );
+    return -1;
+  }
+  void *segment = mmap( 0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+  ::close( fd );
+  if ( segment == MAP_FAILED ) {
+    Error = "cannot map shared memory segment " + name + ": " + strerror( errno );
+    shm_unlink( name.c_str() );
+    return -1;
+  }
+
+  Name = name;
+  Segment = (char *)segment;
+  Size = size;
+  Header = (relacs_shm_header *)Segment;
+  Traces = (relacs_shm_trace *)( Segment + sizeof( relacs_shm_header ) );
+  Events = (relacs_shm_events *)( Traces + ntraces );
+  IL = &data;
+  EL = &events;
+
+  // descriptions (the segment is zero initialized by ftruncate()):
+  memcpy( Header->magic, RELACS_SHM_MAGIC, sizeof( Header->magic ) );
+  Header->version = RELACS_SHM_VERSION;
+  Header->ntraces = ntraces;
+  Header->nevents = nevents;
+  Header->size = size;
+  TraceIndex.resize( ntraces );
+  for ( int k=0; k<ntraces; k++ ) {
+    copyString( Traces[k].ident, data[k].ident(), RELACS_SHM_IDENT );
+    copyString( Traces[k].unit, data[k].unit(), RELACS_SHM_UNIT );
+    Traces[k].sampleinterval = data[k].sampleInterval();
+    Traces[k].offset = traceoffsets[k];
+    Traces[k].capacity = tracecapacities[k];
+    TraceIndex[k] = data[k].size();
+    Traces[k].writing = TraceIndex[k];
+    Traces[k].written = TraceIndex[k];
+  }
+  EventIndex.resize( nevents );
+  for ( int k=0; k<nevents; k++ ) {
+    copyString( Events[k].ident, events[k].ident(), RELACS_SHM_IDENT );
+    copyString( Events[k].sizeunit, events[k].sizeUnit(), RELACS_SHM_UNIT );
+    Events[k].offset = eventoffsets[k];
+    Events[k].sizeoffset = sizeoffsets[k];
+    Events[k].capacity = eventcapacities[k];
+    EventIndex[k] = events[k].size();
+    Events[k].writing = EventIndex[k];
+    Events[k].written = EventIndex[k];
+  }
+  __atomic_store_n( &Header->active, 1, __ATOMIC_RELEASE );
+
+  return 0;
+}
+
+
+bool LiveExport::isOpen( void ) const
+{
+  return ( Segment != 0 );
+}
+
+
+string LiveExport::name( void ) const
+{
+  return Name;
+}
+
+
+string LiveExport::error( void ) const
+{
+  return Error;
+}
+
+
+void LiveExport::update( void )
+{
+  if ( Segment == 0 )
+    return;
+
+  for ( unsigned int k=0; k<TraceIndex.size(); k++ ) {
+    const InData &data = (*IL)[k];
+    relacs_shm_trace &trace = Traces[k];
+    int from = TraceIndex[k];
+    int to = data.size();
+    if ( to <= from )
+      continue;
+    if ( from < data.minIndex() )
+      from = data.minIndex();
+    if ( (uint64_t)( to - from ) > trace.capacity )
+      from = to - trace.capacity;
+    // announce the elements that are going to be overwritten.
+    // If data were dropped, the buffer still holds stale elements
+    // in front of from, so writing is advanced to invalidate them:
+    uint64_t writing = to;
+    if ( from > TraceIndex[k] && from + trace.capacity > writing )
+      writing = from + trace.capacity;
+    if ( writing < trace.writing )
+      writing = trace.writing;
+    __atomic_store_n( &trace.writing, writing, __ATOMIC_RELAXED );
+    __atomic_thread_fence( __ATOMIC_RELEASE );
+    float *buffer = (float *)( Segment + trace.offset );
+    while ( from < to ) {
+      int n = 0;
+      const float *src = data.readBuffer( from, n );
+      if ( n > to - from )
+	n = to - from;
+      // split at the end of the cyclic buffer in the segment:
+      size_t pos = from % trace.capacity;
+      if ( pos + n > trace.capacity )
+	n = trace.capacity - pos;
+      memcpy( buffer + pos, src, n*sizeof( float ) );
+      from += n;
+    }
+    __atomic_store_n( &trace.written, (uint64_t)to, __ATOMIC_RELEASE );
+    TraceIndex[k] = to;
+  }
+
+  for ( unsigned int k=0; k<EventIndex.size(); k++ ) {
+    const EventData &events = (*EL)[k];
+    relacs_shm_events &ev = Events[k];
+    int from = EventIndex[k];
+    int to = events.size();
+    if ( to <= from )
+      continue;
+    if ( from < events.minEvent() )
+      from = events.minEvent();
+    if ( (uint64_t)( to - from ) > ev.capacity )
+      from = to - ev.capacity;
+    uint64_t writing = to;
+    if ( from > EventIndex[k] && from + ev.capacity > writing )
+      writing = from + ev.capacity;
+    if ( writing < ev.writing )
+      writing = ev.writing;
+    __atomic_store_n( &ev.writing, writing, __ATOMIC_RELAXED );
+    __atomic_thread_fence( __ATOMIC_RELEASE );
+    double *times = (double *)( Segment + ev.offset );
+    double *sizes = ev.sizeoffset > 0 ? (double *)( Segment + ev.sizeoffset ) : 0;
+    for ( int i=from; i<to; i++ ) {
+      size_t pos = i % ev.capacity;
+      times[pos] = events[i];
+      if ( sizes != 0 )
+	sizes[pos] = events.eventSize( i );
+    }
+    __atomic_store_n( &ev.written, (uint64_t)to, __ATOMIC_RELEASE );
+    EventIndex[k] = to;
+  }
+
+  if ( IL->size() > 0 )
+    Header->time = (*IL)[0].currentTime();
+  __atomic_add_fetch( &Header->updates, 1, __ATOMIC_RELEASE );
+}
+
+
+void LiveExport::close( void )
+{
+  if ( Segment == 0 )
+    return;
+  __atomic_store_n( &Header->active, 0, __ATOMIC_RELEASE );
+  munmap( Segment, Size );
+  shm_unlink( Name.c_str() );
+  Segment = 0;
+  Size = 0;
+  Header = 0;
+  Traces = 0;
+  Events = 0;
+  IL = 0;
+  EL = 0;
+  TraceIndex.clear();
+  EventIndex.clear();
+}
+
+
+}; /* namespace relacs */
+
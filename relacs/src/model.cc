@@ -20,6 +20,7 @@
 */
 
 #include <QAction>
+#include <relacs/profiler.h>
 #include <relacs/relacswidget.h>
 #include <relacs/model.h>
 
@@ -95,6 +96,8 @@ void Model::push( int trace, float val )
 
 void Model::next( void )
 {
+  static const int profileid = Profiler::id( "Model::next" );
+  long long profilestart = Profiler::enabled() ? Profiler::now() : -1;
   double t = Data[0].currentTime();
   if ( AIDevice != 0 ) {
     // compute dynamic clamp model:
@@ -128,8 +131,15 @@ void Model::next( void )
     if ( st <= 0 )
       st = 1;
     DataWait->wakeAll();
+    // do not count the time waiting for the simulated acquisition:
+    if ( profilestart >= 0 ) {
+      Profiler::record( profileid, profilestart, Profiler::now() );
+      profilestart = -1;
+    }
     InputWait.wait( DataMutex, st );
   }
+  if ( profilestart >= 0 )
+    Profiler::record( profileid, profilestart, Profiler::now() );
 }
 
 
@@ -188,9 +198,9 @@ double Model::signal( double t, int trace ) const
     int inx = Signals[trace].Buffer.index( t );
     if ( inx < 0 )
       inx = 0;
-    else if ( inx >= Signals[trace].Buffer.size() )
-      inx = Signals[trace].Buffer.size()-1;
-    Signals[trace].LastSignal = Signals[trace].Buffer[inx];
+    else if ( inx >= Signals[trace].Buffer.deviceSize() )
+      inx = Signals[trace].Buffer.deviceSize()-1;
+    Signals[trace].LastSignal = Signals[trace].Buffer.streamValue( inx );
   }
   return Signals[trace].LastSignal + Signals[trace].ModelValue;
 }
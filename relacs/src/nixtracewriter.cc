@@ -0,0 +1,248 @@
+/*
+  nixtracewriter.cc
+  Gathers trace data into chunks and writes them to a NIX file in the background.
+
+  RELACS - Relaxed ELectrophysiological data Acquisition, Control, and Stimulation
+  Copyright (C) 2002-2015 Jan Benda <jan.benda@uni-tuebingen.de>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+  
+  RELACS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifdef HAVE_NIX
+
+#include <cmath>
+#include <iostream>
+#include <QMutexLocker>
+#include <relacs/nixtracewriter.h>
+
+namespace relacs {
+
+
+NixTraceWriter::NixTraceWriter( void )
+  : QThread(),
+    MaxQueue( 16 ),
+    Writing( false ),
+    Stop( false ),
+    Written( 0 ),
+    Stalls( 0 ),
+    NixMutex( QMutex::Recursive )
+{
+}
+
+
+NixTraceWriter::~NixTraceWriter( void )
+{
+  stop();
+}
+
+
+size_t NixTraceWriter::chunkSize( double samplerate )
+{
+  size_t n = 4096;
+  while ( n < samplerate && n < 131072 )
+    n *= 2;
+  return n;
+}
+
+
+int NixTraceWriter::addTrace( const nix::DataArray &data, size_t chunksize )
+{
+  Trace trace;
+  trace.Data = data;
+  trace.ChunkSize = chunksize > 0 ? chunksize : 4096;
+  trace.Offset = { 0 };
+  trace.Buffer.reserve( trace.ChunkSize );
+  Traces.push_back( trace );
+  QMutexLocker locker( &QueueMutex );
+  // enough chunks of all traces for the writing thread to lag behind a bit:
+  MaxQueue = 4*Traces.size();
+  if ( MaxQueue < 16 )
+    MaxQueue = 16;
+  return Traces.size() - 1;
+}
+
+
+void NixTraceWriter::clearTraces( void )
+{
+  Traces.clear();
+}
+
+
+int NixTraceWriter::traces( void ) const
+{
+  return Traces.size();
+}
+
+
+void NixTraceWriter::append( int trace, const float *data, size_t n )
+{
+  Trace &tr = Traces[trace];
+  while ( n > 0 ) {
+    size_t m = tr.ChunkSize - tr.Buffer.size();
+    if ( m > n )
+      m = n;
+    tr.Buffer.insert( tr.Buffer.end(), data, data + m );
+    data += m;
+    n -= m;
+    if ( tr.Buffer.size() >= tr.ChunkSize )
+      queueChunk( tr );
+  }
+}
+
+
+void NixTraceWriter::queueChunk( Trace &trace )
+{
+  if ( trace.Buffer.empty() )
+    return;
+
+  typedef nix::NDSize::value_type value_type;
+  nix::NDSize count = { static_cast< value_type >( trace.Buffer.size() ) };
+
+  Chunk chunk;
+  chunk.Data = trace.Data;
+  chunk.Offset = trace.Offset;
+  chunk.Buffer.swap( trace.Buffer );
+  trace.Offset = trace.Offset + count;
+  trace.Buffer.reserve( trace.ChunkSize );
+
+  if ( ! isRunning() ) {
+    // no thread, write directly:
+    QMutexLocker locker( &NixMutex );
+    try {
+      nix::NDSize size = chunk.Offset + count;
+      chunk.Data.dataExtent( size );
+      chunk.Data.setData( nix::DataType::Float, chunk.Buffer.data(),
+			  count, chunk.Offset );
+    }
+    catch ( ... ) {
+      cerr << "NixTraceWriter: failed to write chunk of " << chunk.Buffer.size()
+	   << " data elements to " << chunk.Data.name() << '\n';
+    }
+    Written += chunk.Buffer.size();
+    return;
+  }
+
+  QMutexLocker locker( &QueueMutex );
+  if ( (int)Queue.size() >= MaxQueue ) {
+    // the writing thread cannot keep up:
+    Stalls++;
+    while ( (int)Queue.size() >= MaxQueue )
+      DoneWait.wait( &QueueMutex );
+  }
+  Queue.push_back( Chunk() );
+  Queue.back().Data = chunk.Data;
+  Queue.back().Offset = chunk.Offset;
+  Queue.back().Buffer.swap( chunk.Buffer );
+  QueueWait.wakeAll();
+}
+
+
+void NixTraceWriter::flush( void )
+{
+  for ( unsigned int k=0; k<Traces.size(); k++ )
+    queueChunk( Traces[k] );
+  QMutexLocker locker( &QueueMutex );
+  while ( ! Queue.empty() || Writing )
+    DoneWait.wait( &QueueMutex );
+}
+
+
+void NixTraceWriter::start( void )
+{
+  QueueMutex.lock();
+  Stop = false;
+  QueueMutex.unlock();
+  QThread::start();
+}
+
+
+void NixTraceWriter::stop( void )
+{
+  // without a thread the remaining chunks are written directly:
+  flush();
+  if ( ! isRunning() )
+    return;
+  QueueMutex.lock();
+  Stop = true;
+  QueueWait.wakeAll();
+  QueueMutex.unlock();
+  wait();
+}
+
+
+QMutex *NixTraceWriter::mutex( void )
+{
+  return &NixMutex;
+}
+
+
+size_t NixTraceWriter::written( void ) const
+{
+  QMutexLocker locker( &QueueMutex );
+  return Written;
+}
+
+
+int NixTraceWriter::stalls( void ) const
+{
+  QMutexLocker locker( &QueueMutex );
+  return Stalls;
+}
+
+
+void NixTraceWriter::run( void )
+{
+  QueueMutex.lock();
+  while ( true ) {
+    while ( Queue.empty() && ! Stop )
+      QueueWait.wait( &QueueMutex );
+    if ( Queue.empty() )
+      break;
+    Chunk chunk;
+    chunk.Data = Queue.front().Data;
+    chunk.Offset = Queue.front().Offset;
+    chunk.Buffer.swap( Queue.front().Buffer );
+    Queue.pop_front();
+    Writing = true;
+    DoneWait.wakeAll();
+    QueueMutex.unlock();
+
+    // extend the data array and write the chunk, this compresses the data:
+    typedef nix::NDSize::value_type value_type;
+    nix::NDSize count = { static_cast< value_type >( chunk.Buffer.size() ) };
+    NixMutex.lock();
+    try {
+      nix::NDSize size = chunk.Offset + count;
+      chunk.Data.dataExtent( size );
+      chunk.Data.setData( nix::DataType::Float, chunk.Buffer.data(),
+			  count, chunk.Offset );
+    }
+    catch ( ... ) {
+      cerr << "NixTraceWriter: failed to write chunk of " << chunk.Buffer.size()
+	   << " data elements to " << chunk.Data.name() << '\n';
+    }
+    NixMutex.unlock();
+
+    QueueMutex.lock();
+    Written += chunk.Buffer.size();
+    Writing = false;
+    DoneWait.wakeAll();
+  }
+  QueueMutex.unlock();
+}
+
+
+}; /* namespace relacs */
+
+#endif /* HAVE_NIX */
@@ -0,0 +1,131 @@
+/*
+  nixwritebench.cc
+  Benchmark for writing traces to NIX files with and without compression.
+
+  RELACS - Relaxed ELectrophysiological data Acquisition, Control, and Stimulation
+  Copyright (C) 2002-2015 Jan Benda <jan.benda@uni-tuebingen.de>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+  
+  RELACS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cmath>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include <nix.hpp>
+#include <relacs/random.h>
+#include <relacs/nixtracewriter.h>
+using namespace std;
+using namespace relacs;
+
+
+  // Write \a channels traces sampled with \a rate for \a duration seconds
+  // in updates of \a update seconds to \a path.
+  // If \a chunked, use the NixTraceWriter, otherwise extend
+  // and write each update directly.
+void benchmark( const string &path, bool compression, bool chunked,
+		int channels, double rate, double duration, double update )
+{
+  typedef nix::NDSize::value_type value_type;
+  nix::Compression compr = compression ? nix::Compression::DeflateNormal : nix::Compression::None;
+  nix::File fd = nix::File::open( path, nix::FileMode::Overwrite, "hdf5", compr );
+  nix::Block block = fd.createBlock( "benchmark", "relacs.recording" );
+
+  // synthetic recordings: noisy oscillations with different frequencies:
+  int nupdate = (int)::rint( update*rate );
+  vector< vector< float > > data( channels, vector< float >( nupdate ) );
+  vector< nix::DataArray > arrays;
+  vector< nix::NDSize > offsets( channels, nix::NDSize( { 0 } ) );
+  NixTraceWriter writer;
+  size_t chunksize = chunked ? NixTraceWriter::chunkSize( rate ) : 4096;
+  for ( int c=0; c<channels; c++ ) {
+    nix::DataArray da = block.createDataArray( "V-" + to_string( c+1 ), "relacs.data.sampled",
+					       nix::DataType::Float, { 0 } );
+    da.appendSampledDimension( 1.0/rate );
+    arrays.push_back( da );
+    if ( chunked )
+      writer.addTrace( da, chunksize );
+  }
+  if ( chunked )
+    writer.start();
+
+  int nupdates = (int)::rint( duration/update );
+  double maxupdate = 0.0;
+  auto t0 = chrono::steady_clock::now();
+  for ( int u=0; u<nupdates; u++ ) {
+    for ( int c=0; c<channels; c++ ) {
+      for ( int k=0; k<nupdate; k++ ) {
+	double t = ( u*nupdate + k )/rate;
+	data[c][k] = ::sin( 2.0*M_PI*(10.0+10.0*c)*t ) + 0.1*rnd.gaussian();
+      }
+    }
+    auto t1 = chrono::steady_clock::now();
+    for ( int c=0; c<channels; c++ ) {
+      if ( chunked )
+	writer.append( c, data[c].data(), nupdate );
+      else {
+	nix::NDSize count = { static_cast< value_type >( nupdate ) };
+	nix::NDSize size = offsets[c] + count;
+	arrays[c].dataExtent( size );
+	arrays[c].setData( nix::DataType::Float, data[c].data(), count, offsets[c] );
+	offsets[c] = size;
+      }
+    }
+    double dt = chrono::duration< double >( chrono::steady_clock::now() - t1 ).count();
+    if ( dt > maxupdate )
+      maxupdate = dt;
+  }
+  if ( chunked )
+    writer.stop();
+  fd.close();
+  double total = chrono::duration< double >( chrono::steady_clock::now() - t0 ).count();
+
+  struct stat st;
+  double filesize = ::stat( path.c_str(), &st ) == 0 ? st.st_size : 0.0;
+  double rawsize = double( channels )*nupdates*nupdate*sizeof( float );
+  cout << setw( 12 ) << ( compression ? "deflate" : "none" )
+       << setw( 10 ) << ( chunked ? "chunked" : "direct" )
+       << setw( 14 ) << setprecision( 4 ) << rawsize/total/1.0e6
+       << setw( 16 ) << setprecision( 4 ) << 1000.0*maxupdate
+       << setw( 14 ) << setprecision( 4 ) << filesize/1.0e6
+       << setw( 10 ) << setprecision( 3 ) << filesize/rawsize
+       << setw( 8 ) << ( chunked ? writer.stalls() : 0 ) << '\n';
+  ::remove( path.c_str() );
+}
+
+
+int main( int argc, char *argv[] )
+{
+  int channels = 32;
+  double rate = 50000.0;
+  double duration = 60.0;
+  double update = 0.01;
+  if ( argc > 1 )
+    duration = atof( argv[1] );
+  string path = "nixwritebench.nix";
+
+  cout << channels << " channels at " << 0.001*rate << "kHz for "
+       << duration << "s in updates of " << 1000.0*update << "ms\n";
+  cout << "compression    writing  bandwidth MB/s  max update ms  file size MB     ratio  stalls\n";
+  for ( int c=0; c<2; c++ ) {
+    for ( int k=0; k<2; k++ )
+      benchmark( path, c > 0, k > 0, channels, rate, duration, update );
+  }
+  return 0;
+}
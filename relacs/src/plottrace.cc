@@ -32,6 +32,7 @@
 #include <relacs/str.h>
 #include <relacs/datafile.h>
 #include <relacs/filterdetectors.h>
+#include <relacs/profiler.h>
 #include <relacs/relacswidget.h>
 #include <relacs/plottrace.h>
 
@@ -523,6 +524,9 @@ void PlotTrace::plot( void )
   if ( !plotting ) 
     return;
 
+  static const int profileid = Profiler::id( "PlotTrace::plot" );
+  ProfileTimer profiletimer( profileid );
+
   // get data:
   lock();
   getData();
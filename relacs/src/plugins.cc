@@ -19,10 +19,14 @@
   along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <cctype>
 #include <cstdlib>
 #include <dlfcn.h>
+#include <sys/stat.h>
 #include <fstream>
 #include <iostream>
+#include <sstream>
+#include <set>
 #include <QDir>
 #include <QFileInfo>
 #include <relacs/str.h>
@@ -44,6 +48,9 @@ Plugins::FilesType Plugins::Files;
 string Plugins::LibraryErrors = "";
 string Plugins::ClassErrors = "";
 int Plugins::CurrentFileID = 0;
+Plugins::ManifestType Plugins::Manifest;
+string Plugins::ManifestFile = "";
+bool Plugins::ManifestChanged = false;
 
 
 Plugins::Plugins( void )
@@ -60,9 +67,13 @@ int Plugins::open( const string &file )
 {
   // already loaded?
   unsigned int index;
-  for ( index=0; index<Files.size(); index++ )
-    if ( Files[index].File == file && Files[index].Lib != 0 )
-      return -AlreadyLoaded;
+  for ( index=0; index<Files.size(); index++ ) {
+    if ( Files[index].File == file ) {
+      if ( Files[index].Lib != 0 )
+	return -AlreadyLoaded;
+      break;
+    }
+  }
 
   // load plugin file:
   CurrentFileID = newFileID();
@@ -132,11 +143,28 @@ int Plugins::open( int id )
 
 int Plugins::openPath( const string &path, const string &relativepath,
 		       const StrQueue &pluginhomes )
+{
+  StrQueue files;
+  libraryFiles( path, relativepath, pluginhomes, files );
+
+  int n = 0;
+  for ( int k=0; k<files.size(); k++ ) {
+    int r = open( files[k] );
+    if ( r >= 0 || r == -AlreadyLoaded )
+      n ++;
+  }
+  
+  return n;
+}
+
+
+void Plugins::libraryFiles( const string &path, const string &relativepath,
+			    const StrQueue &pluginhomes, StrQueue &files )
 {
   Str p( path );
   p.strip();
   if ( p.empty() )
-    return 0;
+    return;
 
   // add pattern:
   if ( p[p.size()-1] == '/' )
@@ -164,8 +192,7 @@ int Plugins::openPath( const string &path, const string &relativepath,
     rps = "";
   }
 
-  // read all libraries specified by path:
-  int n = 0;
+  // all libraries specified by path:
   for ( int j=0; j<rps.size(); j++ ) {
     // add relative path:
     Str file = p;
@@ -178,19 +205,14 @@ int Plugins::openPath( const string &path, const string &relativepath,
     if ( filename.substr( 0, 3 ) != "lib" )
       filename = "lib" + filename;
     // look for files in directory:
-    QDir files( file.dir().c_str(), filename.c_str() );
-    for ( unsigned int k=0; k < files.count(); k++ ) {
-      Str libfile = files.absoluteFilePath( files[k] ).toStdString();
+    QDir dir( file.dir().c_str(), filename.c_str() );
+    for ( unsigned int k=0; k < dir.count(); k++ ) {
+      Str libfile = dir.absoluteFilePath( dir[k] ).toStdString();
       QFileInfo qfi( libfile.c_str() );
-      if ( qfi.exists() ) {
-	int r = open( libfile );
-	if ( r >= 0 || r == -AlreadyLoaded )
-	  n ++;
-      }
+      if ( qfi.exists() )
+	files.add( libfile );
     }
   }
-  
-  return n;
 }
 
 
@@ -221,6 +243,239 @@ int Plugins::openFile( const string &file )
 }
 
 
+int Plugins::setManifest( const string &file )
+{
+  ManifestFile = file;
+  Manifest.clear();
+  ManifestChanged = false;
+
+  ifstream mf( file.c_str() );
+  if ( !mf )
+    return 0;
+
+  string line;
+  bool version = false;
+  while ( getline( mf, line ) ) {
+    if ( line.empty() || line[0] == '#' )
+      continue;
+    istringstream ls( line );
+    string key;
+    ls >> key;
+    if ( key == "version:" ) {
+      string v;
+      ls >> v;
+      if ( v != Version )
+	break;
+      version = true;
+    }
+    else if ( ! version )
+      break;
+    else if ( key == "library:" ) {
+      long mtime = 0;
+      long size = 0;
+      string lib;
+      ls >> mtime >> size >> ws;
+      getline( ls, lib );
+      if ( ! lib.empty() )
+	Manifest.push_back( ManifestInfo( lib, mtime, size ) );
+    }
+    else if ( key == "plugin:" && ! Manifest.empty() ) {
+      int type = 0;
+      string ident;
+      ls >> type >> ident;
+      if ( ! ident.empty() ) {
+	Manifest.back().Idents.push_back( ident );
+	Manifest.back().Types.push_back( type );
+      }
+    }
+  }
+
+  // manifest of a different version is useless:
+  if ( ! version ) {
+    Manifest.clear();
+    ManifestChanged = true;
+  }
+
+  return Manifest.size();
+}
+
+
+int Plugins::saveManifest( void )
+{
+  if ( ManifestFile.empty() )
+    return -CantGetFiles;
+  if ( ! ManifestChanged )
+    return Manifest.size();
+
+  ofstream mf( ManifestFile.c_str() );
+  if ( !mf )
+    return -CantGetFiles;
+
+  mf << "# RELACS plugin manifest, generated automatically.\n";
+  mf << "version: " << Version << '\n';
+  int n = 0;
+  for ( unsigned int k=0; k<Manifest.size(); k++ ) {
+    // skip libraries that are no longer in the file list:
+    unsigned int j;
+    for ( j=0; j<Files.size() && Files[j].File != Manifest[k].File; j++ );
+    if ( j >= Files.size() )
+      continue;
+    mf << "library: " << Manifest[k].MTime << ' ' << Manifest[k].Size
+       << ' ' << Manifest[k].File << '\n';
+    for ( unsigned int i=0; i<Manifest[k].Idents.size(); i++ )
+      mf << "plugin: " << Manifest[k].Types[i] << ' '
+	 << Manifest[k].Idents[i] << '\n';
+    n++;
+  }
+  if ( !mf )
+    return -CantGetFiles;
+
+  ManifestChanged = false;
+  return n;
+}
+
+
+int Plugins::scanPath( const string &path, const string &relativepath,
+		       const StrQueue &pluginhomes )
+{
+  StrQueue files;
+  libraryFiles( path, relativepath, pluginhomes, files );
+
+  int n = 0;
+  for ( int k=0; k<files.size(); k++ ) {
+    // already in the list?
+    unsigned int j;
+    for ( j=0; j<Files.size() && Files[j].File != files[k]; j++ );
+    if ( j < Files.size() ) {
+      n++;
+      continue;
+    }
+
+    // known library:
+    if ( manifestIndex( files[k] ) >= 0 ) {
+      Files.push_back( FileInfo( files[k], 0, newFileID() ) );
+      n++;
+      continue;
+    }
+
+    // unknown or modified library, load it to get its plugins:
+    for ( ManifestType::iterator mp = Manifest.begin(); mp != Manifest.end(); ) {
+      if ( mp->File == files[k] )
+	mp = Manifest.erase( mp );
+      else
+	++mp;
+    }
+    ManifestChanged = true;
+    int r = open( files[k] );
+    if ( r < 0 )
+      continue;
+    n++;
+    struct stat fs;
+    if ( ::stat( files[k].c_str(), &fs ) != 0 )
+      continue;
+    Manifest.push_back( ManifestInfo( files[k], fs.st_mtime, fs.st_size ) );
+    for ( unsigned int i=0; i<Plugs.size(); i++ ) {
+      if ( Plugs[i].FileID == r ) {
+	Manifest.back().Idents.push_back( Plugs[i].Ident );
+	Manifest.back().Types.push_back( Plugs[i].Type );
+      }
+    }
+  }
+
+  return n;
+}
+
+
+int Plugins::openReferenced( const StrQueue &files )
+{
+  // collect all words of the files:
+  set< string > words;
+  for ( int k=0; k<files.size(); k++ ) {
+    ifstream cf( files[k].c_str() );
+    string line;
+    while ( getline( cf, line ) ) {
+      string::size_type p = 0;
+      while ( p < line.size() ) {
+	while ( p < line.size() && ! isalnum( (unsigned char)line[p] ) && line[p] != '_' )
+	  p++;
+	string::size_type e = p;
+	while ( e < line.size() && ( isalnum( (unsigned char)line[e] ) || line[e] == '_' ) )
+	  e++;
+	if ( e > p )
+	  words.insert( line.substr( p, e-p ) );
+	p = e;
+      }
+    }
+  }
+
+  // load libraries containing referenced plugins:
+  int n = 0;
+  for ( unsigned int k=0; k<Files.size(); k++ ) {
+    if ( Files[k].Lib != 0 )
+      continue;
+    int m = manifestIndex( Files[k].File );
+    if ( m < 0 )
+      continue;
+    for ( unsigned int i=0; i<Manifest[m].Idents.size(); i++ ) {
+      string ps = Manifest[m].Idents[i];
+      string::size_type p = ps.find( '[' );
+      if ( p != string::npos )
+	ps.resize( p );
+      if ( words.find( ps ) != words.end() ) {
+	if ( open( Files[k].FileID ) >= 0 )
+	  n++;
+	break;
+      }
+    }
+  }
+
+  return n;
+}
+
+
+int Plugins::openAll( int type )
+{
+  int n = 0;
+  for ( unsigned int k=0; k<Files.size(); k++ ) {
+    if ( Files[k].Lib != 0 )
+      continue;
+    if ( type > 0 ) {
+      int m = manifestIndex( Files[k].File );
+      if ( m >= 0 ) {
+	unsigned int i;
+	for ( i=0; i<Manifest[m].Types.size() &&
+		(Manifest[m].Types[i] & type) != type; i++ );
+	if ( i >= Manifest[m].Types.size() )
+	  continue;
+      }
+    }
+    if ( open( Files[k].FileID ) >= 0 )
+      n++;
+  }
+  return n;
+}
+
+
+int Plugins::manifestIndex( const string &file )
+{
+  struct stat fs;
+  if ( ::stat( file.c_str(), &fs ) != 0 )
+    return -1;
+
+  for ( unsigned int k=0; k<Manifest.size(); k++ ) {
+    if ( Manifest[k].File == file ) {
+      if ( Manifest[k].MTime == (long)fs.st_mtime &&
+	   Manifest[k].Size == (long)fs.st_size )
+	return k;
+      else
+	return -1;
+    }
+  }
+
+  return -1;
+}
+
+
 int Plugins::close( int id )
 {
   unsigned int index;
@@ -232,6 +487,10 @@ int Plugins::close( int id )
   if ( index >= Files.size() )
     return -InvalidFile;
 
+  // not loaded:
+  if ( Files[index].Lib == 0 )
+    return id;
+
   // check for still used plugins:
   for ( unsigned int k=0; k<Plugs.size(); k++ ) {
     if ( Plugs[k].FileID == id && Plugs[k].UseCount > 0 )
@@ -465,25 +724,26 @@ string Plugins::first( int type )
 
 int Plugins::index( const string &plugin, int type )
 {
-  if ( plugin.find( '[' ) == string::npos ) {
-    // search without pluginset name:
-    for ( unsigned int k=0; k<Plugs.size(); k++ ) {
-      if ( ( type <= 0 || (Plugs[k].Type & type) == type ) ) {
-	string ps = Plugs[k].Ident;
-	string::size_type n = ps.find_first_of( '[' );
-	if ( n != string::npos && n < ps.size() )
-	  ps.resize( n );
-	if ( ps == plugin )
-	  return k;
-      }
-    }
+  for ( unsigned int k=0; k<Plugs.size(); k++ ) {
+    if ( ( type <= 0 || (Plugs[k].Type & type) == type ) &&
+	 match( Plugs[k].Ident, plugin ) )
+      return k;
   }
-  else {
-    // search with pluginset name:
-    for ( unsigned int k=0; k<Plugs.size(); k++ ) {
-      if ( ( type <= 0 || (Plugs[k].Type & type) == type ) &&
-	   Plugs[k].Ident == plugin )
-	return k;
+
+  // load the library containing the plugin:
+  for ( unsigned int k=0; k<Files.size(); k++ ) {
+    if ( Files[k].Lib != 0 )
+      continue;
+    int m = manifestIndex( Files[k].File );
+    if ( m < 0 )
+      continue;
+    for ( unsigned int i=0; i<Manifest[m].Idents.size(); i++ ) {
+      if ( ( type <= 0 || (Manifest[m].Types[i] & type) == type ) &&
+	   match( Manifest[m].Idents[i], plugin ) ) {
+	if ( open( Files[k].FileID ) >= 0 )
+	  return index( plugin, type );
+	break;
+      }
     }
   }
 
@@ -491,6 +751,19 @@ int Plugins::index( const string &plugin, int type )
 }
 
 
+bool Plugins::match( const string &ident, const string &plugin )
+{
+  if ( plugin.find( '[' ) != string::npos )
+    return ( ident == plugin );
+
+  // compare without pluginset name:
+  string::size_type n = ident.find_first_of( '[' );
+  if ( n == string::npos )
+    return ( ident == plugin );
+  return ( ident.compare( 0, n, plugin ) == 0 && plugin.size() == n );
+}
+
+
 int Plugins::type( int index )
 {
   if ( index >= 0 && index < (int)Plugs.size() )
@@ -681,5 +954,13 @@ Plugins::FileInfo::FileInfo( const string &file, void *lib, int fileid )
 }
 
 
+Plugins::ManifestInfo::ManifestInfo( const string &file, long mtime, long size )
+{
+  File = file;
+  MTime = mtime;
+  Size = size;
+}
+
+
 }; /* namespace relacs */
 
@@ -0,0 +1,293 @@
+/*
+  profiler.cc
+  Low-overhead scoped timers for the data path
+
+  RELACS - Relaxed ELectrophysiological data Acquisition, Control, and Stimulation
+  Copyright (C) 2002-2015 Jan Benda <jan.benda@uni-tuebingen.de>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+  
+  RELACS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <QCoreApplication>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <relacs/str.h>
+#include <relacs/profiler.h>
+
+namespace relacs {
+
+
+  // Cyclic buffer of timings written by a single thread.
+class Profiler::Buffer
+{
+
+public:
+
+  static const long Capacity = 65536;
+
+  struct Event
+  {
+    int Id;
+    long long Start;
+    long long End;
+  };
+
+  Buffer( const string &name )
+    : Name( name ), Events( Capacity ), Count( 0 ), First( 0 ) {};
+
+  void push( int id, long long start, long long end )
+  {
+    long n = Count.load( memory_order_relaxed );
+    Event &e = Events[n%Capacity];
+    e.Id = id;
+    e.Start = start;
+    e.End = end;
+    Count.store( n+1, memory_order_release );
+  };
+
+    // Copy the timings that have not been overwritten to \a events.
+  void copy( vector< Event > &events ) const
+  {
+    long n = Count.load( memory_order_acquire );
+    long first = First.load( memory_order_relaxed );
+    if ( first < n - Capacity )
+      first = n - Capacity;
+    events.clear();
+    events.reserve( n - first );
+    for ( long k=first; k<n; k++ )
+      events.push_back( Events[k%Capacity] );
+    // discard timings overwritten in the meantime, including the one
+    // at nn - Capacity that push() may be writing right now:
+    long nn = Count.load( memory_order_acquire );
+    if ( nn - Capacity + 1 > first )
+      events.erase( events.begin(),
+		    events.begin() + min( long( events.size() ), nn - Capacity + 1 - first ) );
+  };
+
+  void clear( void )
+  {
+    First.store( Count.load( memory_order_acquire ), memory_order_relaxed );
+  };
+
+  string Name;
+
+    // Names of the code sections and buffers of all threads:
+  static QMutex Mutex;
+  static vector< string > Names;
+  static map< string, int > Ids;
+  static vector< Buffer* > Buffers;
+  static thread_local Buffer *Current;
+
+
+private:
+
+  vector< Event > Events;
+  atomic< long > Count;
+  atomic< long > First;
+
+};
+
+
+QMutex Profiler::Buffer::Mutex;
+vector< string > Profiler::Buffer::Names;
+map< string, int > Profiler::Buffer::Ids;
+vector< Profiler::Buffer* > Profiler::Buffer::Buffers;
+thread_local Profiler::Buffer *Profiler::Buffer::Current = 0;
+
+atomic< bool > Profiler::Enabled( false );
+
+
+void Profiler::setEnabled( bool enable )
+{
+  Enabled.store( enable, memory_order_relaxed );
+}
+
+
+int Profiler::id( const string &name )
+{
+  QMutexLocker locker( &Buffer::Mutex );
+  map< string, int >::const_iterator i = Buffer::Ids.find( name );
+  if ( i != Buffer::Ids.end() )
+    return i->second;
+  int id = Buffer::Names.size();
+  Buffer::Names.push_back( name );
+  Buffer::Ids[name] = id;
+  return id;
+}
+
+
+string Profiler::name( int id )
+{
+  QMutexLocker locker( &Buffer::Mutex );
+  if ( id < 0 || id >= (int)Buffer::Names.size() )
+    return "";
+  return Buffer::Names[id];
+}
+
+
+long long Profiler::now( void )
+{
+  return chrono::duration_cast< chrono::nanoseconds >( chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+
+Profiler::Buffer *Profiler::buffer( void )
+{
+  if ( Buffer::Current == 0 ) {
+    string name;
+    QThread *thread = QThread::currentThread();
+    if ( QCoreApplication::instance() != 0 &&
+	 thread == QCoreApplication::instance()->thread() )
+      name = "GUI";
+    else if ( thread != 0 && ! thread->objectName().isEmpty() )
+      name = thread->objectName().toStdString();
+    else if ( thread != 0 )
+      name = thread->metaObject()->className();
+    QMutexLocker locker( &Buffer::Mutex );
+    name += " " + Str( Buffer::Buffers.size() + 1 );
+    // buffers stay alive until the end of the program,
+    // since their timings are still needed after their threads finished:
+    Buffer::Current = new Buffer( name );
+    Buffer::Buffers.push_back( Buffer::Current );
+  }
+  return Buffer::Current;
+}
+
+
+void Profiler::record( int id, long long start, long long end )
+{
+  buffer()->push( id, start, end );
+}
+
+
+void Profiler::clear( void )
+{
+  QMutexLocker locker( &Buffer::Mutex );
+  for ( unsigned int k=0; k<Buffer::Buffers.size(); k++ )
+    Buffer::Buffers[k]->clear();
+}
+
+
+void Profiler::statistics( vector< Statistics > &stats )
+{
+  stats.clear();
+  QMutexLocker locker( &Buffer::Mutex );
+  vector< vector< double > > durations( Buffer::Names.size() );
+  vector< Buffer::Event > events;
+  for ( unsigned int k=0; k<Buffer::Buffers.size(); k++ ) {
+    Buffer::Buffers[k]->copy( events );
+    for ( unsigned int j=0; j<events.size(); j++ ) {
+      if ( events[j].Id >= 0 && events[j].Id < (int)durations.size() )
+	durations[events[j].Id].push_back( 1.0e-9*( events[j].End - events[j].Start ) );
+    }
+  }
+  for ( unsigned int k=0; k<durations.size(); k++ ) {
+    vector< double > &d = durations[k];
+    if ( d.empty() )
+      continue;
+    sort( d.begin(), d.end() );
+    Statistics s;
+    s.Name = Buffer::Names[k];
+    s.Count = d.size();
+    s.Total = 0.0;
+    for ( unsigned int j=0; j<d.size(); j++ )
+      s.Total += d[j];
+    s.Mean = s.Total/d.size();
+    s.Median = d[d.size()/2];
+    s.Quantile99 = d[(d.size()-1)*99/100];
+    s.Max = d.back();
+    stats.push_back( s );
+  }
+  sort( stats.begin(), stats.end(),
+	[]( const Statistics &a, const Statistics &b ) { return a.Total > b.Total; } );
+}
+
+
+double Profiler::duration( void )
+{
+  QMutexLocker locker( &Buffer::Mutex );
+  long long first = -1;
+  long long last = -1;
+  vector< Buffer::Event > events;
+  for ( unsigned int k=0; k<Buffer::Buffers.size(); k++ ) {
+    Buffer::Buffers[k]->copy( events );
+    for ( unsigned int j=0; j<events.size(); j++ ) {
+      if ( first < 0 || events[j].Start < first )
+	first = events[j].Start;
+      if ( events[j].End > last )
+	last = events[j].End;
+    }
+  }
+  return first < 0 ? 0.0 : 1.0e-9*( last - first );
+}
+
+
+  // Escape \a s for a JSON string.
+static string jsonString( const string &s )
+{
+  string r = "\"";
+  for ( unsigned int k=0; k<s.size(); k++ ) {
+    if ( s[k] == '"' || s[k] == '\\' )
+      r += '\\';
+    if ( (unsigned char)s[k] >= 0x20 )
+      r += s[k];
+  }
+  r += '"';
+  return r;
+}
+
+
+int Profiler::saveChromeTrace( const string &file )
+{
+  ofstream df( file.c_str() );
+  if ( ! df.good() )
+    return -1;
+
+  QMutexLocker locker( &Buffer::Mutex );
+  int pid = ::getpid();
+  df << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  df << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << pid
+     << ",\"tid\":0,\"args\":{\"name\":\"RELACS\"}}";
+  vector< Buffer::Event > events;
+  for ( unsigned int k=0; k<Buffer::Buffers.size(); k++ ) {
+    int tid = k + 1;
+    df << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid
+       << ",\"tid\":" << tid << ",\"args\":{\"name\":"
+       << jsonString( Buffer::Buffers[k]->Name ) << "}}";
+    Buffer::Buffers[k]->copy( events );
+    for ( unsigned int j=0; j<events.size(); j++ ) {
+      if ( events[j].Id < 0 || events[j].Id >= (int)Buffer::Names.size() )
+	continue;
+      // times in microseconds:
+      df << ",\n{\"name\":" << jsonString( Buffer::Names[events[j].Id] )
+	 << ",\"cat\":\"relacs\",\"ph\":\"X\",\"pid\":" << pid
+	 << ",\"tid\":" << tid
+	 << ",\"ts\":" << Str( 0.001*events[j].Start, "%.3f" )
+	 << ",\"dur\":" << Str( 0.001*( events[j].End - events[j].Start ), "%.3f" )
+	 << "}";
+    }
+  }
+  df << "\n]}\n";
+  return df.good() ? 0 : -1;
+}
+
+
+}; /* namespace relacs */
+
@@ -323,6 +323,26 @@ int RELACSPlugin::getData( double mintracetime, double prevsignal )
 }
 
 
+bool RELACSPlugin::waitOnTraceTime( double tracetime, double timeout )
+{
+  unlock();
+  bool r = RW->waitOnData( tracetime, MAXDOUBLE, timeout );
+  lock();
+  getData();
+  return r;
+}
+
+
+bool RELACSPlugin::waitOnSignalTime( double signaltime, double timeout )
+{
+  unlock();
+  bool r = RW->waitOnData( MAXDOUBLE, signaltime, timeout );
+  lock();
+  getData();
+  return r;
+}
+
+
 const InList &RELACSPlugin::traces( void ) const
 {
   return IData;
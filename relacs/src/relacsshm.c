@@ -0,0 +1,305 @@
+/*
+  relacsshm.c
+  Layout of and read access to traces and events exported by RELACS to shared memory
+
+  RELACS - Relaxed ELectrophysiological data Acquisition, Control, and Stimulation
+  Copyright (C) 2002-2015 Jan Benda <jan.benda@uni-tuebingen.de>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+  
+  RELACS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <relacs/relacsshm.h>
+
+
+struct relacs_shm
+{
+  const char *segment;
+  size_t size;
+  const relacs_shm_header *header;
+  const relacs_shm_trace *traces;
+  const relacs_shm_events *events;
+};
+
+
+static uint64_t load_acquire( const uint64_t *counter )
+{
+  return __atomic_load_n( counter, __ATOMIC_ACQUIRE );
+}
+
+
+  /* Index of the oldest element that is not going to be overwritten. */
+static uint64_t min_index( const uint64_t *writing, uint64_t capacity )
+{
+  uint64_t w = __atomic_load_n( writing, __ATOMIC_RELAXED );
+  return w > capacity ? w - capacity : 0;
+}
+
+
+  /* Check after reading the data whether element index is still valid. */
+static int still_valid( const uint64_t *writing, uint64_t capacity,
+			uint64_t index )
+{
+  __atomic_thread_fence( __ATOMIC_ACQUIRE );
+  return ( index >= min_index( writing, capacity ) );
+}
+
+
+relacs_shm *relacs_shm_open( const char *name )
+{
+  int fd = shm_open( name, O_RDONLY, 0 );
+  if ( fd < 0 )
+    return NULL;
+  struct stat st;
+  if ( fstat( fd, &st ) < 0 ) {
+    close( fd );
+    return NULL;
+  }
+  if ( (size_t)st.st_size < sizeof( relacs_shm_header ) ) {
+    close( fd );
+    errno = EINVAL;
+    return NULL;
+  }
+  void *segment = mmap( NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+  close( fd );
+  if ( segment == MAP_FAILED )
+    return NULL;
+
+  const relacs_shm_header *header = (const relacs_shm_header *)segment;
+  if ( memcmp( header->magic, RELACS_SHM_MAGIC, sizeof( header->magic ) ) != 0 ||
+       header->version != RELACS_SHM_VERSION ||
+       header->size > (uint64_t)st.st_size ) {
+    munmap( segment, st.st_size );
+    errno = EINVAL;
+    return NULL;
+  }
+
+  relacs_shm *shm = (relacs_shm *)malloc( sizeof( relacs_shm ) );
+  if ( shm == NULL ) {
+    munmap( segment, st.st_size );
+    return NULL;
+  }
+  shm->segment = (const char *)segment;
+  shm->size = st.st_size;
+  shm->header = header;
+  shm->traces = (const relacs_shm_trace *)( shm->segment + sizeof( relacs_shm_header ) );
+  shm->events = (const relacs_shm_events *)( shm->traces + header->ntraces );
+  return shm;
+}
+
+
+void relacs_shm_close( relacs_shm *shm )
+{
+  if ( shm == NULL )
+    return;
+  munmap( (void *)shm->segment, shm->size );
+  free( shm );
+}
+
+
+const relacs_shm_header *relacs_shm_info( const relacs_shm *shm )
+{
+  return shm->header;
+}
+
+
+int relacs_shm_active( const relacs_shm *shm )
+{
+  return __atomic_load_n( &shm->header->active, __ATOMIC_ACQUIRE ) != 0;
+}
+
+
+uint64_t relacs_shm_updates( const relacs_shm *shm )
+{
+  return load_acquire( &shm->header->updates );
+}
+
+
+int relacs_shm_wait( const relacs_shm *shm, uint64_t updates, double timeout )
+{
+  /* RELACS updates its data every few milliseconds,
+     polling every 100 microseconds keeps the latency small
+     without wasting a core: */
+  struct timespec poll = { 0, 100000 };
+  long maxpolls = (long)( timeout*1.0e4 );
+  for ( long k=0; ; k++ ) {
+    if ( ! relacs_shm_active( shm ) )
+      return -1;
+    if ( relacs_shm_updates( shm ) != updates )
+      return 1;
+    if ( k >= maxpolls )
+      return 0;
+    nanosleep( &poll, NULL );
+  }
+}
+
+
+int relacs_shm_traces( const relacs_shm *shm )
+{
+  return shm->header->ntraces;
+}
+
+
+const relacs_shm_trace *relacs_shm_trace_info( const relacs_shm *shm, int trace )
+{
+  if ( trace < 0 || trace >= (int)shm->header->ntraces )
+    return NULL;
+  return &shm->traces[trace];
+}
+
+
+int relacs_shm_find_trace( const relacs_shm *shm, const char *ident )
+{
+  for ( int k=0; k<(int)shm->header->ntraces; k++ ) {
+    if ( strncmp( shm->traces[k].ident, ident, RELACS_SHM_IDENT ) == 0 )
+      return k;
+  }
+  return -1;
+}
+
+
+uint64_t relacs_shm_trace_index( const relacs_shm *shm, int trace )
+{
+  return load_acquire( &shm->traces[trace].written );
+}
+
+
+uint64_t relacs_shm_trace_min_index( const relacs_shm *shm, int trace )
+{
+  const relacs_shm_trace *tr = &shm->traces[trace];
+  return min_index( &tr->writing, tr->capacity );
+}
+
+
+const float *relacs_shm_trace_buffer( const relacs_shm *shm, int trace,
+				      uint64_t index, long *n )
+{
+  *n = 0;
+  const relacs_shm_trace *tr = relacs_shm_trace_info( shm, trace );
+  if ( tr == NULL )
+    return NULL;
+  uint64_t written = load_acquire( &tr->written );
+  if ( index >= written || index < min_index( &tr->writing, tr->capacity ) )
+    return NULL;
+  uint64_t pos = index % tr->capacity;
+  uint64_t m = written - index;
+  if ( pos + m > tr->capacity )
+    m = tr->capacity - pos;
+  *n = (long)m;
+  return (const float *)( shm->segment + tr->offset ) + pos;
+}
+
+
+int relacs_shm_trace_valid( const relacs_shm *shm, int trace, uint64_t index )
+{
+  const relacs_shm_trace *tr = &shm->traces[trace];
+  return still_valid( &tr->writing, tr->capacity, index );
+}
+
+
+long relacs_shm_read_trace( const relacs_shm *shm, int trace,
+			    uint64_t index, float *buffer, long n )
+{
+  const relacs_shm_trace *tr = relacs_shm_trace_info( shm, trace );
+  if ( tr == NULL )
+    return -1;
+  uint64_t written = load_acquire( &tr->written );
+  if ( index < min_index( &tr->writing, tr->capacity ) )
+    return -1;
+  if ( index >= written )
+    return 0;
+  if ( (uint64_t)n > written - index )
+    n = written - index;
+  const float *data = (const float *)( shm->segment + tr->offset );
+  uint64_t pos = index % tr->capacity;
+  long m = n;
+  if ( pos + m > tr->capacity )
+    m = tr->capacity - pos;
+  memcpy( buffer, data + pos, m*sizeof( float ) );
+  memcpy( buffer + m, data, (n-m)*sizeof( float ) );
+  return still_valid( &tr->writing, tr->capacity, index ) ? n : -1;
+}
+
+
+int relacs_shm_events_size( const relacs_shm *shm )
+{
+  return shm->header->nevents;
+}
+
+
+const relacs_shm_events *relacs_shm_events_info( const relacs_shm *shm, int events )
+{
+  if ( events < 0 || events >= (int)shm->header->nevents )
+    return NULL;
+  return &shm->events[events];
+}
+
+
+int relacs_shm_find_events( const relacs_shm *shm, const char *ident )
+{
+  for ( int k=0; k<(int)shm->header->nevents; k++ ) {
+    if ( strncmp( shm->events[k].ident, ident, RELACS_SHM_IDENT ) == 0 )
+      return k;
+  }
+  return -1;
+}
+
+
+uint64_t relacs_shm_events_index( const relacs_shm *shm, int events )
+{
+  return load_acquire( &shm->events[events].written );
+}
+
+
+uint64_t relacs_shm_events_min_index( const relacs_shm *shm, int events )
+{
+  const relacs_shm_events *ev = &shm->events[events];
+  return min_index( &ev->writing, ev->capacity );
+}
+
+
+long relacs_shm_read_events( const relacs_shm *shm, int events,
+			     uint64_t index, double *times, double *sizes, long n )
+{
+  const relacs_shm_events *ev = relacs_shm_events_info( shm, events );
+  if ( ev == NULL )
+    return -1;
+  uint64_t written = load_acquire( &ev->written );
+  if ( index < min_index( &ev->writing, ev->capacity ) )
+    return -1;
+  if ( index >= written )
+    return 0;
+  if ( (uint64_t)n > written - index )
+    n = written - index;
+  uint64_t pos = index % ev->capacity;
+  long m = n;
+  if ( pos + m > ev->capacity )
+    m = ev->capacity - pos;
+  const double *data = (const double *)( shm->segment + ev->offset );
+  memcpy( times, data + pos, m*sizeof( double ) );
+  memcpy( times + m, data, (n-m)*sizeof( double ) );
+  if ( sizes != NULL && ev->sizeoffset > 0 ) {
+    data = (const double *)( shm->segment + ev->sizeoffset );
+    memcpy( sizes, data + pos, m*sizeof( double ) );
+    memcpy( sizes + m, data, (n-m)*sizeof( double ) );
+  }
+  return still_valid( &ev->writing, ev->capacity, index ) ? n : -1;
+}
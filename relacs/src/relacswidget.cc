@@ -30,6 +30,7 @@
 #include <QToolTip>
 #include <QLayout>
 #include <QTextBrowser>
+#include <QFileDialog>
 #include <relacs/outdatainfo.h>
 #include <relacs/plugins.h>
 #include <relacs/defaultsession.h>
@@ -45,11 +46,14 @@
 #include <relacs/filter.h>
 #include <relacs/filterdetectors.h>
 #include <relacs/inputconfig.h>
+#include <relacs/liveexport.h>
 #include <relacs/outputconfig.h>
+#include <relacs/profiler.h>
 #include <relacs/macros.h>
 #include <relacs/model.h>
 #include <relacs/messagebox.h>
 #include <relacs/relacsdevices.h>
+#include <relacs/deviceopener.h>
 #include <relacs/repros.h>
 #include <relacs/savefiles.h>
 #include <relacs/session.h>
@@ -111,6 +115,7 @@ RELACSWidget::RELACSWidget( const string &pluginrelative,
     IsMaximized( false ),
     DeviceMenu( 0 ),
     Help( false ),
+    ProfileView( 0 ),
     HandlingEvent( false ),
     Doxydoc(doxydoc)
 {
@@ -189,6 +194,14 @@ RELACSWidget::RELACSWidget( const string &pluginrelative,
   ATD = new AttDevices();
   ATI = new AttInterfaces();
 
+  // opens devices concurrently:
+  DO = new DeviceOpener();
+  connect( DO, SIGNAL( progress( const QString& ) ),
+	   statusBar(), SLOT( showMessage( const QString& ) ) );
+
+  // live export of data to shared memory:
+  LE = new LiveExport();
+
   // load config:
   SF = 0;
   int r = CFG.read( RELACSPlugin::Core );
@@ -209,12 +222,36 @@ RELACSWidget::RELACSWidget( const string &pluginrelative,
   Plugins::add( "AttSim[relacs]", RELACSPlugin::AttenuatorId, createAttSim, VERSION );
   StrQueue pluginhomes( pluginhome, "|" );
   pluginhomes.strip();
+  bool lazyplugins = SS.boolean( "lazyplugins", true );
+  if ( lazyplugins )
+    Plugins::setManifest( SS.text( "pluginmanifest", "relacsplugins.manifest" ) );
   for ( int k=0; k<SS.Options::size( "pluginpathes" ); k++ ) {
     string pluginlib = SS.text( "pluginpathes", k );
     if ( !pluginlib.empty() ) {
-      Plugins::openPath( pluginlib, pluginrelative, pluginhomes );
+      if ( lazyplugins )
+	Plugins::scanPath( pluginlib, pluginrelative, pluginhomes );
+      else
+	Plugins::openPath( pluginlib, pluginrelative, pluginhomes );
     }
   }
+  if ( lazyplugins ) {
+    // load only libraries with RePros or with plugins mentioned
+    // in the configuration files:
+    StrQueue cfgfiles;
+    for ( int g=0; g<CFG.groups(); g++ ) {
+      for ( int l=0; ! CFG.configFile( g, l ).empty(); l++ )
+	cfgfiles.add( CFG.configFile( g, l ) );
+    }
+    for ( int k=0; k<MC->Options::size( "file" ); k++ )
+      cfgfiles.add( MC->text( "file", k ) );
+    if ( ! MC->text( "mainfile" ).empty() )
+      cfgfiles.add( MC->text( "mainfile" ) );
+    Plugins::openReferenced( cfgfiles );
+    // RePros are created only once, but macro files loaded later
+    // may refer to any of them:
+    Plugins::openAll( RELACSPlugin::ReProId );
+    Plugins::saveManifest();
+  }
 
   if ( Plugins::empty() ) {
     printlog(  "! error: No valid plugins found. Exit now." );
@@ -440,6 +477,7 @@ RELACSWidget::RELACSWidget( const string &pluginrelative,
   FullscreenAction = viewmenu->addAction( "&Full screen",
 					  (QWidget*)this, SLOT( fullScreen() ),
 					  Qt::CTRL + Qt::SHIFT + Qt::Key_F );
+  viewmenu->addAction( "&Profiler...", (QWidget*)this, SLOT( profiler() ) );
   viewmenu->addSeparator();
   PT->addMenu( viewmenu );
 
@@ -487,6 +525,9 @@ RELACSWidget::~RELACSWidget( void )
   delete CW;
   delete RP;
   delete PT;
+  delete LE;
+  // destroys devices that were still being opened:
+  delete DO;
   Plugins::close();
   delete AQD;
   delete SIM;
@@ -536,18 +577,54 @@ int RELACSWidget::openHardware( int n, int errorlevel )
   Str warnings = "";
   int error = 0;
 
+  // create devices:
+  DO->clear();
+  DO->setParallel( SS.boolean( "paralleldevices", true ) );
+  DO->setTimeout( SS.number( "devicetimeout", 30.0 ) );
+  DV->prepare( *ADV, n, "0", *DO );
+  if ( n == 0 )
+    AID->prepare( *ADV, n, "0", *DO );
+  else
+    AID->prepare( *ADV, 1, "AISim", *DO );
+  if ( n == 0 )
+    AOD->prepare( *ADV, n, "0", *DO );
+  else
+    AOD->prepare( *ADV, 1, "AOSim", *DO );
+  DIOD->prepare( *ADV, n, "0", *DO );
+  TRIGD->prepare( *ADV, n, "0", *DO );
+  if ( n == 0 )
+    ATD->prepare( *ADV, n, "0", *DO );
+  else
+    ATD->prepare( *ADV, 1, "AttSim", *DO );
+  ATI->prepare( *ADV, 0, "0", *DO );
+
+  // open all devices concurrently:
+  if ( DO->size() > 0 ) {
+    QTime opentime;
+    opentime.start();
+    DO->open();
+    double slowest = 0.0;
+    string slowestident = "";
+    for ( int k=0; k<DO->size(); k++ ) {
+      if ( DO->time( k ) > slowest ) {
+	slowest = DO->time( k );
+	slowestident = DO->device( k )->deviceIdent();
+      }
+    }
+    printlog( "Opened " + Str( DO->size() ) + " devices in "
+	      + Str( 0.001*opentime.elapsed(), 0, 2, 'f' ) + "s (slowest: "
+	      + slowestident + " " + Str( slowest, 0, 2, 'f' ) + "s)" );
+  }
+
   // activate devices:
-  DV->create( *ADV, n );
+  DV->finish( *ADV, *DO );
   errors += DV->errors();
   warnings += DV->warnings();
   if ( ! DV->ok() )
     error |= 1;
 
   // activate analog input devices:
-  if ( n == 0 )
-    AID->create( *ADV, n );
-  else
-    AID->create( *ADV, 1, "AISim" );
+  AID->finish( *ADV, *DO );
   errors += AID->errors();
   warnings += AID->warnings();
   if ( ! AID->ok() ) {
@@ -556,10 +633,7 @@ int RELACSWidget::openHardware( int n, int errorlevel )
   }
 
   // activate analog output devices:
-  if ( n == 0 )
-    AOD->create( *ADV, n );
-  else
-    AOD->create( *ADV, 1, "AOSim" );
+  AOD->finish( *ADV, *DO );
   errors += AOD->errors();
   warnings += AOD->warnings();
   if ( ! AOD->ok() ) {
@@ -568,30 +642,27 @@ int RELACSWidget::openHardware( int n, int errorlevel )
   }
 
   // activate digital I/O devices:
-  DIOD->create( *ADV, n );
+  DIOD->finish( *ADV, *DO );
   errors += DIOD->errors();
   warnings += DIOD->warnings();
   if ( ! DIOD->ok() )
     error |= 1;
 
   // activate trigger devices:
-  TRIGD->create( *ADV, n );
+  TRIGD->finish( *ADV, *DO );
   errors += TRIGD->errors();
   warnings += TRIGD->warnings();
   if ( ! TRIGD->ok() )
     error |= 1;
 
   // activate attenuators:
-  if ( n == 0 )
-    ATD->create( *ADV, n );
-  else
-    ATD->create( *ADV, 1, "AttSim" );
+  ATD->finish( *ADV, *DO );
   errors += ATD->errors();
   warnings += ATD->warnings();
   if ( ! ATD->ok() )
     error |= 3;
 
-  ATI->create( *ADV, 0 );
+  ATI->finish( *ADV, *DO );
   errors += ATI->errors();
   warnings += ATI->warnings();
   if ( ! ATI->ok() )
@@ -688,6 +759,8 @@ int RELACSWidget::setupHardware( int n )
   else {
 
     // clear devices:
+    DO->wait();
+    DO->clear();
     CW->clearDevices();
     ADV->clear();
     DV->clear();
@@ -706,6 +779,8 @@ int RELACSWidget::setupHardware( int n )
 
 void RELACSWidget::clearHardware( void )
 {
+  DO->wait();
+  DO->clear();
   CW->clearDevices();
   AQD->clear();
   SIM->clear();
@@ -722,6 +797,7 @@ void RELACSWidget::clearHardware( void )
 
 void RELACSWidget::closeHardware( void )
 {
+  DO->wait();
   AQD->clear();
   SIM->clear();
   ADV->close();
@@ -891,7 +967,7 @@ int RELACSWidget::getData( InList &data, EventList &events, double &signaltime,
       while ( IData.success() &&
 	      SignalTime <= prevsignal+1.0e-8 &&
 	      AQ->isReadRunning() ) { 
-	UpdateDataWait.wait( &DerivedDataMutex );
+	DataWait.wait( &DerivedDataMutex, MAXDOUBLE, prevsignal+1.0e-8 );
 	if ( ! AQ->isWriteRunning() )
 	  break;
       }
@@ -905,7 +981,7 @@ int RELACSWidget::getData( InList &data, EventList &events, double &signaltime,
     while ( IData.success() &&
 	    IData.currentTimeRaw() < mintracetime+1.0e-8 &&
 	    AQ->isReadRunning() && WriteFlag ) {
-      UpdateDataWait.wait( &DerivedDataMutex );
+      DataWait.wait( &DerivedDataMutex, mintracetime+1.0e-8 );
     }
     
     interrupted = ( IData.currentTimeRaw() < mintracetime || mintracetime == 0.0 );
@@ -922,6 +998,23 @@ int RELACSWidget::getData( InList &data, EventList &events, double &signaltime,
 }
 
 
+bool RELACSWidget::waitOnData( double tracetime, double signaltime,
+			       double timeout )
+{
+  DerivedDataMutex.lockForRead();
+  if ( IData.currentTimeRaw() < tracetime &&
+       SignalTime <= signaltime &&
+       IData.success() && AQ->isReadRunning() ) {
+    unsigned long t = timeout == MAXDOUBLE ? ULONG_MAX : (unsigned long)::rint( 1.0e3*timeout );
+    DataWait.wait( &DerivedDataMutex, tracetime, signaltime, t );
+  }
+  bool reached = ( IData.currentTimeRaw() >= tracetime ||
+		   SignalTime > signaltime );
+  DerivedDataMutex.unlock();
+  return reached;
+}
+
+
 int RELACSWidget::updateData( void )
 // called continuously from ReadThread::run()
 {
@@ -930,6 +1023,7 @@ int RELACSWidget::updateData( void )
   if ( r < 0 ) {
     // error handling:
     AQ->stopRead();
+    DataWait.wakeAll();
     AQ->lockRead();
     string es = IRawData.errorText();
     printlog( "! error in reading acquired data: " + es );
@@ -962,6 +1056,8 @@ int RELACSWidget::updateData( void )
     }
   }
   else if ( r > 0 ) {
+    static const int profileid = Profiler::id( "RELACSWidget::updateData" );
+    ProfileTimer profiletimer( profileid );
     // update derived data:
     DerivedDataMutex.lockForWrite();
     if ( signaltime >= 0.0 )
@@ -976,13 +1072,20 @@ int RELACSWidget::updateData( void )
     if ( !fdw.empty() )
       printlog( "! error: " + fdw.erasedMarkup() );
     AM->updateDerivedTraces(); // XXX is this really good?
+    double currenttime = IData.currentTimeRaw();
+    double currentsignal = SignalTime;
     DerivedDataMutex.unlock();
 
     // save data:
     SF->saveTraces();
 
-    // notify other plugins about available data:
-    UpdateDataWait.wakeAll();
+    // export data to shared memory:
+    LE->update();
+
+    // notify plugins waiting for the available data,
+    // and for a signal in case there is none to come:
+    DataWait.wakeUp( currenttime,
+		     AQ->isWriteRunning() ? currentsignal : MAXDOUBLE );
   }
   DataRunLock.lock();
   bool dr = DataRun;
@@ -993,7 +1096,7 @@ int RELACSWidget::updateData( void )
 
 void RELACSWidget::wakeAll( void )
 {
-  UpdateDataWait.wakeAll();
+  DataWait.wakeAll();
   ReProSleepWait.wakeAll();
   ReProAfterWait.wakeAll();
   SessionStartWait.wakeAll();
@@ -1164,6 +1267,8 @@ int RELACSWidget::stopWrite( void )
   DerivedDataMutex.lockForWrite();
   WriteFlag = false;
   DerivedDataMutex.unlock();
+  // getData() does not wait on data anymore:
+  DataWait.wakeAll();
   return r;
 }
 
@@ -1470,6 +1575,7 @@ void RELACSWidget::stopThreads( void )
     ReadLoop.wait();
     AQ->stop();
   }
+  LE->close();
 
   // process pending events posted from threads.
   qApp->processEvents();
@@ -1584,6 +1690,7 @@ void RELACSWidget::editDevices()
   deviceLists[ATD->pluginId()] = ATD;
   deviceLists[ATI->pluginId()] = ATI;
 
+  Plugins::openAll();
   DeviceSelector* oc = new DeviceSelector(deviceLists, this);
   OptDialog* od = new OptDialog(false, this);
   od->setCaption("Active devices");
@@ -1598,6 +1705,7 @@ void RELACSWidget::editDevices()
 
 void RELACSWidget::editFilters()
 {
+  Plugins::openAll();
   FilterSelector* fc = new FilterSelector(this);
 
   fc->setInputTraces(Options::section("input data"));
@@ -1867,6 +1975,15 @@ void RELACSWidget::startFirstAcquisition( bool simulation )
     }
   }
 
+  // export data to shared memory:
+  if ( SS.boolean( "liveexport" ) ) {
+    if ( LE->open( IData, EData, SS.text( "liveexportname", "/relacs" ),
+		   SS.number( "liveexporttime", 10.0 ) ) < 0 )
+      printlog( "! warning: " + LE->error() );
+    else
+      printlog( "Exporting data to shared memory segment " + LE->name() );
+  }
+
   // initialize filters:
   FD->setAdjustFlag( AQ->adjustFlag() );
   fdw = FD->init();  // init filters/detectors before RePro!
@@ -2277,6 +2394,89 @@ void RELACSWidget::helpClosed( int r )
 }
 
 
+void RELACSWidget::profiler( void )
+{
+  if ( ProfileView != 0 )
+    return;
+
+  OptDialog *od = new OptDialog( false, this );
+  od->setCaption( "RELACS Profiler" );
+  ProfileView = new QTextBrowser( this );
+  ProfileView->setMinimumSize( 700, 400 );
+  updateProfile();
+  od->addWidget( ProfileView );
+  od->addButton( "&Update", OptDialog::NoAction, 1, false );
+  od->addButton( "&Reset", OptDialog::NoAction, 2, false );
+  od->addButton( "&Export...", OptDialog::NoAction, 3, false );
+  od->addButton( "&Close" );
+  connect( od, SIGNAL( buttonClicked( int ) ),
+	   this, SLOT( profilerAction( int ) ) );
+  connect( od, SIGNAL( dialogClosed( int ) ),
+	   this, SLOT( profilerClosed( int ) ) );
+  od->exec();
+}
+
+
+void RELACSWidget::updateProfile( void )
+{
+  if ( ProfileView == 0 )
+    return;
+
+  vector< Profiler::Statistics > stats;
+  Profiler::statistics( stats );
+  double duration = Profiler::duration();
+  Str info;
+  if ( ! Profiler::enabled() )
+    info += "<p>Profiling is switched off. Switch it on in the <b>Profiling</b> section of the settings.</p>\n";
+  if ( stats.empty() ) {
+    info += "<p>No timings recorded.</p>\n";
+    ProfileView->setHtml( info.c_str() );
+    return;
+  }
+  info += "<p>Timings of the last " + Str( duration, 0, 1, 'f' ) + " seconds:</p>\n";
+  info += "<table cellpadding=4>\n";
+  info += "<tr><th align=left>Code section</th><th>Calls</th><th>Total [ms]</th><th>Load [%]</th>";
+  info += "<th>Mean [ms]</th><th>Median [ms]</th><th>99% [ms]</th><th>Max [ms]</th></tr>\n";
+  for ( unsigned int k=0; k<stats.size(); k++ ) {
+    info += "<tr><td>" + stats[k].Name + "</td>";
+    info += "<td align=right>" + Str( stats[k].Count ) + "</td>";
+    info += "<td align=right>" + Str( 1000.0*stats[k].Total, 0, 1, 'f' ) + "</td>";
+    info += "<td align=right>" + Str( duration > 0.0 ? 100.0*stats[k].Total/duration : 0.0, 0, 1, 'f' ) + "</td>";
+    info += "<td align=right>" + Str( 1000.0*stats[k].Mean, 0, 3, 'f' ) + "</td>";
+    info += "<td align=right>" + Str( 1000.0*stats[k].Median, 0, 3, 'f' ) + "</td>";
+    info += "<td align=right>" + Str( 1000.0*stats[k].Quantile99, 0, 3, 'f' ) + "</td>";
+    info += "<td align=right>" + Str( 1000.0*stats[k].Max, 0, 3, 'f' ) + "</td></tr>\n";
+  }
+  info += "</table>\n";
+  ProfileView->setHtml( info.c_str() );
+}
+
+
+void RELACSWidget::profilerAction( int r )
+{
+  if ( r == 2 )
+    Profiler::clear();
+  else if ( r == 3 ) {
+    QString file = QFileDialog::getSaveFileName( this, "Export profile",
+						 "relacs-profile.json",
+						 "Chrome trace (*.json)" );
+    if ( ! file.isEmpty() ) {
+      if ( Profiler::saveChromeTrace( file.toStdString() ) < 0 )
+	MessageBox::error( "RELACS Error !", "Failed to write profile to<br>" + file.toStdString(), this );
+      else
+	printlog( "Exported profile to " + file.toStdString() );
+    }
+  }
+  updateProfile();
+}
+
+
+void RELACSWidget::profilerClosed( int r )
+{
+  ProfileView = 0;
+}
+
+
 KeyTimeOut::KeyTimeOut( QWidget *tlw )
   : TimerId( 0 ),
     TopLevelWidget( tlw ),
@@ -28,6 +28,7 @@
 #include <QMutexLocker>
 #include <relacs/acquire.h>
 #include <relacs/attenuate.h>
+#include <relacs/profiler.h>
 #include <relacs/relacsdevices.h>
 #include <relacs/relacswidget.h>
 #include <relacs/session.h>
@@ -383,6 +384,9 @@ void SaveFiles::saveTraces( void )
 {
   //  cerr << "SaveFiles::saveTraces(): saving=" << saving() << '\n';
 
+  static const int profileid = Profiler::id( "SaveFiles::saveTraces" );
+  ProfileTimer profiletimer( profileid );
+
   QMutexLocker locker( &SaveMutex );
 
   // this function is called from RELACSWidget::updateData()
@@ -476,7 +480,8 @@ void SaveFiles::save( const OutData &signal )
 
   // store stimulus and update output channel setting:
   Stimuli.push_back( signal );
-  setNumber( RW->AQ->outTraceName( signal.trace() ), signal.back() );
+  setNumber( RW->AQ->outTraceName( signal.trace() ),
+	     signal.streamLastValue() );
   // XXX why not using signal.traceName() ?
 
   // reset stimulus offset:
@@ -506,7 +511,8 @@ void SaveFiles::save( const OutList &signal )
   // store stimulus and update output channel settings:
   for ( int k=0; k<signal.size(); k++ ) {
     Stimuli.push_back( signal[k] );
-    setNumber( RW->AQ->outTraceName( signal[k].trace() ), signal[k].back() );
+    setNumber( RW->AQ->outTraceName( signal[k].trace() ),
+	       signal[k].streamLastValue() );
     // XXX why not using signal[k].traceName() ?
   }
   
@@ -1792,6 +1798,9 @@ void SaveFiles::NixFile::close ( )
 {
   if ( fd.isOpen() ) {
     std::cerr << "Closing NIX File" << std::endl;
+    writer.stop();
+    writer.clearTraces();
+    QMutexLocker locker( writer.mutex() );
     if ( repro_tag && repro_tag.extent().size() == 0 ) {
       endRePro(traces[0].written * stepsize);
     }
@@ -1961,6 +1970,7 @@ static void saveNIXOptions(const Options &opts, nix::Section section,
 
 void SaveFiles::NixFile::saveMetadata (const AllDevices *devices)
 {
+  QMutexLocker locker( writer.mutex() );
   string fnname = rid;
   nix::Section hw = root_section.createSection("hardware-" + rid, "hardware");
   for ( int k=0; k < devices->size(); k++ ) {
@@ -1997,6 +2007,7 @@ void SaveFiles::NixFile::saveMetadata (const AllDevices *devices)
 
 void SaveFiles::NixFile::saveMetadata (const MetaData &mtdt)
 {
+  QMutexLocker locker( writer.mutex() );
   Options::SaveFlags flags = static_cast<Options::SaveFlags>(Options::SwitchNameType | Options::FirstOnly);
   saveNIXOptions( mtdt, root_section, flags, mtdt.saveFlags() );
 }
@@ -2006,6 +2017,7 @@ void SaveFiles::NixFile::writeRePro ( const Options &reproinfo, const deque< str
 				      const InList &IL, const EventList &EL, const Options &data,
 				      double sessiontime )
 {
+  QMutexLocker locker( writer.mutex() );
   stepsize =  IL[0].stepsize();
   repro_start_time = traces[0].written * stepsize;
   string repro_name = reproinfo["RePro"].text() + "_" + nix::util::numToStr(reproinfo["Run"].number());
@@ -2046,6 +2058,7 @@ void SaveFiles::NixFile::writeRePro ( const Options &reproinfo, const deque< str
 
 void SaveFiles::NixFile::endRePro( double current_time )
 {
+  QMutexLocker locker( writer.mutex() );
   repro_tag.extent({ (current_time - repro_start_time)});
 
   if ( current_stimulus_info.stimulus_mtag && (stimulus_start_time + stimulus_duration) > current_time ) {
@@ -2076,7 +2089,9 @@ void SaveFiles::NixFile::initTraces ( const InList &IL )
     string ident = ((IL[k].device() == -1 && IL[k].source() > 0 )? "Filtered-" : "") + IL[k].ident();
     string data_type = "relacs.data.sampled." + ident;
 
-    trace.data = root_block.createDataArray(ident, data_type, nix::DataType::Float, {4096});
+    // empty data array, the writer extends it by each chunk:
+    size_t chunksize = NixTraceWriter::chunkSize( IL[k].sampleRate() );
+    trace.data = root_block.createDataArray(ident, data_type, nix::DataType::Float, {0});
     std::string unit = IL[k].unit();
     nix::util::unitSanitizer(unit);
     if ( !unit.empty() && nix::util::isSIUnit(unit) ) {
@@ -2092,27 +2107,22 @@ void SaveFiles::NixFile::initTraces ( const InList &IL )
     dim.label("time");
     trace.index = IL[k].size();
     trace.written = 0;
-    trace.offset = {0};
+    writer.addTrace( trace.data, chunksize );
     //^ NB:size() is the all-time number of bytes written
     //    string source_name = "device-" + nix::util::num2str(IL[k].device());
     //nix::Source s = root_block.createSource();
     traces.push_back(std::move(trace));
   }
+  writer.start();
 }
 
 
-void SaveFiles::NixFile::writeChunk(NixTrace   &trace,
-                                    size_t      to_read,
-                                    const void *data)
+void SaveFiles::NixFile::writeChunk( int trace, size_t to_read, const float *data )
 {
-  typedef nix::NDSize::value_type value_type;
-  nix::NDSize count = { static_cast<value_type>(to_read) };
-  nix::NDSize size = trace.offset + count;
-  trace.data.dataExtent( size );
-  trace.data.setData( nix::DataType::Float, data, count, trace.offset );
-  trace.index += to_read;
-  trace.written += to_read;
-  trace.offset = size;
+  // the writer collects the data into full chunks:
+  writer.append( trace, data, to_read );
+  traces[trace].index += to_read;
+  traces[trace].written += to_read;
 }
 
 
@@ -2267,6 +2277,8 @@ void SaveFiles::NixFile::writeStimulus( const InList &IL, const EventList &EL,
   if ( !fd || IL[0].signalIndex() < 1 || stim_info.size() == 0)
     return;
 
+  QMutexLocker locker( writer.mutex() );
+
   double abs_time = IL[0].signalTime() - sessiontime;
   double delay = stim_info[0].delay();
   double intensity = stim_info[0].intensity();
@@ -2491,11 +2503,11 @@ void SaveFiles::NixFile::writeTraces( const InList &IL ) {
     int to_read = 0;
     const float *data = IL[k].readBuffer( trace.index, to_read );
     if ( to_read > 0 ) {
-      writeChunk( trace, static_cast<size_t>(to_read), data );
+      writeChunk( k, static_cast<size_t>(to_read), data );
       if ( to_read < ndata ) {
 	data = IL[k].readBuffer( trace.index, to_read );
 	if ( to_read > 0 )
-	  writeChunk( trace, static_cast<size_t>(to_read), data );
+	  writeChunk( k, static_cast<size_t>(to_read), data );
       }
     }
   }
@@ -2528,6 +2540,7 @@ void SaveFiles::NixFile::initEvents( const EventList &EL, FilterDetectors *FD )
 void SaveFiles::NixFile::writeEvents( const InList &IL, const EventList &EL ) {
   if ( ! fd )
     return;
+  QMutexLocker locker( writer.mutex() );
   double off = 0.0;
   if ( ! traces.empty() )
     off = IL[0].interval( traces[0].index - traces[0].written );
@@ -25,6 +25,7 @@
 #include <cstdlib>
 #include <relacs/acquire.h>
 #include <relacs/optwidget.h>
+#include <relacs/profiler.h>
 #include <relacs/relacswidget.h>
 #include <relacs/savefiles.h>
 #include <relacs/settings.h>
@@ -41,6 +42,8 @@ Settings::Settings( RELACSWidget* rw )
   newSection( "Plugins" );
   addText( "pluginpathes", "Plugin pathes", "" );
   addText( "pluginhelppathes", "Pathes to plugin help files", "" );
+  addBoolean( "lazyplugins", "Load only plugin libraries that are needed", true );
+  addText( "pluginmanifest", "Plugin manifest file", "relacsplugins.manifest" );
   addText( "controlplugin", "Control plugin", "" );
   addText( "modelplugin", "Model plugin", "" );
   newSection( "Pathes" );
@@ -80,6 +83,14 @@ Settings::Settings( RELACSWidget* rw )
   newSection( "Data acquisition" );
   addNumber( "processinterval", "Interval for periodic processing of data", 0.10, 0.001, 1000.0, 0.001, "seconds", "ms" );
   addNumber( "aitimeout", "Minimum time that has to pass between analog input errors", 10.0, 0.0, 100000.0, 1.0, "seconds" );
+  addBoolean( "paralleldevices", "Open devices concurrently", true );
+  addNumber( "devicetimeout", "Maximum time for opening a single device", 30.0, 0.0, 10000.0, 1.0, "seconds" );
+  newSection( "Live export" );
+  addBoolean( "liveexport", "Export traces and events to shared memory", false );
+  addText( "liveexportname", "Name of the shared memory segment", "/relacs" ).addActivation( "liveexport", "true" );
+  addNumber( "liveexporttime", "Duration of exported data", 10.0, 1.0, 10000.0, 1.0, "seconds" ).addActivation( "liveexport", "true" );
+  newSection( "Profiling" );
+  addBoolean( "profiling", "Record timings of the data processing (View - Profiler)", false );
 
   addDialogStyle( OptWidget::Bold );
 
@@ -122,6 +133,8 @@ void Settings::notify( void )
   Str rp = text( "repropath" );
   rp.provideSlash();
   setenv( "RELACSREPROPATH", rp.c_str(), 1 );
+
+  Profiler::setEnabled( boolean( "profiling" ) );
 }
 
 